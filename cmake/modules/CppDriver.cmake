@@ -270,6 +270,7 @@ macro(CassUseZlib)
     # Assign zlib properties
     set(CASS_INCLUDES ${CASS_INCLUDES} ${ZLIB_INCLUDE_DIRS})
     set(CASS_LIBS ${CASS_LIBS} ${ZLIB_LIBRARIES})
+    add_definitions(-DCASS_USE_ZLIB)
   else()
     message(WARNING "Could not find zlib, try to set the path to zlib root folder in the system variable ZLIB_ROOT_DIR")
     message(WARNING "zlib libraries will not be linked into build")
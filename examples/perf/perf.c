@@ -38,15 +38,33 @@
 /*
  * Use this example with caution. It's just used as a scratch example for debugging and
  * roughly analyzing performance.
+ *
+ * The settings below can be overridden from the command line,
+ * e.g. -DUSE_REQUEST_INTERCEPTOR=1
  */
 
+#ifndef NUM_THREADS
 #define NUM_THREADS 1
+#endif
+#ifndef NUM_IO_WORKER_THREADS
 #define NUM_IO_WORKER_THREADS 4
+#endif
+#ifndef NUM_CONCURRENT_REQUESTS
 #define NUM_CONCURRENT_REQUESTS 10000
+#endif
+#ifndef NUM_ITERATIONS
 #define NUM_ITERATIONS 1000
+#endif
 
+#ifndef DO_SELECTS
 #define DO_SELECTS 1
+#endif
+#ifndef USE_PREPARED
 #define USE_PREPARED 1
+#endif
+#ifndef USE_REQUEST_INTERCEPTOR
+#define USE_REQUEST_INTERCEPTOR 0
+#endif
 
 const char* big_string = "0123456701234567012345670123456701234567012345670123456701234567"
                          "0123456701234567012345670123456701234567012345670123456701234567"
@@ -104,6 +122,12 @@ void print_error(CassFuture* future) {
   fprintf(stderr, "Error: %.*s\n", (int)message_length, message);
 }
 
+#if USE_REQUEST_INTERCEPTOR
+void on_request(const CassRequestInfo* info, CassCustomPayload* payload, void* data) {
+  /* Does nothing, used to measure the overhead of an interceptor */
+}
+#endif
+
 CassCluster* create_cluster(const char* hosts) {
   CassCluster* cluster = cass_cluster_new();
   cass_cluster_set_contact_points(cluster, hosts);
@@ -115,6 +139,9 @@ CassCluster* create_cluster(const char* hosts) {
   cass_cluster_set_core_connections_per_host(cluster, 1);
   cass_cluster_set_max_connections_per_host(cluster, 2);
   cass_cluster_set_max_requests_per_flush(cluster, 10000);
+#if USE_REQUEST_INTERCEPTOR
+  cass_cluster_set_request_interceptor(cluster, on_request, NULL);
+#endif
   return cluster;
 }
 
@@ -463,6 +463,179 @@ typedef struct CassMetrics_ {
 
 } CassMetrics;
 
+/**
+ * A snapshot of the session's connection pool metrics.
+ *
+ * @struct CassPoolMetrics
+ */
+typedef struct CassPoolMetrics_ {
+  cass_uint64_t total_connections; /**< The total number of connections */
+  cass_uint64_t draining_connections; /**< The number of connections closing after their in-flight requests finish */
+  cass_uint64_t connections_scaled_up; /**< Occurrences of a connection created because of request demand */
+  cass_uint64_t connections_scaled_down; /**< Occurrences of a connection closed because of low utilization */
+  cass_uint64_t concurrency_limit; /**< The sum of the adaptive concurrency limits of all pools */
+} CassPoolMetrics;
+
+/**
+ * A snapshot of the metrics of a single host or, when aggregated, of all the
+ * hosts in a data center.
+ *
+ * @struct CassHostMetrics
+ *
+ * @see cass_session_get_host_metrics()
+ * @see cass_session_get_dc_metrics()
+ */
+typedef struct CassHostMetrics_ {
+  CassInet address; /**< The host's address, address_length is 0 for a data center */
+  const char* dc; /**< The host's data center (not null-terminated) */
+  size_t dc_length; /**< The length of the data center's name */
+
+  struct {
+    cass_uint64_t min; /**< Minimum in microseconds */
+    cass_uint64_t max; /**< Maximum in microseconds */
+    cass_uint64_t mean; /**< Mean in microseconds */
+    cass_uint64_t stddev; /**< Standard deviation in microseconds */
+    cass_uint64_t median; /**< Median in microseconds */
+    cass_uint64_t percentile_75th; /**< 75th percentile in microseconds */
+    cass_uint64_t percentile_95th; /**< 95th percentile in microseconds */
+    cass_uint64_t percentile_98th; /**< 98th percentile in microseconds */
+    cass_uint64_t percentile_99th; /**< 99the percentile in microseconds */
+    cass_uint64_t percentile_999th; /**< 99.9th percentile in microseconds */
+    cass_uint64_t count; /**< The number of successful requests */
+    cass_double_t mean_rate; /**<  Mean rate in requests per second*/
+    cass_double_t one_minute_rate; /**< 1 minute rate in requests per second */
+    cass_double_t five_minute_rate; /**<  5 minute rate in requests per second*/
+    cass_double_t fifteen_minute_rate; /**< 15 minute rate in requests per second*/
+  } requests;
+
+  struct {
+    cass_uint64_t count; /**< The number of failed requests */
+    cass_double_t mean_rate; /**<  Mean rate in errors per second*/
+    cass_double_t one_minute_rate; /**< 1 minute rate in errors per second */
+    cass_double_t five_minute_rate; /**<  5 minute rate in errors per second*/
+    cass_double_t fifteen_minute_rate; /**< 15 minute rate in errors per second*/
+  } errors;
+
+  cass_uint64_t inflight_requests; /**< The number of requests waiting for a response */
+} CassHostMetrics;
+
+/**
+ * The time a request spent in each phase of its execution, in microseconds.
+ * Phases the request never reached are 0. When a request is retried the
+ * pool pending phase covers every attempt and the later phases describe the
+ * last attempt.
+ *
+ * @struct CassLatencyBreakdown
+ *
+ * @see cass_future_latency_breakdown()
+ */
+typedef struct CassLatencyBreakdown_ {
+  cass_uint64_t session_queue; /**< Waiting in the session's request queue */
+  cass_uint64_t io_worker_queue; /**< Routing and waiting in an I/O thread's request queue */
+  cass_uint64_t pool_pending; /**< Waiting for an available connection */
+  cass_uint64_t write; /**< Writing the request to the socket */
+  cass_uint64_t server; /**< Waiting for the response */
+  cass_uint64_t decode; /**< Processing the response and setting the future */
+  cass_uint64_t total; /**< From execution to the future being set */
+} CassLatencyBreakdown;
+
+/**
+ * A snapshot of a latency histogram, in microseconds.
+ *
+ * @struct CassLatencySnapshot
+ */
+typedef struct CassLatencySnapshot_ {
+  cass_uint64_t min; /**< Minimum in microseconds */
+  cass_uint64_t max; /**< Maximum in microseconds */
+  cass_uint64_t mean; /**< Mean in microseconds */
+  cass_uint64_t stddev; /**< Standard deviation in microseconds */
+  cass_uint64_t median; /**< Median in microseconds */
+  cass_uint64_t percentile_75th; /**< 75th percentile in microseconds */
+  cass_uint64_t percentile_95th; /**< 95th percentile in microseconds */
+  cass_uint64_t percentile_98th; /**< 98th percentile in microseconds */
+  cass_uint64_t percentile_99th; /**< 99the percentile in microseconds */
+  cass_uint64_t percentile_999th; /**< 99.9th percentile in microseconds */
+} CassLatencySnapshot;
+
+/**
+ * The latencies of every phase of request execution aggregated across all
+ * requests.
+ *
+ * @struct CassLatencyBreakdownMetrics
+ *
+ * @see CassLatencyBreakdown
+ * @see cass_session_get_latency_breakdown_metrics()
+ */
+typedef struct CassLatencyBreakdownMetrics_ {
+  CassLatencySnapshot session_queue;
+  CassLatencySnapshot io_worker_queue;
+  CassLatencySnapshot pool_pending;
+  CassLatencySnapshot write;
+  CassLatencySnapshot server;
+  CassLatencySnapshot decode;
+} CassLatencyBreakdownMetrics;
+
+/**
+ * The health of one of the driver's event loops. The histograms and the
+ * utilization are updated once every sample interval.
+ *
+ * @struct CassEventLoopMetrics
+ *
+ * @see cass_cluster_set_event_loop_metrics()
+ * @see cass_session_get_event_loop_metrics()
+ */
+typedef struct CassEventLoopMetrics_ {
+  CassLatencySnapshot lag; /**< How late the loop ran a periodic timer */
+  CassLatencySnapshot iteration_time; /**< Time spent running callbacks per loop iteration */
+  CassLatencySnapshot request_queue_time; /**< Time requests waited in the loop's request queue */
+  cass_double_t utilization; /**< Fraction of the last sample interval spent running callbacks (0.0 to 1.0) */
+  cass_uint64_t event_queue_size; /**< Current number of queued events */
+  cass_uint64_t request_queue_size; /**< Current number of queued requests */
+} CassEventLoopMetrics;
+
+/**
+ * The bytes held by the driver's buffers across all sessions.
+ *
+ * @struct CassMemoryMetrics
+ *
+ * @see cass_memory_get_metrics()
+ * @see cass_memory_set_limit()
+ */
+typedef struct CassMemoryMetrics_ {
+  cass_uint64_t request_encodings; /**< Bytes of encoded requests and bound values */
+  cass_uint64_t read_buffers; /**< Bytes of connection read buffers in use, excluding the buffers kept for reuse */
+  cass_uint64_t response_bodies; /**< Bytes of responses, including result rows */
+  cass_uint64_t metadata; /**< Bytes held by the schema metadata */
+  cass_uint64_t pending_writes; /**< Bytes of requests waiting to be written, mostly held by request encodings */
+  cass_uint64_t total; /**< Bytes counted against the limit (all of the above except pending writes) */
+  cass_uint64_t limit; /**< The memory limit, 0 if unlimited */
+  cass_uint64_t rejected_requests; /**< Occurrences of requests rejected because of the memory limit */
+} CassMemoryMetrics;
+
+/**
+ * The time spent in each phase of connecting a session. The pool phases are
+ * both measured from the end of the schema phase because pools are connected
+ * in parallel.
+ *
+ * @struct CassStartupReport
+ *
+ * @see cass_session_get_startup_report()
+ */
+typedef struct CassStartupReport_ {
+  cass_uint64_t resolve_us; /**< Resolving the contact points */
+  cass_uint64_t control_connection_us; /**< Establishing the control connection, including protocol negotiation and authentication */
+  cass_uint64_t schema_us; /**< Querying the hosts and schema metadata (or validating the topology cache) */
+  cass_uint64_t first_pool_ready_us; /**< Until the first connection pool was ready */
+  cass_uint64_t all_pools_ready_us; /**< Until all connection pools were ready */
+  cass_uint64_t total_us; /**< From the start of the connect to the session being connected */
+} CassStartupReport;
+
+typedef enum CassConcurrencyLimiter_ {
+  CASS_CONCURRENCY_LIMITER_NONE,
+  CASS_CONCURRENCY_LIMITER_AIMD,
+  CASS_CONCURRENCY_LIMITER_GRADIENT
+} CassConcurrencyLimiter;
+
 typedef enum CassConsistency_ {
   CASS_CONSISTENCY_UNKNOWN      = 0xFFFF,
   CASS_CONSISTENCY_ANY          = 0x0000,
@@ -591,7 +764,9 @@ typedef enum CassIteratorType_ {
   CASS_ITERATOR_TYPE_AGGREGATE_META,
   CASS_ITERATOR_TYPE_COLUMN_META,
   CASS_ITERATOR_TYPE_INDEX_META,
-  CASS_ITERATOR_TYPE_MATERIALIZED_VIEW_META
+  CASS_ITERATOR_TYPE_MATERIALIZED_VIEW_META,
+  CASS_ITERATOR_TYPE_HOST_METRICS,
+  CASS_ITERATOR_TYPE_SLOW_QUERY
 } CassIteratorType;
 
 #define CASS_LOG_LEVEL_MAP(XX) \
@@ -612,6 +787,11 @@ typedef enum CassLogLevel_ {
   /* @endcond */
 } CassLogLevel;
 
+typedef enum CassMemoryLimitMode_ {
+  CASS_MEMORY_LIMIT_MODE_REJECT,
+  CASS_MEMORY_LIMIT_MODE_BLOCK
+} CassMemoryLimitMode;
+
 typedef enum CassSslVerifyFlags {
   CASS_SSL_VERIFY_NONE              = 0x00,
   CASS_SSL_VERIFY_PEER_CERT         = 0x01,
@@ -661,6 +841,8 @@ typedef enum  CassErrorSource_ {
   XX(CASS_ERROR_SOURCE_LIB, CASS_ERROR_LIB_NOT_ENOUGH_DATA, 31, "Not enough data") \
   XX(CASS_ERROR_SOURCE_LIB, CASS_ERROR_LIB_INVALID_STATE, 32, "Invalid state") \
   XX(CASS_ERROR_SOURCE_LIB, CASS_ERROR_LIB_NO_CUSTOM_PAYLOAD, 33, "No custom payload") \
+  XX(CASS_ERROR_SOURCE_LIB, CASS_ERROR_LIB_MEMORY_LIMIT, 34, "Memory limit reached") \
+  XX(CASS_ERROR_SOURCE_LIB, CASS_ERROR_LIB_NO_TRACING_ID, 35, "No tracing ID") \
   XX(CASS_ERROR_SOURCE_SERVER, CASS_ERROR_SERVER_SERVER_ERROR, 0x0000, "Server error") \
   XX(CASS_ERROR_SOURCE_SERVER, CASS_ERROR_SERVER_PROTOCOL_ERROR, 0x000A, "Protocol error") \
   XX(CASS_ERROR_SOURCE_SERVER, CASS_ERROR_SERVER_BAD_CREDENTIALS, 0x0100, "Bad credentials") \
@@ -710,6 +892,144 @@ typedef enum CassError_ {
 typedef void (*CassFutureCallback)(CassFuture* future,
                                    void* data);
 
+/**
+ * A callback that's notified when a session is able to accept requests again
+ * after a request failed because the session's request queue or all its
+ * connections were at capacity.
+ *
+ * @param[in] session
+ * @param[in] data user defined data provided when the callback
+ * was registered.
+ *
+ * @see cass_session_set_capacity_callback()
+ */
+typedef void (*CassCapacityCallback)(CassSession* session,
+                                     void* data);
+
+/**
+ * A request that took longer than the slow query threshold.
+ *
+ * @struct CassSlowQuery
+ *
+ * @see cass_cluster_set_slow_query_log()
+ */
+typedef struct CassSlowQuery_ {
+  const char* statement; /**< The query, or the queries of a batch separated by "; " */
+  size_t statement_length;
+  const cass_int32_t* bound_value_sizes; /**< The size of each bound value in bytes, -1 if null or unset */
+  size_t bound_value_count;
+  CassInet coordinator; /**< The last host tried, the address length is 0 if no host was tried */
+  CassConsistency consistency; /**< The consistency of the last attempt */
+  cass_uint32_t retries; /**< The number of retries */
+  CassError error; /**< CASS_OK if the request succeeded */
+  cass_uint64_t latency; /**< From execution to completion in microseconds */
+  CassLatencyBreakdown phases; /**< All zeros unless latency breakdowns are enabled */
+} CassSlowQuery;
+
+/**
+ * A callback that's notified of slow queries on the session's thread (not
+ * an I/O thread). The query is only valid for the duration of the
+ * callback.
+ *
+ * @param[in] query
+ * @param[in] data user defined data provided when the callback
+ * was registered.
+ *
+ * @see cass_cluster_set_slow_query_callback()
+ */
+typedef void (*CassSlowQueryCallback)(const CassSlowQuery* query,
+                                      void* data);
+
+/**
+ * An event recorded by a host while processing a traced request.
+ *
+ * @struct CassTraceEvent
+ *
+ * @see cass_future_get_trace()
+ */
+typedef struct CassTraceEvent_ {
+  CassUuid event_id; /**< A time-based UUID of when the event occurred */
+  const char* activity; /**< A description of the event */
+  size_t activity_length;
+  CassInet source; /**< The host where the event occurred */
+  cass_int32_t source_elapsed; /**< Microseconds since the request started on the source host */
+  const char* thread; /**< The name of the thread that recorded the event */
+  size_t thread_length;
+} CassTraceEvent;
+
+/**
+ * A traced request's session and events from the "system_traces" keyspace.
+ *
+ * @struct CassTrace
+ *
+ * @see cass_session_get_trace()
+ * @see cass_future_get_trace()
+ */
+typedef struct CassTrace_ {
+  CassUuid tracing_id;
+  CassInet coordinator; /**< The address length is 0 if unknown */
+  cass_int32_t duration; /**< The duration on the coordinator in microseconds */
+  const char* request; /**< A description of the request */
+  size_t request_length;
+  cass_int64_t started_at; /**< Milliseconds since the epoch */
+  const CassTraceEvent* events; /**< The events in the order they occurred */
+  size_t event_count;
+} CassTrace;
+
+/**
+ * The stages of a request's lifecycle that are reported to a request
+ * interceptor.
+ *
+ * @see cass_cluster_set_request_interceptor()
+ */
+typedef enum CassRequestEvent_ {
+  CASS_REQUEST_EVENT_SUBMIT, /**< The request was passed to the session */
+  CASS_REQUEST_EVENT_HOST_CHOSEN, /**< A host was chosen from the query plan */
+  CASS_REQUEST_EVENT_WRITE_COMPLETE, /**< The request was written to the socket */
+  CASS_REQUEST_EVENT_RESPONSE, /**< A response was received from the host */
+  CASS_REQUEST_EVENT_RETRY, /**< The request is going to be retried after an error */
+  CASS_REQUEST_EVENT_COMPLETE /**< The request's future is about to be set */
+} CassRequestEvent;
+
+/**
+ * A read-only view of a request that's passed to a request interceptor.
+ *
+ * @struct CassRequestInfo
+ *
+ * @see cass_cluster_set_request_interceptor()
+ */
+typedef struct CassRequestInfo_ {
+  CassRequestEvent event;
+  cass_uint64_t id; /**< Identifies the request across events */
+  const CassStatement* statement; /**< NULL for batches and prepares */
+  const CassBatch* batch; /**< NULL for statements and prepares */
+  CassInet host; /**< The current host, the address length is 0 if no host has been chosen */
+  CassConsistency consistency; /**< The consistency of the current attempt */
+  cass_uint32_t retries; /**< The number of retries */
+  cass_uint64_t elapsed; /**< From submission to the event in microseconds */
+  CassError error; /**< The request's result (CASS_REQUEST_EVENT_COMPLETE only) */
+} CassRequestInfo;
+
+/**
+ * A callback that's notified at each stage of a request's lifecycle. It's
+ * called on the application's thread (submit), the session's thread
+ * (host chosen) and the I/O threads (the remaining events) so it must be
+ * thread-safe and must not block. The request info is only valid for the
+ * duration of the callback.
+ *
+ * @param[in] info
+ * @param[in] payload Entries added to this payload are sent with the
+ * request (protocol v4+). This is only non-NULL for
+ * CASS_REQUEST_EVENT_SUBMIT.
+ * @param[in] data user defined data provided when the callback
+ * was registered.
+ *
+ * @see cass_cluster_set_request_interceptor()
+ */
+typedef void (*CassRequestInterceptorCallback)(const CassRequestInfo* info,
+                                               CassCustomPayload* payload,
+                                               void* data);
+
 /**
  * Maximum size of a log message
  */
@@ -1006,8 +1326,13 @@ cass_cluster_set_queue_size_event(CassCluster* cluster,
  * Sets the size of the fixed size queue that stores
  * log messages.
  *
+ * <b>Note:</b> The log queue is shared by all sessions, its size is set
+ * using cass_log_set_queue_size(). This setting is ignored.
+ *
  * <b>Default:</b> 8192
  *
+ * @see cass_log_set_queue_size()
+ *
  * @public @memberof CassCluster
  *
  * @param[in] cluster
@@ -1098,6 +1423,109 @@ CASS_EXPORT CassError
 cass_cluster_set_max_concurrent_requests_threshold(CassCluster* cluster,
                                                    unsigned num_requests);
 
+/**
+ * Enable/Disable power of two choices connection selection. When enabled
+ * a request is written to the less busy of two randomly chosen connections
+ * to a host instead of the connection with the fewest in-flight requests.
+ * This spreads load more evenly when a large number of connections per
+ * host is used.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ *
+ * @see cass_cluster_set_max_connections_per_host()
+ */
+CASS_EXPORT void
+cass_cluster_set_connection_power_of_two_choices(CassCluster* cluster,
+                                                 cass_bool_t enabled);
+
+/**
+ * Sets the amount of time a host's connection pool must stay lightly
+ * loaded before a connection above the core number of connections is
+ * closed. The surplus connection stops taking new requests and is closed
+ * once its in-flight requests finish. A value of zero disables scaling
+ * down connection pools.
+ *
+ * <b>Default:</b> 0 (disabled)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] window_ms
+ *
+ * @see cass_cluster_set_core_connections_per_host()
+ * @see cass_cluster_set_max_concurrent_requests_threshold()
+ */
+CASS_EXPORT void
+cass_cluster_set_connection_scale_down_window(CassCluster* cluster,
+                                              unsigned window_ms);
+
+/**
+ * Sets the algorithm used to adaptively limit the number of in-flight
+ * requests to each host. Requests beyond a host's current limit wait for
+ * an in-flight request to finish and are subject to the pending requests
+ * water marks.
+ *
+ * <ul>
+ *   <li>CASS_CONCURRENCY_LIMITER_AIMD: The limit grows by about one request
+ *   per round-trip and is reduced multiplicatively when requests time out or
+ *   the host is overloaded.</li>
+ *   <li>CASS_CONCURRENCY_LIMITER_GRADIENT: The limit follows the ratio of the
+ *   minimum round-trip time observed over a window to the current round-trip
+ *   time and is also reduced when requests time out or the host is
+ *   overloaded.</li>
+ * </ul>
+ *
+ * <b>Default:</b> CASS_CONCURRENCY_LIMITER_NONE (disabled)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] type
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_concurrency_limiter_settings()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_concurrency_limiter(CassCluster* cluster,
+                                     CassConcurrencyLimiter type);
+
+/**
+ * Configures the settings for the adaptive concurrency limiter. Limits
+ * apply to each host's connection pool on each I/O thread.
+ *
+ * <b>Defaults:</b>
+ *
+ * <ul>
+ *   <li>initial_limit: 20</li>
+ *   <li>min_limit: 1</li>
+ *   <li>max_limit: 1000</li>
+ *   <li>min_rtt_window_ms: 1,000 milliseconds (1 second)</li>
+ * </ul>
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] initial_limit The limit used before any requests finish.
+ * @param[in] min_limit The lowest the limit can be reduced to.
+ * @param[in] max_limit The highest the limit can grow to.
+ * @param[in] min_rtt_window_ms The window over which the minimum round-trip
+ * time is tracked by the gradient algorithm.
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_concurrency_limiter()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_concurrency_limiter_settings(CassCluster* cluster,
+                                              unsigned initial_limit,
+                                              unsigned min_limit,
+                                              unsigned max_limit,
+                                              unsigned min_rtt_window_ms);
+
 /**
  * Sets the maximum number of requests processed by an IO worker
  * per flush.
@@ -1351,6 +1779,263 @@ cass_cluster_set_token_aware_routing(CassCluster* cluster,
                                      cass_bool_t enabled);
 
 
+/**
+ * Configures the cluster to use power-of-two-choices request routing or not.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * This routing policy compares two random local hosts from the
+ * dc-aware and/or token-aware routing policies and sends the request to
+ * the host with fewer requests in-flight. Hosts that recently returned
+ * a timeout or overloaded error lose to hosts that didn't. With
+ * token-aware routing enabled the two hosts are replicas of the
+ * request's partition when possible.
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ *
+ * @see cass_cluster_set_power_of_two_choices_error_backoff()
+ */
+CASS_EXPORT void
+cass_cluster_set_power_of_two_choices_routing(CassCluster* cluster,
+                                              cass_bool_t enabled);
+
+/**
+ * Sets the amount of time a host is less preferred by power-of-two-choices
+ * routing after it returns a timeout or overloaded error.
+ *
+ * <b>Default:</b> 1000 milliseconds
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] backoff_ms
+ *
+ * @see cass_cluster_set_power_of_two_choices_routing()
+ */
+CASS_EXPORT void
+cass_cluster_set_power_of_two_choices_error_backoff(CassCluster* cluster,
+                                                    cass_uint64_t backoff_ms);
+
+/**
+ * Enables per-host metrics. A host's metrics are allocated the first time
+ * a request is sent to it.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ *
+ * @see cass_cluster_set_host_metrics_significant_figures()
+ * @see cass_session_get_host_metrics()
+ * @see cass_session_get_dc_metrics()
+ */
+CASS_EXPORT void
+cass_cluster_set_host_metrics(CassCluster* cluster,
+                              cass_bool_t enabled);
+
+/**
+ * Sets the precision of the per-host latency histograms. Each additional
+ * significant figure increases the size of every host's histograms
+ * about ten-fold.
+ *
+ * <b>Default:</b> 2
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] significant_figures A value between 1 and 5
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_host_metrics()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_host_metrics_significant_figures(CassCluster* cluster,
+                                                  unsigned significant_figures);
+
+/**
+ * Enables recording the time requests spend in each phase of their
+ * execution. When disabled this costs a single branch per phase.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ *
+ * @see cass_future_latency_breakdown()
+ * @see cass_session_get_latency_breakdown_metrics()
+ */
+CASS_EXPORT void
+cass_cluster_set_latency_breakdown(CassCluster* cluster,
+                                   cass_bool_t enabled);
+
+/**
+ * Enables logging of request latencies to a file in the HdrHistogram log
+ * format. A compressed histogram of the latencies (in microseconds) of the
+ * requests that finished during each interval is appended to the file so
+ * that it can be processed by the HdrHistogram tools, e.g.
+ * HistogramLogProcessor. The file is truncated when the session connects.
+ *
+ * <b>Note:</b> This requires the driver to be built with zlib
+ * (CASS_USE_ZLIB).
+ *
+ * <b>Default:</b> Disabled
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] path The path of the log file. An empty path disables logging.
+ * @param[in] interval_ms The length of each logged interval in milliseconds.
+ * @return CASS_OK if successful, otherwise an error occurred.
+ * CASS_ERROR_LIB_NOT_IMPLEMENTED is returned if the driver wasn't built
+ * with zlib.
+ *
+ * @see cass_session_get_request_latency_interval()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_histogram_log(CassCluster* cluster,
+                               const char* path,
+                               unsigned interval_ms);
+
+/**
+ * Same as cass_cluster_set_histogram_log(), but with lengths for string
+ * parameters.
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] path
+ * @param[in] path_length
+ * @param[in] interval_ms
+ * @return same as cass_cluster_set_histogram_log()
+ *
+ * @see cass_cluster_set_histogram_log()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_histogram_log_n(CassCluster* cluster,
+                                 const char* path,
+                                 size_t path_length,
+                                 unsigned interval_ms);
+
+/**
+ * Enables the event loop health metrics of the session's event loop and
+ * of each I/O thread's event loop: the loop lag, the time spent running
+ * callbacks per iteration, the loop utilization, the time requests wait in
+ * the request queues and the depths of the queues. The histograms and the
+ * utilization are updated once every sample interval.
+ *
+ * <b>Default:</b> 0 (disabled)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] sample_interval_ms The sample interval in milliseconds. A
+ * value of 0 disables the metrics.
+ *
+ * @see cass_session_get_event_loop_metrics()
+ */
+CASS_EXPORT void
+cass_cluster_set_event_loop_metrics(CassCluster* cluster,
+                                    unsigned sample_interval_ms);
+
+/**
+ * Enables capturing the requests that take longer than a threshold,
+ * including their statement, bound value sizes, coordinator, consistency,
+ * retries and (if enabled) latency breakdown, without enabling tracing.
+ * A fraction of the slow requests can be captured using the sample rate.
+ * Slow queries are kept in a bounded queue that's drained with
+ * cass_session_get_slow_queries() or delivered to the callback set with
+ * cass_cluster_set_slow_query_callback(). Slow queries are dropped if the
+ * queue is full.
+ *
+ * <b>Default:</b> 0 (disabled), 1.0 (all slow queries) and a queue size
+ * of 1024
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] threshold_ms The latency threshold in milliseconds. A value of
+ * 0 disables the slow query log.
+ * @param[in] sample_rate The fraction (0.0 to 1.0) of slow queries that are
+ * captured.
+ * @param[in] queue_size The maximum number of queued slow queries.
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_latency_breakdown()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_slow_query_log(CassCluster* cluster,
+                                cass_uint64_t threshold_ms,
+                                cass_double_t sample_rate,
+                                unsigned queue_size);
+
+/**
+ * Sets a callback that's notified of slow queries on the session's
+ * thread. The slow queries aren't returned by
+ * cass_session_get_slow_queries() when a callback is set.
+ *
+ * <b>Default:</b> NULL (no callback)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] callback
+ * @param[in] data
+ *
+ * @see cass_cluster_set_slow_query_log()
+ */
+CASS_EXPORT void
+cass_cluster_set_slow_query_callback(CassCluster* cluster,
+                                     CassSlowQueryCallback callback,
+                                     void* data);
+
+/**
+ * Sets the maximum amount of time to wait for a trace to be complete when
+ * it's retrieved using cass_session_get_trace(). Traces are written
+ * asynchronously by Cassandra so the "system_traces" tables are polled
+ * with an increasing delay until the trace is complete or this time has
+ * elapsed.
+ *
+ * <b>Default:</b> 2000 milliseconds
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] max_wait_time_ms
+ *
+ * @see cass_session_get_trace()
+ */
+CASS_EXPORT void
+cass_cluster_set_tracing_max_wait_time(CassCluster* cluster,
+                                       unsigned max_wait_time_ms);
+
+/**
+ * Sets an interceptor that's notified when requests are submitted, when
+ * a host is chosen, when the request is written, when a response is
+ * received, when the request is retried and when it completes. The
+ * interceptor can attach custom payload entries when a request is
+ * submitted; these replace the statement's entries with the same name.
+ * When no interceptor is set requests aren't instrumented.
+ *
+ * <b>Default:</b> NULL (no interceptor)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] callback
+ * @param[in] data
+ */
+CASS_EXPORT void
+cass_cluster_set_request_interceptor(CassCluster* cluster,
+                                     CassRequestInterceptorCallback callback,
+                                     void* data);
+
 /**
  * Configures the cluster to use latency-aware request routing or not.
  *
@@ -1659,29 +2344,199 @@ cass_cluster_set_connection_idle_timeout(CassCluster* cluster,
  * @see cass_batch_set_retry_policy()
  */
 CASS_EXPORT void
-cass_cluster_set_retry_policy(CassCluster* cluster,
-                              CassRetryPolicy* retry_policy);
+cass_cluster_set_retry_policy(CassCluster* cluster,
+                              CassRetryPolicy* retry_policy);
+
+/**
+ * Enable/Disable retrieving and updating schema metadata. If disabled
+ * this is allows the driver to skip over retrieving and updating schema
+ * metadata, but it also disables the usage of token-aware routing and
+ * cass_session_get_schema_meta() will always return an empty object. This can
+ * be useful for reducing the startup overhead of short-lived sessions.
+ *
+ * <b>Default:</b> cass_true (enabled).
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] enabled
+ *
+ * @see cass_session_get_schema_meta()
+ * @see cass_cluster_set_token_aware_routing()
+ */
+CASS_EXPORT void
+cass_cluster_set_use_schema(CassCluster* cluster,
+                            cass_bool_t enabled);
+
+/**
+ * Sets/Appends the keyspaces that schema metadata is retrieved for. The first
+ * call sets the keyspaces and any subsequent calls append additional
+ * keyspaces. Passing an empty string will clear the filter and schema
+ * metadata is retrieved for all keyspaces. White space is striped from the
+ * keyspace names.
+ *
+ * Schema metadata for other keyspaces isn't retrieved and schema change events
+ * for other keyspaces are ignored. This reduces the startup time and memory
+ * used by sessions connected to clusters with many keyspaces. Token-aware
+ * routing is only available for requests to keyspaces in the filter and
+ * cass_session_get_schema_meta() only contains the keyspaces in the filter.
+ *
+ * Examples: "ks1" "ks1,ks2"
+ *
+ * <b>Default:</b> Empty (all keyspaces)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] keyspaces A comma delimited list of case-sensitive keyspace
+ * names. An empty string will clear the filter. The string is copied into the
+ * cluster configuration; the memory pointed to by this parameter can be freed
+ * after this call.
+ *
+ * @see cass_cluster_set_use_schema()
+ */
+CASS_EXPORT void
+cass_cluster_set_schema_keyspace_filter(CassCluster* cluster,
+                                        const char* keyspaces);
+
+/**
+ * Same as cass_cluster_set_schema_keyspace_filter(), but with lengths for
+ * string parameters.
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] keyspaces
+ * @param[in] keyspaces_length
+ * @return same as cass_cluster_set_schema_keyspace_filter()
+ *
+ * @see cass_cluster_set_schema_keyspace_filter()
+ */
+CASS_EXPORT void
+cass_cluster_set_schema_keyspace_filter_n(CassCluster* cluster,
+                                          const char* keyspaces,
+                                          size_t keyspaces_length);
+
+/**
+ * Sets the window used to debounce schema and topology change events received
+ * on the control connection. Events received within the window are merged
+ * into the fewest number of metadata refresh queries e.g. many changed tables
+ * in the same keyspace are refreshed using a single set of queries. The window
+ * is restarted by each new event, but pending events are never delayed longer
+ * than the maximum delay after the first event of a burst.
+ *
+ * Dropped keyspaces, tables, types and functions, removed nodes and node status
+ * changes are always handled immediately.
+ *
+ * <b>Default:</b> 0 (disabled, events are handled immediately)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] window_ms The time to wait for additional events in milliseconds.
+ * A value of 0 disables debouncing.
+ * @param[in] max_delay_ms The maximum time an event is delayed in milliseconds.
+ * If this is less than the window then the window is used.
+ *
+ * @see cass_cluster_set_use_schema()
+ */
+CASS_EXPORT void
+cass_cluster_set_event_debounce(CassCluster* cluster,
+                                unsigned window_ms,
+                                unsigned max_delay_ms);
+
+/**
+ * Sets the path of a file used to cache the cluster's topology between process
+ * starts. The file holds the hosts, tokens, partitioner and keyspace
+ * replication settings and is written each time the control connection
+ * refreshes the cluster's metadata.
+ *
+ * When a valid cache exists the session is connected as soon as the control
+ * connection has verified that the schema version and the release version of
+ * the connected host still match the cache. Connection pools are opened to
+ * the cached hosts and token-aware routing is available immediately while the
+ * hosts and schema metadata are refreshed in the background. The cache is
+ * discarded if either version differs.
+ *
+ * <b>Note:</b> The cache requires schema metadata to be enabled.
+ * cass_session_get_schema_meta() doesn't contain the full schema metadata
+ * until the background refresh has finished.
+ *
+ * <b>Default:</b> Disabled
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] path The path of the cache file. An empty path disables the
+ * cache.
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_cluster_set_use_schema()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_topology_cache_file(CassCluster* cluster,
+                                     const char* path);
+
+/**
+ * Same as cass_cluster_set_topology_cache_file(), but with lengths for string
+ * parameters.
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] path
+ * @param[in] path_length
+ * @return same as cass_cluster_set_topology_cache_file()
+ *
+ * @see cass_cluster_set_topology_cache_file()
+ */
+CASS_EXPORT CassError
+cass_cluster_set_topology_cache_file_n(CassCluster* cluster,
+                                       const char* path,
+                                       size_t path_length);
+
+/**
+ * Sets the maximum number of connection pools each IO thread connects
+ * concurrently while the session is connecting. Pools to hosts in the local
+ * data center are connected first. This bounds the burst of connection and
+ * handshake traffic when connecting to a large cluster while keeping
+ * independent hosts connecting in parallel. Pools added after the session is
+ * connected are not limited.
+ *
+ * <b>Default:</b> 0 (unbounded, all pools connect at once)
+ *
+ * @public @memberof CassCluster
+ *
+ * @param[in] cluster
+ * @param[in] fanout The maximum number of connecting pools per IO thread.
+ * A value of 0 doesn't limit the number of connecting pools.
+ *
+ * @see cass_cluster_set_num_threads_io()
+ * @see cass_session_get_startup_report()
+ */
+CASS_EXPORT void
+cass_cluster_set_startup_pool_fanout(CassCluster* cluster,
+                                     unsigned fanout);
 
 /**
- * Enable/Disable retrieving and updating schema metadata. If disabled
- * this is allows the driver to skip over retrieving and updating schema
- * metadata, but it also disables the usage of token-aware routing and
- * cass_session_get_schema_meta() will always return an empty object. This can
- * be useful for reducing the startup overhead of short-lived sessions.
+ * Enable/Disable sending an OPTIONS request before the STARTUP request when
+ * a connection is established. The driver doesn't use the options returned
+ * by the server so disabling the request removes a round trip from every new
+ * connection. Servers that require an OPTIONS request before STARTUP are
+ * rare, but it can be enabled if a proxy expects it.
  *
- * <b>Default:</b> cass_true (enabled).
+ * <b>Default:</b> cass_true (enabled)
  *
  * @public @memberof CassCluster
  *
  * @param[in] cluster
  * @param[in] enabled
  *
- * @see cass_session_get_schema_meta()
- * @see cass_cluster_set_token_aware_routing()
+ * @see cass_session_get_startup_report()
  */
 CASS_EXPORT void
-cass_cluster_set_use_schema(CassCluster* cluster,
-                            cass_bool_t enabled);
+cass_cluster_set_use_options_handshake(CassCluster* cluster,
+                                       cass_bool_t enabled);
 
 /**
  * Enable/Disable retrieving hostnames for IP addresses using reverse IP lookup.
@@ -1870,6 +2725,48 @@ CASS_EXPORT CassFuture*
 cass_session_execute_batch(CassSession* session,
                            const CassBatch* batch);
 
+/**
+ * Gets the approximate number of requests that can be executed before the
+ * session's request queue is full and requests fail with
+ * CASS_ERROR_LIB_REQUEST_QUEUE_FULL.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @return The remaining capacity of the request queue or zero if the
+ * session is not connected.
+ *
+ * @see cass_cluster_set_queue_size_io()
+ * @see cass_session_set_capacity_callback()
+ */
+CASS_EXPORT size_t
+cass_session_get_request_capacity(const CassSession* session);
+
+/**
+ * Sets a callback that's notified when the session is able to accept
+ * requests again after a request failed with CASS_ERROR_LIB_REQUEST_QUEUE_FULL
+ * or because all connections were busy. The callback is notified once the
+ * request queue drains below half its capacity or once a host's pending
+ * requests drop below the pending requests low water mark. This allows
+ * producers to wait for capacity instead of retrying failed requests.
+ *
+ * <b>Note:</b> The callback is notified on the session's internal thread and
+ * must not block. It can be set or replaced at any time.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[in] callback
+ * @param[in] data
+ *
+ * @see cass_session_get_request_capacity()
+ * @see cass_cluster_set_pending_requests_low_water_mark()
+ */
+CASS_EXPORT void
+cass_session_set_capacity_callback(CassSession* session,
+                                   CassCapacityCallback callback,
+                                   void* data);
+
 /**
  * Gets a snapshot of this session's schema metadata. The returned
  * snapshot of the schema metadata is not updated. This function
@@ -1900,6 +2797,183 @@ CASS_EXPORT void
 cass_session_get_metrics(const CassSession* session,
                          CassMetrics* output);
 
+/**
+ * Gets a copy of this session's connection pool metrics.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[out] output
+ *
+ * @see cass_cluster_set_connection_scale_down_window()
+ */
+CASS_EXPORT void
+cass_session_get_pool_metrics(const CassSession* session,
+                              CassPoolMetrics* output);
+
+/**
+ * Gets a snapshot of the request latencies recorded since the previous call
+ * to this function (or since the session was connected for the first call).
+ * Unlike cass_session_get_metrics(), which reports latencies since the
+ * session was connected, this starts a new interval every time it's called
+ * so that recent changes in latency aren't hidden by the session's history.
+ *
+ * <b>Note:</b> The interval is shared by all callers of this function.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[out] output
+ *
+ * @see cass_cluster_set_histogram_log()
+ */
+CASS_EXPORT void
+cass_session_get_request_latency_interval(const CassSession* session,
+                                          CassLatencySnapshot* output);
+
+/**
+ * Gets an iterator over a snapshot of the metrics of each host that has
+ * been sent requests. Per-host metrics must be enabled.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @return A new iterator that must be freed.
+ *
+ * @see cass_cluster_set_host_metrics()
+ * @see cass_iterator_get_host_metrics()
+ * @see cass_iterator_free()
+ */
+CASS_EXPORT CassIterator*
+cass_session_get_host_metrics(const CassSession* session);
+
+/**
+ * Gets an iterator that removes the slow queries captured by the session.
+ * Each slow query is only returned once. The slow query log must be
+ * enabled.
+ *
+ * <b>Note:</b> The iterator must be freed before the session.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @return A new iterator that must be freed.
+ *
+ * @see cass_cluster_set_slow_query_log()
+ * @see cass_iterator_get_slow_query()
+ * @see cass_iterator_free()
+ */
+CASS_EXPORT CassIterator*
+cass_session_get_slow_queries(CassSession* session);
+
+/**
+ * Retrieves the trace of a request that was executed with tracing enabled.
+ * The trace is queried from the "system_traces" keyspace using the control
+ * connection and the query is retried with an increasing delay until the
+ * trace is complete.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[in] tracing_id The tracing ID returned by cass_future_tracing_id().
+ * @return A future that must be freed. The trace is returned by
+ * cass_future_get_trace().
+ *
+ * @see cass_statement_set_tracing()
+ * @see cass_cluster_set_tracing_max_wait_time()
+ */
+CASS_EXPORT CassFuture*
+cass_session_get_trace(CassSession* session,
+                       CassUuid tracing_id);
+
+/**
+ * Gets an iterator over a snapshot of the per-host metrics aggregated by
+ * data center. Per-host metrics must be enabled.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @return A new iterator that must be freed.
+ *
+ * @see cass_cluster_set_host_metrics()
+ * @see cass_iterator_get_host_metrics()
+ * @see cass_iterator_free()
+ */
+CASS_EXPORT CassIterator*
+cass_session_get_dc_metrics(const CassSession* session);
+
+/**
+ * Gets a snapshot of the latency histograms of each phase of request
+ * execution.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise an error occurred.
+ * CASS_ERROR_LIB_BAD_PARAMS is returned if latency breakdowns aren't
+ * enabled.
+ *
+ * @see cass_cluster_set_latency_breakdown()
+ */
+CASS_EXPORT CassError
+cass_session_get_latency_breakdown_metrics(const CassSession* session,
+                                           CassLatencyBreakdownMetrics* output);
+
+/**
+ * Gets the number of event loops used by the session. This is the number
+ * of I/O threads plus one for the session's own event loop.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @return The number of event loops.
+ *
+ * @see cass_session_get_event_loop_metrics()
+ */
+CASS_EXPORT size_t
+cass_session_get_event_loop_count(const CassSession* session);
+
+/**
+ * Gets the health metrics of one of the session's event loops. Index 0
+ * is the session's event loop and the remaining indexes are the I/O
+ * thread event loops.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[in] index
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise an error occurred.
+ * CASS_ERROR_LIB_BAD_PARAMS is returned if event loop metrics aren't
+ * enabled, the session isn't connected or the index is out of range.
+ *
+ * @see cass_cluster_set_event_loop_metrics()
+ * @see cass_session_get_event_loop_count()
+ */
+CASS_EXPORT CassError
+cass_session_get_event_loop_metrics(const CassSession* session,
+                                    size_t index,
+                                    CassEventLoopMetrics* output);
+
+/**
+ * Gets the time spent in each phase of connecting the session. The report is
+ * also logged at the CASS_LOG_INFO level when the session connects.
+ *
+ * @public @memberof CassSession
+ *
+ * @param[in] session
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise CASS_ERROR_LIB_NO_HOSTS_AVAILABLE
+ * if the session isn't connected.
+ *
+ * @see cass_cluster_set_startup_pool_fanout()
+ * @see cass_cluster_set_use_options_handshake()
+ */
+CASS_EXPORT CassError
+cass_session_get_startup_report(const CassSession* session,
+                                CassStartupReport* output);
+
 /***********************************************************************************
  *
  * Schema Metadata
@@ -3680,6 +4754,61 @@ cass_future_custom_payload_item(CassFuture* future,
                                 const cass_byte_t** value,
                                 size_t* value_size);
 
+/**
+ * Gets the time the request spent in each phase of its execution. This
+ * is a blocking call if the future is not set.
+ *
+ * @public @memberof CassFuture
+ *
+ * @param[in] future
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise an error occurred.
+ * CASS_ERROR_LIB_BAD_PARAMS is returned if latency breakdowns weren't
+ * enabled when the request was executed.
+ *
+ * @see cass_cluster_set_latency_breakdown()
+ */
+CASS_EXPORT CassError
+cass_future_latency_breakdown(CassFuture* future,
+                              CassLatencyBreakdown* output);
+
+/**
+ * Gets the tracing ID of a traced request from a response future. If the
+ * future is not ready this method will wait for the future to be set.
+ *
+ * @public @memberof CassFuture
+ *
+ * @param[in] future
+ * @param[out] tracing_id
+ * @return CASS_OK if successful, otherwise an error occurred.
+ * CASS_ERROR_LIB_NO_TRACING_ID is returned if the request wasn't traced.
+ *
+ * @see cass_statement_set_tracing()
+ * @see cass_session_get_trace()
+ */
+CASS_EXPORT CassError
+cass_future_tracing_id(CassFuture* future,
+                       CassUuid* tracing_id);
+
+/**
+ * Gets a trace from a future returned by cass_session_get_trace(). If the
+ * future is not ready this method will wait for the future to be set. The
+ * trace's strings and events are valid until the future is freed.
+ *
+ * @public @memberof CassFuture
+ *
+ * @param[in] future
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise an error occurred.
+ * CASS_ERROR_LIB_REQUEST_TIMED_OUT is returned if the trace wasn't
+ * complete within the maximum wait time.
+ *
+ * @see cass_session_get_trace()
+ */
+CASS_EXPORT CassError
+cass_future_get_trace(CassFuture* future,
+                      CassTrace* output);
+
 /***********************************************************************************
  *
  * Statement
@@ -3950,6 +5079,23 @@ CASS_EXPORT CassError
 cass_statement_set_custom_payload(CassStatement* statement,
                                   const CassCustomPayload* payload);
 
+/**
+ * Enables server-side tracing for the statement. The tracing ID is
+ * returned by cass_future_tracing_id() and the trace can be retrieved
+ * using cass_session_get_trace().
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * @public @memberof CassStatement
+ *
+ * @param[in] statement
+ * @param[in] enabled
+ * @return CASS_OK if successful, otherwise an error occurred.
+ */
+CASS_EXPORT CassError
+cass_statement_set_tracing(CassStatement* statement,
+                           cass_bool_t enabled);
+
 /**
  * Binds null to a query or bound statement at the specified index.
  *
@@ -5228,6 +6374,23 @@ CASS_EXPORT CassError
 cass_batch_set_custom_payload(CassBatch* batch,
                               const CassCustomPayload* payload);
 
+/**
+ * Enables server-side tracing for the batch.
+ *
+ * <b>Default:</b> cass_false (disabled).
+ *
+ * @public @memberof CassBatch
+ *
+ * @param[in] batch
+ * @param[in] enabled
+ * @return CASS_OK if successful, otherwise an error occurred.
+ *
+ * @see cass_statement_set_tracing()
+ */
+CASS_EXPORT CassError
+cass_batch_set_tracing(CassBatch* batch,
+                       cass_bool_t enabled);
+
 /**
  * Adds a statement to a batch.
  *
@@ -8562,6 +9725,43 @@ cass_iterator_get_function_meta(const CassIterator* iterator);
 CASS_EXPORT const CassAggregateMeta*
 cass_iterator_get_aggregate_meta(const CassIterator* iterator);
 
+/**
+ * Gets the host or data center metrics at the iterator's current position.
+ *
+ * Calling cass_iterator_next() will invalidate the data center name
+ * returned by this method.
+ *
+ * @public @memberof CassIterator
+ *
+ * @param[in] iterator
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise error occurred
+ *
+ * @see cass_session_get_host_metrics()
+ * @see cass_session_get_dc_metrics()
+ */
+CASS_EXPORT CassError
+cass_iterator_get_host_metrics(const CassIterator* iterator,
+                               CassHostMetrics* output);
+
+/**
+ * Gets the slow query at the iterator's current position.
+ *
+ * Calling cass_iterator_next() will invalidate the statement and bound
+ * value sizes returned by this method.
+ *
+ * @public @memberof CassIterator
+ *
+ * @param[in] iterator
+ * @param[out] output
+ * @return CASS_OK if successful, otherwise error occurred
+ *
+ * @see cass_session_get_slow_queries()
+ */
+CASS_EXPORT CassError
+cass_iterator_get_slow_query(const CassIterator* iterator,
+                             CassSlowQuery* output);
+
 /**
  * Gets the column metadata entry at the iterator's current position.
  *
@@ -9455,11 +10655,14 @@ cass_error_desc(CassError error);
  * This *MUST* be the last call using the library. It is an error
  * to call any cass_*() functions after this call.
  *
- * @deprecated This is no longer useful and does nothing. Expect this to be
- * removed in a few releases.
+ * <b>Note:</b> This only needs to be called if a log queue was enabled
+ * using cass_log_set_queue_size(). The logging callback won't be called
+ * after this returns.
+ *
+ * @see cass_log_set_queue_size()
  */
 CASS_EXPORT void
-CASS_DEPRECATED(cass_log_cleanup());
+cass_log_cleanup();
 
 /**
  * Sets the log level.
@@ -9491,20 +10694,38 @@ cass_log_set_callback(CassLogCallback callback,
                       void* data);
 
 /**
- * Sets the log queue size.
+ * Sets the log queue size. A non-zero size enables asynchronous logging:
+ * log messages are added to a fixed size queue and the logging callback is
+ * called on a dedicated logging thread, so a slow callback doesn't block
+ * the driver's threads. Messages are dropped if the queue is full, the
+ * number of dropped messages is returned by cass_log_get_dropped_count()
+ * and is periodically logged as a warning.
  *
  * <b>Note:</b> This needs to be done before any call that might log, such as
- * any of the cass_cluster_*() or cass_ssl_*() functions.
+ * any of the cass_cluster_*() or cass_ssl_*() functions. cass_log_cleanup()
+ * must be called to flush the queue before the application exits.
  *
- * <b>Default:</b> 2048
+ * <b>Default:</b> 0 (The logging callback is called synchronously on the
+ * thread that logged the message)
  *
- * @deprecated This is no longer useful and does nothing. Expect this to be
- * removed in a few releases.
+ * @param[in] queue_size The maximum number of queued messages (rounded
+ * up to the next power of 2), 0 disables asynchronous logging.
  *
- * @param[in] queue_size
+ * @see cass_log_cleanup()
  */
 CASS_EXPORT void
-CASS_DEPRECATED(cass_log_set_queue_size(size_t queue_size));
+cass_log_set_queue_size(size_t queue_size);
+
+/**
+ * Gets the number of log messages that were dropped because the log queue
+ * was full.
+ *
+ * @return The number of dropped messages.
+ *
+ * @see cass_log_set_queue_size()
+ */
+CASS_EXPORT cass_uint64_t
+cass_log_get_dropped_count();
 
 /**
  * Gets the string for a log level.
@@ -9516,6 +10737,51 @@ CASS_DEPRECATED(cass_log_set_queue_size(size_t queue_size));
 CASS_EXPORT const char*
 cass_log_level_string(CassLogLevel log_level);
 
+/***********************************************************************************
+ *
+ * Memory
+ *
+ ***********************************************************************************/
+
+/**
+ * Sets a limit on the bytes held by the driver's buffers (request
+ * encodings, read buffers, responses and schema metadata) across all
+ * sessions. New requests aren't admitted once the limit is reached:
+ *
+ * <ul>
+ *   <li>CASS_MEMORY_LIMIT_MODE_REJECT: The request's future is immediately
+ *   set to CASS_ERROR_LIB_MEMORY_LIMIT.</li>
+ *   <li>CASS_MEMORY_LIMIT_MODE_BLOCK: The executing thread waits for
+ *   buffers to be released, up to the request timeout, before the request
+ *   fails with CASS_ERROR_LIB_MEMORY_LIMIT.</li>
+ * </ul>
+ *
+ * <b>Note:</b> The limit is checked when a request is executed so the
+ * total can exceed the limit by the size of the requests (and their
+ * responses) already in flight. Requests waiting for a connection in a
+ * host's pool aren't encoded yet so only their bound values are counted.
+ *
+ * <b>Default:</b> 0 (unlimited), CASS_MEMORY_LIMIT_MODE_REJECT
+ *
+ * @param[in] limit_bytes The limit in bytes. A value of 0 disables the limit.
+ * @param[in] mode
+ *
+ * @see cass_memory_get_metrics()
+ */
+CASS_EXPORT void
+cass_memory_set_limit(cass_uint64_t limit_bytes,
+                      CassMemoryLimitMode mode);
+
+/**
+ * Gets the bytes held by the driver's buffers across all sessions.
+ *
+ * @param[out] output
+ *
+ * @see cass_memory_set_limit()
+ */
+CASS_EXPORT void
+cass_memory_get_metrics(CassMemoryMetrics* output);
+
 /***********************************************************************************
  *
  * Inet
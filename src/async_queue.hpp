@@ -56,6 +56,9 @@ public:
 
   bool dequeue(typename Q::EntryType& data) { return queue_.dequeue(data); }
 
+  size_t size() const { return queue_.size(); }
+  size_t capacity() const { return queue_.capacity(); }
+
   // Testing only
   bool is_empty() const { return queue_.is_empty(); }
 
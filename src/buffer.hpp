@@ -34,7 +34,7 @@ public:
   Buffer(const char* data, size_t size)
     : size_(size) {
     if (size > FIXED_BUFFER_SIZE) {
-      RefBuffer* buffer = RefBuffer::create(size);
+      RefBuffer* buffer = RefBuffer::create(size, MemoryBudget::REQUEST_ENCODING);
       buffer->inc_ref();
       memcpy(buffer->data(), data, size);
       data_.buffer = buffer;
@@ -47,7 +47,7 @@ public:
   Buffer(size_t size)
     : size_(size) {
     if (size > FIXED_BUFFER_SIZE) {
-      RefBuffer* buffer = RefBuffer::create(size);
+      RefBuffer* buffer = RefBuffer::create(size, MemoryBudget::REQUEST_ENCODING);
       buffer->inc_ref();
       data_.buffer = buffer;
     }
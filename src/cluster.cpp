@@ -17,6 +17,7 @@
 #include "cluster.hpp"
 
 #include "dc_aware_policy.hpp"
+#include "histogram_log_writer.hpp"
 #include "logger.hpp"
 #include "round_robin_policy.hpp"
 #include "external_types.hpp"
@@ -142,6 +143,46 @@ CassError cass_cluster_set_max_concurrent_requests_threshold(CassCluster* cluste
   return CASS_OK;
 }
 
+void cass_cluster_set_connection_power_of_two_choices(CassCluster* cluster,
+                                                     cass_bool_t enabled) {
+  cluster->config().set_connection_power_of_two_choices(enabled == cass_true);
+}
+
+void cass_cluster_set_connection_scale_down_window(CassCluster* cluster,
+                                                   unsigned window_ms) {
+  cluster->config().set_connection_scale_down_window(window_ms);
+}
+
+CassError cass_cluster_set_concurrency_limiter(CassCluster* cluster,
+                                               CassConcurrencyLimiter type) {
+  if (type != CASS_CONCURRENCY_LIMITER_NONE &&
+      type != CASS_CONCURRENCY_LIMITER_AIMD &&
+      type != CASS_CONCURRENCY_LIMITER_GRADIENT) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().concurrency_limiter_settings().type = type;
+  return CASS_OK;
+}
+
+CassError cass_cluster_set_concurrency_limiter_settings(CassCluster* cluster,
+                                                        unsigned initial_limit,
+                                                        unsigned min_limit,
+                                                        unsigned max_limit,
+                                                        unsigned min_rtt_window_ms) {
+  if (min_limit == 0 || min_limit > max_limit ||
+      initial_limit < min_limit || initial_limit > max_limit ||
+      min_rtt_window_ms == 0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cass::ConcurrencyLimiter::Settings& settings
+      = cluster->config().concurrency_limiter_settings();
+  settings.initial_limit = initial_limit;
+  settings.min_limit = min_limit;
+  settings.max_limit = max_limit;
+  settings.min_rtt_window_ns = static_cast<uint64_t>(min_rtt_window_ms) * 1000 * 1000;
+  return CASS_OK;
+}
+
 CassError cass_cluster_set_max_requests_per_flush(CassCluster* cluster,
                                                   unsigned num_requests) {
   if (num_requests == 0) {
@@ -265,6 +306,93 @@ void cass_cluster_set_token_aware_routing(CassCluster* cluster,
   }
 }
 
+void cass_cluster_set_power_of_two_choices_routing(CassCluster* cluster,
+                                                   cass_bool_t enabled) {
+  cluster->config().set_power_of_two_choices_routing(enabled == cass_true);
+}
+
+void cass_cluster_set_power_of_two_choices_error_backoff(CassCluster* cluster,
+                                                         cass_uint64_t backoff_ms) {
+  cluster->config().set_power_of_two_choices_error_backoff_ms(backoff_ms);
+}
+
+void cass_cluster_set_host_metrics(CassCluster* cluster,
+                                   cass_bool_t enabled) {
+  cluster->config().set_host_metrics(enabled == cass_true);
+}
+
+CassError cass_cluster_set_host_metrics_significant_figures(CassCluster* cluster,
+                                                            unsigned significant_figures) {
+  if (significant_figures < 1 || significant_figures > 5) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().set_host_metrics_significant_figures(significant_figures);
+  return CASS_OK;
+}
+
+void cass_cluster_set_latency_breakdown(CassCluster* cluster,
+                                        cass_bool_t enabled) {
+  cluster->config().set_latency_breakdown(enabled == cass_true);
+}
+
+CassError cass_cluster_set_histogram_log(CassCluster* cluster,
+                                         const char* path,
+                                         unsigned interval_ms) {
+  if (path == NULL) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  return cass_cluster_set_histogram_log_n(cluster,
+                                          path, strlen(path),
+                                          interval_ms);
+}
+
+CassError cass_cluster_set_histogram_log_n(CassCluster* cluster,
+                                           const char* path,
+                                           size_t path_length,
+                                           unsigned interval_ms) {
+  if (path == NULL || interval_ms == 0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  if (path_length > 0 && !cass::HistogramLogWriter::is_available()) {
+    return CASS_ERROR_LIB_NOT_IMPLEMENTED;
+  }
+  cluster->config().set_histogram_log(std::string(path, path_length), interval_ms);
+  return CASS_OK;
+}
+
+void cass_cluster_set_event_loop_metrics(CassCluster* cluster,
+                                         unsigned sample_interval_ms) {
+  cluster->config().set_event_loop_metrics_interval_ms(sample_interval_ms);
+}
+
+CassError cass_cluster_set_slow_query_log(CassCluster* cluster,
+                                          cass_uint64_t threshold_ms,
+                                          cass_double_t sample_rate,
+                                          unsigned queue_size) {
+  if (sample_rate < 0.0 || sample_rate > 1.0 || queue_size == 0) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().set_slow_query_log(threshold_ms, sample_rate, queue_size);
+  return CASS_OK;
+}
+
+void cass_cluster_set_slow_query_callback(CassCluster* cluster,
+                                          CassSlowQueryCallback callback,
+                                          void* data) {
+  cluster->config().set_slow_query_callback(callback, data);
+}
+
+void cass_cluster_set_tracing_max_wait_time(CassCluster* cluster,
+                                            unsigned max_wait_time_ms) {
+  cluster->config().set_tracing_max_wait_time_ms(max_wait_time_ms);
+}
+
+void cass_cluster_set_request_interceptor(CassCluster* cluster,
+                                          CassRequestInterceptorCallback callback,
+                                          void* data) {
+  cluster->config().set_request_interceptor(callback, data);
+}
+
 void cass_cluster_set_latency_aware_routing(CassCluster* cluster,
                                             cass_bool_t enabled) {
   cluster->config().set_latency_aware_routing(enabled == cass_true);
@@ -365,6 +493,26 @@ void cass_cluster_set_blacklist_dc_filtering_n(CassCluster* cluster,
   }
 }
 
+void cass_cluster_set_schema_keyspace_filter(CassCluster* cluster,
+                                             const char* keyspaces) {
+  size_t keyspaces_length
+      = keyspaces == NULL ? 0 : strlen(keyspaces);
+  cass_cluster_set_schema_keyspace_filter_n(cluster,
+                                            keyspaces,
+                                            keyspaces_length);
+}
+
+void cass_cluster_set_schema_keyspace_filter_n(CassCluster* cluster,
+                                               const char* keyspaces,
+                                               size_t keyspaces_length) {
+  if (keyspaces_length == 0) {
+    cluster->config().schema_keyspace_filter().clear();
+  } else {
+    cass::explode(std::string(keyspaces, keyspaces_length),
+                  cluster->config().schema_keyspace_filter());
+  }
+}
+
 void cass_cluster_set_tcp_nodelay(CassCluster* cluster,
                                   cass_bool_t enabled) {
   cluster->config().set_tcp_nodelay(enabled == cass_true);
@@ -413,6 +561,40 @@ void cass_cluster_set_use_schema(CassCluster* cluster,
   }
 }
 
+void cass_cluster_set_event_debounce(CassCluster* cluster,
+                                     unsigned window_ms,
+                                     unsigned max_delay_ms) {
+  cluster->config().set_event_debounce(window_ms, max_delay_ms);
+}
+
+CassError cass_cluster_set_topology_cache_file(CassCluster* cluster,
+                                               const char* path) {
+  if (path == NULL) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  return cass_cluster_set_topology_cache_file_n(cluster, path, strlen(path));
+}
+
+CassError cass_cluster_set_topology_cache_file_n(CassCluster* cluster,
+                                                 const char* path,
+                                                 size_t path_length) {
+  if (path == NULL) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  cluster->config().set_topology_cache_file(std::string(path, path_length));
+  return CASS_OK;
+}
+
+void cass_cluster_set_startup_pool_fanout(CassCluster* cluster,
+                                          unsigned fanout) {
+  cluster->config().set_startup_pool_fanout(fanout);
+}
+
+void cass_cluster_set_use_options_handshake(CassCluster* cluster,
+                                            cass_bool_t enabled) {
+  cluster->config().set_use_options_handshake(enabled == cass_true);
+}
+
 CassError cass_cluster_set_use_hostname_resolution(CassCluster* cluster,
                                               cass_bool_t enabled) {
 #if UV_VERSION_MAJOR >= 1
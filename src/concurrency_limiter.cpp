@@ -0,0 +1,103 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "concurrency_limiter.hpp"
+
+#include <algorithm>
+#include <math.h>
+
+namespace cass {
+
+ConcurrencyLimiter::ConcurrencyLimiter(const Settings& settings)
+  : settings_(settings)
+  , limit_(settings.initial_limit)
+  , in_flight_(0)
+  , min_rtt_ns_(0)
+  , window_min_rtt_ns_(0)
+  , min_rtt_window_start_ns_(0) {
+  set_limit(limit_);
+}
+
+void ConcurrencyLimiter::release(Outcome outcome, uint64_t rtt_ns, uint64_t now_ns) {
+  if (in_flight_ > 0) --in_flight_;
+
+  switch (outcome) {
+    case SUCCESS:
+      if (settings_.type == CASS_CONCURRENCY_LIMITER_GRADIENT) {
+        update_gradient(rtt_ns, now_ns);
+      } else {
+        update_aimd();
+      }
+      break;
+
+    case DROPPED:
+      set_limit(limit_ * settings_.backoff_ratio);
+      break;
+
+    case IGNORED:
+      break;
+  }
+}
+
+void ConcurrencyLimiter::update_aimd() {
+  // Only grow the limit when it's actually being used, otherwise an idle
+  // host would drift up to the max limit. The limit grows by about one
+  // request per round-trip.
+  if ((in_flight_ + 1) * 2 >= limit_) {
+    set_limit(limit_ + 1.0 / limit_);
+  }
+}
+
+void ConcurrencyLimiter::update_gradient(uint64_t rtt_ns, uint64_t now_ns) {
+  if (rtt_ns == 0) rtt_ns = 1;
+
+  // The minimum RTT approximates the host's latency without queueing. It's
+  // replaced with the minimum of the previous window at the end of each
+  // window so that it follows changes in the host's baseline latency.
+  if (window_min_rtt_ns_ == 0 || rtt_ns < window_min_rtt_ns_) {
+    window_min_rtt_ns_ = rtt_ns;
+  }
+  if (min_rtt_ns_ == 0) {
+    min_rtt_ns_ = rtt_ns;
+    min_rtt_window_start_ns_ = now_ns;
+  } else if (now_ns - min_rtt_window_start_ns_ >= settings_.min_rtt_window_ns) {
+    min_rtt_ns_ = window_min_rtt_ns_;
+    window_min_rtt_ns_ = 0;
+    min_rtt_window_start_ns_ = now_ns;
+  } else if (rtt_ns < min_rtt_ns_) {
+    min_rtt_ns_ = rtt_ns;
+  }
+
+  double gradient = settings_.rtt_tolerance *
+                    static_cast<double>(min_rtt_ns_) / static_cast<double>(rtt_ns);
+  gradient = std::max(0.5, std::min(1.0, gradient));
+
+  // Allow some queueing so the limit can grow when the RTT isn't increasing
+  double new_limit = limit_ * gradient + sqrt(limit_);
+  if (new_limit > limit_ && (in_flight_ + 1) * 2 < limit_) {
+    return; // Not using enough of the current limit to justify growing
+  }
+
+  set_limit(limit_ * (1.0 - settings_.smoothing) +
+            new_limit * settings_.smoothing);
+}
+
+void ConcurrencyLimiter::set_limit(double limit) {
+  limit_ = std::max(static_cast<double>(settings_.min_limit),
+                    std::min(static_cast<double>(settings_.max_limit), limit));
+}
+
+} // namespace cass
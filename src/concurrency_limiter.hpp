@@ -0,0 +1,91 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_CONCURRENCY_LIMITER_HPP_INCLUDED__
+#define __CASS_CONCURRENCY_LIMITER_HPP_INCLUDED__
+
+#include "cassandra.h"
+#include "macros.hpp"
+
+#include <stdint.h>
+
+namespace cass {
+
+// Estimates the number of requests that can be in-flight to a host without
+// queueing on the server. The limit is adjusted as requests finish using
+// either additive-increase/multiplicative-decrease (AIMD) or a gradient of
+// the minimum round-trip time observed over a window against the current
+// round-trip time. This is not thread-safe, each pool has its own instance
+// that's only used on its IO worker's thread.
+class ConcurrencyLimiter {
+public:
+  enum Outcome {
+    SUCCESS, // The request completed, its RTT is used to update the limit
+    DROPPED, // The request timed out or the host was overloaded
+    IGNORED  // The request failed for a reason unrelated to load
+  };
+
+  struct Settings {
+    Settings()
+      : type(CASS_CONCURRENCY_LIMITER_NONE)
+      , initial_limit(20)
+      , min_limit(1)
+      , max_limit(1000)
+      , min_rtt_window_ns(1000LL * 1000LL * 1000LL)
+      , backoff_ratio(0.9)
+      , smoothing(0.2)
+      , rtt_tolerance(1.5) {}
+
+    CassConcurrencyLimiter type;
+    unsigned initial_limit;
+    unsigned min_limit;
+    unsigned max_limit;
+    uint64_t min_rtt_window_ns;
+    double backoff_ratio;
+    double smoothing;
+    double rtt_tolerance;
+  };
+
+  ConcurrencyLimiter(const Settings& settings);
+
+  int limit() const { return static_cast<int>(limit_); }
+  int in_flight() const { return in_flight_; }
+
+  bool is_limited() const { return in_flight_ >= limit(); }
+
+  void acquire() { ++in_flight_; }
+  void release(Outcome outcome, uint64_t rtt_ns, uint64_t now_ns);
+
+private:
+  void update_aimd();
+  void update_gradient(uint64_t rtt_ns, uint64_t now_ns);
+  void set_limit(double limit);
+
+private:
+  const Settings settings_;
+  double limit_;
+  int in_flight_;
+  uint64_t min_rtt_ns_;
+  uint64_t window_min_rtt_ns_;
+  uint64_t min_rtt_window_start_ns_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(ConcurrencyLimiter);
+};
+
+} // namespace cass
+
+#endif
@@ -19,8 +19,10 @@
 
 #include "auth.hpp"
 #include "cassandra.h"
+#include "concurrency_limiter.hpp"
 #include "dc_aware_policy.hpp"
 #include "latency_aware_policy.hpp"
+#include "power_of_two_choices_policy.hpp"
 #include "retry_policy.hpp"
 #include "ssl.hpp"
 #include "timestamp_generator.hpp"
@@ -52,6 +54,8 @@ public:
       , max_concurrent_creation_(1)
       , max_requests_per_flush_(128)
       , max_concurrent_requests_threshold_(100)
+      , connection_power_of_two_choices_(false)
+      , connection_scale_down_window_ms_(0)
       , write_bytes_high_water_mark_(64 * 1024)
       , write_bytes_low_water_mark_(32 * 1024)
       , pending_requests_high_water_mark_(128 * max_connections_per_host_)
@@ -66,6 +70,21 @@ public:
       , load_balancing_policy_(new DCAwarePolicy())
       , token_aware_routing_(true)
       , latency_aware_routing_(false)
+      , power_of_two_choices_routing_(false)
+      , power_of_two_choices_error_backoff_ms_(1000)
+      , host_metrics_(false)
+      , host_metrics_significant_figures_(2)
+      , latency_breakdown_(false)
+      , histogram_log_interval_ms_(5000)
+      , event_loop_metrics_interval_ms_(0)
+      , slow_query_threshold_ms_(0)
+      , slow_query_sample_rate_(1.0)
+      , slow_query_queue_size_(1024)
+      , slow_query_callback_(NULL)
+      , slow_query_callback_data_(NULL)
+      , request_interceptor_(NULL)
+      , request_interceptor_data_(NULL)
+      , tracing_max_wait_time_ms_(2000)
       , tcp_nodelay_enable_(true)
       , tcp_keepalive_enable_(false)
       , tcp_keepalive_delay_secs_(0)
@@ -74,6 +93,10 @@ public:
       , timestamp_gen_(new ServerSideTimestampGenerator())
       , retry_policy_(new DefaultRetryPolicy())
       , use_schema_(true)
+      , event_debounce_window_ms_(0)
+      , event_debounce_max_delay_ms_(0)
+      , startup_pool_fanout_(0)
+      , use_options_handshake_(true)
       , use_hostname_resolution_(false) { }
 
   unsigned thread_count_io() const { return thread_count_io_; }
@@ -174,6 +197,30 @@ public:
     max_concurrent_requests_threshold_ = num_requests;
   }
 
+  bool connection_power_of_two_choices() const {
+    return connection_power_of_two_choices_;
+  }
+
+  void set_connection_power_of_two_choices(bool enable) {
+    connection_power_of_two_choices_ = enable;
+  }
+
+  unsigned connection_scale_down_window_ms() const {
+    return connection_scale_down_window_ms_;
+  }
+
+  void set_connection_scale_down_window(unsigned window_ms) {
+    connection_scale_down_window_ms_ = window_ms;
+  }
+
+  const ConcurrencyLimiter::Settings& concurrency_limiter_settings() const {
+    return concurrency_limiter_settings_;
+  }
+
+  ConcurrencyLimiter::Settings& concurrency_limiter_settings() {
+    return concurrency_limiter_settings_;
+  }
+
   unsigned connect_timeout_ms() const { return connect_timeout_ms_; }
 
   void set_connect_timeout(unsigned timeout_ms) {
@@ -256,6 +303,10 @@ public:
     if (token_aware_routing()) {
       chain = new TokenAwarePolicy(chain);
     }
+    if (power_of_two_choices_routing()) {
+      chain = new PowerOfTwoChoicesPolicy(chain,
+                                          power_of_two_choices_error_backoff_ms_ * 1000LL * 1000LL);
+    }
     if (latency_aware()) {
       chain = new LatencyAwarePolicy(chain, latency_aware_routing_settings_);
     }
@@ -285,6 +336,85 @@ public:
     latency_aware_routing_settings_ = settings;
   }
 
+  bool power_of_two_choices_routing() const { return power_of_two_choices_routing_; }
+
+  void set_power_of_two_choices_routing(bool is_power_of_two_choices) {
+    power_of_two_choices_routing_ = is_power_of_two_choices;
+  }
+
+  uint64_t power_of_two_choices_error_backoff_ms() const {
+    return power_of_two_choices_error_backoff_ms_;
+  }
+
+  void set_power_of_two_choices_error_backoff_ms(uint64_t backoff_ms) {
+    power_of_two_choices_error_backoff_ms_ = backoff_ms;
+  }
+
+  bool host_metrics() const { return host_metrics_; }
+
+  void set_host_metrics(bool enabled) { host_metrics_ = enabled; }
+
+  int host_metrics_significant_figures() const { return host_metrics_significant_figures_; }
+
+  void set_host_metrics_significant_figures(int significant_figures) {
+    host_metrics_significant_figures_ = significant_figures;
+  }
+
+  bool latency_breakdown() const { return latency_breakdown_; }
+
+  void set_latency_breakdown(bool enabled) { latency_breakdown_ = enabled; }
+
+  const std::string& histogram_log_path() const { return histogram_log_path_; }
+
+  unsigned histogram_log_interval_ms() const { return histogram_log_interval_ms_; }
+
+  void set_histogram_log(const std::string& path, unsigned interval_ms) {
+    histogram_log_path_ = path;
+    histogram_log_interval_ms_ = interval_ms;
+  }
+
+  unsigned event_loop_metrics_interval_ms() const { return event_loop_metrics_interval_ms_; }
+
+  void set_event_loop_metrics_interval_ms(unsigned interval_ms) {
+    event_loop_metrics_interval_ms_ = interval_ms;
+  }
+
+  uint64_t slow_query_threshold_ms() const { return slow_query_threshold_ms_; }
+
+  double slow_query_sample_rate() const { return slow_query_sample_rate_; }
+
+  unsigned slow_query_queue_size() const { return slow_query_queue_size_; }
+
+  void set_slow_query_log(uint64_t threshold_ms, double sample_rate, unsigned queue_size) {
+    slow_query_threshold_ms_ = threshold_ms;
+    slow_query_sample_rate_ = sample_rate;
+    slow_query_queue_size_ = queue_size;
+  }
+
+  CassSlowQueryCallback slow_query_callback() const { return slow_query_callback_; }
+
+  void* slow_query_callback_data() const { return slow_query_callback_data_; }
+
+  void set_slow_query_callback(CassSlowQueryCallback callback, void* data) {
+    slow_query_callback_ = callback;
+    slow_query_callback_data_ = data;
+  }
+
+  CassRequestInterceptorCallback request_interceptor() const { return request_interceptor_; }
+
+  void* request_interceptor_data() const { return request_interceptor_data_; }
+
+  void set_request_interceptor(CassRequestInterceptorCallback callback, void* data) {
+    request_interceptor_ = callback;
+    request_interceptor_data_ = data;
+  }
+
+  unsigned tracing_max_wait_time_ms() const { return tracing_max_wait_time_ms_; }
+
+  void set_tracing_max_wait_time_ms(unsigned max_wait_time_ms) {
+    tracing_max_wait_time_ms_ = max_wait_time_ms;
+  }
+
   ContactPointList& whitelist() {
     return whitelist_;
   }
@@ -354,6 +484,31 @@ public:
     use_schema_ = enable;
   }
 
+  const KeyspaceList& schema_keyspace_filter() const { return schema_keyspace_filter_; }
+  KeyspaceList& schema_keyspace_filter() { return schema_keyspace_filter_; }
+
+  unsigned event_debounce_window_ms() const { return event_debounce_window_ms_; }
+  unsigned event_debounce_max_delay_ms() const { return event_debounce_max_delay_ms_; }
+  void set_event_debounce(unsigned window_ms, unsigned max_delay_ms) {
+    event_debounce_window_ms_ = window_ms;
+    event_debounce_max_delay_ms_ = max_delay_ms;
+  }
+
+  const std::string& topology_cache_file() const { return topology_cache_file_; }
+  void set_topology_cache_file(const std::string& path) {
+    topology_cache_file_ = path;
+  }
+
+  unsigned startup_pool_fanout() const { return startup_pool_fanout_; }
+  void set_startup_pool_fanout(unsigned fanout) {
+    startup_pool_fanout_ = fanout;
+  }
+
+  bool use_options_handshake() const { return use_options_handshake_; }
+  void set_use_options_handshake(bool enable) {
+    use_options_handshake_ = enable;
+  }
+
   bool use_hostname_resolution() const { return use_hostname_resolution_; }
   void set_use_hostname_resolution(bool enable) {
     use_hostname_resolution_ = enable;
@@ -373,6 +528,9 @@ private:
   unsigned max_concurrent_creation_;
   unsigned max_requests_per_flush_;
   unsigned max_concurrent_requests_threshold_;
+  bool connection_power_of_two_choices_;
+  unsigned connection_scale_down_window_ms_;
+  ConcurrencyLimiter::Settings concurrency_limiter_settings_;
   unsigned write_bytes_high_water_mark_;
   unsigned write_bytes_low_water_mark_;
   unsigned pending_requests_high_water_mark_;
@@ -389,10 +547,27 @@ private:
   bool token_aware_routing_;
   bool latency_aware_routing_;
   LatencyAwarePolicy::Settings latency_aware_routing_settings_;
+  bool power_of_two_choices_routing_;
+  uint64_t power_of_two_choices_error_backoff_ms_;
+  bool host_metrics_;
+  int host_metrics_significant_figures_;
+  bool latency_breakdown_;
+  std::string histogram_log_path_;
+  unsigned histogram_log_interval_ms_;
+  unsigned event_loop_metrics_interval_ms_;
+  uint64_t slow_query_threshold_ms_;
+  double slow_query_sample_rate_;
+  unsigned slow_query_queue_size_;
+  CassSlowQueryCallback slow_query_callback_;
+  void* slow_query_callback_data_;
+  CassRequestInterceptorCallback request_interceptor_;
+  void* request_interceptor_data_;
+  unsigned tracing_max_wait_time_ms_;
   ContactPointList whitelist_;
   ContactPointList blacklist_;
   DcList whitelist_dc_;
   DcList blacklist_dc_;
+  KeyspaceList schema_keyspace_filter_;
   bool tcp_nodelay_enable_;
   bool tcp_keepalive_enable_;
   unsigned tcp_keepalive_delay_secs_;
@@ -401,6 +576,11 @@ private:
   SharedRefPtr<TimestampGenerator> timestamp_gen_;
   SharedRefPtr<RetryPolicy> retry_policy_;
   bool use_schema_;
+  unsigned event_debounce_window_ms_;
+  unsigned event_debounce_max_delay_ms_;
+  std::string topology_cache_file_;
+  unsigned startup_pool_fanout_;
+  bool use_options_handshake_;
   bool use_hostname_resolution_;
 };
 
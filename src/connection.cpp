@@ -33,6 +33,7 @@
 #include "error_response.hpp"
 #include "event_response.hpp"
 #include "logger.hpp"
+#include "memory_budget.hpp"
 #include "utils.hpp"
 
 #include <iomanip>
@@ -245,6 +246,7 @@ bool Connection::internal_write(Handler* handler, bool flush_immediately, bool r
   if (stream < 0) {
     return false;
   }
+  on_stream_acquired();
 
   handler->inc_ref(); // Connection reference
   handler->set_connection(this);
@@ -263,6 +265,7 @@ bool Connection::internal_write(Handler* handler, bool flush_immediately, bool r
   int32_t request_size = pending_write->write(handler);
   if (request_size < 0) {
     stream_manager_.release(stream);
+    on_stream_released();
     switch (request_size) {
       case Request::ENCODE_ERROR_BATCH_WITH_NAMED_VALUES:
       case Request::ENCODE_ERROR_PARAMETER_UNSET:
@@ -280,10 +283,11 @@ bool Connection::internal_write(Handler* handler, bool flush_immediately, bool r
 
   pending_writes_size_ += request_size;
   if (pending_writes_size_ > config_.write_bytes_high_water_mark()) {
-    LOG_WARN("Exceeded write bytes water mark (current: %u water mark: %u) on connection to host %s",
-             static_cast<unsigned int>(pending_writes_size_),
-             config_.write_bytes_high_water_mark(),
-             host_->address_string().c_str());
+    LOG_WARN_RATELIMITED(1000, 10,
+                         "Exceeded write bytes water mark (current: %u water mark: %u) on connection to host %s",
+                         static_cast<unsigned int>(pending_writes_size_),
+                         config_.write_bytes_high_water_mark(),
+                         host_->address_string().c_str());
     metrics_->exceeded_write_bytes_water_mark.inc();
     set_state(CONNECTION_STATE_OVERWHELMED);
   }
@@ -457,6 +461,7 @@ void Connection::consume(char* input, size_t size) {
       } else {
         Handler* handler = NULL;
         if (stream_manager_.get_pending_and_release(response->stream(), handler)) {
+          on_stream_released();
           switch (handler->state()) {
             case Handler::REQUEST_STATE_READING:
               maybe_set_keyspace(response.get());
@@ -558,6 +563,11 @@ void Connection::on_close(uv_handle_t* handle) {
             static_cast<void*>(connection),
             connection->host_->address_string().c_str());
 
+  // Streams still pending are never released, remove them from the host's
+  // in-flight count.
+  connection->host_->dec_inflight_request_count(
+        static_cast<int>(connection->stream_manager_.pending_streams()));
+
   cleanup_pending_handlers(&connection->pending_reads_);
 
   while (!connection->pending_writes_.is_empty()) {
@@ -581,19 +591,33 @@ void Connection::on_close(uv_handle_t* handle) {
   delete connection;
 }
 
+void Connection::on_stream_acquired() {
+  host_->inc_inflight_request_count();
+  listener_->on_pending_request_count_change(this, 1);
+}
+
+void Connection::on_stream_released() {
+  host_->dec_inflight_request_count();
+  listener_->on_pending_request_count_change(this, -1);
+}
+
 uv_buf_t Connection::internal_alloc_buffer(size_t suggested_size) {
   if (suggested_size <= BUFFER_REUSE_SIZE) {
     if (!buffer_reuse_list_.empty()) {
       uv_buf_t ret = buffer_reuse_list_.top();
       buffer_reuse_list_.pop();
+      MemoryBudget::add(MemoryBudget::READ_BUFFER, ret.len);
       return ret;
     }
-    return uv_buf_init(new char[BUFFER_REUSE_SIZE], BUFFER_REUSE_SIZE);
+    suggested_size = BUFFER_REUSE_SIZE;
   }
+  MemoryBudget::add(MemoryBudget::READ_BUFFER, suggested_size);
   return uv_buf_init(new char[suggested_size], suggested_size);
 }
 
 void Connection::internal_reuse_buffer(uv_buf_t buf) {
+  // Only the buffers being read into are accounted, not the parked ones
+  MemoryBudget::remove(MemoryBudget::READ_BUFFER, buf.len);
   if (buf.len == BUFFER_REUSE_SIZE && buffer_reuse_list_.size() < MAX_BUFFER_REUSE_NO) {
     buffer_reuse_list_.push(buf);
     return;
@@ -722,7 +746,12 @@ void Connection::on_timeout(Timer* timer) {
 }
 
 void Connection::on_connected() {
-  write(new StartupHandler(this, new OptionsRequest()));
+  if (config_.use_options_handshake()) {
+    write(new StartupHandler(this, new OptionsRequest()));
+  } else {
+    // The supported options aren't used so the round trip can be skipped
+    write(new StartupHandler(this, new StartupRequest()));
+  }
 }
 
 void Connection::on_authenticate(const std::string& class_name) {
@@ -908,6 +937,7 @@ void Connection::PendingSchemaAgreement::stop_timer() {
 }
 
 Connection::PendingWriteBase::~PendingWriteBase() {
+  MemoryBudget::remove(MemoryBudget::PENDING_WRITE, size_);
   cleanup_pending_handlers(&handlers_);
 }
 
@@ -920,6 +950,7 @@ int32_t Connection::PendingWriteBase::write(Handler* handler) {
   }
 
   size_ += request_size;
+  MemoryBudget::add(MemoryBudget::PENDING_WRITE, request_size);
   handlers_.add_to_back(handler);
 
   return request_size;
@@ -949,6 +980,7 @@ void Connection::PendingWriteBase::on_write(uv_write_t* req, int status) {
           }
 
           connection->stream_manager_.release(handler->stream());
+          connection->on_stream_released();
           handler->stop_timer();
           handler->set_state(Handler::REQUEST_STATE_DONE);
           handler->on_error(CASS_ERROR_LIB_WRITE_ERROR,
@@ -20,6 +20,7 @@
 #include "buffer.hpp"
 #include "cassandra.h"
 #include "handler.hpp"
+#include "heap.hpp"
 #include "host.hpp"
 #include "list.hpp"
 #include "macros.hpp"
@@ -46,7 +47,7 @@ class Connector;
 class EventResponse;
 class Request;
 
-class Connection {
+class Connection : public HeapNode {
 public:
   enum ConnectionState {
     CONNECTION_STATE_NEW,
@@ -86,6 +87,10 @@ public:
     virtual void on_close(Connection* connection) = 0;
     virtual void on_availability_change(Connection* connection) = 0;
 
+    // Called when a stream is acquired (delta is 1) or released (delta is -1)
+    // on a connection
+    virtual void on_pending_request_count_change(Connection* connection, int delta) {}
+
     virtual void on_event(EventResponse* response) = 0;
 
   private:
@@ -108,6 +113,7 @@ public:
 
   void schedule_schema_agreement(const SharedRefPtr<SchemaChangeHandler>& handler, uint64_t wait);
 
+  uv_loop_t* loop() const { return loop_; }
   const Config& config() const { return config_; }
   Metrics* metrics() { return metrics_; }
   const Address& address() const { return host_->address(); }
@@ -287,6 +293,9 @@ private:
   void on_supported(ResponseMessage* response);
   static void on_pending_schema_agreement(Timer* timer);
 
+  void on_stream_acquired();
+  void on_stream_released();
+
   void notify_ready();
   void notify_error(const std::string& message, ConnectionError code = CONNECTION_ERROR_GENERIC);
 
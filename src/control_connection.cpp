@@ -34,7 +34,8 @@
 #include <vector>
 
 #define SELECT_LOCAL "SELECT data_center, rack, release_version FROM system.local WHERE key='local'"
-#define SELECT_LOCAL_TOKENS "SELECT data_center, rack, release_version, partitioner, tokens FROM system.local WHERE key='local'"
+#define SELECT_LOCAL_TOKENS "SELECT data_center, rack, release_version, partitioner, tokens, schema_version FROM system.local WHERE key='local'"
+#define SELECT_LOCAL_VERSIONS "SELECT release_version, schema_version FROM system.local WHERE key='local'"
 #define SELECT_PEERS "SELECT peer, data_center, rack, release_version, rpc_address FROM system.peers"
 #define SELECT_PEERS_TOKENS "SELECT peer, data_center, rack, release_version, rpc_address, tokens FROM system.peers"
 
@@ -56,6 +57,45 @@
 
 namespace cass {
 
+static void append_quoted(const std::string& value, std::string* output) {
+  output->push_back('\'');
+  for (std::string::const_iterator i = value.begin(); i != value.end(); ++i) {
+    if (*i == '\'') output->push_back('\''); // Escape quotes
+    output->push_back(*i);
+  }
+  output->push_back('\'');
+}
+
+// Returns " AND <column>='name'" for a single name or
+// " AND <column> IN ('name1', 'name2', ...)" for multiple names
+static std::string names_clause(const char* column, const StringVec& names) {
+  std::string clause(" AND ");
+  clause.append(column);
+  if (names.size() == 1) {
+    clause.push_back('=');
+    append_quoted(names.front(), &clause);
+    return clause;
+  }
+  clause.append(" IN (");
+  for (StringVec::const_iterator i = names.begin(),
+       end = names.end(); i != end; ++i) {
+    if (i != names.begin()) clause.append(", ");
+    append_quoted(*i, &clause);
+  }
+  clause.push_back(')');
+  return clause;
+}
+
+static std::string join_names(const StringVec& names) {
+  std::string result;
+  for (StringVec::const_iterator i = names.begin(),
+       end = names.end(); i != end; ++i) {
+    if (i != names.begin()) result.append(", ");
+    result.append(*i);
+  }
+  return result;
+}
+
 class ControlStartupQueryPlan : public QueryPlan {
 public:
   ControlStartupQueryPlan(const HostMap& hosts)
@@ -112,7 +152,8 @@ ControlConnection::ControlConnection()
   , session_(NULL)
   , connection_(NULL)
   , protocol_version_(0)
-  , should_query_tokens_(false) {}
+  , should_query_tokens_(false)
+  , has_topology_cache_(false) {}
 
 const SharedRefPtr<Host>& ControlConnection::connected_host() const {
   return current_host_;
@@ -123,10 +164,14 @@ void ControlConnection::clear() {
   session_ = NULL;
   connection_ = NULL;
   reconnect_timer_.stop();
+  debounce_timer_.stop();
+  debouncer_.clear();
   query_plan_.reset();
   protocol_version_ = 0;
   last_connection_error_.clear();
   should_query_tokens_ = false;
+  topology_cache_.clear();
+  has_topology_cache_ = false;
 }
 
 void ControlConnection::connect(Session* session) {
@@ -134,6 +179,18 @@ void ControlConnection::connect(Session* session) {
   query_plan_.reset(new ControlStartupQueryPlan(session_->hosts_)); // No hosts lock necessary (read-only)
   protocol_version_ = session_->config().protocol_version();
   should_query_tokens_ = session_->config().token_aware_routing();
+  debouncer_.init(session_->config().event_debounce_window_ms(),
+                  session_->config().event_debounce_max_delay_ms());
+
+  // The cache is only used when the schema metadata is available because the
+  // keyspaces' replication is required for token-aware routing
+  topology_cache_.clear();
+  has_topology_cache_ = false;
+  topology_cache_writer_.set_loop(session_->loop());
+  if (session_->config().use_schema() &&
+      !session_->config().topology_cache_file().empty()) {
+    has_topology_cache_ = topology_cache_.load(session_->config().topology_cache_file());
+  }
   if (protocol_version_ < 0) {
     protocol_version_ = CASS_HIGHEST_SUPPORTED_PROTOCOL_VERSION;
   }
@@ -154,6 +211,8 @@ void ControlConnection::close() {
     connection_->close();
   }
   reconnect_timer_.stop();
+  debounce_timer_.stop();
+  debouncer_.clear();
 }
 
 void ControlConnection::schedule_reconnect(uint64_t ms) {
@@ -202,6 +261,24 @@ void ControlConnection::on_ready(Connection* connection) {
   // A protocol version is need to encode/decode maps properly
   session_->metadata().set_protocol_version(protocol_version_);
 
+  if (state_ == CONTROL_STATE_NEW) {
+    session_->on_control_connection_connected();
+  }
+
+  // Pending schema refreshes are covered by the full refresh of the schema
+  // below, but node refreshes are still required to add new nodes.
+  debouncer_.clear_schema();
+  if (!debouncer_.is_empty()) {
+    debounce();
+  }
+
+  // A valid topology cache allows the session to connect before the hosts
+  // and schema have been refreshed
+  if (state_ == CONTROL_STATE_NEW && has_topology_cache_) {
+    query_topology_cache_versions();
+    return;
+  }
+
   // The control connection has to refresh meta when there's a reconnect because
   // events could have been missed while not connected.
   query_meta_hosts();
@@ -274,7 +351,7 @@ void ControlConnection::on_event(EventResponse* response) {
           SharedRefPtr<Host> host = session_->get_host(response->affected_node());
           if (!host) {
             host = session_->add_host(response->affected_node());
-            refresh_node_info(host, true, true);
+            schedule_refresh_node_info(host, true, true);
           }
           break;
         }
@@ -282,6 +359,7 @@ void ControlConnection::on_event(EventResponse* response) {
         case EventResponse::REMOVED_NODE: {
           LOG_INFO("Node %s removed", address_str.c_str());
           SharedRefPtr<Host> host = session_->get_host(response->affected_node());
+          debouncer_.remove_node(response->affected_node());
           if (host) {
             session_->on_remove(host);
             session_->metadata().remove_host(host);
@@ -295,7 +373,7 @@ void ControlConnection::on_event(EventResponse* response) {
           LOG_INFO("Node %s moved", address_str.c_str());
           SharedRefPtr<Host> host = session_->get_host(response->affected_node());
           if (host) {
-            refresh_node_info(host, false, true);
+            schedule_refresh_node_info(host, false, true);
           } else {
             LOG_DEBUG("Move event for host %s that doesn't exist", address_str.c_str());
             session_->metadata().remove_host(host);
@@ -328,18 +406,27 @@ void ControlConnection::on_event(EventResponse* response) {
                 response->schema_change(),
                 (int)response->keyspace().size(), response->keyspace().data(),
                 (int)response->target().size(), response->target().data());
+      if (is_keyspace_filtered(response->keyspace())) {
+        break;
+      }
       switch (response->schema_change()) {
         case EventResponse::CREATED:
         case EventResponse::UPDATED:
+          if (debouncer_.is_enabled()) {
+            debounce_schema_change(response);
+            break;
+          }
           switch (response->schema_change_target()) {
             case EventResponse::KEYSPACE:
-              refresh_keyspace(response->keyspace());
+              refresh_keyspaces(StringVec(1, response->keyspace().to_string()));
               break;
             case EventResponse::TABLE:
-              refresh_table_or_view(response->keyspace(), response->target());
+              refresh_tables_or_views(response->keyspace().to_string(),
+                                      StringVec(1, response->target().to_string()));
               break;
             case EventResponse::TYPE:
-              refresh_type(response->keyspace(), response->target());
+              refresh_types(response->keyspace().to_string(),
+                            StringVec(1, response->target().to_string()));
               break;
             case EventResponse::FUNCTION:
             case EventResponse::AGGREGATE:
@@ -354,22 +441,35 @@ void ControlConnection::on_event(EventResponse* response) {
         case EventResponse::DROPPED:
           switch (response->schema_change_target()) {
             case EventResponse::KEYSPACE:
+              debouncer_.drop_keyspace(response->keyspace().to_string());
               session_->metadata().drop_keyspace(response->keyspace().to_string());
               break;
             case EventResponse::TABLE:
+              debouncer_.drop_table_or_view(response->keyspace().to_string(),
+                                            response->target().to_string());
               session_->metadata().drop_table_or_view(response->keyspace().to_string(),
                                                       response->target().to_string());
               break;
             case EventResponse::TYPE:
+              debouncer_.drop_type(response->keyspace().to_string(),
+                                   response->target().to_string());
               session_->metadata().drop_user_type(response->keyspace().to_string(),
                                                   response->target().to_string());
               break;
             case EventResponse::FUNCTION:
+              debouncer_.drop_function(response->keyspace().to_string(),
+                                       response->target().to_string(),
+                                       to_strings(response->arg_types()),
+                                       false);
               session_->metadata().drop_function(response->keyspace().to_string(),
                                                  Metadata::full_function_name(response->target().to_string(),
                                                                               to_strings(response->arg_types())));
               break;
             case EventResponse::AGGREGATE:
+              debouncer_.drop_function(response->keyspace().to_string(),
+                                       response->target().to_string(),
+                                       to_strings(response->arg_types()),
+                                       true);
               session_->metadata().drop_aggregate(response->keyspace().to_string(),
                                                   Metadata::full_function_name(response->target().to_string(),
                                                                                to_strings(response->arg_types())));
@@ -386,6 +486,205 @@ void ControlConnection::on_event(EventResponse* response) {
   }
 }
 
+void ControlConnection::debounce_schema_change(EventResponse* response) {
+  switch (response->schema_change_target()) {
+    case EventResponse::KEYSPACE:
+      debouncer_.add_keyspace(response->keyspace());
+      break;
+    case EventResponse::TABLE:
+      debouncer_.add_table_or_view(response->keyspace(), response->target());
+      break;
+    case EventResponse::TYPE:
+      debouncer_.add_type(response->keyspace(), response->target());
+      break;
+    case EventResponse::FUNCTION:
+    case EventResponse::AGGREGATE:
+      debouncer_.add_function(response->keyspace(),
+                              response->target(),
+                              response->arg_types(),
+                              response->schema_change_target() == EventResponse::AGGREGATE);
+      break;
+  }
+  debounce();
+}
+
+void ControlConnection::debounce() {
+  uint64_t delay_ms = debouncer_.next_delay(uv_now(session_->loop()));
+  debounce_timer_.start(session_->loop(),
+                        delay_ms,
+                        this,
+                        ControlConnection::on_debounce);
+}
+
+void ControlConnection::on_debounce(Timer* timer) {
+  ControlConnection* control_connection = static_cast<ControlConnection*>(timer->data());
+  control_connection->flush_pending_refreshes();
+}
+
+void ControlConnection::flush_pending_refreshes() {
+  // The pending refreshes are kept until the control connection is
+  // re-established
+  if (connection() == NULL) return;
+
+  EventDebouncer::Pending pending;
+  debouncer_.take(&pending);
+
+  if (!pending.keyspaces.empty()) {
+    refresh_keyspaces(StringVec(pending.keyspaces.begin(), pending.keyspaces.end()));
+  }
+
+  // Types are refreshed before tables because columns can reference them
+  for (EventDebouncer::KeyspaceNameMap::const_iterator i = pending.types.begin(),
+       end = pending.types.end(); i != end; ++i) {
+    refresh_types(i->first, StringVec(i->second.begin(), i->second.end()));
+  }
+
+  for (EventDebouncer::KeyspaceNameMap::const_iterator i = pending.tables_and_views.begin(),
+       end = pending.tables_and_views.end(); i != end; ++i) {
+    refresh_tables_or_views(i->first, StringVec(i->second.begin(), i->second.end()));
+  }
+
+  for (EventDebouncer::FunctionSet::const_iterator i = pending.functions.begin(),
+       end = pending.functions.end(); i != end; ++i) {
+    StringRefVec arg_types(i->arg_types.begin(), i->arg_types.end());
+    refresh_function(i->keyspace, i->name, arg_types, i->is_aggregate);
+  }
+
+  for (EventDebouncer::NodeMap::const_iterator i = pending.nodes.begin(),
+       end = pending.nodes.end(); i != end; ++i) {
+    refresh_node_info(i->second.host, i->second.is_new_node, i->second.query_tokens);
+  }
+}
+
+void ControlConnection::query_topology_cache_versions() {
+  connection_->write(
+        new ControlHandler<UnusedData>(new QueryRequest(SELECT_LOCAL_VERSIONS),
+                                       this,
+                                       ControlConnection::on_query_topology_cache_versions,
+                                       UnusedData()));
+}
+
+void ControlConnection::on_query_topology_cache_versions(ControlConnection* control_connection,
+                                                         const UnusedData& data,
+                                                         Response* response) {
+  Connection* connection = control_connection->connection_;
+  if (connection == NULL) {
+    return;
+  }
+
+  // The cache is only used for the initial connection
+  control_connection->has_topology_cache_ = false;
+
+  const TopologyCache& cache = control_connection->topology_cache_;
+  TopologyCache::HostEntryMap::const_iterator connected_host
+      = cache.hosts.find(connection->address());
+
+  ResultResponse* result = static_cast<ResultResponse*>(response);
+  std::string release_version;
+  std::string schema_version;
+  if (result->row_count() > 0) {
+    result->decode_first_row();
+    result->first_row().get_string_by_name("release_version", &release_version);
+    result->first_row().get_string_by_name("schema_version", &schema_version);
+  }
+
+  if (connected_host == cache.hosts.end() ||
+      connected_host->second.release_version != release_version ||
+      cache.schema_version != schema_version) {
+    LOG_INFO("Topology cache \"%s\" is out of date and will be refreshed",
+             control_connection->session_->config().topology_cache_file().c_str());
+    control_connection->topology_cache_.clear();
+    control_connection->query_meta_hosts();
+    return;
+  }
+
+  control_connection->apply_topology_cache();
+}
+
+void ControlConnection::apply_topology_cache() {
+  LOG_INFO("Using topology cache \"%s\" with %u hosts and %u keyspaces",
+           session_->config().topology_cache_file().c_str(),
+           static_cast<unsigned int>(topology_cache_.hosts.size()),
+           static_cast<unsigned int>(topology_cache_.keyspaces.size()));
+
+  if (should_query_tokens_) {
+    session_->metadata().set_partitioner(topology_cache_.partitioner);
+  }
+
+  for (TopologyCache::HostEntryMap::const_iterator i = topology_cache_.hosts.begin(),
+       end = topology_cache_.hosts.end(); i != end; ++i) {
+    const TopologyCache::HostEntry& entry = i->second;
+
+    SharedRefPtr<Host> host = session_->get_host(entry.address);
+    if (!host) {
+      host = session_->add_host(entry.address);
+    }
+    host->set_mark(session_->current_host_mark_);
+    host->set_rack_and_dc(entry.rack, entry.dc);
+    host->set_listen_address(entry.listen_address);
+
+    VersionNumber cassandra_version;
+    if (cassandra_version.parse(entry.release_version)) {
+      host->set_cassaandra_version(cassandra_version);
+    }
+    if (host->address().compare(connection_->address()) == 0) {
+      session_->metadata().set_cassandra_version(cassandra_version);
+    }
+
+    if (should_query_tokens_ && !entry.tokens.empty()) {
+      TokenStringList tokens(entry.tokens.begin(), entry.tokens.end());
+      session_->metadata().update_host(host, tokens);
+    }
+  }
+
+  session_->purge_hosts(true);
+
+  if (should_query_tokens_) {
+    for (TopologyCache::KeyspaceEntryMap::const_iterator i = topology_cache_.keyspaces.begin(),
+         end = topology_cache_.keyspaces.end(); i != end; ++i) {
+      session_->metadata().update_keyspace_replication(
+            i->first,
+            ReplicationStrategy::from_options(i->second.strategy_class, i->second.options));
+    }
+    session_->metadata().build();
+  }
+
+  state_ = CONTROL_STATE_READY;
+  session_->on_control_connection_ready();
+  query_plan_.reset(session_->new_query_plan());
+
+  // Validate and refresh the cached hosts and schema in the background
+  query_meta_hosts();
+}
+
+void ControlConnection::save_topology_cache() {
+  const std::string& path = session_->config().topology_cache_file();
+  if (path.empty()) return;
+
+  // Only the hosts that are still part of the cluster are saved
+  TopologyCache::HostEntryMap::iterator it = topology_cache_.hosts.begin();
+  while (it != topology_cache_.hosts.end()) {
+    if (session_->hosts_.find(it->first) == session_->hosts_.end()) {
+      topology_cache_.hosts.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  topology_cache_.keyspaces.clear();
+  Metadata::SchemaSnapshot snapshot = session_->metadata().schema_snapshot();
+  const KeyspaceMetadata::Map& keyspaces = *snapshot.keyspaces();
+  for (KeyspaceMetadata::Map::const_iterator i = keyspaces.begin(),
+       end = keyspaces.end(); i != end; ++i) {
+    TopologyCache::KeyspaceEntry& entry = topology_cache_.keyspaces[i->first];
+    entry.strategy_class = i->second.strategy_class().to_string();
+    ReplicationStrategy::options_from_keyspace_meta(i->second, &entry.options);
+  }
+
+  // Encoded here and written on the thread pool
+  topology_cache_writer_.save(path, topology_cache_);
+}
+
 void ControlConnection::query_meta_hosts() {
   ScopedRefPtr<ControlMultipleRequestHandler<UnusedData> > handler(
         new ControlMultipleRequestHandler<UnusedData>(this, ControlConnection::on_query_hosts, UnusedData()));
@@ -405,6 +704,12 @@ void ControlConnection::on_query_hosts(ControlConnection* control_connection,
 
   bool is_initial_connection = (control_connection->state_ == CONTROL_STATE_NEW);
 
+  // The token map is rebuilt from the hosts' tokens and the keyspaces that
+  // are refreshed next
+  if (control_connection->should_query_tokens_) {
+    session->metadata().clear_token_map();
+  }
+
   // If the 'system.local' table is empty the connection isn't used as a control
   // connection because at least one node's information is required (itself). An
   // empty 'system.local' can happen during the bootstrapping process on some
@@ -421,6 +726,8 @@ void ControlConnection::on_query_hosts(ControlConnection* control_connection,
         local_result->decode_first_row();
         control_connection->update_node_info(host, &local_result->first_row());
         session->metadata().set_cassandra_version(host->cassandra_version());
+        local_result->first_row().get_string_by_name("schema_version",
+                                                     &control_connection->topology_cache_.schema_version);
       } else {
         LOG_WARN("No row found in %s's local system table",
                  connection->address_string().c_str());
@@ -486,25 +793,28 @@ void ControlConnection::query_meta_schema() {
   ScopedRefPtr<ControlMultipleRequestHandler<UnusedData> > handler(
         new ControlMultipleRequestHandler<UnusedData>(this, ControlConnection::on_query_meta_schema, UnusedData()));
 
+  // Only the keyspaces in the filter are retrieved, if there is one
+  std::string where(keyspace_filter_clause(session_->config().schema_keyspace_filter()));
+
   if (session_->metadata().cassandra_version() >= VersionNumber(3, 0, 0)) {
-    handler->execute_query("keyspaces", SELECT_KEYSPACES_30);
-    handler->execute_query("tables", SELECT_TABLES_30);
-    handler->execute_query("views", SELECT_VIEWS_30);
-    handler->execute_query("columns", SELECT_COLUMNS_30);
-    handler->execute_query("indexes", SELECT_INDEXES_30);
-    handler->execute_query("user_types", SELECT_USERTYPES_30);
-    handler->execute_query("functions", SELECT_FUNCTIONS_30);
-    handler->execute_query("aggregates", SELECT_AGGREGATES_30);
+    handler->execute_query("keyspaces", SELECT_KEYSPACES_30 + where);
+    handler->execute_query("tables", SELECT_TABLES_30 + where);
+    handler->execute_query("views", SELECT_VIEWS_30 + where);
+    handler->execute_query("columns", SELECT_COLUMNS_30 + where);
+    handler->execute_query("indexes", SELECT_INDEXES_30 + where);
+    handler->execute_query("user_types", SELECT_USERTYPES_30 + where);
+    handler->execute_query("functions", SELECT_FUNCTIONS_30 + where);
+    handler->execute_query("aggregates", SELECT_AGGREGATES_30 + where);
   } else {
-    handler->execute_query("keyspaces", SELECT_KEYSPACES_20);
-    handler->execute_query("tables", SELECT_COLUMN_FAMILIES_20);
-    handler->execute_query("columns", SELECT_COLUMNS_20);
+    handler->execute_query("keyspaces", SELECT_KEYSPACES_20 + where);
+    handler->execute_query("tables", SELECT_COLUMN_FAMILIES_20 + where);
+    handler->execute_query("columns", SELECT_COLUMNS_20 + where);
     if (session_->metadata().cassandra_version() >= VersionNumber(2, 1, 0)) {
-      handler->execute_query("user_types", SELECT_USERTYPES_21);
+      handler->execute_query("user_types", SELECT_USERTYPES_21 + where);
     }
     if (session_->metadata().cassandra_version() >= VersionNumber(2, 2, 0)) {
-      handler->execute_query("functions", SELECT_FUNCTIONS_22);
-      handler->execute_query("aggregates", SELECT_AGGREGATES_22);
+      handler->execute_query("functions", SELECT_FUNCTIONS_22 + where);
+      handler->execute_query("aggregates", SELECT_AGGREGATES_22 + where);
     }
   }
 }
@@ -521,8 +831,6 @@ void ControlConnection::on_query_meta_schema(ControlConnection* control_connecti
 
   session->metadata().clear_and_update_back();
 
-  bool is_initial_connection = (control_connection->state_ == CONTROL_STATE_NEW);
-
   ResultResponse* keyspaces_result;
   if (MultipleRequestHandler::get_result_response(responses, "keyspaces", &keyspaces_result)) {
     session->metadata().update_keyspaces(keyspaces_result);
@@ -564,9 +872,25 @@ void ControlConnection::on_query_meta_schema(ControlConnection* control_connecti
   }
 
   session->metadata().swap_to_back_and_update_front();
+
+  // The schema is built off of the session's thread
+  session->metadata().notify_when_applied(ControlConnection::on_meta_schema_applied,
+                                          control_connection);
+}
+
+void ControlConnection::on_meta_schema_applied(void* data) {
+  ControlConnection* control_connection = static_cast<ControlConnection*>(data);
+  if (control_connection->connection_ == NULL) {
+    return;
+  }
+
+  Session* session = control_connection->session_;
+
   if (control_connection->should_query_tokens_) session->metadata().build();
 
-  if (is_initial_connection) {
+  control_connection->save_topology_cache();
+
+  if (control_connection->state_ == CONTROL_STATE_NEW) {
     control_connection->state_ = CONTROL_STATE_READY;
     session->on_control_connection_ready();
     // Create a new query plan that considers all the new hosts from the
@@ -575,6 +899,17 @@ void ControlConnection::on_query_meta_schema(ControlConnection* control_connecti
   }
 }
 
+void ControlConnection::schedule_refresh_node_info(const SharedRefPtr<Host>& host,
+                                                   bool is_new_node,
+                                                   bool query_tokens) {
+  if (debouncer_.is_enabled()) {
+    debouncer_.add_node(host, is_new_node, query_tokens);
+    debounce();
+  } else {
+    refresh_node_info(host, is_new_node, query_tokens);
+  }
+}
+
 void ControlConnection::refresh_node_info(SharedRefPtr<Host> host,
                                           bool is_new_node,
                                           bool query_tokens) {
@@ -727,11 +1062,23 @@ void ControlConnection::update_node_info(SharedRefPtr<Host> host, const Row* row
              host->address().to_string().c_str());
   }
 
+  bool use_topology_cache = !session_->config().topology_cache_file().empty();
+  TopologyCache::HostEntry* entry = NULL;
+  if (use_topology_cache) {
+    entry = &topology_cache_.hosts[host->address()];
+    entry->address = host->address();
+    entry->dc = host->dc();
+    entry->rack = host->rack();
+    entry->release_version = release_version;
+    entry->listen_address = host->listen_address();
+  }
+
   if (should_query_tokens_) {
     bool is_connected_host = connection_ != NULL && host->address().compare(connection_->address()) == 0;
     std::string partitioner;
     if (is_connected_host && row->get_string_by_name("partitioner", &partitioner)) {
       session_->metadata().set_partitioner(partitioner);
+      if (use_topology_cache) topology_cache_.partitioner = partitioner;
     }
     v = row->get_by_name("tokens");
     if (v != NULL) {
@@ -742,12 +1089,36 @@ void ControlConnection::update_node_info(SharedRefPtr<Host> host, const Row* row
       }
       if (!tokens.empty()) {
         session_->metadata().update_host(host, tokens);
+        if (entry != NULL) entry->tokens = to_strings(tokens);
       }
     }
   }
 }
 
-void ControlConnection::refresh_keyspace(const StringRef& keyspace_name) {
+std::string ControlConnection::keyspace_filter_clause(const KeyspaceList& keyspaces) {
+  if (keyspaces.empty()) return std::string();
+
+  std::string clause(" WHERE keyspace_name IN (");
+  for (KeyspaceList::const_iterator i = keyspaces.begin(),
+       end = keyspaces.end(); i != end; ++i) {
+    if (i != keyspaces.begin()) clause.append(", ");
+    append_quoted(*i, &clause);
+  }
+  clause.push_back(')');
+  return clause;
+}
+
+bool ControlConnection::is_keyspace_filtered(const StringRef& keyspace_name) const {
+  const KeyspaceList& keyspaces = session_->config().schema_keyspace_filter();
+  if (keyspaces.empty()) return false;
+  for (KeyspaceList::const_iterator i = keyspaces.begin(),
+       end = keyspaces.end(); i != end; ++i) {
+    if (keyspace_name == *i) return false;
+  }
+  return true;
+}
+
+void ControlConnection::refresh_keyspaces(const StringVec& keyspace_names) {
   std::string query;
 
   if (session_->metadata().cassandra_version() >= VersionNumber(3, 0, 0)) {
@@ -755,73 +1126,77 @@ void ControlConnection::refresh_keyspace(const StringRef& keyspace_name) {
   }  else {
     query.assign(SELECT_KEYSPACES_20);
   }
-  query.append(" WHERE keyspace_name='")
-       .append(keyspace_name.data(), keyspace_name.size())
-       .append("'");
+  if (keyspace_names.size() == 1) {
+    query.append(" WHERE keyspace_name=");
+    append_quoted(keyspace_names.front(), &query);
+  } else {
+    query.append(keyspace_filter_clause(keyspace_names));
+  }
 
   LOG_DEBUG("Refreshing keyspace %s", query.c_str());
 
   connection_->write(
-        new ControlHandler<std::string>(new QueryRequest(query),
-                                        this,
-                                        ControlConnection::on_refresh_keyspace,
-                                        keyspace_name.to_string()));
+        new ControlHandler<StringVec>(new QueryRequest(query),
+                                      this,
+                                      ControlConnection::on_refresh_keyspaces,
+                                      keyspace_names));
 }
 
-void ControlConnection::on_refresh_keyspace(ControlConnection* control_connection,
-                                            const std::string& keyspace_name,
-                                            Response* response) {
+void ControlConnection::on_refresh_keyspaces(ControlConnection* control_connection,
+                                             const StringVec& keyspace_names,
+                                             Response* response) {
   ResultResponse* result = static_cast<ResultResponse*>(response);
   if (result->row_count() == 0) {
     LOG_ERROR("No row found for keyspace %s in system schema table.",
-              keyspace_name.c_str());
+              join_names(keyspace_names).c_str());
     return;
   }
   control_connection->session_->metadata().update_keyspaces(result);
 }
 
-void ControlConnection::refresh_table_or_view(const StringRef& keyspace_name,
-                                              const StringRef& table_or_view_name) {
+void ControlConnection::refresh_tables_or_views(const std::string& keyspace_name,
+                                                const StringVec& table_or_view_names) {
   std::string table_query;
   std::string view_query;
   std::string column_query;
   std::string index_query;
 
+  std::string keyspace_clause(" WHERE keyspace_name=");
+  append_quoted(keyspace_name, &keyspace_clause);
+
   if (session_->metadata().cassandra_version() >= VersionNumber(3, 0, 0)) {
+    std::string table_clause(names_clause("table_name", table_or_view_names));
+
     table_query.assign(SELECT_TABLES_30);
-    table_query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-        .append("' AND table_name='").append(table_or_view_name.data(), table_or_view_name.size()).append("'");
+    table_query.append(keyspace_clause).append(table_clause);
 
     view_query.assign(SELECT_VIEWS_30);
-    view_query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-        .append("' AND view_name='").append(table_or_view_name.data(), table_or_view_name.size()).append("'");
+    view_query.append(keyspace_clause).append(names_clause("view_name", table_or_view_names));
 
     column_query.assign(SELECT_COLUMNS_30);
-    column_query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-        .append("' AND table_name='").append(table_or_view_name.data(), table_or_view_name.size()).append("'");
+    column_query.append(keyspace_clause).append(table_clause);
 
     index_query.assign(SELECT_INDEXES_30);
-    index_query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-        .append("' AND table_name='").append(table_or_view_name.data(), table_or_view_name.size()).append("'");
+    index_query.append(keyspace_clause).append(table_clause);
 
     LOG_DEBUG("Refreshing table/view %s; %s; %s; %s", table_query.c_str(), view_query.c_str(),
                                                       column_query.c_str(), index_query.c_str());
   } else {
+    std::string table_clause(names_clause("columnfamily_name", table_or_view_names));
+
     table_query.assign(SELECT_COLUMN_FAMILIES_20);
-    table_query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-        .append("' AND columnfamily_name='").append(table_or_view_name.data(), table_or_view_name.size()).append("'");
+    table_query.append(keyspace_clause).append(table_clause);
 
     column_query.assign(SELECT_COLUMNS_20);
-    column_query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-        .append("' AND columnfamily_name='").append(table_or_view_name.data(), table_or_view_name.size()).append("'");
+    column_query.append(keyspace_clause).append(table_clause);
 
     LOG_DEBUG("Refreshing table %s; %s", table_query.c_str(), column_query.c_str());
   }
 
   ScopedRefPtr<ControlMultipleRequestHandler<RefreshTableData> > handler(
         new ControlMultipleRequestHandler<RefreshTableData>(this,
-                                                            ControlConnection::on_refresh_table_or_view,
-                                                            RefreshTableData(keyspace_name.to_string(), table_or_view_name.to_string())));
+                                                            ControlConnection::on_refresh_tables_or_views,
+                                                            RefreshTableData(keyspace_name, table_or_view_names)));
   handler->execute_query("tables", table_query);
   if (!view_query.empty()) {
     handler->execute_query("views", view_query);
@@ -832,24 +1207,31 @@ void ControlConnection::refresh_table_or_view(const StringRef& keyspace_name,
   }
 }
 
-void ControlConnection::on_refresh_table_or_view(ControlConnection* control_connection,
-                                                 const RefreshTableData& data,
-                                                 const MultipleRequestHandler::ResponseMap& responses) {
-  ResultResponse* tables_result;
+void ControlConnection::on_refresh_tables_or_views(ControlConnection* control_connection,
+                                                   const RefreshTableData& data,
+                                                   const MultipleRequestHandler::ResponseMap& responses) {
   Session* session = control_connection->session_;
-  if (!MultipleRequestHandler::get_result_response(responses, "tables", &tables_result) ||
-      tables_result->row_count() == 0) {
-    ResultResponse* views_result;
-    if (!MultipleRequestHandler::get_result_response(responses, "views", &views_result) ||
-        views_result->row_count() == 0) {
-      LOG_ERROR("No row found for table (or view) %s.%s in system schema tables.",
-                data.keyspace_name.c_str(), data.table_or_view_name.c_str());
-      return;
-    }
-    session->metadata().update_views(views_result);
-  } else {
+
+  // A refresh of multiple names can contain both tables and views
+  ResultResponse* tables_result;
+  bool has_tables = MultipleRequestHandler::get_result_response(responses, "tables", &tables_result) &&
+                    tables_result->row_count() > 0;
+  ResultResponse* views_result;
+  bool has_views = MultipleRequestHandler::get_result_response(responses, "views", &views_result) &&
+                   views_result->row_count() > 0;
+
+  if (!has_tables && !has_views) {
+    LOG_ERROR("No row found for table (or view) %s.%s in system schema tables.",
+              data.keyspace_name.c_str(), join_names(data.table_or_view_names).c_str());
+    return;
+  }
+
+  if (has_tables) {
     session->metadata().update_tables(tables_result);
   }
+  if (has_views) {
+    session->metadata().update_views(views_result);
+  }
 
   ResultResponse* columns_result;
   if (MultipleRequestHandler::get_result_response(responses, "columns", &columns_result)) {
@@ -863,8 +1245,8 @@ void ControlConnection::on_refresh_table_or_view(ControlConnection* control_conn
 }
 
 
-void ControlConnection::refresh_type(const StringRef& keyspace_name,
-                                     const StringRef& type_name) {
+void ControlConnection::refresh_types(const std::string& keyspace_name,
+                                      const StringVec& type_names) {
 
   std::string query;
   if (session_->metadata().cassandra_version() >= VersionNumber(3, 0, 0)) {
@@ -873,26 +1255,27 @@ void ControlConnection::refresh_type(const StringRef& keyspace_name,
     query.assign(SELECT_USERTYPES_21);
   }
 
-  query.append(" WHERE keyspace_name='").append(keyspace_name.data(), keyspace_name.size())
-                .append("' AND type_name='").append(type_name.data(), type_name.size()).append("'");
+  query.append(" WHERE keyspace_name=");
+  append_quoted(keyspace_name, &query);
+  query.append(names_clause("type_name", type_names));
 
   LOG_DEBUG("Refreshing type %s", query.c_str());
 
   connection_->write(
-        new ControlHandler<std::pair<std::string, std::string> >(new QueryRequest(query),
+        new ControlHandler<std::pair<std::string, StringVec> >(new QueryRequest(query),
                                         this,
-                                        ControlConnection::on_refresh_type,
-                                        std::make_pair(keyspace_name.to_string(), type_name.to_string())));
+                                        ControlConnection::on_refresh_types,
+                                        std::make_pair(keyspace_name, type_names)));
 }
 
-void ControlConnection::on_refresh_type(ControlConnection* control_connection,
-                                        const std::pair<std::string, std::string>& keyspace_and_type_names,
-                                        Response* response) {
+void ControlConnection::on_refresh_types(ControlConnection* control_connection,
+                                         const std::pair<std::string, StringVec>& keyspace_and_type_names,
+                                         Response* response) {
   ResultResponse* result = static_cast<ResultResponse*>(response);
   if (result->row_count() == 0) {
     LOG_ERROR("No row found for keyspace %s and type %s in system schema.",
               keyspace_and_type_names.first.c_str(),
-              keyspace_and_type_names.second.c_str());
+              join_names(keyspace_and_type_names.second).c_str());
     return;
   }
   control_connection->session_->metadata().update_user_types(result);
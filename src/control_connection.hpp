@@ -19,6 +19,7 @@
 
 #include "address.hpp"
 #include "connection.hpp"
+#include "event_debouncer.hpp"
 #include "token_map.hpp"
 #include "handler.hpp"
 #include "host.hpp"
@@ -27,6 +28,8 @@
 #include "multiple_request_handler.hpp"
 #include "response.hpp"
 #include "scoped_ptr.hpp"
+#include "topology_cache.hpp"
+#include "utils.hpp"
 
 namespace cass {
 
@@ -50,6 +53,9 @@ public:
     CONTROL_STATE_CLOSED
   };
 
+  // Returns a "WHERE keyspace_name IN (...)" clause for the keyspaces
+  static std::string keyspace_filter_clause(const KeyspaceList& keyspaces);
+
   ControlConnection();
   virtual ~ControlConnection() {}
 
@@ -59,6 +65,15 @@ public:
 
   const SharedRefPtr<Host>& connected_host() const;
 
+  // Returns NULL if the control connection isn't ready
+  Connection* connection() const {
+    if (state_ != CONTROL_STATE_READY ||
+        connection_ == NULL || !connection_->is_ready()) {
+      return NULL;
+    }
+    return connection_;
+  }
+
   void clear();
 
   void connect(Session* session);
@@ -99,11 +114,11 @@ private:
 
   struct RefreshTableData {
     RefreshTableData(const std::string& keyspace_name,
-                     const std::string& table_name)
+                     const StringVec& table_names)
       : keyspace_name(keyspace_name)
-      , table_or_view_name(table_name) {}
+      , table_or_view_names(table_names) {}
     std::string keyspace_name;
-    std::string table_or_view_name;
+    StringVec table_or_view_names;
   };
 
   struct UnusedData {};
@@ -182,10 +197,22 @@ private:
 
   static void on_reconnect(Timer* timer);
 
+  void debounce();
+  static void on_debounce(Timer* timer);
+  void flush_pending_refreshes();
+  void debounce_schema_change(EventResponse* response);
+
   bool handle_query_invalid_response(Response* response);
   void handle_query_failure(CassError code, const std::string& message);
   void handle_query_timeout();
 
+  void query_topology_cache_versions();
+  static void on_query_topology_cache_versions(ControlConnection* control_connection,
+                                               const UnusedData& data,
+                                               Response* response);
+  void apply_topology_cache();
+  void save_topology_cache();
+
   void query_meta_hosts();
   static void on_query_hosts(ControlConnection* control_connection,
                              const UnusedData& data,
@@ -195,7 +222,11 @@ private:
   static void on_query_meta_schema(ControlConnection* control_connection,
                                 const UnusedData& data,
                                 const MultipleRequestHandler::ResponseMap& responses);
+  static void on_meta_schema_applied(void* data);
 
+  void schedule_refresh_node_info(const SharedRefPtr<Host>& host,
+                                  bool is_new_node,
+                                  bool query_tokens);
   void refresh_node_info(SharedRefPtr<Host> host,
                          bool is_new_node,
                          bool query_tokens = false);
@@ -208,20 +239,22 @@ private:
 
   void update_node_info(SharedRefPtr<Host> host, const Row* row);
 
-  void refresh_keyspace(const StringRef& keyspace_name);
-  static void on_refresh_keyspace(ControlConnection* control_connection, const std::string& keyspace_name, Response* response);
+  bool is_keyspace_filtered(const StringRef& keyspace_name) const;
+
+  void refresh_keyspaces(const StringVec& keyspace_names);
+  static void on_refresh_keyspaces(ControlConnection* control_connection, const StringVec& keyspace_names, Response* response);
 
-  void refresh_table_or_view(const StringRef& keyspace_name,
-                     const StringRef& table_name);
-  static void on_refresh_table_or_view(ControlConnection* control_connection,
-                               const RefreshTableData& data,
-                               const MultipleRequestHandler::ResponseMap& responses);
+  void refresh_tables_or_views(const std::string& keyspace_name,
+                               const StringVec& table_names);
+  static void on_refresh_tables_or_views(ControlConnection* control_connection,
+                                         const RefreshTableData& data,
+                                         const MultipleRequestHandler::ResponseMap& responses);
 
-  void refresh_type(const StringRef& keyspace_name,
-                    const StringRef& type_name);
-  static void on_refresh_type(ControlConnection* control_connection,
-                              const std::pair<std::string, std::string>& keyspace_and_type_names,
-                              Response* response);
+  void refresh_types(const std::string& keyspace_name,
+                     const StringVec& type_names);
+  static void on_refresh_types(ControlConnection* control_connection,
+                               const std::pair<std::string, StringVec>& keyspace_and_type_names,
+                               Response* response);
 
   void refresh_function(const StringRef& keyspace_name,
                         const StringRef& function_name,
@@ -236,11 +269,16 @@ private:
   Session* session_;
   Connection* connection_;
   Timer reconnect_timer_;
+  EventDebouncer debouncer_;
+  Timer debounce_timer_;
   ScopedPtr<QueryPlan> query_plan_;
   Host::Ptr current_host_;
   int protocol_version_;
   std::string last_connection_error_;
   bool should_query_tokens_;
+  TopologyCache topology_cache_;
+  TopologyCacheWriter topology_cache_writer_;
+  bool has_topology_cache_;
 
   static Address bind_any_ipv4_;
   static Address bind_any_ipv6_;
@@ -383,6 +383,20 @@ namespace cass {
 
 const DataType::ConstPtr DataType::NIL;
 
+bool has_user_type(const DataType::ConstPtr& data_type) {
+  if (!data_type) return false;
+  if (data_type->is_user_type()) return true;
+  if (data_type->is_collection() || data_type->is_tuple()) {
+    const CompositeType* composite_type
+        = static_cast<const CompositeType*>(data_type.get());
+    for (DataType::Vec::const_iterator i = composite_type->types().begin(),
+         end = composite_type->types().end(); i != end; ++i) {
+      if (has_user_type(*i)) return true;
+    }
+  }
+  return false;
+}
+
 void NativeDataTypes::init_class_names() {
   if (!by_class_names_.empty()) return;
   by_class_names_["org.apache.cassandra.db.marshal.AsciiType"] = DataType::ConstPtr(new DataType(CASS_VALUE_TYPE_ASCII));
@@ -449,6 +449,10 @@ private:
   CaseInsensitiveHashTable<Field> fields_;
 };
 
+// Returns true if the type is a user type or if it's a collection or tuple
+// that contains a user type
+bool has_user_type(const DataType::ConstPtr& data_type);
+
 class NativeDataTypes {
 public:
   void init_class_names();
@@ -18,10 +18,12 @@
 
 #include "utils.hpp"
 #include "logger.hpp"
+#include "scoped_lock.hpp"
 #include "scoped_ptr.hpp"
 #include "string_ref.hpp"
 
 #include <sstream>
+#include <uv.h>
 
 #define REVERSED_TYPE "org.apache.cassandra.db.marshal.ReversedType"
 #define FROZEN_TYPE "org.apache.cassandra.db.marshal.FrozenType"
@@ -64,10 +66,84 @@ bool from_hex(const std::string& hex, std::string* result) {
   return true;
 }
 
+typedef std::map<std::string, DataType::ConstPtr> DataTypeMap;
+
+static uv_once_t cache_init_guard = UV_ONCE_INIT;
+static uv_mutex_t cache_mutex;
+static DataTypeMap* cache;
+
+static void cache_init() {
+  uv_mutex_init(&cache_mutex);
+  // Never freed so that it's valid during static destruction
+  cache = new DataTypeMap[DataTypeCache::TYPE_COUNT];
+}
+
+DataType::ConstPtr DataTypeCache::get(Type type, const std::string& name) {
+  uv_once(&cache_init_guard, cache_init);
+  ScopedMutex l(&cache_mutex);
+  DataTypeMap::const_iterator i = cache[type].find(name);
+  if (i == cache[type].end()) return DataType::ConstPtr();
+  return i->second;
+}
+
+void DataTypeCache::put(Type type, const std::string& name, const DataType::ConstPtr& data_type) {
+  uv_once(&cache_init_guard, cache_init);
+  // The type being replaced is released outside of the lock
+  DataTypeMap previous;
+  {
+    ScopedMutex l(&cache_mutex);
+    if (cache[type].size() >= MAX_SIZE) {
+      previous.swap(cache[type]);
+    }
+    cache[type][name] = data_type;
+  }
+}
+
+size_t DataTypeCache::size() {
+  uv_once(&cache_init_guard, cache_init);
+  ScopedMutex l(&cache_mutex);
+  size_t size = 0;
+  for (int i = 0; i < TYPE_COUNT; ++i) {
+    size += cache[i].size();
+  }
+  return size;
+}
+
+void DataTypeCache::clear() {
+  uv_once(&cache_init_guard, cache_init);
+  DataTypeMap previous[TYPE_COUNT];
+  {
+    ScopedMutex l(&cache_mutex);
+    for (int i = 0; i < TYPE_COUNT; ++i) {
+      previous[i].swap(cache[i]);
+    }
+  }
+}
+
 DataType::ConstPtr DataTypeCqlNameParser::parse(const std::string& type,
                                                 const NativeDataTypes& native_types,
                                                 KeyspaceMetadata* keyspace,
                                                 bool is_frozen) {
+  // Frozen types are only parsed as part of a "frozen<...>" type which is
+  // cached as a whole
+  if (is_frozen) {
+    return parse_uncached(type, native_types, keyspace, is_frozen);
+  }
+
+  DataType::ConstPtr data_type(DataTypeCache::get(DataTypeCache::CQL_NAME, type));
+  if (data_type) return data_type;
+
+  data_type = parse_uncached(type, native_types, keyspace, is_frozen);
+  if (data_type && !has_user_type(data_type)) {
+    DataTypeCache::put(DataTypeCache::CQL_NAME, type, data_type);
+  }
+  return data_type;
+}
+
+DataType::ConstPtr DataTypeCqlNameParser::parse_uncached(const std::string& type,
+                                                         const NativeDataTypes& native_types,
+                                                         KeyspaceMetadata* keyspace,
+                                                         bool is_frozen) {
   Parser parser(type, 0);
   std::string type_name;
   Parser::TypeParamsVec params;
@@ -279,6 +355,17 @@ bool DataTypeClassNameParser::is_tuple_type(const std::string& type) {
 }
 
 DataType::ConstPtr DataTypeClassNameParser::parse_one(const std::string& type, const NativeDataTypes& native_types) {
+  DataType::ConstPtr data_type(DataTypeCache::get(DataTypeCache::CLASS_NAME, type));
+  if (data_type) return data_type;
+
+  data_type = parse_one_uncached(type, native_types);
+  if (data_type) {
+    DataTypeCache::put(DataTypeCache::CLASS_NAME, type, data_type);
+  }
+  return data_type;
+}
+
+DataType::ConstPtr DataTypeClassNameParser::parse_one_uncached(const std::string& type, const NativeDataTypes& native_types) {
   bool is_frozen = DataTypeClassNameParser::is_frozen(type);
 
   std::string class_name;
@@ -80,6 +80,32 @@ protected:
   size_t index_;
 };
 
+// A bounded, process wide cache of parsed types. Types are immutable so every
+// column (in every session and schema refresh) with the same type string
+// shares a single type. The cache is cleared when it's full.
+//
+// CQL names reference user types by name and are resolved against the
+// keyspace being built, so CQL types that contain user types are never
+// cached. Class names include the user type's fields which means that an
+// altered user type has a different class name.
+class DataTypeCache {
+public:
+  enum Type {
+    CQL_NAME,
+    CLASS_NAME,
+    TYPE_COUNT
+  };
+
+  static const size_t MAX_SIZE = 4096;
+
+  // Returns an empty pointer if the type isn't cached
+  static DataType::ConstPtr get(Type type, const std::string& name);
+  static void put(Type type, const std::string& name, const DataType::ConstPtr& data_type);
+
+  static size_t size();
+  static void clear();
+};
+
 class DataTypeCqlNameParser {
 public:
   static DataType::ConstPtr parse(const std::string& type,
@@ -88,6 +114,12 @@ public:
                                   bool is_frozen = false);
 
 private:
+  static DataType::ConstPtr parse_uncached(const std::string& type,
+                                           const NativeDataTypes& native_types,
+                                           KeyspaceMetadata* keyspace,
+                                           bool is_frozen);
+
+
   class Parser : public ParserBase {
   public:
     typedef std::vector<std::string> TypeParamsVec;
@@ -150,6 +182,7 @@ public:
   static SharedRefPtr<ParseResult> parse_with_composite(const std::string& type, const NativeDataTypes& native_types);
 
 private:
+  static DataType::ConstPtr parse_one_uncached(const std::string& type, const NativeDataTypes& native_types);
   static bool get_nested_class_name(const std::string& type, std::string* class_name);
 
   typedef std::vector<std::string> TypeParamsVec;
@@ -0,0 +1,152 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "event_debouncer.hpp"
+
+#include <algorithm>
+
+namespace cass {
+
+static void erase_name(const std::string& keyspace,
+                       const std::string& name,
+                       EventDebouncer::KeyspaceNameMap* names) {
+  EventDebouncer::KeyspaceNameMap::iterator i = names->find(keyspace);
+  if (i != names->end()) {
+    i->second.erase(name);
+    if (i->second.empty()) {
+      names->erase(i);
+    }
+  }
+}
+
+bool EventDebouncer::Function::operator<(const Function& other) const {
+  if (keyspace != other.keyspace) return keyspace < other.keyspace;
+  if (name != other.name) return name < other.name;
+  if (is_aggregate != other.is_aggregate) return is_aggregate < other.is_aggregate;
+  return arg_types < other.arg_types;
+}
+
+EventDebouncer::EventDebouncer()
+  : window_ms_(0)
+  , max_delay_ms_(0)
+  , has_first_event_(false)
+  , first_event_ms_(0) { }
+
+void EventDebouncer::init(uint64_t window_ms, uint64_t max_delay_ms) {
+  window_ms_ = window_ms;
+  max_delay_ms_ = std::max(window_ms, max_delay_ms);
+  clear();
+}
+
+void EventDebouncer::add_keyspace(const StringRef& keyspace) {
+  pending_.keyspaces.insert(keyspace.to_string());
+}
+
+void EventDebouncer::add_table_or_view(const StringRef& keyspace, const StringRef& name) {
+  pending_.tables_and_views[keyspace.to_string()].insert(name.to_string());
+}
+
+void EventDebouncer::add_type(const StringRef& keyspace, const StringRef& name) {
+  pending_.types[keyspace.to_string()].insert(name.to_string());
+}
+
+void EventDebouncer::add_function(const StringRef& keyspace,
+                                  const StringRef& name,
+                                  const StringRefVec& arg_types,
+                                  bool is_aggregate) {
+  pending_.functions.insert(Function(keyspace.to_string(),
+                                     name.to_string(),
+                                     to_strings(arg_types),
+                                     is_aggregate));
+}
+
+void EventDebouncer::add_node(const SharedRefPtr<Host>& host,
+                              bool is_new_node,
+                              bool query_tokens) {
+  NodeMap::iterator i = pending_.nodes.find(host->address());
+  if (i == pending_.nodes.end()) {
+    pending_.nodes.insert(std::make_pair(host->address(),
+                                         Node(host, is_new_node, query_tokens)));
+  } else {
+    i->second.host = host;
+    i->second.is_new_node = i->second.is_new_node || is_new_node;
+    i->second.query_tokens = i->second.query_tokens || query_tokens;
+  }
+}
+
+void EventDebouncer::drop_keyspace(const std::string& keyspace) {
+  pending_.keyspaces.erase(keyspace);
+  pending_.tables_and_views.erase(keyspace);
+  pending_.types.erase(keyspace);
+  FunctionSet::iterator i = pending_.functions.begin();
+  while (i != pending_.functions.end()) {
+    if (i->keyspace == keyspace) {
+      pending_.functions.erase(i++);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void EventDebouncer::drop_table_or_view(const std::string& keyspace,
+                                        const std::string& name) {
+  erase_name(keyspace, name, &pending_.tables_and_views);
+}
+
+void EventDebouncer::drop_type(const std::string& keyspace,
+                               const std::string& name) {
+  erase_name(keyspace, name, &pending_.types);
+}
+
+void EventDebouncer::drop_function(const std::string& keyspace,
+                                   const std::string& name,
+                                   const StringVec& arg_types,
+                                   bool is_aggregate) {
+  pending_.functions.erase(Function(keyspace, name, arg_types, is_aggregate));
+}
+
+void EventDebouncer::remove_node(const Address& address) {
+  pending_.nodes.erase(address);
+}
+
+void EventDebouncer::clear_schema() {
+  pending_.clear_schema();
+  if (pending_.is_empty()) {
+    has_first_event_ = false;
+  }
+}
+
+void EventDebouncer::clear() {
+  pending_ = Pending();
+  has_first_event_ = false;
+}
+
+uint64_t EventDebouncer::next_delay(uint64_t now_ms) {
+  if (!has_first_event_) {
+    has_first_event_ = true;
+    first_event_ms_ = now_ms;
+  }
+  uint64_t deadline_ms = first_event_ms_ + max_delay_ms_;
+  if (now_ms >= deadline_ms) return 0;
+  return std::min(window_ms_, deadline_ms - now_ms);
+}
+
+void EventDebouncer::take(Pending* output) {
+  *output = pending_;
+  clear();
+}
+
+} // namespace cass
@@ -0,0 +1,147 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_EVENT_DEBOUNCER_HPP_INCLUDED__
+#define __CASS_EVENT_DEBOUNCER_HPP_INCLUDED__
+
+#include "address.hpp"
+#include "host.hpp"
+#include "string_ref.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace cass {
+
+// Accumulates the metadata refreshes triggered by schema and topology change
+// events so that a burst of events is handled using the fewest number of
+// refresh queries. Duplicate refreshes are merged and the tables and types
+// changed in the same keyspace are grouped so they can be refreshed together.
+class EventDebouncer {
+public:
+  typedef std::set<std::string> NameSet;
+  typedef std::map<std::string, NameSet> KeyspaceNameMap;
+
+  struct Function {
+    Function(const std::string& keyspace,
+             const std::string& name,
+             const StringVec& arg_types,
+             bool is_aggregate)
+      : keyspace(keyspace)
+      , name(name)
+      , arg_types(arg_types)
+      , is_aggregate(is_aggregate) { }
+
+    bool operator<(const Function& other) const;
+
+    std::string keyspace;
+    std::string name;
+    StringVec arg_types;
+    bool is_aggregate;
+  };
+
+  typedef std::set<Function> FunctionSet;
+
+  struct Node {
+    Node(const SharedRefPtr<Host>& host,
+         bool is_new_node,
+         bool query_tokens)
+      : host(host)
+      , is_new_node(is_new_node)
+      , query_tokens(query_tokens) { }
+
+    SharedRefPtr<Host> host;
+    bool is_new_node;
+    bool query_tokens;
+  };
+
+  typedef std::map<Address, Node> NodeMap;
+
+  struct Pending {
+    bool is_empty() const {
+      return keyspaces.empty() && tables_and_views.empty() &&
+          types.empty() && functions.empty() && nodes.empty();
+    }
+
+    void clear_schema() {
+      keyspaces.clear();
+      tables_and_views.clear();
+      types.clear();
+      functions.clear();
+    }
+
+    NameSet keyspaces;
+    KeyspaceNameMap tables_and_views;
+    KeyspaceNameMap types;
+    FunctionSet functions;
+    NodeMap nodes;
+  };
+
+  EventDebouncer();
+
+  void init(uint64_t window_ms, uint64_t max_delay_ms);
+
+  bool is_enabled() const { return window_ms_ > 0; }
+  bool is_empty() const { return pending_.is_empty(); }
+  const Pending& pending() const { return pending_; }
+
+  void add_keyspace(const StringRef& keyspace);
+  void add_table_or_view(const StringRef& keyspace, const StringRef& name);
+  void add_type(const StringRef& keyspace, const StringRef& name);
+  void add_function(const StringRef& keyspace,
+                    const StringRef& name,
+                    const StringRefVec& arg_types,
+                    bool is_aggregate);
+  void add_node(const SharedRefPtr<Host>& host,
+                bool is_new_node,
+                bool query_tokens);
+
+  // Dropped and removed objects are handled immediately so any pending
+  // refreshes for them are discarded.
+  void drop_keyspace(const std::string& keyspace);
+  void drop_table_or_view(const std::string& keyspace, const std::string& name);
+  void drop_type(const std::string& keyspace, const std::string& name);
+  void drop_function(const std::string& keyspace,
+                     const std::string& name,
+                     const StringVec& arg_types,
+                     bool is_aggregate);
+  void remove_node(const Address& address);
+
+  // Discards the pending schema refreshes, the node refreshes are kept
+  void clear_schema();
+  void clear();
+
+  // Returns the time to wait before the pending refreshes are handled. The
+  // window is restarted by each event, but the first event of a burst is
+  // never delayed more than the max delay.
+  uint64_t next_delay(uint64_t now_ms);
+
+  // Moves the pending refreshes into the output and starts a new burst
+  void take(Pending* output);
+
+private:
+  uint64_t window_ms_;
+  uint64_t max_delay_ms_;
+  bool has_first_event_;
+  uint64_t first_event_ms_;
+  Pending pending_;
+};
+
+} // namespace cass
+
+#endif
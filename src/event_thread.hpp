@@ -43,6 +43,8 @@ public:
 
   bool send_event_async(const E& event) { return event_queue_->enqueue(event); }
 
+  size_t event_queue_size() const { return event_queue_->size(); }
+
   virtual void on_event(const E& event) = 0;
 
 private:
@@ -19,6 +19,7 @@
 #include "request_handler.hpp"
 #include "scoped_ptr.hpp"
 #include "external_types.hpp"
+#include "trace_handler.hpp"
 
 extern "C" {
 
@@ -160,6 +161,46 @@ CassError cass_future_custom_payload_item(CassFuture* future,
   return CASS_OK;
 }
 
+CassError cass_future_latency_breakdown(CassFuture* future,
+                                        CassLatencyBreakdown* output) {
+  if (future->type() != cass::CASS_FUTURE_TYPE_RESPONSE) {
+    return CASS_ERROR_LIB_INVALID_FUTURE_TYPE;
+  }
+  cass::LatencyBreakdown latency_breakdown;
+  if (!static_cast<cass::ResponseFuture*>(future->from())->latency_breakdown(&latency_breakdown)) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+  latency_breakdown.to_cass(output);
+  return CASS_OK;
+}
+
+CassError cass_future_tracing_id(CassFuture* future,
+                                 CassUuid* tracing_id) {
+  if (future->type() != cass::CASS_FUTURE_TYPE_RESPONSE) {
+    return CASS_ERROR_LIB_INVALID_FUTURE_TYPE;
+  }
+  cass::SharedRefPtr<cass::Response> response(
+        static_cast<cass::ResponseFuture*>(future->from())->response());
+  if (!response || !response->has_tracing_id()) {
+    return CASS_ERROR_LIB_NO_TRACING_ID;
+  }
+  *tracing_id = response->tracing_id();
+  return CASS_OK;
+}
+
+CassError cass_future_get_trace(CassFuture* future,
+                                CassTrace* output) {
+  if (future->type() != cass::CASS_FUTURE_TYPE_TRACE) {
+    return CASS_ERROR_LIB_INVALID_FUTURE_TYPE;
+  }
+  const cass::Future::Error* error = future->get_error();
+  if (error != NULL) {
+    return error->code;
+  }
+  static_cast<cass::TraceFuture*>(future->from())->trace(output);
+  return CASS_OK;
+}
+
 } // extern "C"
 
 namespace cass {
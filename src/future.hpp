@@ -35,7 +35,8 @@ struct Error;
 
 enum FutureType {
   CASS_FUTURE_TYPE_SESSION,
-  CASS_FUTURE_TYPE_RESPONSE
+  CASS_FUTURE_TYPE_RESPONSE,
+  CASS_FUTURE_TYPE_TRACE
 };
 
 class Future : public RefCounted<Future> {
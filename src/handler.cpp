@@ -37,9 +37,15 @@ int32_t Handler::encode(int version, int flags, BufferVec* bufs) {
   const Request* req = request();
   int32_t length = 0;
 
-  if (version >= 4 && req->custom_payload()) {
+  if (req->tracing()) {
+    flags |= CASS_FLAG_TRACING;
+  }
+
+  const CustomPayload* custom_payload = custom_payload_ ? custom_payload_.get()
+                                                        : req->custom_payload().get();
+  if (version >= 4 && custom_payload != NULL) {
     flags |= CASS_FLAG_CUSTOM_PAYLOAD;
-    length += req->custom_payload()->encode(bufs);
+    length += custom_payload->encode(bufs);
   }
 
   int32_t result = req->encode(version, this, bufs);
@@ -75,6 +81,9 @@ void Handler::set_state(Handler::State next_state) {
         stream_ = -1;
       } else if (next_state == REQUEST_STATE_WRITING) {
         start_time_ns_ = uv_hrtime();
+        if (is_latency_breakdown_enabled_) {
+          latency_breakdown_.record(LatencyBreakdown::STAGE_WRITE_STARTED, start_time_ns_);
+        }
         state_ = next_state;
       } else {
         assert(false && "Invalid request state after new");
@@ -83,7 +92,11 @@ void Handler::set_state(Handler::State next_state) {
 
     case REQUEST_STATE_WRITING:
       if (next_state == REQUEST_STATE_READING) { // Success
+        record_stage(LatencyBreakdown::STAGE_WRITE_FINISHED);
         state_ = next_state;
+        if (is_write_notification_enabled_) {
+          on_write_finished();
+        }
       } else if (next_state == REQUEST_STATE_READ_BEFORE_WRITE ||
                  next_state == REQUEST_STATE_DONE) {
         stop_timer();
@@ -20,6 +20,7 @@
 #include "buffer.hpp"
 #include "constants.hpp"
 #include "cassandra.h"
+#include "latency_breakdown.hpp"
 #include "utils.hpp"
 #include "list.hpp"
 #include "request.hpp"
@@ -57,7 +58,9 @@ public:
     , state_(REQUEST_STATE_NEW)
     , cl_(CASS_CONSISTENCY_UNKNOWN)
     , timestamp_(CASS_INT64_MIN)
-    , start_time_ns_(0) { }
+    , start_time_ns_(0)
+    , is_latency_breakdown_enabled_(false)
+    , is_write_notification_enabled_(false) { }
 
   virtual ~Handler() {}
 
@@ -114,8 +117,41 @@ public:
 
   uint64_t start_time_ns() const { return start_time_ns_; }
 
+  bool is_latency_breakdown_enabled() const { return is_latency_breakdown_enabled_; }
+
+  void enable_latency_breakdown() {
+    is_latency_breakdown_enabled_ = true;
+    latency_breakdown_.record(LatencyBreakdown::STAGE_CREATED, uv_hrtime());
+  }
+
+  const LatencyBreakdown& latency_breakdown() const { return latency_breakdown_; }
+
+  void record_stage(LatencyBreakdown::Stage stage) {
+    if (is_latency_breakdown_enabled_) {
+      latency_breakdown_.record(stage, uv_hrtime());
+    }
+  }
+
+  void clear_stages_after(LatencyBreakdown::Stage stage) {
+    latency_breakdown_.clear_after(stage);
+  }
+
   Request::EncodingCache* encoding_cache() { return &encoding_cache_; }
 
+  // Replaces the request's custom payload for this execution only
+  void set_custom_payload(const CustomPayload* payload) {
+    custom_payload_.reset(payload);
+  }
+
+protected:
+  // Called when the request has been written if enabled using
+  // enable_write_notification()
+  virtual void on_write_finished() { }
+
+  void enable_write_notification() {
+    is_write_notification_enabled_ = true;
+  }
+
 protected:
   ScopedRefPtr<const Request> request_;
   Connection* connection_;
@@ -127,7 +163,11 @@ private:
   CassConsistency cl_;
   int64_t timestamp_;
   uint64_t start_time_ns_;
+  bool is_latency_breakdown_enabled_;
+  bool is_write_notification_enabled_;
+  LatencyBreakdown latency_breakdown_;
   Request::EncodingCache encoding_cache_;
+  SharedRefPtr<const CustomPayload> custom_payload_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(Handler);
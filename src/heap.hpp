@@ -0,0 +1,162 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_HEAP_HPP_INCLUDED__
+#define __CASS_HEAP_HPP_INCLUDED__
+
+#include "macros.hpp"
+
+#include <assert.h>
+#include <stddef.h>
+#include <vector>
+
+namespace cass {
+
+// Elements of an intrusive heap keep track of their own position so that they
+// can be removed or re-positioned in O(log n) when their key changes.
+class HeapNode {
+public:
+  HeapNode()
+      : heap_index_(invalid_index()) {}
+
+  bool is_in_heap() const { return heap_index_ != invalid_index(); }
+
+private:
+  static size_t invalid_index() { return static_cast<size_t>(-1); }
+
+  template <class T, class Compare>
+  friend class Heap;
+
+  size_t heap_index_;
+};
+
+// A binary min-heap of pointers to elements derived from HeapNode. The
+// comparison must be a strict weak ordering, the smallest element is at the
+// top. When an element's key changes update() must be called to restore the
+// heap property.
+template <class T, class Compare>
+class Heap {
+public:
+  typedef typename std::vector<T*>::const_iterator const_iterator;
+
+  Heap(Compare compare = Compare())
+      : compare_(compare) {}
+
+  bool empty() const { return elements_.empty(); }
+  size_t size() const { return elements_.size(); }
+
+  T* top() const { return elements_.empty() ? NULL : elements_.front(); }
+
+  // Elements are in heap order, not sorted order
+  T* operator[](size_t index) const { return elements_[index]; }
+
+  const_iterator begin() const { return elements_.begin(); }
+  const_iterator end() const { return elements_.end(); }
+
+  bool contains(const T* element) const {
+    const HeapNode* node = element;
+    return node->is_in_heap() &&
+        node->heap_index_ < elements_.size() &&
+        elements_[node->heap_index_] == element;
+  }
+
+  void push(T* element) {
+    assert(!static_cast<HeapNode*>(element)->is_in_heap());
+    elements_.push_back(element);
+    set_index(elements_.size() - 1);
+    sift_up(elements_.size() - 1);
+  }
+
+  bool remove(T* element) {
+    if (!contains(element)) return false;
+    size_t index = static_cast<HeapNode*>(element)->heap_index_;
+    size_t last = elements_.size() - 1;
+    if (index != last) {
+      elements_[index] = elements_[last];
+      set_index(index);
+    }
+    elements_.pop_back();
+    static_cast<HeapNode*>(element)->heap_index_ = HeapNode::invalid_index();
+    if (index != last) {
+      update_at(index);
+    }
+    return true;
+  }
+
+  void update(T* element) {
+    if (!contains(element)) return;
+    update_at(static_cast<HeapNode*>(element)->heap_index_);
+  }
+
+private:
+  void set_index(size_t index) {
+    static_cast<HeapNode*>(elements_[index])->heap_index_ = index;
+  }
+
+  void swap(size_t a, size_t b) {
+    T* temp = elements_[a];
+    elements_[a] = elements_[b];
+    elements_[b] = temp;
+    set_index(a);
+    set_index(b);
+  }
+
+  void update_at(size_t index) {
+    if (index > 0 && compare_(elements_[index], elements_[(index - 1) / 2])) {
+      sift_up(index);
+    } else {
+      sift_down(index);
+    }
+  }
+
+  void sift_up(size_t index) {
+    while (index > 0) {
+      size_t parent = (index - 1) / 2;
+      if (!compare_(elements_[index], elements_[parent])) break;
+      swap(index, parent);
+      index = parent;
+    }
+  }
+
+  void sift_down(size_t index) {
+    const size_t size = elements_.size();
+    while (true) {
+      size_t smallest = index;
+      size_t left = 2 * index + 1;
+      size_t right = left + 1;
+      if (left < size && compare_(elements_[left], elements_[smallest])) {
+        smallest = left;
+      }
+      if (right < size && compare_(elements_[right], elements_[smallest])) {
+        smallest = right;
+      }
+      if (smallest == index) break;
+      swap(index, smallest);
+      index = smallest;
+    }
+  }
+
+private:
+  Compare compare_;
+  std::vector<T*> elements_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(Heap);
+};
+
+} // namespace cass
+
+#endif
@@ -0,0 +1,217 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "histogram_log_writer.hpp"
+
+#include "logger.hpp"
+#include "serialization.hpp"
+
+#include <algorithm>
+#include <time.h>
+#include <vector>
+
+#ifdef CASS_USE_ZLIB
+#include <zlib.h>
+#endif
+
+#define V2_ENCODING_COOKIE 0x1c849313
+#define V2_COMPRESSION_COOKIE 0x1c849314
+#define V2_ENCODING_HEADER_SIZE 40
+#define V2_COMPRESSION_HEADER_SIZE 8
+
+namespace cass {
+
+#ifdef CASS_USE_ZLIB
+
+// ZigZag LEB128-64b9B encoding used for the counts of V2 histograms. The
+// ninth byte (if needed) holds the remaining 8 bits.
+static void encode_zig_zag(int64_t value, std::vector<char>* output) {
+  uint64_t v = static_cast<uint64_t>((value << 1) ^ (value >> 63));
+  for (int i = 0; i < 8; ++i) {
+    if (v < 0x80) {
+      output->push_back(static_cast<char>(v));
+      return;
+    }
+    output->push_back(static_cast<char>((v & 0x7F) | 0x80));
+    v >>= 7;
+  }
+  output->push_back(static_cast<char>(v));
+}
+
+static void encode_base64(const char* data, size_t size, std::string* output) {
+  static const char* alphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  output->reserve(output->size() + ((size + 2) / 3) * 4);
+
+  size_t i = 0;
+  for (; i + 2 < size; i += 3) {
+    uint32_t n = (static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << 16) |
+                 (static_cast<uint32_t>(static_cast<uint8_t>(data[i + 1])) << 8) |
+                 (static_cast<uint32_t>(static_cast<uint8_t>(data[i + 2])));
+    output->push_back(alphabet[(n >> 18) & 0x3F]);
+    output->push_back(alphabet[(n >> 12) & 0x3F]);
+    output->push_back(alphabet[(n >> 6) & 0x3F]);
+    output->push_back(alphabet[n & 0x3F]);
+  }
+
+  if (i < size) {
+    uint32_t n = static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << 16;
+    if (i + 1 < size) {
+      n |= static_cast<uint32_t>(static_cast<uint8_t>(data[i + 1])) << 8;
+    }
+    output->push_back(alphabet[(n >> 18) & 0x3F]);
+    output->push_back(alphabet[(n >> 12) & 0x3F]);
+    output->push_back(i + 1 < size ? alphabet[(n >> 6) & 0x3F] : '=');
+    output->push_back('=');
+  }
+}
+
+#endif
+
+HistogramLogWriter::HistogramLogWriter(const std::string& path,
+                                       int significant_figures)
+  : path_(path)
+  , file_(NULL)
+  , interval_(NULL)
+  , start_time_ms_(0)
+  , interval_start_time_ms_(0) {
+  hdr_init(1LL, Metrics::Histogram::HIGHEST_TRACKABLE_VALUE,
+           significant_figures, &interval_);
+}
+
+HistogramLogWriter::~HistogramLogWriter() {
+  if (file_ != NULL) {
+    fclose(file_);
+  }
+  free(interval_);
+}
+
+bool HistogramLogWriter::is_available() {
+#ifdef CASS_USE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool HistogramLogWriter::open(uint64_t start_time_ms) {
+  if (!is_available()) {
+    LOG_ERROR("Unable to write histogram log '%s': zlib support is required",
+              path_.c_str());
+    return false;
+  }
+
+  file_ = fopen(path_.c_str(), "w");
+  if (file_ == NULL) {
+    LOG_ERROR("Unable to open histogram log '%s'", path_.c_str());
+    return false;
+  }
+
+  start_time_ms_ = interval_start_time_ms_ = start_time_ms;
+
+  time_t start_time_secs = static_cast<time_t>(start_time_ms / 1000);
+  char date[64] = { '\0' };
+  strftime(date, sizeof(date), "%a %b %d %H:%M:%S UTC %Y", gmtime(&start_time_secs));
+
+  fprintf(file_, "#[Histogram log format version 1.3]\n");
+  fprintf(file_, "#[StartTime: %.3f (seconds since epoch), %s]\n",
+          start_time_ms / 1000.0, date);
+  fprintf(file_, "\"StartTimestamp\",\"Interval_Length\",\"Interval_Max\",\"Interval_Compressed_Histogram\"\n");
+  fflush(file_);
+
+  return true;
+}
+
+void HistogramLogWriter::write_interval(const Metrics::Histogram& histogram,
+                                        uint64_t end_time_ms) {
+  if (file_ == NULL) return;
+
+  histogram.take_interval(Metrics::Histogram::INTERVAL_READER_LOG, interval_);
+
+  std::string encoded;
+  if (encode(interval_, &encoded)) {
+    uint64_t end = std::max(end_time_ms, interval_start_time_ms_);
+    fprintf(file_, "%.3f,%.3f,%.3f,%s\n",
+            (interval_start_time_ms_ - start_time_ms_) / 1000.0,
+            (end - interval_start_time_ms_) / 1000.0,
+            // Values are in microseconds, maximums are logged in milliseconds
+            hdr_max(interval_) / 1000.0,
+            encoded.c_str());
+    fflush(file_);
+    interval_start_time_ms_ = end;
+  } else {
+    LOG_ERROR("Unable to encode histogram interval for log '%s'", path_.c_str());
+  }
+
+  hdr_reset(interval_);
+}
+
+bool HistogramLogWriter::encode(hdr_histogram* h, std::string* output) {
+#ifdef CASS_USE_ZLIB
+  // Counts after the last non-zero count aren't encoded
+  int32_t counts_limit = 0;
+  for (int32_t i = h->counts_len - 1; i >= 0; --i) {
+    if (h->counts[i] != 0) {
+      counts_limit = i + 1;
+      break;
+    }
+  }
+
+  std::vector<char> buffer(V2_ENCODING_HEADER_SIZE);
+  for (int32_t i = 0; i < counts_limit;) {
+    int64_t count = h->counts[i++];
+    if (count == 0) {
+      // Runs of zeros are encoded as a negative count of zeros
+      int64_t zeros = 1;
+      while (i < counts_limit && h->counts[i] == 0) {
+        ++zeros;
+        ++i;
+      }
+      count = -zeros;
+    }
+    encode_zig_zag(count, &buffer);
+  }
+
+  char* header = &buffer[0];
+  encode_int32(header, V2_ENCODING_COOKIE);
+  encode_int32(header + 4, static_cast<int32_t>(buffer.size() - V2_ENCODING_HEADER_SIZE));
+  encode_int32(header + 8, h->normalizing_index_offset);
+  encode_int32(header + 12, static_cast<int32_t>(h->significant_figures));
+  encode_int64(header + 16, h->lowest_trackable_value);
+  encode_int64(header + 24, h->highest_trackable_value);
+  encode_double(header + 32, h->conversion_ratio);
+
+  uLongf compressed_size = compressBound(static_cast<uLong>(buffer.size()));
+  std::vector<char> compressed(V2_COMPRESSION_HEADER_SIZE + compressed_size);
+  if (compress(reinterpret_cast<Bytef*>(&compressed[V2_COMPRESSION_HEADER_SIZE]),
+               &compressed_size,
+               reinterpret_cast<const Bytef*>(&buffer[0]),
+               static_cast<uLong>(buffer.size())) != Z_OK) {
+    return false;
+  }
+  encode_int32(&compressed[0], V2_COMPRESSION_COOKIE);
+  encode_int32(&compressed[4], static_cast<int32_t>(compressed_size));
+
+  output->clear();
+  encode_base64(&compressed[0], V2_COMPRESSION_HEADER_SIZE + compressed_size, output);
+  return true;
+#else
+  return false;
+#endif
+}
+
+} // namespace cass
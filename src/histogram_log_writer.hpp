@@ -0,0 +1,68 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_HISTOGRAM_LOG_WRITER_HPP_INCLUDED__
+#define __CASS_HISTOGRAM_LOG_WRITER_HPP_INCLUDED__
+
+#include "macros.hpp"
+#include "metrics.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+namespace cass {
+
+// Writes intervals of a latency histogram to a file using the HdrHistogram
+// log format (version 1.3) so that it can be processed by the HdrHistogram
+// tools (e.g. HistogramLogProcessor). Each interval is written on its own
+// line as a base64 encoded, zlib compressed histogram. Values are recorded
+// in microseconds and the interval maximums are written in milliseconds.
+// This requires zlib (CASS_USE_ZLIB), is_available() is false otherwise.
+class HistogramLogWriter {
+public:
+  HistogramLogWriter(const std::string& path, int significant_figures);
+  ~HistogramLogWriter();
+
+  static bool is_available();
+
+  const std::string& path() const { return path_; }
+
+  // Creates (or truncates) the log file and writes the log header
+  bool open(uint64_t start_time_ms);
+
+  // Writes the values recorded by the histogram since its previous log
+  // interval. The histogram must have the precision used by the writer.
+  void write_interval(const Metrics::Histogram& histogram, uint64_t end_time_ms);
+
+  // Encodes a histogram using the V2 compressed format ("HISTF..." when
+  // base64 encoded)
+  static bool encode(hdr_histogram* h, std::string* output);
+
+private:
+  std::string path_;
+  FILE* file_;
+  hdr_histogram* interval_;
+  uint64_t start_time_ms_;
+  uint64_t interval_start_time_ms_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(HistogramLogWriter);
+};
+
+} // namespace cass
+
+#endif
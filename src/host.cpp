@@ -16,6 +16,8 @@
 
 #include "host.hpp"
 
+#include "metrics.hpp"
+
 namespace cass {
 
 void copy_hosts(const HostMap& from_hosts, CopyOnWriteHostVec& to_hosts) {
@@ -49,6 +51,10 @@ void remove_host(CopyOnWriteHostVec& hosts, const SharedRefPtr<Host>& host) {
   }
 }
 
+Host::~Host() {
+  delete metrics_.load();
+}
+
 void Host::LatencyTracker::update(uint64_t latency_ns) {
   uint64_t now = uv_hrtime();
 
@@ -91,6 +91,8 @@ private:
   int patch_version_;
 };
 
+class HostMetrics;
+
 class Host : public RefCounted<Host> {
 public:
   typedef SharedRefPtr<Host> Ptr;
@@ -115,8 +117,14 @@ public:
       : address_(address)
       , mark_(mark)
       , state_(ADDED)
+      , concurrency_limit_(0)
+      , inflight_request_count_(0)
+      , last_error_time_ns_(0)
+      , metrics_(NULL)
       , address_string_(address.to_string()) { }
 
+  ~Host();
+
   const Address& address() const { return address_; }
   const std::string& address_string() const { return address_string_; }
 
@@ -179,6 +187,50 @@ public:
     }
   }
 
+  // The sum of the adaptive concurrency limits of this host's pools. Pools
+  // only hold a const reference to the host so this is mutable.
+  int concurrency_limit() const {
+    return concurrency_limit_.load(MEMORY_ORDER_RELAXED);
+  }
+
+  void add_concurrency_limit(int delta) const {
+    concurrency_limit_.fetch_add(delta, MEMORY_ORDER_RELAXED);
+  }
+
+  // The number of requests written to this host that haven't completed, summed
+  // over the connections of every IO worker.
+  int inflight_request_count() const {
+    return inflight_request_count_.load(MEMORY_ORDER_RELAXED);
+  }
+
+  void inc_inflight_request_count() const {
+    inflight_request_count_.fetch_add(1, MEMORY_ORDER_RELAXED);
+  }
+
+  void dec_inflight_request_count(int count = 1) const {
+    inflight_request_count_.fetch_sub(count, MEMORY_ORDER_RELAXED);
+  }
+
+  // The time of the most recent load-related error (timeout, overloaded, etc.)
+  // returned by this host, 0 if there hasn't been one.
+  uint64_t last_error_time_ns() const {
+    return last_error_time_ns_.load(MEMORY_ORDER_RELAXED);
+  }
+
+  void set_last_error_time_ns(uint64_t time_ns) const {
+    last_error_time_ns_.store(time_ns, MEMORY_ORDER_RELAXED);
+  }
+
+  // Per-host metrics are created on first use by Metrics::host_metrics()
+  HostMetrics* metrics() const {
+    return metrics_.load(MEMORY_ORDER_ACQUIRE);
+  }
+
+  bool set_metrics(HostMetrics* metrics) const {
+    HostMetrics* expected = NULL;
+    return metrics_.compare_exchange_strong(expected, metrics);
+  }
+
   TimestampedAverage get_current_average() const {
     if (latency_tracker_) {
       return latency_tracker_->get();
@@ -221,6 +273,10 @@ private:
   Address address_;
   bool mark_;
   Atomic<HostState> state_;
+  mutable Atomic<int> concurrency_limit_;
+  mutable Atomic<int> inflight_request_count_;
+  mutable Atomic<uint64_t> last_error_time_ns_;
+  mutable Atomic<HostMetrics*> metrics_;
   std::string address_string_;
   std::string listen_address_;
   VersionNumber cassandra_version_;
@@ -0,0 +1,150 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "host_metrics_iterator.hpp"
+
+#include "external_types.hpp"
+
+#include <map>
+#include <string.h>
+
+extern "C" {
+
+CassError cass_iterator_get_host_metrics(const CassIterator* iterator,
+                                         CassHostMetrics* metrics) {
+  if (iterator->type() != CASS_ITERATOR_TYPE_HOST_METRICS) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+
+  const cass::HostMetricsIterator::Entry& entry
+      = static_cast<const cass::HostMetricsIterator*>(
+          iterator->from())->entry();
+
+  memset(&metrics->address, 0, sizeof(metrics->address));
+  if (entry.has_address) {
+    metrics->address.address_length = entry.address.to_inet(metrics->address.address);
+  }
+  metrics->dc = entry.dc.data();
+  metrics->dc_length = entry.dc.size();
+
+  metrics->requests.min = entry.latencies.min;
+  metrics->requests.max = entry.latencies.max;
+  metrics->requests.mean = entry.latencies.mean;
+  metrics->requests.stddev = entry.latencies.stddev;
+  metrics->requests.median = entry.latencies.median;
+  metrics->requests.percentile_75th = entry.latencies.percentile_75th;
+  metrics->requests.percentile_95th = entry.latencies.percentile_95th;
+  metrics->requests.percentile_98th = entry.latencies.percentile_98th;
+  metrics->requests.percentile_99th = entry.latencies.percentile_99th;
+  metrics->requests.percentile_999th = entry.latencies.percentile_999th;
+
+  metrics->requests.count = entry.requests.count;
+  metrics->requests.mean_rate = entry.requests.mean_rate;
+  metrics->requests.one_minute_rate = entry.requests.one_minute_rate;
+  metrics->requests.five_minute_rate = entry.requests.five_minute_rate;
+  metrics->requests.fifteen_minute_rate = entry.requests.fifteen_minute_rate;
+
+  metrics->errors.count = entry.errors.count;
+  metrics->errors.mean_rate = entry.errors.mean_rate;
+  metrics->errors.one_minute_rate = entry.errors.one_minute_rate;
+  metrics->errors.five_minute_rate = entry.errors.five_minute_rate;
+  metrics->errors.fifteen_minute_rate = entry.errors.fifteen_minute_rate;
+
+  metrics->inflight_requests = entry.inflight_requests > 0 ? entry.inflight_requests : 0;
+
+  return CASS_OK;
+}
+
+} // extern "C"
+
+namespace cass {
+
+void HostMetricsIterator::Rates::add(const Metrics::Meter& meter) {
+  count += meter.count();
+  mean_rate += meter.mean_rate();
+  one_minute_rate += meter.one_minute_rate();
+  five_minute_rate += meter.five_minute_rate();
+  fifteen_minute_rate += meter.fifteen_minute_rate();
+}
+
+HostMetricsIterator::HostMetricsIterator(const HostVec& hosts, bool aggregate_by_dc)
+  : Iterator(CASS_ITERATOR_TYPE_HOST_METRICS)
+  , index_(0) {
+  if (aggregate_by_dc) {
+    add_dcs(hosts);
+  } else {
+    add_hosts(hosts);
+  }
+}
+
+bool HostMetricsIterator::next() {
+  if (index_ >= entries_.size()) return false;
+  ++index_;
+  return true;
+}
+
+void HostMetricsIterator::add_hosts(const HostVec& hosts) {
+  for (HostVec::const_iterator it = hosts.begin(),
+       end = hosts.end(); it != end; ++it) {
+    const HostMetrics* metrics = (*it)->metrics();
+    if (metrics == NULL) continue; // The host hasn't been used
+
+    Entry entry;
+    entry.address = (*it)->address();
+    entry.has_address = true;
+    entry.dc = (*it)->dc();
+    metrics->request_latencies.get_snapshot(&entry.latencies);
+    entry.requests.add(metrics->request_rates);
+    entry.errors.add(metrics->error_rates);
+    entry.inflight_requests = (*it)->inflight_request_count();
+    entries_.push_back(entry);
+  }
+}
+
+void HostMetricsIterator::add_dcs(const HostVec& hosts) {
+  typedef std::map<std::string, std::pair<Entry, hdr_histogram*> > DcMap;
+  DcMap dcs;
+
+  for (HostVec::const_iterator it = hosts.begin(),
+       end = hosts.end(); it != end; ++it) {
+    const HostMetrics* metrics = (*it)->metrics();
+    if (metrics == NULL) continue; // The host hasn't been used
+
+    DcMap::iterator dc = dcs.find((*it)->dc());
+    if (dc == dcs.end()) {
+      hdr_histogram* histogram = NULL;
+      hdr_init(1LL, Metrics::Histogram::HIGHEST_TRACKABLE_VALUE,
+               metrics->request_latencies.significant_figures(), &histogram);
+      dc = dcs.insert(DcMap::value_type((*it)->dc(),
+                                        std::make_pair(Entry(), histogram))).first;
+      dc->second.first.dc = (*it)->dc();
+    }
+
+    Entry& entry = dc->second.first;
+    metrics->request_latencies.add_to(dc->second.second);
+    entry.requests.add(metrics->request_rates);
+    entry.errors.add(metrics->error_rates);
+    entry.inflight_requests += (*it)->inflight_request_count();
+  }
+
+  for (DcMap::iterator it = dcs.begin(), end = dcs.end(); it != end; ++it) {
+    Metrics::Histogram::get_snapshot(it->second.second, &it->second.first.latencies);
+    free(it->second.second);
+    entries_.push_back(it->second.first);
+  }
+}
+
+} // namespace cass
@@ -0,0 +1,84 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_HOST_METRICS_ITERATOR_HPP_INCLUDED__
+#define __CASS_HOST_METRICS_ITERATOR_HPP_INCLUDED__
+
+#include "address.hpp"
+#include "host.hpp"
+#include "iterator.hpp"
+#include "metrics.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cass {
+
+// Iterates over a snapshot of the metrics of each host, or of each data
+// center when the hosts' metrics are aggregated. The snapshot is taken when
+// the iterator is created.
+class HostMetricsIterator : public Iterator {
+public:
+  struct Rates {
+    Rates()
+      : count(0)
+      , mean_rate(0.0)
+      , one_minute_rate(0.0)
+      , five_minute_rate(0.0)
+      , fifteen_minute_rate(0.0) {}
+
+    void add(const Metrics::Meter& meter);
+
+    uint64_t count;
+    double mean_rate;
+    double one_minute_rate;
+    double five_minute_rate;
+    double fifteen_minute_rate;
+  };
+
+  struct Entry {
+    Entry()
+      : has_address(false)
+      , inflight_requests(0) {}
+
+    Address address;
+    bool has_address;
+    std::string dc;
+    Metrics::Histogram::Snapshot latencies;
+    Rates requests;
+    Rates errors;
+    int inflight_requests;
+  };
+
+  typedef std::vector<Entry> EntryVec;
+
+  HostMetricsIterator(const HostVec& hosts, bool aggregate_by_dc);
+
+  virtual bool next();
+
+  const Entry& entry() const { return entries_[index_ - 1]; }
+
+private:
+  void add_hosts(const HostVec& hosts);
+  void add_dcs(const HostVec& hosts);
+
+  EntryVec entries_;
+  size_t index_; // One past the current entry, 0 before the first call to next()
+};
+
+} // namespace cass
+
+#endif
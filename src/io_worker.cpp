@@ -52,6 +52,9 @@ int IOWorker::init() {
   if (rc != 0) return rc;
   rc = uv_prepare_start(&prepare_, on_prepare);
   if (rc != 0) return rc;
+  if (config_.event_loop_metrics_interval_ms() > 0) {
+    rc = loop_monitor_.init(loop(), config_.event_loop_metrics_interval_ms());
+  }
   return rc;
 }
 
@@ -70,11 +73,20 @@ bool IOWorker::is_host_up(const Address& address) const {
 }
 
 void IOWorker::set_host_is_available(const Address& address, bool is_available) {
-  ScopedMutex lock(&unavailable_addresses_mutex_);
-  if (is_available) {
-    unavailable_addresses_.erase(address);
-  } else {
-    unavailable_addresses_.insert(address);
+  bool is_newly_available = false;
+  { // Lock unavailable addresses
+    ScopedMutex lock(&unavailable_addresses_mutex_);
+    if (is_available) {
+      is_newly_available = unavailable_addresses_.erase(address) > 0;
+    } else {
+      unavailable_addresses_.insert(address);
+    }
+  }
+
+  // A host's pool dropped below its pending requests low water mark, let the
+  // session know in case producers are waiting for capacity.
+  if (is_newly_available && session_->is_capacity_exhausted()) {
+    session_->notify_capacity_available_async();
   }
 }
 
@@ -120,7 +132,7 @@ void IOWorker::add_pool(const Host::ConstPtr& host, bool is_initial_connection)
 
     SharedRefPtr<Pool> pool(new Pool(this, host, is_initial_connection));
     pools_[address] = pool;
-    pool->connect();
+    connect_pool(pool);
   } else  {
     // We could have a connection that's waiting to reconnect. In that case,
     // this will start to connect immediately.
@@ -131,7 +143,39 @@ void IOWorker::add_pool(const Host::ConstPtr& host, bool is_initial_connection)
   }
 }
 
+void IOWorker::connect_pool(const SharedRefPtr<Pool>& pool) {
+  unsigned fanout = config_.startup_pool_fanout();
+  if (fanout > 0 && pool->is_initial_connection()) {
+    if (pools_connecting_.size() >= fanout) {
+      LOG_DEBUG("Delaying connection of pool(%p) for host %s until a connecting pool is ready",
+                static_cast<void*>(pool.get()),
+                pool->host()->address_string().c_str());
+      pools_waiting_to_connect_.push_back(pool);
+      return;
+    }
+    pools_connecting_.insert(pool.get());
+  }
+  pool->connect();
+}
+
+void IOWorker::maybe_connect_waiting_pools() {
+  unsigned fanout = config_.startup_pool_fanout();
+  while (!pools_waiting_to_connect_.empty() &&
+         pools_connecting_.size() < fanout) {
+    SharedRefPtr<Pool> pool(pools_waiting_to_connect_.front());
+    pools_waiting_to_connect_.pop_front();
+    // The pool could have been closed or connected by a later add pool event
+    if (pool->is_new()) {
+      pools_connecting_.insert(pool.get());
+      pool->connect();
+    }
+  }
+}
+
 bool IOWorker::execute(RequestHandler* request_handler) {
+  if (loop_monitor_.is_enabled()) {
+    request_handler->set_enqueue_time_ns(uv_hrtime());
+  }
   return request_queue_.enqueue(request_handler);
 }
 
@@ -169,6 +213,10 @@ void IOWorker::request_finished(RequestHandler* request_handler) {
 }
 
 void IOWorker::notify_pool_ready(Pool* pool) {
+  if (pools_connecting_.erase(pool) > 0) {
+    maybe_connect_waiting_pools();
+  }
+
   if (pool->is_initial_connection()) {
     if (pool->is_keyspace_error()) {
       session_->notify_keyspace_error_async();
@@ -239,6 +287,7 @@ void IOWorker::maybe_notify_closed() {
 void IOWorker::close_handles() {
   EventThread<IOWorkerEvent>::close_handles();
   request_queue_.close_handles();
+  loop_monitor_.close_handles();
   uv_prepare_stop(&prepare_);
   uv_close(copy_cast<uv_prepare_t*, uv_handle_t*>(&prepare_), NULL);
 }
@@ -281,8 +330,10 @@ void IOWorker::on_execute(uv_async_t* async) {
   size_t remaining = io_worker->config().max_requests_per_flush();
   while (remaining != 0 && io_worker->request_queue_.dequeue(request_handler)) {
     if (request_handler != NULL) {
+      io_worker->loop_monitor_.record_request_queue_time(request_handler->enqueue_time_ns());
       io_worker->pending_request_count_++;
       request_handler->set_io_worker(io_worker);
+      request_handler->record_stage(LatencyBreakdown::STAGE_IO_WORKER_DEQUEUED);
       request_handler->retry();
     } else {
       io_worker->state_ = IO_WORKER_STATE_CLOSING;
@@ -290,6 +341,11 @@ void IOWorker::on_execute(uv_async_t* async) {
     remaining--;
   }
 
+  if (io_worker->session_->is_capacity_exhausted() &&
+      io_worker->request_queue_.size() < io_worker->request_queue_.capacity() / 2) {
+    io_worker->session_->notify_capacity_available_async();
+  }
+
   io_worker->maybe_close();
 }
 
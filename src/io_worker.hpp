@@ -25,11 +25,14 @@
 #include "event_thread.hpp"
 #include "host.hpp"
 #include "logger.hpp"
+#include "loop_monitor.hpp"
 #include "metrics.hpp"
 #include "spsc_queue.hpp"
 #include "timer.hpp"
 
+#include <deque>
 #include <map>
+#include <set>
 #include <string>
 #include <uv.h>
 
@@ -80,6 +83,9 @@ public:
 
   const Config& config() const { return config_; }
   Metrics* metrics() const { return metrics_; }
+  const LoopMonitor& loop_monitor() const { return loop_monitor_; }
+
+  size_t request_queue_size() const { return request_queue_.size(); }
 
   int protocol_version() const {
     return protocol_version_.load();
@@ -113,6 +119,8 @@ public:
 
 private:
   void add_pool(const Host::ConstPtr& host, bool is_initial_connection);
+  void connect_pool(const SharedRefPtr<Pool>& pool);
+  void maybe_connect_waiting_pools();
   void maybe_close();
   void maybe_notify_closed();
   void close_handles();
@@ -132,6 +140,8 @@ private:
 private:
   typedef std::map<Address, SharedRefPtr<Pool> > PoolMap;
   typedef std::vector<SharedRefPtr<Pool> > PoolVec;
+  typedef std::deque<SharedRefPtr<Pool> > PoolDeque;
+  typedef std::set<Pool*> PoolSet;
 
   void schedule_reconnect(const Host::ConstPtr& host);
 
@@ -150,10 +160,15 @@ private:
 
   PoolMap pools_;
   PoolVec pools_pending_flush_;
+  // Initial pools counted against the startup fan-out and the pools waiting
+  // for one of them to finish connecting
+  PoolSet pools_connecting_;
+  PoolDeque pools_waiting_to_connect_;
   bool is_closing_;
   int pending_request_count_;
 
   AsyncQueue<SPSCQueue<RequestHandler*> > request_queue_;
+  LoopMonitor loop_monitor_;
 };
 
 } // namespace cass
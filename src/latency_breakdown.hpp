@@ -0,0 +1,122 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_LATENCY_BREAKDOWN_HPP_INCLUDED__
+#define __CASS_LATENCY_BREAKDOWN_HPP_INCLUDED__
+
+#include "cassandra.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace cass {
+
+// The times a request reached each stage of its execution. Phases are the
+// time between two stages. The queue phases are recorded once per request;
+// when a request is retried the pool pending phase runs from the I/O worker
+// dequeue to the last attempt's write and the later phases describe the
+// last attempt.
+class LatencyBreakdown {
+public:
+  enum Stage {
+    STAGE_CREATED,
+    STAGE_SESSION_DEQUEUED,
+    STAGE_IO_WORKER_DEQUEUED,
+    STAGE_WRITE_STARTED,
+    STAGE_WRITE_FINISHED,
+    STAGE_RESPONSE_RECEIVED,
+    STAGE_FINISHED,
+    STAGE_COUNT
+  };
+
+  enum Phase {
+    PHASE_SESSION_QUEUE,    // Created -> session dequeued
+    PHASE_IO_WORKER_QUEUE,  // Session dequeued -> IO worker dequeued
+    PHASE_POOL_PENDING,     // IO worker dequeued -> write started
+    PHASE_WRITE,            // Write started -> write finished
+    PHASE_SERVER,           // Write finished -> response received
+    PHASE_DECODE,           // Response received -> finished
+    PHASE_COUNT
+  };
+
+  LatencyBreakdown() {
+    memset(times_ns_, 0, sizeof(times_ns_));
+  }
+
+  // Clears the later stages so that a retried request doesn't mix the
+  // stages of different attempts
+  void record(Stage stage, uint64_t time_ns) {
+    times_ns_[stage] = time_ns;
+    clear_after(stage);
+  }
+
+  void clear_after(Stage stage) {
+    for (int i = stage + 1; i < STAGE_COUNT; ++i) {
+      times_ns_[i] = 0;
+    }
+  }
+
+  uint64_t time_ns(Stage stage) const { return times_ns_[stage]; }
+
+  bool is_phase_reached(Phase phase) const {
+    Stage from, to;
+    phase_stages(phase, &from, &to);
+    return times_ns_[from] != 0 && times_ns_[to] >= times_ns_[from];
+  }
+
+  // Returns 0 if either of the phase's stages wasn't reached
+  uint64_t phase_ns(Phase phase) const {
+    Stage from, to;
+    phase_stages(phase, &from, &to);
+    return elapsed_ns(from, to);
+  }
+
+  uint64_t total_ns() const {
+    return elapsed_ns(STAGE_CREATED, STAGE_FINISHED);
+  }
+
+  // Converts the phases to microseconds
+  void to_cass(CassLatencyBreakdown* output) const {
+    output->session_queue = phase_ns(PHASE_SESSION_QUEUE) / 1000;
+    output->io_worker_queue = phase_ns(PHASE_IO_WORKER_QUEUE) / 1000;
+    output->pool_pending = phase_ns(PHASE_POOL_PENDING) / 1000;
+    output->write = phase_ns(PHASE_WRITE) / 1000;
+    output->server = phase_ns(PHASE_SERVER) / 1000;
+    output->decode = phase_ns(PHASE_DECODE) / 1000;
+    output->total = total_ns() / 1000;
+  }
+
+private:
+  void phase_stages(Phase phase, Stage* from, Stage* to) const {
+    *from = static_cast<Stage>(phase);
+    *to = static_cast<Stage>(phase + 1);
+    if (phase == PHASE_SERVER && times_ns_[STAGE_WRITE_FINISHED] == 0) {
+      // The response can arrive before the write callback runs
+      *from = STAGE_WRITE_STARTED;
+    }
+  }
+
+  uint64_t elapsed_ns(Stage from, Stage to) const {
+    if (times_ns_[from] == 0 || times_ns_[to] < times_ns_[from]) return 0;
+    return times_ns_[to] - times_ns_[from];
+  }
+
+  uint64_t times_ns_[STAGE_COUNT];
+};
+
+} // namespace cass
+
+#endif
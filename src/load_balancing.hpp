@@ -63,6 +63,10 @@ public:
   virtual ~QueryPlan() {}
   virtual SharedRefPtr<Host> compute_next() = 0;
 
+  // The replicas that are tried first by a token-aware plan or NULL if the
+  // plan isn't routed using the request's replicas
+  virtual const CopyOnWriteHostVec* replicas() const { return NULL; }
+
   bool compute_next(Address* address) {
     SharedRefPtr<Host> host = compute_next();
     if (host) {
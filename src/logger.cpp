@@ -16,10 +16,16 @@
 
 #include "logger.hpp"
 
+#include "async_queue.hpp"
+#include "atomic.hpp"
+#include "loop_thread.hpp"
+#include "mpmc_queue.hpp"
+#include "scoped_ptr.hpp"
+
 extern "C" {
 
 void cass_log_cleanup() {
-  // Deprecated
+  cass::Logger::cleanup();
 }
 
 void cass_log_set_level(CassLogLevel log_level) {
@@ -32,7 +38,11 @@ void cass_log_set_callback(CassLogCallback callback,
 }
 
 void cass_log_set_queue_size(size_t queue_size) {
-  // Deprecated
+  cass::Logger::set_queue_size(queue_size);
+}
+
+cass_uint64_t cass_log_get_dropped_count() {
+  return cass::Logger::dropped_count();
 }
 
 } // extern "C"
@@ -50,20 +60,120 @@ void stderr_log_callback(const CassLogMessage* message, void* data) {
 
 void noop_log_callback(const CassLogMessage* message, void* data) { }
 
+static Atomic<uint64_t> dropped_count_(0);
+
+// Calls the logging callback on a dedicated thread so that slow callbacks
+// (e.g. writing to disk) don't block the session and IO worker threads.
+// Messages are formatted by the thread that logs them because their
+// arguments aren't guaranteed to outlive the call. If the queue is full the
+// message is dropped and counted.
+class LogThread : public LoopThread {
+public:
+  LogThread(size_t queue_size)
+    : log_queue_(queue_size)
+    , reported_dropped_count_(dropped_count_.load())
+    , is_closing_(false) {}
+
+  int init() {
+    int rc = LoopThread::init();
+    if (rc != 0) return rc;
+    return log_queue_.init(loop(), this, on_log);
+  }
+
+  bool is_full() const {
+    return log_queue_.size() >= log_queue_.capacity();
+  }
+
+  void log(const CassLogMessage& message) {
+    if (!log_queue_.enqueue(message)) {
+      dropped_count_.fetch_add(1);
+    }
+  }
+
+  // Flushes the queued messages and waits for the thread to exit
+  void close() {
+    CassLogMessage message = { 0, CASS_LOG_DISABLED, "", 0, "", "" };
+    while (!log_queue_.enqueue(message)) {
+      // Keep trying
+    }
+    join();
+  }
+
+private:
+#if UV_VERSION_MAJOR == 0
+  static void on_log(uv_async_t* async, int status) {
+#else
+  static void on_log(uv_async_t* async) {
+#endif
+    LogThread* log_thread = static_cast<LogThread*>(async->data);
+
+    CassLogMessage message;
+    while (log_thread->log_queue_.dequeue(message)) {
+      if (message.severity == CASS_LOG_DISABLED) {
+        log_thread->is_closing_ = true;
+      } else {
+        Logger::cb_(&message, Logger::data_);
+      }
+    }
+
+    log_thread->report_dropped();
+
+    if (log_thread->is_closing_) {
+      log_thread->log_queue_.close_handles();
+      log_thread->close_handles();
+    }
+  }
+
+  void report_dropped() {
+    uint64_t dropped_count = dropped_count_.load();
+    if (dropped_count == reported_dropped_count_) return;
+
+    if (CASS_LOG_WARN <= Logger::log_level()) {
+      CassLogMessage message = {
+        get_time_since_epoch_ms(), CASS_LOG_WARN,
+        LOG_FILE_, __LINE__, LOG_FUNCTION_,
+        ""
+      };
+      snprintf(message.message, sizeof(message.message),
+               "Dropped %llu log message(s) because the log queue was full",
+               static_cast<unsigned long long>(dropped_count - reported_dropped_count_));
+      Logger::cb_(&message, Logger::data_);
+    }
+    reported_dropped_count_ = dropped_count;
+  }
+
+private:
+  AsyncQueue<MPMCQueue<CassLogMessage> > log_queue_;
+  uint64_t reported_dropped_count_;
+  bool is_closing_;
+};
+
 CassLogLevel Logger::log_level_ = CASS_LOG_WARN;
 CassLogCallback Logger::cb_ = stderr_log_callback;
 void* Logger::data_ = NULL;
+LogThread* Logger::log_thread_ = NULL;
 
 void Logger::log(CassLogLevel severity,
                  const char* file, int line, const char* function,
                  const char* format, va_list args) {
+  if (log_thread_ != NULL && log_thread_->is_full()) {
+    // Avoid formatting messages that would be dropped
+    dropped_count_.fetch_add(1);
+    return;
+  }
+
   CassLogMessage message = {
     get_time_since_epoch_ms(), severity,
     file, line, function,
     ""
   };
   vsnprintf(message.message, sizeof(message.message), format, args);
-  Logger::cb_(&message, Logger::data_);
+
+  if (log_thread_ != NULL) {
+    log_thread_->log(message);
+  } else {
+    Logger::cb_(&message, Logger::data_);
+  }
 }
 
 void Logger::set_log_level(CassLogLevel log_level) {
@@ -75,4 +185,30 @@ void Logger::set_callback(CassLogCallback cb, void* data) {
   data_ = data;
 }
 
+void Logger::set_queue_size(size_t queue_size) {
+  cleanup();
+  if (queue_size == 0) return;
+
+  ScopedPtr<LogThread> log_thread(new LogThread(queue_size));
+  if (log_thread->init() != 0 || log_thread->run() != 0) {
+    fprintf(stderr, "Unable to start the logging thread, "
+                    "messages will be logged synchronously\n");
+    return;
+  }
+  log_thread_ = log_thread.release();
+}
+
+void Logger::cleanup() {
+  if (log_thread_ != NULL) {
+    LogThread* log_thread = log_thread_;
+    log_thread_ = NULL;
+    log_thread->close();
+    delete log_thread;
+  }
+}
+
+uint64_t Logger::dropped_count() {
+  return dropped_count_.load();
+}
+
 } // namespace cass
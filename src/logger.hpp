@@ -17,6 +17,7 @@
 #ifndef __CASS_LOGGER_HPP_INCLUDED__
 #define __CASS_LOGGER_HPP_INCLUDED__
 
+#include "atomic.hpp"
 #include "cassandra.h"
 #include "get_time.hpp"
 
@@ -26,11 +27,20 @@
 
 namespace cass {
 
+class LogThread;
+
 class Logger {
 public:
   static void set_log_level(CassLogLevel level);
   static void set_callback(CassLogCallback cb, void* data);
 
+  // A non-zero queue size starts a thread that calls the callback, zero
+  // flushes the queue and stops the thread
+  static void set_queue_size(size_t queue_size);
+  static void cleanup();
+
+  static uint64_t dropped_count();
+
 #if defined(__GNUC__) || defined(__clang__)
 #define ATTR_FORMAT(string, first) __attribute__((__format__(__printf__, string, first)))
 #else
@@ -56,13 +66,52 @@ private:
                   const char* format, va_list args);
 
 private:
+  friend class LogThread;
+
   static CassLogLevel log_level_;
   static CassLogCallback cb_;
   static void* data_;
+  static LogThread* log_thread_;
 
   Logger(); // Keep this object from being created
 };
 
+// Limits the number of messages logged by a call site to at most "max_count"
+// messages per interval. The LOG_*_RATELIMITED() macros use a function-local
+// static instance whose initialization is guarded by the compiler, so its
+// first use is safe from multiple threads. Where static initialization isn't
+// thread-safe (MSVC before 2015) a racing initialization only resets the
+// counters, which at worst lets a few extra messages through.
+class LogRateLimiter {
+public:
+  LogRateLimiter()
+    : window_start_ms_(0)
+    , count_(0)
+    , suppressed_(0) { }
+
+  // Returns true if the message should be logged. "suppressed" is set to the
+  // number of messages that were suppressed since the last logged message.
+  bool allow(uint64_t interval_ms, int max_count, uint64_t* suppressed) {
+    uint64_t now = uv_hrtime() / (1000 * 1000);
+    uint64_t window_start = window_start_ms_.load(MEMORY_ORDER_RELAXED);
+    if (now - window_start >= interval_ms &&
+        window_start_ms_.compare_exchange_strong(window_start, now)) {
+      count_.store(0, MEMORY_ORDER_RELAXED);
+    }
+    if (count_.fetch_add(1, MEMORY_ORDER_RELAXED) < max_count) {
+      *suppressed = suppressed_.exchange(0, MEMORY_ORDER_RELAXED);
+      return true;
+    }
+    suppressed_.fetch_add(1, MEMORY_ORDER_RELAXED);
+    return false;
+  }
+
+private:
+  Atomic<uint64_t> window_start_ms_;
+  Atomic<int> count_;
+  Atomic<uint64_t> suppressed_;
+};
+
 } // namespace cass
 
 // These macros allow the LOG_<level>() methods to accept one or more
@@ -110,11 +159,95 @@ private:
   }                                                               \
 } while(0)
 
+// Logs at most "max_count" messages every "interval_ms" milliseconds from
+// the call site. The number of suppressed messages is logged before the
+// next message that's allowed.
+#define LOG_CHECK_LEVEL_RATELIMITED(severity, interval_ms, max_count, ...) do { \
+  if (severity <= Logger::log_level()) {                                      \
+    static LogRateLimiter log_rate_limiter__;                                  \
+    uint64_t log_suppressed__;                                                \
+    if (log_rate_limiter__.allow(interval_ms, max_count, &log_suppressed__)) { \
+      if (log_suppressed__ > 0) {                                             \
+        Logger::log(severity,                                                 \
+                    LOG_FILE_, __LINE__, LOG_FUNCTION_,                       \
+                    "Suppressed %llu similar message(s)",                     \
+                    static_cast<unsigned long long>(log_suppressed__));       \
+      }                                                                       \
+      Logger::log(severity,                                                   \
+                  LOG_FILE_, __LINE__, LOG_FUNCTION_,                         \
+                  LOG_FIRST_(__VA_ARGS__) LOG_REST_(__VA_ARGS__));            \
+    }                                                                         \
+  }                                                                           \
+} while(0)
+
+// Messages more verbose than CASS_COMPILED_LOG_LEVEL (set using the CMake
+// option of the same name) are removed at compile time. The arguments are
+// still type checked, but the call is never made and the log level isn't
+// checked.
+#ifndef CASS_COMPILED_LOG_LEVEL
+#define CASS_COMPILED_LOG_LEVEL 6 // CASS_LOG_TRACE
+#endif
+
+#define LOG_COMPILED_OUT_(...) do {                                \
+  if (false) {                                                    \
+    Logger::log(CASS_LOG_DISABLED,                                \
+                 LOG_FILE_, __LINE__, LOG_FUNCTION_,              \
+                 LOG_FIRST_(__VA_ARGS__) LOG_REST_(__VA_ARGS__)); \
+  }                                                               \
+} while(0)
+
+#if CASS_COMPILED_LOG_LEVEL >= 1
 #define LOG_CRITICAL(...) LOG_CHECK_LEVEL(CASS_LOG_CRITICAL, __VA_ARGS__)
+#define LOG_CRITICAL_RATELIMITED(interval_ms, max_count, ...) \
+  LOG_CHECK_LEVEL_RATELIMITED(CASS_LOG_CRITICAL, interval_ms, max_count, __VA_ARGS__)
+#else
+#define LOG_CRITICAL(...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#define LOG_CRITICAL_RATELIMITED(interval_ms, max_count, ...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#endif
+
+#if CASS_COMPILED_LOG_LEVEL >= 2
 #define LOG_ERROR(...) LOG_CHECK_LEVEL(CASS_LOG_ERROR, __VA_ARGS__)
+#define LOG_ERROR_RATELIMITED(interval_ms, max_count, ...) \
+  LOG_CHECK_LEVEL_RATELIMITED(CASS_LOG_ERROR, interval_ms, max_count, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#define LOG_ERROR_RATELIMITED(interval_ms, max_count, ...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#endif
+
+#if CASS_COMPILED_LOG_LEVEL >= 3
 #define LOG_WARN(...) LOG_CHECK_LEVEL(CASS_LOG_WARN, __VA_ARGS__)
+#define LOG_WARN_RATELIMITED(interval_ms, max_count, ...) \
+  LOG_CHECK_LEVEL_RATELIMITED(CASS_LOG_WARN, interval_ms, max_count, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#define LOG_WARN_RATELIMITED(interval_ms, max_count, ...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#endif
+
+#if CASS_COMPILED_LOG_LEVEL >= 4
 #define LOG_INFO(...) LOG_CHECK_LEVEL(CASS_LOG_INFO, __VA_ARGS__)
+#define LOG_INFO_RATELIMITED(interval_ms, max_count, ...) \
+  LOG_CHECK_LEVEL_RATELIMITED(CASS_LOG_INFO, interval_ms, max_count, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#define LOG_INFO_RATELIMITED(interval_ms, max_count, ...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#endif
+
+#if CASS_COMPILED_LOG_LEVEL >= 5
 #define LOG_DEBUG(...) LOG_CHECK_LEVEL(CASS_LOG_DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_RATELIMITED(interval_ms, max_count, ...) \
+  LOG_CHECK_LEVEL_RATELIMITED(CASS_LOG_DEBUG, interval_ms, max_count, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#define LOG_DEBUG_RATELIMITED(interval_ms, max_count, ...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#endif
+
+#if CASS_COMPILED_LOG_LEVEL >= 6
 #define LOG_TRACE(...) LOG_CHECK_LEVEL(CASS_LOG_TRACE, __VA_ARGS__)
+#define LOG_TRACE_RATELIMITED(interval_ms, max_count, ...) \
+  LOG_CHECK_LEVEL_RATELIMITED(CASS_LOG_TRACE, interval_ms, max_count, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#define LOG_TRACE_RATELIMITED(interval_ms, max_count, ...) LOG_COMPILED_OUT_(__VA_ARGS__)
+#endif
 
 #endif
@@ -0,0 +1,180 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "loop_monitor.hpp"
+
+#include "scoped_lock.hpp"
+#include "utils.hpp"
+
+#if defined(UV_VERSION_HEX) && UV_VERSION_HEX >= 0x012700
+#define CASS_HAS_UV_METRICS_IDLE_TIME
+#endif
+
+// Loop measurements are much shorter than request latencies
+#define HIGHEST_TRACKABLE_VALUE (60LL * 1000LL * 1000LL) // 1 minute in microseconds
+#define SIGNIFICANT_FIGURES 2
+
+namespace cass {
+
+LoopMonitor::Histogram::Histogram() {
+  hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, SIGNIFICANT_FIGURES, &recording);
+  hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, SIGNIFICANT_FIGURES, &published);
+}
+
+LoopMonitor::Histogram::~Histogram() {
+  free(recording);
+  free(published);
+}
+
+void LoopMonitor::Histogram::publish() {
+  hdr_add(published, recording);
+  hdr_reset(recording);
+}
+
+LoopMonitor::LoopMonitor()
+  : loop_(NULL)
+  , sample_interval_ns_(0)
+  , sample_start_ns_(0)
+  , sample_busy_ns_(0)
+  , last_prepare_ns_(0)
+  , last_check_ns_(0)
+  , last_idle_ns_(0)
+  , utilization_(0.0) {
+  prepare_.data = this;
+  check_.data = this;
+  uv_mutex_init(&mutex_);
+}
+
+LoopMonitor::~LoopMonitor() {
+  uv_mutex_destroy(&mutex_);
+}
+
+int LoopMonitor::init(uv_loop_t* loop, uint64_t sample_interval_ms) {
+  int rc = 0;
+#ifdef CASS_HAS_UV_METRICS_IDLE_TIME
+  rc = uv_loop_configure(loop, UV_METRICS_IDLE_TIME);
+  if (rc != 0) return rc;
+#endif
+  rc = uv_prepare_init(loop, &prepare_);
+  if (rc != 0) return rc;
+  rc = uv_prepare_start(&prepare_, on_prepare);
+  if (rc != 0) return rc;
+  rc = uv_check_init(loop, &check_);
+  if (rc != 0) return rc;
+  rc = uv_check_start(&check_, on_check);
+  if (rc != 0) return rc;
+
+  loop_ = loop;
+  sample_interval_ns_ = sample_interval_ms * 1000 * 1000;
+  sample_start_ns_ = uv_hrtime();
+  timer_.start(loop, sample_interval_ms, this, on_sample);
+  return 0;
+}
+
+void LoopMonitor::close_handles() {
+  if (loop_ == NULL) return;
+  timer_.stop();
+  uv_prepare_stop(&prepare_);
+  uv_close(copy_cast<uv_prepare_t*, uv_handle_t*>(&prepare_), NULL);
+  uv_check_stop(&check_);
+  uv_close(copy_cast<uv_check_t*, uv_handle_t*>(&check_), NULL);
+}
+
+void LoopMonitor::get_snapshot(Snapshot* snapshot) const {
+  ScopedMutex l(&mutex_);
+  Metrics::Histogram::get_snapshot(lag_.published, &snapshot->lag);
+  Metrics::Histogram::get_snapshot(iteration_time_.published, &snapshot->iteration_time);
+  Metrics::Histogram::get_snapshot(request_queue_time_.published, &snapshot->request_queue_time);
+  snapshot->utilization = utilization_.load();
+}
+
+void LoopMonitor::on_sample() {
+  uint64_t now = uv_hrtime();
+  uint64_t expected = sample_start_ns_ + sample_interval_ns_;
+  if (now > expected) {
+    // Measurements are in microseconds
+    hdr_record_value(lag_.recording, static_cast<int64_t>((now - expected) / 1000));
+  }
+
+  if (now > sample_start_ns_) {
+    double utilization = static_cast<double>(sample_busy_ns_) / (now - sample_start_ns_);
+    utilization_.store(utilization > 1.0 ? 1.0 : utilization);
+  }
+  sample_busy_ns_ = 0;
+  sample_start_ns_ = now;
+
+  { // Lock published histograms
+    ScopedMutex l(&mutex_);
+    lag_.publish();
+    iteration_time_.publish();
+    request_queue_time_.publish();
+  }
+
+  timer_.start(loop_, sample_interval_ns_ / (1000 * 1000), this, on_sample);
+}
+
+void LoopMonitor::on_sample(Timer* timer) {
+  static_cast<LoopMonitor*>(timer->data())->on_sample();
+}
+
+#if UV_VERSION_MAJOR == 0
+void LoopMonitor::on_prepare(uv_prepare_t* prepare, int status) {
+#else
+void LoopMonitor::on_prepare(uv_prepare_t* prepare) {
+#endif
+  LoopMonitor* monitor = static_cast<LoopMonitor*>(prepare->data);
+  uint64_t now = uv_hrtime();
+
+  if (monitor->last_prepare_ns_ > 0) {
+    uint64_t busy;
+#ifdef CASS_HAS_UV_METRICS_IDLE_TIME
+    uint64_t idle = monitor->idle_time_ns();
+    uint64_t elapsed = now - monitor->last_prepare_ns_;
+    uint64_t idle_elapsed = idle - monitor->last_idle_ns_;
+    busy = elapsed > idle_elapsed ? elapsed - idle_elapsed : 0;
+    monitor->last_idle_ns_ = idle;
+#else
+    busy = monitor->last_check_ns_ > 0 ? now - monitor->last_check_ns_ : 0;
+#endif
+    monitor->sample_busy_ns_ += busy;
+    // Measurements are in microseconds
+    hdr_record_value(monitor->iteration_time_.recording,
+                     static_cast<int64_t>(busy / 1000));
+  } else {
+    monitor->last_idle_ns_ = monitor->idle_time_ns();
+  }
+
+  monitor->last_prepare_ns_ = now;
+}
+
+#if UV_VERSION_MAJOR == 0
+void LoopMonitor::on_check(uv_check_t* check, int status) {
+#else
+void LoopMonitor::on_check(uv_check_t* check) {
+#endif
+  LoopMonitor* monitor = static_cast<LoopMonitor*>(check->data);
+  monitor->last_check_ns_ = uv_hrtime();
+}
+
+uint64_t LoopMonitor::idle_time_ns() const {
+#ifdef CASS_HAS_UV_METRICS_IDLE_TIME
+  return uv_metrics_idle_time(loop_);
+#else
+  return 0;
+#endif
+}
+
+} // namespace cass
@@ -0,0 +1,126 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_LOOP_MONITOR_HPP_INCLUDED__
+#define __CASS_LOOP_MONITOR_HPP_INCLUDED__
+
+#include "atomic.hpp"
+#include "macros.hpp"
+#include "metrics.hpp"
+#include "timer.hpp"
+
+#include "third_party/hdr_histogram/hdr_histogram.hpp"
+
+#include <stdint.h>
+#include <uv.h>
+
+namespace cass {
+
+// Measures the health of an event loop:
+//
+// * Lag: How late a timer that fires every sample interval runs. A loop
+//   that's busy processing callbacks runs its timers late.
+// * Iteration time: The time spent running callbacks (not waiting for I/O)
+//   in each iteration of the loop. This is measured between the loop's
+//   prepare phases, less the time the loop was idle. The idle time is only
+//   known for libuv 1.39+, older versions don't include the I/O callbacks
+//   run during the poll phase.
+// * Utilization: The fraction of the last sample interval spent running
+//   callbacks.
+// * Request queue time: The time requests waited in the loop's request
+//   queue, using the timestamp recorded when they were enqueued.
+//
+// Values are recorded on the loop's thread without synchronization and are
+// published for readers every sample interval.
+class LoopMonitor {
+public:
+  struct Snapshot {
+    Metrics::Histogram::Snapshot lag;
+    Metrics::Histogram::Snapshot iteration_time;
+    Metrics::Histogram::Snapshot request_queue_time;
+    double utilization;
+  };
+
+  LoopMonitor();
+  ~LoopMonitor();
+
+  // Must be called before the loop is run
+  int init(uv_loop_t* loop, uint64_t sample_interval_ms);
+  void close_handles();
+
+  bool is_enabled() const { return loop_ != NULL; }
+
+  // Must be called on the loop's thread
+  void record_request_queue_time(uint64_t enqueue_time_ns) {
+    if (enqueue_time_ns == 0) return;
+    // Measurements are in microseconds
+    hdr_record_value(request_queue_time_.recording,
+                     static_cast<int64_t>((uv_hrtime() - enqueue_time_ns) / 1000));
+  }
+
+  // Gets the values published at the end of the last sample interval
+  void get_snapshot(Snapshot* snapshot) const;
+
+private:
+  // Values are recorded in one histogram by the loop and moved into the
+  // published histogram every sample interval
+  struct Histogram {
+    Histogram();
+    ~Histogram();
+    void publish();
+    hdr_histogram* recording;
+    hdr_histogram* published;
+  };
+
+  void on_sample();
+  static void on_sample(Timer* timer);
+
+#if UV_VERSION_MAJOR == 0
+  static void on_prepare(uv_prepare_t* prepare, int status);
+  static void on_check(uv_check_t* check, int status);
+#else
+  static void on_prepare(uv_prepare_t* prepare);
+  static void on_check(uv_check_t* check);
+#endif
+
+  uint64_t idle_time_ns() const;
+
+private:
+  uv_loop_t* loop_;
+  uint64_t sample_interval_ns_;
+  uv_prepare_t prepare_;
+  uv_check_t check_;
+  Timer timer_;
+
+  uint64_t sample_start_ns_;
+  uint64_t sample_busy_ns_;
+  uint64_t last_prepare_ns_;
+  uint64_t last_check_ns_;
+  uint64_t last_idle_ns_;
+
+  Histogram lag_;
+  Histogram iteration_time_;
+  Histogram request_queue_time_;
+  Atomic<double> utilization_;
+  mutable uv_mutex_t mutex_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(LoopMonitor);
+};
+
+} // namespace cass
+
+#endif
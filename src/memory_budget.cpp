@@ -0,0 +1,107 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "memory_budget.hpp"
+
+#include "scoped_lock.hpp"
+
+#include <uv.h>
+
+extern "C" {
+
+void cass_memory_set_limit(cass_uint64_t limit_bytes,
+                           CassMemoryLimitMode mode) {
+  cass::MemoryBudget::set_limit(limit_bytes, mode);
+}
+
+void cass_memory_get_metrics(CassMemoryMetrics* metrics) {
+  metrics->request_encodings = cass::MemoryBudget::bytes(cass::MemoryBudget::REQUEST_ENCODING);
+  metrics->read_buffers = cass::MemoryBudget::bytes(cass::MemoryBudget::READ_BUFFER);
+  metrics->response_bodies = cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY);
+  metrics->metadata = cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA);
+  metrics->pending_writes = cass::MemoryBudget::bytes(cass::MemoryBudget::PENDING_WRITE);
+  metrics->total = cass::MemoryBudget::total();
+  metrics->limit = cass::MemoryBudget::limit();
+  metrics->rejected_requests = cass::MemoryBudget::rejected_count();
+}
+
+} // extern "C"
+
+namespace cass {
+
+Atomic<int64_t> MemoryBudget::bytes_[CATEGORY_COUNT];
+Atomic<uint64_t> MemoryBudget::limit_;
+Atomic<int> MemoryBudget::mode_;
+Atomic<int> MemoryBudget::waiters_;
+Atomic<uint64_t> MemoryBudget::rejected_count_;
+
+static uv_once_t init_guard = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+static uv_cond_t cond;
+
+static void init() {
+  uv_mutex_init(&mutex);
+  uv_cond_init(&cond);
+}
+
+void MemoryBudget::set_limit(uint64_t limit_bytes, CassMemoryLimitMode mode) {
+  uv_once(&init_guard, init);
+  mode_.store(mode);
+  limit_.store(limit_bytes);
+  // Changing the limit might admit blocked requests
+  notify_waiters();
+}
+
+bool MemoryBudget::admit_slow(uint64_t timeout_ms) {
+  if (mode_.load() == CASS_MEMORY_LIMIT_MODE_BLOCK) {
+    uv_once(&init_guard, init);
+
+    uint64_t start = uv_hrtime();
+    ScopedMutex l(&mutex);
+    // The waiter count must be visible before the total is checked so that
+    // remove() either frees enough memory before the check or notifies.
+    waiters_.fetch_add(1);
+    while (true) {
+      uint64_t limit = limit_.load();
+      if (limit == 0 || total() < static_cast<int64_t>(limit)) {
+        waiters_.fetch_sub(1);
+        return true;
+      }
+      if (timeout_ms == 0) {
+        uv_cond_wait(&cond, l.get());
+      } else {
+        uint64_t elapsed = uv_hrtime() - start;
+        uint64_t timeout_ns = timeout_ms * 1000 * 1000;
+        if (elapsed >= timeout_ns ||
+            uv_cond_timedwait(&cond, l.get(), timeout_ns - elapsed) != 0) {
+          break;
+        }
+      }
+    }
+    waiters_.fetch_sub(1);
+  }
+
+  rejected_count_.fetch_add(1, MEMORY_ORDER_RELAXED);
+  return false;
+}
+
+void MemoryBudget::notify_waiters() {
+  uv_once(&init_guard, init);
+  ScopedMutex l(&mutex);
+  uv_cond_broadcast(&cond);
+}
+
+} // namespace cass
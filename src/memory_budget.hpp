@@ -0,0 +1,93 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_MEMORY_BUDGET_HPP_INCLUDED__
+#define __CASS_MEMORY_BUDGET_HPP_INCLUDED__
+
+#include "atomic.hpp"
+#include "cassandra.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cass {
+
+// Accounts the bytes held by the driver's larger buffers, across all
+// sessions, and optionally limits the admission of new requests once the
+// total reaches a budget. Accounting is a relaxed atomic add per allocation.
+//
+// The counters are zero-initialized static storage (no constructors) so
+// that they're valid for buffers allocated during static initialization.
+class MemoryBudget {
+public:
+  enum Category {
+    REQUEST_ENCODING, // Encoded requests and bound values
+    READ_BUFFER,      // Connection socket read buffers
+    RESPONSE_BODY,    // Response bodies (including result rows)
+    METADATA,         // Buffers held by the schema metadata
+    PENDING_WRITE,    // Encoded requests queued on connections
+    CATEGORY_COUNT
+  };
+
+  static void add(Category category, size_t bytes) {
+    bytes_[category].fetch_add(static_cast<int64_t>(bytes), MEMORY_ORDER_RELAXED);
+  }
+
+  static void remove(Category category, size_t bytes) {
+    bytes_[category].fetch_sub(static_cast<int64_t>(bytes));
+    if (waiters_.load() > 0) notify_waiters();
+  }
+
+  static int64_t bytes(Category category) {
+    return bytes_[category].load(MEMORY_ORDER_RELAXED);
+  }
+
+  // The bytes counted against the limit. Pending writes are excluded
+  // because they're mostly held by request encoding buffers.
+  static int64_t total() {
+    return bytes(REQUEST_ENCODING) + bytes(READ_BUFFER) +
+        bytes(RESPONSE_BODY) + bytes(METADATA);
+  }
+
+  static void set_limit(uint64_t limit_bytes, CassMemoryLimitMode mode);
+
+  static uint64_t limit() { return limit_.load(MEMORY_ORDER_RELAXED); }
+  static uint64_t rejected_count() { return rejected_count_.load(MEMORY_ORDER_RELAXED); }
+
+  // Returns false if a new request can't be admitted because the total is
+  // at or above the limit. In blocking mode this waits up to "timeout_ms"
+  // (0 waits indefinitely) for buffers to be released.
+  static bool admit(uint64_t timeout_ms) {
+    uint64_t limit = limit_.load(MEMORY_ORDER_RELAXED);
+    if (limit == 0 || total() < static_cast<int64_t>(limit)) return true;
+    return admit_slow(timeout_ms);
+  }
+
+private:
+  static bool admit_slow(uint64_t timeout_ms);
+  static void notify_waiters();
+
+private:
+  static Atomic<int64_t> bytes_[CATEGORY_COUNT];
+  static Atomic<uint64_t> limit_;
+  static Atomic<int> mode_;
+  static Atomic<int> waiters_;
+  static Atomic<uint64_t> rejected_count_;
+};
+
+} // namespace cass
+
+#endif
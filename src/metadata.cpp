@@ -33,6 +33,7 @@
 #include "third_party/rapidjson/rapidjson/document.h"
 
 #include <algorithm>
+#include <assert.h>
 #include <cmath>
 #include <ctype.h>
 
@@ -795,6 +796,239 @@ Metadata::SchemaSnapshot Metadata::schema_snapshot() const {
 }
 
 void Metadata::update_keyspaces(ResultResponse* result) {
+  add(Update::UPDATE_KEYSPACES, result);
+}
+
+void Metadata::update_tables(ResultResponse* result) {
+  add(Update::UPDATE_TABLES, result);
+}
+
+void Metadata::update_views(ResultResponse* result) {
+  add(Update::UPDATE_VIEWS, result);
+}
+
+void Metadata::update_columns(ResultResponse* result) {
+  add(Update::UPDATE_COLUMNS, result);
+}
+
+void Metadata::update_indexes(ResultResponse* result) {
+  add(Update::UPDATE_INDEXES, result);
+}
+
+void Metadata::update_user_types(ResultResponse* result) {
+  add(Update::UPDATE_USER_TYPES, result);
+}
+
+void Metadata::update_functions(ResultResponse* result) {
+  add(Update::UPDATE_FUNCTIONS, result);
+}
+
+void Metadata::update_aggregates(ResultResponse* result) {
+  add(Update::UPDATE_AGGREGATES, result);
+}
+
+void Metadata::drop_keyspace(const std::string& keyspace_name) {
+  add(Update::DROP_KEYSPACE, keyspace_name, std::string());
+}
+
+void Metadata::drop_table_or_view(const std::string& keyspace_name, const std::string& table_or_view_name) {
+  add(Update::DROP_TABLE_OR_VIEW, keyspace_name, table_or_view_name);
+}
+
+void Metadata::drop_user_type(const std::string& keyspace_name, const std::string& type_name) {
+  add(Update::DROP_USER_TYPE, keyspace_name, type_name);
+}
+
+void Metadata::drop_function(const std::string& keyspace_name, const std::string& full_function_name) {
+  add(Update::DROP_FUNCTION, keyspace_name, full_function_name);
+}
+
+void Metadata::drop_aggregate(const std::string& keyspace_name, const std::string& full_aggregate_name) {
+  add(Update::DROP_AGGREGATE, keyspace_name, full_aggregate_name);
+}
+
+void Metadata::clear_and_update_back() {
+  add(Update(Update::CLEAR_AND_UPDATE_BACK));
+}
+
+void Metadata::swap_to_back_and_update_front() {
+  add(Update(Update::SWAP_TO_BACK_AND_UPDATE_FRONT));
+}
+
+void Metadata::notify_when_applied(Callback callback, void* data) {
+  Update update(Update::NOTIFY);
+  update.callback = callback;
+  update.data = data;
+  add(update);
+}
+
+void Metadata::set_protocol_version(int version) {
+  Update update(Update::SET_PROTOCOL_VERSION);
+  update.protocol_version = version;
+  add(update);
+}
+
+void Metadata::set_cassandra_version(const VersionNumber& cassandra_version) {
+  cassandra_version_ = cassandra_version;
+  Update update(Update::SET_CASSANDRA_VERSION);
+  update.cassandra_version = cassandra_version;
+  add(update);
+}
+
+void Metadata::add(const Update& update) {
+  pending_.push_back(update);
+
+  if (loop_ == NULL) {
+    UpdateVec updates;
+    UpdateVec applied;
+    updates.swap(pending_);
+    apply(updates, &applied);
+    finish(applied);
+    return;
+  }
+
+  if (!is_working_) {
+    applying_.swap(pending_);
+    is_working_ = true;
+    uv_queue_work(loop_, &work_request_, on_work, on_after_work);
+  }
+}
+
+void Metadata::add(Update::Type type, ResultResponse* result) {
+  // The result is kept alive until it's been applied
+  Update update(type);
+  update.result = SharedRefPtr<ResultResponse>(result);
+  add(update);
+}
+
+void Metadata::add(Update::Type type, const std::string& keyspace_name, const std::string& name) {
+  Update update(type);
+  update.keyspace_name = keyspace_name;
+  update.name = name;
+  add(update);
+}
+
+void Metadata::apply(const UpdateVec& updates, UpdateVec* applied) {
+  for (UpdateVec::const_iterator i = updates.begin(),
+       end = updates.end(); i != end; ++i) {
+    ResultResponse* result = i->result.get();
+    switch (i->type) {
+      case Update::SET_PROTOCOL_VERSION: {
+        ScopedMutex l(&mutex_);
+        config_.protocol_version = i->protocol_version;
+        break;
+      }
+
+      case Update::SET_CASSANDRA_VERSION: {
+        ScopedMutex l(&mutex_);
+        config_.cassandra_version = i->cassandra_version;
+        break;
+      }
+
+      case Update::UPDATE_KEYSPACES:
+        internal_update_keyspaces(result, applied);
+        break;
+
+      case Update::UPDATE_TABLES:
+        internal_update_tables(result);
+        break;
+
+      case Update::UPDATE_VIEWS:
+        internal_update_views(result);
+        break;
+
+      case Update::UPDATE_COLUMNS:
+        internal_update_columns(result);
+        break;
+
+      case Update::UPDATE_INDEXES:
+        internal_update_indexes(result);
+        break;
+
+      case Update::UPDATE_USER_TYPES:
+        internal_update_user_types(result);
+        break;
+
+      case Update::UPDATE_FUNCTIONS:
+        internal_update_functions(result);
+        break;
+
+      case Update::UPDATE_AGGREGATES:
+        internal_update_aggregates(result);
+        break;
+
+      case Update::DROP_KEYSPACE:
+        internal_drop_keyspace(i->keyspace_name);
+        break;
+
+      case Update::DROP_TABLE_OR_VIEW:
+        internal_drop_table_or_view(i->keyspace_name, i->name);
+        break;
+
+      case Update::DROP_USER_TYPE:
+        internal_drop_user_type(i->keyspace_name, i->name);
+        break;
+
+      case Update::DROP_FUNCTION:
+        internal_drop_function(i->keyspace_name, i->name);
+        break;
+
+      case Update::DROP_AGGREGATE:
+        internal_drop_aggregate(i->keyspace_name, i->name);
+        break;
+
+      case Update::CLEAR_AND_UPDATE_BACK:
+        internal_clear_and_update_back();
+        break;
+
+      case Update::SWAP_TO_BACK_AND_UPDATE_FRONT:
+        internal_swap_to_back_and_update_front();
+        break;
+
+      case Update::UPDATE_KEYSPACE_REPLICATION:
+      case Update::NOTIFY:
+        applied->push_back(*i);
+        break;
+    }
+  }
+}
+
+void Metadata::finish(const UpdateVec& applied) {
+  for (UpdateVec::const_iterator i = applied.begin(),
+       end = applied.end(); i != end; ++i) {
+    if (i->type == Update::UPDATE_KEYSPACE_REPLICATION) {
+      token_map_builder_->update_keyspace(i->keyspace_name, i->strategy);
+    } else if (i->type == Update::NOTIFY) {
+      i->callback(i->data);
+    }
+  }
+}
+
+void Metadata::on_work(uv_work_t* request) {
+  Metadata* metadata = static_cast<Metadata*>(request->data);
+  metadata->apply(metadata->applying_, &metadata->applied_);
+  // The results are released here instead of on the loop's thread
+  metadata->applying_.clear();
+}
+
+void Metadata::on_after_work(uv_work_t* request, int status) {
+  Metadata* metadata = static_cast<Metadata*>(request->data);
+
+  UpdateVec applied;
+  applied.swap(metadata->applied_);
+
+  metadata->is_working_ = false;
+  if (!metadata->pending_.empty()) {
+    metadata->applying_.swap(metadata->pending_);
+    metadata->is_working_ = true;
+    uv_queue_work(metadata->loop_, &metadata->work_request_, on_work, on_after_work);
+  }
+
+  // Callbacks can add more changes
+  metadata->finish(applied);
+}
+
+void Metadata::internal_update_keyspaces(ResultResponse* result, UpdateVec* applied) {
   KeyspaceMetadata::Map updates;
 
   schema_snapshot_version_++;
@@ -807,11 +1041,16 @@ void Metadata::update_keyspaces(ResultResponse* result) {
   }
 
   for (KeyspaceMetadata::Map::const_iterator i = updates.begin(); i != updates.end(); ++i) {
-    token_map_.update_keyspace(i->first, i->second);
+    // The keyspace metadata is only valid on this thread so the strategy is
+    // created here
+    Update update(Update::UPDATE_KEYSPACE_REPLICATION);
+    update.keyspace_name = i->first;
+    update.strategy = ReplicationStrategy::from_keyspace_meta(i->second);
+    applied->push_back(update);
   }
 }
 
-void Metadata::update_tables(ResultResponse* result) {
+void Metadata::internal_update_tables(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -822,7 +1061,7 @@ void Metadata::update_tables(ResultResponse* result) {
   }
 }
 
-void Metadata::update_views(ResultResponse* result) {
+void Metadata::internal_update_views(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -833,24 +1072,26 @@ void Metadata::update_views(ResultResponse* result) {
   }
 }
 
-void Metadata::update_columns(ResultResponse* result) {
+void Metadata::internal_update_columns(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
     ScopedMutex l(&mutex_);
-    updating_->update_columns(config_, result);
-    if (cassandra_version() < VersionNumber(3, 0, 0)) {
+    updating_->update_columns(config_, result, NULL);
+    if (config_.cassandra_version < VersionNumber(3, 0, 0)) {
       updating_->update_legacy_indexes(config_, result);
     }
   } else {
-    updating_->update_columns(config_, result);
-    if (cassandra_version() < VersionNumber(3, 0, 0)) {
+    // Share unchanged columns with the front buffer while it's rebuilt
+    bool is_same_version = front_cassandra_version_.compare(config_.cassandra_version) == 0;
+    updating_->update_columns(config_, result, is_same_version ? &front_ : NULL);
+    if (config_.cassandra_version < VersionNumber(3, 0, 0)) {
       updating_->update_legacy_indexes(config_, result);
     }
   }
 }
 
-void Metadata::update_indexes(ResultResponse* result) {
+void Metadata::internal_update_indexes(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -861,7 +1102,7 @@ void Metadata::update_indexes(ResultResponse* result) {
   }
 }
 
-void Metadata::update_user_types(ResultResponse* result) {
+void Metadata::internal_update_user_types(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -872,7 +1113,7 @@ void Metadata::update_user_types(ResultResponse* result) {
   }
 }
 
-void Metadata::update_functions(ResultResponse* result) {
+void Metadata::internal_update_functions(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -883,7 +1124,7 @@ void Metadata::update_functions(ResultResponse* result) {
   }
 }
 
-void Metadata::update_aggregates(ResultResponse* result) {
+void Metadata::internal_update_aggregates(ResultResponse* result) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -894,7 +1135,7 @@ void Metadata::update_aggregates(ResultResponse* result) {
   }
 }
 
-void Metadata::drop_keyspace(const std::string& keyspace_name) {
+void Metadata::internal_drop_keyspace(const std::string& keyspace_name) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -905,7 +1146,7 @@ void Metadata::drop_keyspace(const std::string& keyspace_name) {
   }
 }
 
-void Metadata::drop_table_or_view(const std::string& keyspace_name, const std::string& table_or_view_name) {
+void Metadata::internal_drop_table_or_view(const std::string& keyspace_name, const std::string& table_or_view_name) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -916,7 +1157,7 @@ void Metadata::drop_table_or_view(const std::string& keyspace_name, const std::s
   }
 }
 
-void Metadata::drop_user_type(const std::string& keyspace_name, const std::string& type_name) {
+void Metadata::internal_drop_user_type(const std::string& keyspace_name, const std::string& type_name) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -927,7 +1168,7 @@ void Metadata::drop_user_type(const std::string& keyspace_name, const std::strin
   }
 }
 
-void Metadata::drop_function(const std::string& keyspace_name, const std::string& full_function_name) {
+void Metadata::internal_drop_function(const std::string& keyspace_name, const std::string& full_function_name) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -938,7 +1179,7 @@ void Metadata::drop_function(const std::string& keyspace_name, const std::string
   }
 }
 
-void Metadata::drop_aggregate(const std::string& keyspace_name, const std::string& full_aggregate_name) {
+void Metadata::internal_drop_aggregate(const std::string& keyspace_name, const std::string& full_aggregate_name) {
   schema_snapshot_version_++;
 
   if (is_front_buffer()) {
@@ -949,41 +1190,86 @@ void Metadata::drop_aggregate(const std::string& keyspace_name, const std::strin
   }
 }
 
-void Metadata::clear_and_update_back() {
+void Metadata::internal_clear_and_update_back() {
   if (config_.cassandra_version >= VersionNumber(3, 0, 0)) {
     config_.native_types.init_cql_names();
   } else {
     config_.native_types.init_class_names();
   }
-  token_map_.clear();
   back_.clear();
   updating_ = &back_;
 }
 
-void Metadata::swap_to_back_and_update_front() {
+void Metadata::internal_swap_to_back_and_update_front() {
   {
     ScopedMutex l(&mutex_);
     schema_snapshot_version_++;
     front_.swap(back_);
   }
+  front_cassandra_version_ = config_.cassandra_version;
   back_.clear();
   updating_ = &front_;
+  StringInterner::purge();
 }
 
 void Metadata::clear() {
+  assert(!is_working_ && "Unable to clear while changes are being applied");
+  pending_.clear();
   {
     ScopedMutex l(&mutex_);
     schema_snapshot_version_ = 0;
     front_.clear();
   }
   back_.clear();
-  token_map_.clear();
+  StringInterner::purge();
+  token_map_builder_->reset();
+}
+
+// Copies a row's values out of the result page so that the metadata built
+// from it only holds on to its own row instead of the whole page
+static SharedRefPtr<RefBuffer> copy_row(const Row* row, Row* output) {
+  const char* begin = NULL;
+  const char* end = NULL;
+  for (OutputValueVec::const_iterator i = row->values.begin(),
+       values_end = row->values.end(); i != values_end; ++i) {
+    if (i->is_null()) continue;
+    if (begin == NULL || i->data() < begin) begin = i->data();
+    if (end == NULL || i->data() + i->size() > end) end = i->data() + i->size();
+  }
+
+  size_t size = begin != NULL ? static_cast<size_t>(end - begin) : 0;
+  SharedRefPtr<RefBuffer> buffer(RefBuffer::create(size, MemoryBudget::METADATA));
+  if (size > 0) {
+    memcpy(buffer->data(), begin, size);
+  }
+
+  *output = Row(row->result());
+  output->values.reserve(row->values.size());
+  for (OutputValueVec::const_iterator i = row->values.begin(),
+       values_end = row->values.end(); i != values_end; ++i) {
+    if (i->is_null()) {
+      output->values.push_back(Value(i->data_type()));
+    } else {
+      output->values.push_back(Value(i->protocol_version(),
+                                     i->data_type(),
+                                     i->count(),
+                                     buffer->data() + (i->data() - begin),
+                                     i->size()));
+    }
+  }
+
+  return buffer;
+}
+
+static bool field_name_less(const MetadataField& field, const std::string& name) {
+  return field.name() < name;
 }
 
 const Value* MetadataBase::get_field(const std::string& name) const {
-  MetadataField::Map::const_iterator it = fields_.find(name);
-  if (it == fields_.end()) return NULL;
-  return it->second.value();
+  MetadataField::Vec::const_iterator it = std::lower_bound(fields_.begin(), fields_.end(),
+                                                           name, field_name_less);
+  if (it == fields_.end() || it->name() != name) return NULL;
+  return it->value();
 }
 
 std::string MetadataBase::get_string_field(const std::string& name) const {
@@ -992,27 +1278,38 @@ std::string MetadataBase::get_string_field(const std::string& name) const {
   return value->to_string();
 }
 
+const MetadataField& MetadataBase::set_field(const MetadataField& field) {
+  MetadataField::Vec::iterator it = std::lower_bound(fields_.begin(), fields_.end(),
+                                                     field.name(), field_name_less);
+  if (it != fields_.end() && it->name() == field.name()) {
+    *it = field;
+  } else {
+    it = fields_.insert(it, field);
+  }
+  return *it;
+}
+
 const Value* MetadataBase::add_field(const SharedRefPtr<RefBuffer>& buffer, const Row* row, const std::string& name) {
   const Value* value = row->get_by_name(name);
   if (value == NULL) return NULL;
   if (value->size() <= 0) {
-    fields_[name] = MetadataField(name);
+    set_field(MetadataField(StringInterner::intern(name)));
     return NULL; // Return NULL for "null" columns
   } else {
-    fields_[name] = MetadataField(name, *value, buffer);
+    set_field(MetadataField(StringInterner::intern(name), *value, buffer));
     return value;
   }
 }
 
 void MetadataBase::add_field(const SharedRefPtr<RefBuffer>& buffer, const Value& value, const std::string& name) {
-  fields_[name] = MetadataField(name, value, buffer);
+  set_field(MetadataField(StringInterner::intern(name), value, buffer));
 }
 
 void MetadataBase::add_json_list_field(int protocol_version, const Row* row, const std::string& name) {
   const Value* value = row->get_by_name(name);
   if (value == NULL) return;
   if (value->size() <= 0) {
-    fields_[name] = MetadataField(name);
+    set_field(MetadataField(StringInterner::intern(name)));
     return;
   }
 
@@ -1031,7 +1328,7 @@ void MetadataBase::add_json_list_field(int protocol_version, const Row* row, con
 
   if (!d.IsArray()) {
     LOG_DEBUG("Expected JSON array for column '%s' (probably null or empty)", name.c_str());
-    fields_[name] = MetadataField(name);
+    set_field(MetadataField(StringInterner::intern(name)));
     return;
   }
 
@@ -1042,7 +1339,7 @@ void MetadataBase::add_json_list_field(int protocol_version, const Row* row, con
   }
 
   size_t encoded_size = collection.get_items_size(protocol_version);
-  SharedRefPtr<RefBuffer> encoded(RefBuffer::create(encoded_size));
+  SharedRefPtr<RefBuffer> encoded(RefBuffer::create(encoded_size, MemoryBudget::METADATA));
 
   collection.encode_items(protocol_version, encoded->data());
 
@@ -1051,14 +1348,14 @@ void MetadataBase::add_json_list_field(int protocol_version, const Row* row, con
              d.Size(),
              encoded->data(),
              encoded_size);
-  fields_[name] = MetadataField(name, list, encoded);
+  set_field(MetadataField(StringInterner::intern(name), list, encoded));
 }
 
 const Value* MetadataBase::add_json_map_field(int protocol_version, const Row* row, const std::string& name) {
   const Value* value = row->get_by_name(name);
   if (value == NULL) return NULL;
   if (value->size() <= 0) {
-    return (fields_[name] = MetadataField(name)).value();
+    return set_field(MetadataField(StringInterner::intern(name))).value();
   }
 
   int32_t buffer_size = value->size();
@@ -1071,13 +1368,12 @@ const Value* MetadataBase::add_json_map_field(int protocol_version, const Row* r
 
   if (d.HasParseError()) {
     LOG_ERROR("Unable to parse JSON (object) for column '%s'", name.c_str());
-    return (fields_[name] = MetadataField(name)).value();
+    return set_field(MetadataField(StringInterner::intern(name))).value();
   }
 
   if (!d.IsObject()) {
     LOG_DEBUG("Expected JSON object for column '%s' (probably null or empty)", name.c_str());
-    fields_[name] = MetadataField(name);
-    return (fields_[name] = MetadataField(name)).value();
+    return set_field(MetadataField(StringInterner::intern(name))).value();
   }
 
   Collection collection(CollectionType::map(SharedRefPtr<DataType>(new DataType(CASS_VALUE_TYPE_TEXT)),
@@ -1090,7 +1386,7 @@ const Value* MetadataBase::add_json_map_field(int protocol_version, const Row* r
   }
 
   size_t encoded_size = collection.get_items_size(protocol_version);
-  SharedRefPtr<RefBuffer> encoded(RefBuffer::create(encoded_size));
+  SharedRefPtr<RefBuffer> encoded(RefBuffer::create(encoded_size, MemoryBudget::METADATA));
 
   collection.encode_items(protocol_version, encoded->data());
 
@@ -1100,7 +1396,7 @@ const Value* MetadataBase::add_json_map_field(int protocol_version, const Row* r
             encoded->data(),
             encoded_size);
 
-  return (fields_[name] = MetadataField(name, map, encoded)).value();
+  return set_field(MetadataField(StringInterner::intern(name), map, encoded)).value();
 }
 
 const TableMetadata* KeyspaceMetadata::get_table(const std::string& name) const {
@@ -1294,6 +1590,15 @@ const ColumnMetadata* TableMetadataBase::get_column(const std::string& name) con
   return i->second.get();
 }
 
+ColumnMetadata::Ptr TableMetadataBase::get_unchanged_column(const std::string& name,
+                                                            const Row* row) const {
+  ColumnMetadata::Map::const_iterator i = columns_by_name_.find(name);
+  if (i == columns_by_name_.end() || !i->second->is_unchanged(row)) {
+    return ColumnMetadata::Ptr();
+  }
+  return i->second;
+}
+
 void TableMetadataBase::add_column(const ColumnMetadata::Ptr& column) {
   if (columns_by_name_.insert(std::make_pair(column->name(), column)).second) {
     columns_.push_back(column);
@@ -1869,9 +2174,31 @@ ColumnMetadata::ColumnMetadata(const MetadataConfig& config,
   }
 }
 
+bool ColumnMetadata::is_unchanged(const Row* row) const {
+  if (has_user_type(data_type_)) return false;
+  for (MetadataField::Vec::const_iterator i = fields_.begin(),
+       end = fields_.end(); i != end; ++i) {
+    const Value* value = row->get_by_name(i->name());
+    if (value == NULL) return false;
+    const Value* field_value = i->value();
+    if (field_value->is_null()) {
+      // Empty values are stored as "null" fields
+      if (value->size() > 0) return false;
+    } else if (value->to_string_ref() != field_value->to_string_ref()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const KeyspaceMetadata* Metadata::InternalData::get_keyspace(const std::string& name) const {
+  KeyspaceMetadata::Map::const_iterator i = keyspaces_->find(name);
+  if (i == keyspaces_->end()) return NULL;
+  return &i->second;
+}
+
 void Metadata::InternalData::update_keyspaces(const MetadataConfig& config,
                                               ResultResponse* result, KeyspaceMetadata::Map& updates) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -1885,15 +2212,15 @@ void Metadata::InternalData::update_keyspaces(const MetadataConfig& config,
     }
 
     KeyspaceMetadata* keyspace = get_or_create_keyspace(keyspace_name);
-    keyspace->update(config, buffer, row);
+    Row compact_row;
+    SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
+    keyspace->update(config, buffer, &compact_row);
     updates.insert(std::make_pair(keyspace_name, *keyspace));
   }
 }
 
 void Metadata::InternalData::update_tables(const MetadataConfig& config,
                                            ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -1916,14 +2243,14 @@ void Metadata::InternalData::update_tables(const MetadataConfig& config,
       keyspace = get_or_create_keyspace(keyspace_name);
     }
 
-    keyspace->add_table(TableMetadata::Ptr(new TableMetadata(config, table_name, buffer, row)));
+    Row compact_row;
+    SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
+    keyspace->add_table(TableMetadata::Ptr(new TableMetadata(config, table_name, buffer, &compact_row)));
   }
 }
 
 void Metadata::InternalData::update_views(const MetadataConfig& config,
                                           ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -1960,7 +2287,9 @@ void Metadata::InternalData::update_views(const MetadataConfig& config,
       continue;
     }
 
-    ViewMetadata::Ptr view(new ViewMetadata(config, table.get(), view_name, buffer, row));
+    Row compact_row;
+    SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
+    ViewMetadata::Ptr view(new ViewMetadata(config, table.get(), view_name, buffer, &compact_row));
     keyspace->add_view(view);
     table->add_view(view);
     updated_tables.push_back(table);
@@ -2057,8 +2386,6 @@ void Metadata::InternalData::update_user_types(const MetadataConfig& config, Res
 
 void Metadata::InternalData::update_functions(const MetadataConfig& config,
                                               ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -2083,17 +2410,17 @@ void Metadata::InternalData::update_functions(const MetadataConfig& config,
       keyspace = get_or_create_keyspace(keyspace_name);
     }
 
+    Row compact_row;
+    SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
     keyspace->add_function(FunctionMetadata::Ptr(new FunctionMetadata(config,
                                                                       function_name, signature,
                                                                       keyspace,
-                                                                      buffer, row)));
+                                                                      buffer, &compact_row)));
 
   }
 }
 
 void Metadata::InternalData::update_aggregates(const MetadataConfig& config, ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -2118,10 +2445,12 @@ void Metadata::InternalData::update_aggregates(const MetadataConfig& config, Res
       keyspace = get_or_create_keyspace(keyspace_name);
     }
 
+    Row compact_row;
+    SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
     keyspace->add_aggregate(AggregateMetadata::Ptr(new AggregateMetadata(config,
                                                                          aggregate_name, signature,
                                                                          keyspace,
-                                                                         buffer, row)));
+                                                                         buffer, &compact_row)));
   }
 }
 
@@ -2154,9 +2483,8 @@ void Metadata::InternalData::drop_aggregate(const std::string& keyspace_name, co
   i->second.drop_aggregate(full_aggregate_name);
 }
 
-void Metadata::InternalData::update_columns(const MetadataConfig& config, ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
+void Metadata::InternalData::update_columns(const MetadataConfig& config, ResultResponse* result,
+                                            const InternalData* previous) {
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -2166,6 +2494,8 @@ void Metadata::InternalData::update_columns(const MetadataConfig& config, Result
 
   KeyspaceMetadata* keyspace = NULL;
   TableMetadataBase::Ptr table_or_view;
+  const KeyspaceMetadata* previous_keyspace = NULL;
+  const TableMetadataBase* previous_table_or_view = NULL;
 
   while (rows.next()) {
     std::string temp_keyspace_name;
@@ -2184,6 +2514,7 @@ void Metadata::InternalData::update_columns(const MetadataConfig& config, Result
       keyspace_name = temp_keyspace_name;
       keyspace = get_or_create_keyspace(keyspace_name);
       table_or_view_name.clear();
+      previous_keyspace = previous != NULL ? previous->get_keyspace(keyspace_name) : NULL;
     }
 
     if (table_or_view_name != temp_table_or_view_name) {
@@ -2198,11 +2529,30 @@ void Metadata::InternalData::update_columns(const MetadataConfig& config, Result
         if (!table_or_view) continue;
       }
       table_or_view->clear_columns();
+
+      previous_table_or_view = NULL;
+      if (previous_keyspace != NULL) {
+        previous_table_or_view = previous_keyspace->get_table(table_or_view_name);
+        if (previous_table_or_view == NULL) {
+          previous_table_or_view = previous_keyspace->get_view(table_or_view_name);
+        }
+      }
     }
 
     if (table_or_view) {
-      table_or_view->add_column(ColumnMetadata::Ptr(new ColumnMetadata(config, column_name,
-                                                                       keyspace, buffer, row)));
+      // Columns are immutable so an unchanged column is shared with the
+      // previous schema instead of being rebuilt
+      ColumnMetadata::Ptr column;
+      if (previous_table_or_view != NULL) {
+        column = previous_table_or_view->get_unchanged_column(column_name, row);
+      }
+      if (!column) {
+        Row compact_row;
+        SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
+        column = ColumnMetadata::Ptr(new ColumnMetadata(config, column_name,
+                                                        keyspace, buffer, &compact_row));
+      }
+      table_or_view->add_column(column);
     }
   }
 
@@ -2213,8 +2563,6 @@ void Metadata::InternalData::update_columns(const MetadataConfig& config, Result
 }
 
 void Metadata::InternalData::update_legacy_indexes(const MetadataConfig& config, ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
   ResultIterator rows(result);
 
   std::string keyspace_name;
@@ -2257,7 +2605,9 @@ void Metadata::InternalData::update_legacy_indexes(const MetadataConfig& config,
         if (index_type != NULL &&
             index_type->value_type() == CASS_VALUE_TYPE_VARCHAR) {
           std::string index_name = column->get_string_field("index_name");
-          table->add_index(IndexMetadata::from_legacy(config, index_name, column, buffer, row));
+          Row compact_row;
+          SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
+          table->add_index(IndexMetadata::from_legacy(config, index_name, column, buffer, &compact_row));
         }
       }
     }
@@ -2265,8 +2615,6 @@ void Metadata::InternalData::update_legacy_indexes(const MetadataConfig& config,
 }
 
 void Metadata::InternalData::update_indexes(const MetadataConfig& config, ResultResponse* result) {
-  SharedRefPtr<RefBuffer> buffer = result->buffer();
-
   result->decode_first_row();
   ResultIterator rows(result);
 
@@ -2302,7 +2650,9 @@ void Metadata::InternalData::update_indexes(const MetadataConfig& config, Result
       table->clear_indexes();
     }
 
-    table->add_index(IndexMetadata::from_row(index_name, buffer, row));
+    Row compact_row;
+    SharedRefPtr<RefBuffer> buffer(copy_row(row, &compact_row));
+    table->add_index(IndexMetadata::from_row(index_name, buffer, &compact_row));
   }
 }
 
@@ -21,9 +21,12 @@
 #include "iterator.hpp"
 #include "macros.hpp"
 #include "ref_counted.hpp"
+#include "result_response.hpp"
 #include "scoped_lock.hpp"
 #include "scoped_ptr.hpp"
+#include "string_interner.hpp"
 #include "token_map.hpp"
+#include "token_map_builder.hpp"
 #include "data_type.hpp"
 #include "value.hpp"
 
@@ -39,7 +42,6 @@ class TableMetadata;
 class KeyspaceMetadata;
 class TableMetadata;
 class Row;
-class ResultResponse;
 
 template<class T>
 class MapIteratorImpl {
@@ -107,14 +109,12 @@ struct MetadataConfig {
 
 class MetadataField {
 public:
-  typedef std::map<std::string, MetadataField> Map;
+  typedef std::vector<MetadataField> Vec;
 
-  MetadataField() { }
-
-  MetadataField(const std::string& name)
+  MetadataField(const InternedString::Ptr& name)
     : name_(name) { }
 
-  MetadataField(const std::string& name,
+  MetadataField(const InternedString::Ptr& name,
                 const Value& value,
                 const SharedRefPtr<RefBuffer>& buffer)
     : name_(name)
@@ -122,7 +122,7 @@ public:
     , buffer_(buffer) { }
 
   const std::string& name() const {
-    return name_;
+    return name_->str();
   }
 
   const Value* value() const {
@@ -130,32 +130,36 @@ public:
   }
 
 private:
-  std::string name_;
+  InternedString::Ptr name_;
   Value value_;
   SharedRefPtr<RefBuffer> buffer_;
 };
 
 class MetadataFieldIterator : public Iterator {
 public:
-  typedef MapIteratorImpl<MetadataField>::Collection Map;
+  typedef VecIteratorImpl<MetadataField>::Collection Vec;
 
-  MetadataFieldIterator(const Map& map)
+  MetadataFieldIterator(const Vec& fields)
     : Iterator(CASS_ITERATOR_TYPE_META_FIELD)
-    , impl_(map) { }
+    , impl_(fields) { }
 
   virtual bool next() { return impl_.next(); }
   const MetadataField* field() const { return &impl_.item(); }
 
 private:
-  MapIteratorImpl<MetadataField> impl_;
+  VecIteratorImpl<MetadataField> impl_;
 };
 
+// The names of schema objects and their fields are interned because the same
+// names are repeated across many objects. Fields are kept in a vector sorted
+// by name and each field only references the bytes of its own row (see
+// copy_row() in metadata.cpp), never the whole result page.
 class MetadataBase {
 public:
   MetadataBase(const std::string& name)
-    : name_(name) { }
+    : name_(StringInterner::intern(name)) { }
 
-  const std::string& name() const { return name_; }
+  const std::string& name() const { return name_->str(); }
 
   const Value* get_field(const std::string& name) const;
   std::string get_string_field(const std::string& name) const;
@@ -171,10 +175,14 @@ protected:
   void add_json_list_field(int version, const Row* row, const std::string& name);
   const Value* add_json_map_field(int version, const Row* row, const std::string& name);
 
-  MetadataField::Map fields_;
+  // Replaces an existing field with the same name. The returned pointer is
+  // only valid until the next field is added.
+  const MetadataField& set_field(const MetadataField& field);
+
+  MetadataField::Vec fields_;
 
 private:
-  const std::string name_;
+  InternedString::Ptr name_;
 };
 
 template<class IteratorImpl>
@@ -334,6 +342,11 @@ public:
   const DataType::ConstPtr& data_type() const { return data_type_; }
   bool is_reversed() const { return is_reversed_; }
 
+  // Returns true if the column would be rebuilt exactly the same from the
+  // row. Columns that use user types are never considered unchanged because
+  // the types could have changed without changing the column's row.
+  bool is_unchanged(const Row* row) const;
+
 private:
   CassColumnType type_;
   int32_t position_;
@@ -372,6 +385,7 @@ public:
 
   Iterator* iterator_columns() const { return new ColumnIterator(columns_); }
   const ColumnMetadata* get_column(const std::string& name) const;
+  ColumnMetadata::Ptr get_unchanged_column(const std::string& name, const Row* row) const;
   void add_column(const ColumnMetadata::Ptr& column);
   void clear_columns();
   void build_keys_and_sort(const MetadataConfig& config);
@@ -612,6 +626,7 @@ public:
 
     const KeyspaceMetadata* get_keyspace(const std::string& name) const;
     Iterator* iterator_keyspaces() const { return new KeyspaceIterator(*keyspaces_); }
+    const KeyspaceMetadata::MapPtr& keyspaces() const { return keyspaces_; }
 
     const UserType* get_user_type(const std::string& keyspace_name,
                                   const std::string& type_name) const;
@@ -626,9 +641,15 @@ public:
   static std::string full_function_name(const std::string& name, const StringVec& signature);
 
 public:
+  typedef void (*Callback)(void* data);
+
   Metadata()
-    : updating_(&front_)
-    , schema_snapshot_version_(0) {
+    : loop_(NULL)
+    , is_working_(false)
+    , updating_(&front_)
+    , schema_snapshot_version_(0)
+    , token_map_builder_(new TokenMapBuilder()) {
+    work_request_.data = this;
     uv_mutex_init(&mutex_);
   }
 
@@ -636,8 +657,14 @@ public:
     uv_mutex_destroy(&mutex_);
   }
 
+  // This can be called from any thread
   SchemaSnapshot schema_snapshot() const;
 
+  // The following methods must be called on the loop's thread. When a loop
+  // is set the schema results are decoded and applied, in order, on the
+  // loop's thread pool so that building the metadata never blocks the
+  // loop's thread. New snapshots become visible once the changes are
+  // applied.
   void update_keyspaces(ResultResponse* result);
   void update_tables(ResultResponse* result);
   void update_views(ResultResponse* result);
@@ -661,25 +688,111 @@ public:
   // happen directly to the front buffer.
   void swap_to_back_and_update_front();
 
+  // Runs the callback on the loop's thread after the changes made before
+  // it have been applied (and passed on to the token map)
+  void notify_when_applied(Callback callback, void* data);
+
+  // This must only be called when no changes are being applied e.g. when the
+  // loop isn't running.
   void clear();
 
-  void set_protocol_version(int version) {
-    config_.protocol_version = version;
-  }
+  void set_protocol_version(int version);
+
+  const VersionNumber& cassandra_version() const { return cassandra_version_; }
+  void set_cassandra_version(const VersionNumber& cassandra_version);
 
-  const VersionNumber& cassandra_version() const { return config_.cassandra_version; }
-  void set_cassandra_version(const VersionNumber& cassandra_version) {
-    config_.cassandra_version = cassandra_version;
+  // The schema and token map are updated on the loop's thread pool when a
+  // loop is set
+  void set_loop(uv_loop_t* loop) {
+    loop_ = loop;
+    token_map_builder_->set_loop(loop);
   }
 
-  void set_partitioner(const std::string& partitioner_class) { token_map_.set_partitioner(partitioner_class); }
-  void update_host(SharedRefPtr<Host>& host, const TokenStringList& tokens) { token_map_.update_host(host, tokens); }
-  void build() { token_map_.build(); }
-  void remove_host(SharedRefPtr<Host>& host) { token_map_.remove_host(host); }
+  void set_partitioner(const std::string& partitioner_class) { token_map_builder_->set_partitioner(partitioner_class); }
+  void update_host(SharedRefPtr<Host>& host, const TokenStringList& tokens) { token_map_builder_->update_host(host, tokens); }
+  void update_keyspace_replication(const std::string& ks_name,
+                                   const SharedRefPtr<ReplicationStrategy>& strategy) {
+    token_map_builder_->update_keyspace(ks_name, strategy);
+  }
+  void build() { token_map_builder_->build(); }
+  void clear_token_map() { token_map_builder_->clear(); }
+  void remove_host(SharedRefPtr<Host>& host) { token_map_builder_->remove_host(host); }
 
-  const TokenMap& token_map() const { return token_map_; }
+  // The latest token map snapshot, this can be called from any thread
+  TokenMap::ConstPtr token_map() const { return token_map_builder_->snapshot(); }
 
 private:
+  struct Update {
+    enum Type {
+      SET_PROTOCOL_VERSION,
+      SET_CASSANDRA_VERSION,
+      UPDATE_KEYSPACES,
+      UPDATE_TABLES,
+      UPDATE_VIEWS,
+      UPDATE_COLUMNS,
+      UPDATE_INDEXES,
+      UPDATE_USER_TYPES,
+      UPDATE_FUNCTIONS,
+      UPDATE_AGGREGATES,
+      DROP_KEYSPACE,
+      DROP_TABLE_OR_VIEW,
+      DROP_USER_TYPE,
+      DROP_FUNCTION,
+      DROP_AGGREGATE,
+      CLEAR_AND_UPDATE_BACK,
+      SWAP_TO_BACK_AND_UPDATE_FRONT,
+      // The following are passed on to the loop's thread after the changes
+      // before them are applied
+      UPDATE_KEYSPACE_REPLICATION,
+      NOTIFY
+    };
+
+    Update(Type type)
+      : type(type)
+      , protocol_version(0)
+      , callback(NULL)
+      , data(NULL) { }
+
+    Type type;
+    SharedRefPtr<ResultResponse> result;
+    std::string keyspace_name;
+    std::string name; // The table, view, type, function or aggregate name
+    int protocol_version;
+    VersionNumber cassandra_version;
+    SharedRefPtr<ReplicationStrategy> strategy;
+    Callback callback;
+    void* data;
+  };
+
+  typedef std::vector<Update> UpdateVec;
+
+  void add(const Update& update);
+  void add(Update::Type type, ResultResponse* result);
+  void add(Update::Type type, const std::string& keyspace_name, const std::string& name);
+  void apply(const UpdateVec& updates, UpdateVec* applied);
+  void finish(const UpdateVec& applied);
+
+  static void on_work(uv_work_t* request);
+  static void on_after_work(uv_work_t* request, int status);
+
+  void internal_update_keyspaces(ResultResponse* result, UpdateVec* applied);
+  void internal_update_tables(ResultResponse* result);
+  void internal_update_views(ResultResponse* result);
+  void internal_update_columns(ResultResponse* result);
+  void internal_update_indexes(ResultResponse* result);
+  void internal_update_user_types(ResultResponse* result);
+  void internal_update_functions(ResultResponse* result);
+  void internal_update_aggregates(ResultResponse* result);
+
+  void internal_drop_keyspace(const std::string& keyspace_name);
+  void internal_drop_table_or_view(const std::string& keyspace_name, const std::string& table_or_view_name);
+  void internal_drop_user_type(const std::string& keyspace_name, const std::string& type_name);
+  void internal_drop_function(const std::string& keyspace_name, const std::string& full_function_name);
+  void internal_drop_aggregate(const std::string& keyspace_name, const std::string& full_aggregate_name);
+
+  void internal_clear_and_update_back();
+  void internal_swap_to_back_and_update_front();
+
   bool is_front_buffer() const { return updating_ == &front_; }
 
 private:
@@ -689,11 +802,14 @@ private:
       : keyspaces_(new KeyspaceMetadata::Map()) { }
 
     const KeyspaceMetadata::MapPtr& keyspaces() const { return keyspaces_; }
+    const KeyspaceMetadata* get_keyspace(const std::string& name) const;
 
     void update_keyspaces(const MetadataConfig& config, ResultResponse* result, KeyspaceMetadata::Map& updates);
     void update_tables(const MetadataConfig& config, ResultResponse* result);
     void update_views(const MetadataConfig& config, ResultResponse* result);
-    void update_columns(const MetadataConfig& config, ResultResponse* result);
+    // Unchanged columns are shared with the "previous" data (if not NULL)
+    void update_columns(const MetadataConfig& config, ResultResponse* result,
+                        const InternalData* previous);
     void update_legacy_indexes(const MetadataConfig& config, ResultResponse* result);
     void update_indexes(const MetadataConfig& config, ResultResponse* result);
     void update_user_types(const MetadataConfig& config, ResultResponse* result);
@@ -724,22 +840,37 @@ private:
     DISALLOW_COPY_AND_ASSIGN(InternalData);
   };
 
+  uv_loop_t* loop_;
+  uv_work_t work_request_;
+  bool is_working_;
+
+  // Only used on the loop's thread
+  UpdateVec pending_;
+  VersionNumber cassandra_version_;
+
+  // Only used by the thread applying the changes
+  UpdateVec applying_;
+  UpdateVec applied_;
+
   InternalData* updating_;
   InternalData front_;
   InternalData back_;
 
+  // The version used to build the front buffer. Columns are only shared
+  // between buffers built for the same version.
+  VersionNumber front_cassandra_version_;
+
   uint32_t schema_snapshot_version_;
 
   // This lock prevents partial snapshots when updating metadata
   mutable uv_mutex_t mutex_;
 
-  // Only used internally on a single thread so it doesn't currently use
-  // copy-on-write. When this is exposed externally it needs to be
-  // moved into the InternalData class and made to use copy-on-write.
-  TokenMap token_map_;
+  // Builds the token map off of the session thread and publishes
+  // immutable snapshots of it
+  SharedRefPtr<TokenMapBuilder> token_map_builder_;
 
-  // Only used internally on a single thread, there's
-  // no need for copy-on-write.
+  // Only used by the thread applying the changes (and by snapshots while
+  // holding the lock), there's no need for copy-on-write.
   MetadataConfig config_;
 
 private:
@@ -22,6 +22,8 @@
 
 #include "atomic.hpp"
 #include "constants.hpp"
+#include "host.hpp"
+#include "latency_breakdown.hpp"
 #include "scoped_ptr.hpp"
 #include "scoped_lock.hpp"
 
@@ -43,6 +45,8 @@
 
 namespace cass {
 
+class HostMetrics;
+
 class Metrics {
 public:
   class ThreadState {
@@ -105,6 +109,10 @@ public:
       counters_[thread_state_->current_thread_id()].sub(1LL);
     }
 
+    void add(int64_t n) {
+      counters_[thread_state_->current_thread_id()].add(n);
+    }
+
     int64_t sum() const {
       int64_t sum = 0;
       for (size_t i = 0; i < thread_state_->max_threads(); ++i) {
@@ -268,6 +276,14 @@ public:
   public:
     static const int64_t HIGHEST_TRACKABLE_VALUE = 3600LL * 1000LL * 1000LL;
 
+    // Each reader of interval snapshots gets its own histogram so that
+    // reading an interval for one doesn't reset the interval of another
+    enum IntervalReader {
+      INTERVAL_READER_API, // cass_session_get_*_interval() functions
+      INTERVAL_READER_LOG, // The histogram log writer
+      INTERVAL_READER_COUNT
+    };
+
     struct Snapshot {
       int64_t min;
       int64_t max;
@@ -281,15 +297,25 @@ public:
       int64_t percentile_999th;
     };
 
-    Histogram(ThreadState* thread_state)
+    Histogram(ThreadState* thread_state, int significant_figures = 3)
       : thread_state_(thread_state)
+      , significant_figures_(significant_figures)
       , histograms_(new PerThreadHistogram[thread_state->max_threads()]) {
-      hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, 3, &histogram_);
+      hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, significant_figures, &histogram_);
+      for (size_t i = 0; i < thread_state->max_threads(); ++i) {
+        histograms_[i].init(significant_figures);
+      }
+      for (int i = 0; i < INTERVAL_READER_COUNT; ++i) {
+        interval_histograms_[i] = NULL;
+      }
       uv_mutex_init(&mutex_);
     }
 
     ~Histogram() {
       free(histogram_);
+      for (int i = 0; i < INTERVAL_READER_COUNT; ++i) {
+        free(interval_histograms_[i]);
+      }
       uv_mutex_destroy(&mutex_);
     }
 
@@ -301,12 +327,41 @@ public:
       histograms_[thread_state_->current_thread_id()].record_value(value);
     }
 
+    int significant_figures() const { return significant_figures_; }
+
     void get_snapshot(Snapshot* snapshot) const {
       ScopedMutex l(&mutex_);
-      hdr_histogram* h = histogram_;
-      for (size_t i = 0; i < thread_state_->max_threads(); ++i) {
-        histograms_[i].add(h);
-      }
+      merge();
+      get_snapshot(histogram_, snapshot);
+    }
+
+    // Adds all the values recorded by this histogram to another histogram
+    void add_to(hdr_histogram* to) const {
+      ScopedMutex l(&mutex_);
+      merge();
+      hdr_add(to, histogram_);
+    }
+
+    // Gets a snapshot of the values recorded since the reader's previous
+    // interval and starts a new interval. The first interval of a reader
+    // includes all the values recorded since the histogram was created.
+    void get_interval_snapshot(IntervalReader reader, Snapshot* snapshot) const {
+      ScopedMutex l(&mutex_);
+      hdr_histogram* interval = interval_histogram(reader);
+      get_snapshot(interval, snapshot);
+      hdr_reset(interval);
+    }
+
+    // Same as get_interval_snapshot(), but moves the interval's values into
+    // another histogram. The histogram must have the same precision.
+    void take_interval(IntervalReader reader, hdr_histogram* to) const {
+      ScopedMutex l(&mutex_);
+      hdr_histogram* interval = interval_histogram(reader);
+      hdr_add(to, interval);
+      hdr_reset(interval);
+    }
+
+    static void get_snapshot(hdr_histogram* h, Snapshot* snapshot) {
       snapshot->min = hdr_min(h);
       snapshot->max = hdr_max(h);
       snapshot->mean = static_cast<int64_t>(hdr_mean(h));
@@ -320,11 +375,40 @@ public:
     }
 
   private:
+    // Must be called with the mutex held
+    void merge() const {
+      for (size_t i = 0; i < thread_state_->max_threads(); ++i) {
+        histograms_[i].add(histogram_, interval_histograms_);
+      }
+    }
+
+    // Must be called with the mutex held
+    hdr_histogram* interval_histogram(IntervalReader reader) const {
+      merge();
+      hdr_histogram*& interval = interval_histograms_[reader];
+      if (interval == NULL) {
+        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, significant_figures_, &interval);
+        hdr_add(interval, histogram_);
+      }
+      return interval;
+    }
+
+    static void add_to_intervals(hdr_histogram* from, hdr_histogram* const* intervals) {
+      for (int i = 0; i < INTERVAL_READER_COUNT; ++i) {
+        if (intervals[i] != NULL) {
+          hdr_add(intervals[i], from);
+        }
+      }
+    }
+
 #if UV_VERSION_MAJOR == 0
     class PerThreadHistogram {
     public:
-      PerThreadHistogram() {
-        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, 3, &histogram_);
+      PerThreadHistogram()
+        : histogram_(NULL) {}
+
+      void init(int significant_figures) {
+        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, significant_figures, &histogram_);
       }
 
       ~PerThreadHistogram() {
@@ -336,8 +420,10 @@ public:
 
       }
 
-      void add(hdr_histogram* to) {
+      void add(hdr_histogram* to, hdr_histogram* const* intervals) {
         hdr_add(to, histogram_);
+        add_to_intervals(histogram_, intervals);
+        hdr_reset(histogram_);
       }
 
     private:
@@ -406,8 +492,13 @@ public:
     public:
       PerThreadHistogram()
         : active_index_(0) {
-        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, 3, &histograms_[0]);
-        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, 3, &histograms_[1]);
+        histograms_[0] = NULL;
+        histograms_[1] = NULL;
+      }
+
+      void init(int significant_figures) {
+        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, significant_figures, &histograms_[0]);
+        hdr_init(1LL, HIGHEST_TRACKABLE_VALUE, significant_figures, &histograms_[1]);
       }
 
       ~PerThreadHistogram() {
@@ -422,11 +513,15 @@ public:
         phaser_.writer_critical_section_end(critical_value_enter);
       }
 
-      void add(hdr_histogram* to) {
+      void add(hdr_histogram* to, hdr_histogram* const* intervals) {
         int inactive_index = active_index_.exchange(!active_index_.load());
         hdr_histogram* from = histograms_[inactive_index];
         phaser_.flip_phase();
         hdr_add(to, from);
+        add_to_intervals(from, intervals);
+        // The values have been moved so they're not added again the next
+        // time this histogram is inactive
+        hdr_reset(from);
       }
 
     private:
@@ -437,15 +532,17 @@ public:
 #endif
 
     ThreadState* thread_state_;
+    const int significant_figures_;
     ScopedPtr<PerThreadHistogram[]> histograms_;
     hdr_histogram* histogram_;
+    mutable hdr_histogram* interval_histograms_[INTERVAL_READER_COUNT];
     mutable uv_mutex_t mutex_;
 
   private:
     DISALLOW_COPY_AND_ASSIGN(Histogram);
   };
 
-  Metrics(size_t max_threads)
+  Metrics(size_t max_threads, int host_metrics_significant_figures = 0)
   // Note: For best performance use libuv 1.X!
 
   // libuv 0.10.X doesn't support thread-local variables so that means
@@ -460,12 +557,17 @@ public:
 #else
     : thread_state_(max_threads)
 #endif
+    , host_metrics_significant_figures_(host_metrics_significant_figures)
     , request_latencies(&thread_state_)
     , request_rates(&thread_state_)
     , total_connections(&thread_state_)
     , available_connections(&thread_state_)
     , exceeded_pending_requests_water_mark(&thread_state_)
     , exceeded_write_bytes_water_mark(&thread_state_)
+    , draining_connections(&thread_state_)
+    , connections_scaled_up(&thread_state_)
+    , connections_scaled_down(&thread_state_)
+    , concurrency_limit(&thread_state_)
     , connection_timeouts(&thread_state_)
     , pending_request_timeouts(&thread_state_)
     , request_timeouts(&thread_state_) {}
@@ -476,8 +578,48 @@ public:
     request_rates.mark();
   }
 
+  // The per-phase latency histograms are only allocated when latency
+  // breakdowns are enabled
+  void enable_latency_breakdown() {
+    for (int i = 0; i < LatencyBreakdown::PHASE_COUNT; ++i) {
+      phase_latencies_[i].reset(new Histogram(&thread_state_));
+    }
+  }
+
+  bool is_latency_breakdown_enabled() const {
+    return phase_latencies_[0];
+  }
+
+  const Histogram* phase_latencies(LatencyBreakdown::Phase phase) const {
+    return phase_latencies_[phase].get();
+  }
+
+  void record_latency_breakdown(const LatencyBreakdown& latency_breakdown) {
+    if (!is_latency_breakdown_enabled()) return;
+    for (int i = 0; i < LatencyBreakdown::PHASE_COUNT; ++i) {
+      LatencyBreakdown::Phase phase = static_cast<LatencyBreakdown::Phase>(i);
+      // Failed requests can stop before a phase, don't count it as 0
+      if (!latency_breakdown.is_phase_reached(phase)) continue;
+      // Final measurement is in microseconds
+      phase_latencies_[i]->record_value(latency_breakdown.phase_ns(phase) / 1000);
+    }
+  }
+
+  bool is_host_metrics_enabled() const {
+    return host_metrics_significant_figures_ > 0;
+  }
+
+  // Returns the host's metrics, creating them on first use. Returns NULL if
+  // per-host metrics are disabled.
+  HostMetrics* host_metrics(const Host* host);
+
+  void record_host_request(const Host* host, uint64_t latency_ns);
+  void record_host_error(const Host* host);
+
 private:
   ThreadState thread_state_;
+  const int host_metrics_significant_figures_;
+  ScopedPtr<Histogram> phase_latencies_[LatencyBreakdown::PHASE_COUNT];
 
 public:
   Histogram request_latencies;
@@ -488,6 +630,11 @@ public:
   Counter exceeded_pending_requests_water_mark;
   Counter exceeded_write_bytes_water_mark;
 
+  Counter draining_connections;
+  Counter connections_scaled_up;
+  Counter connections_scaled_down;
+  Counter concurrency_limit;
+
   Counter connection_timeouts;
   Counter pending_request_timeouts;
   Counter request_timeouts;
@@ -496,6 +643,54 @@ private:
   DISALLOW_COPY_AND_ASSIGN(Metrics);
 };
 
+// Request latencies and rates for a single host. These are only allocated
+// for hosts that are actually sent requests and use the precision set by
+// cass_cluster_set_host_metrics_significant_figures() to bound their size.
+class HostMetrics {
+public:
+  HostMetrics(Metrics::ThreadState* thread_state, int significant_figures)
+    : request_latencies(thread_state, significant_figures)
+    , request_rates(thread_state)
+    , error_rates(thread_state) {}
+
+  Metrics::Histogram request_latencies;
+  Metrics::Meter request_rates;
+  Metrics::Meter error_rates;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(HostMetrics);
+};
+
+inline HostMetrics* Metrics::host_metrics(const Host* host) {
+  if (!is_host_metrics_enabled()) return NULL;
+  HostMetrics* metrics = host->metrics();
+  if (metrics == NULL) {
+    metrics = new HostMetrics(&thread_state_, host_metrics_significant_figures_);
+    if (!host->set_metrics(metrics)) {
+      // Another thread created the host's metrics first
+      delete metrics;
+      metrics = host->metrics();
+    }
+  }
+  return metrics;
+}
+
+inline void Metrics::record_host_request(const Host* host, uint64_t latency_ns) {
+  HostMetrics* metrics = host_metrics(host);
+  if (metrics != NULL) {
+    // Final measurement is in microseconds
+    metrics->request_latencies.record_value(latency_ns / 1000);
+    metrics->request_rates.mark();
+  }
+}
+
+inline void Metrics::record_host_error(const Host* host) {
+  HostMetrics* metrics = host_metrics(host);
+  if (metrics != NULL) {
+    metrics->error_rates.mark();
+  }
+}
+
 } // namespace cass
 
 #endif
@@ -26,6 +26,7 @@
 #include "utils.hpp"
 #include "macros.hpp"
 
+#include <algorithm>
 #include <assert.h>
 
 namespace cass {
@@ -131,6 +132,16 @@ public:
     return (intptr_t)node_seq - (intptr_t)(pos + 1) < 0;
   }
 
+  // The number of entries in the queue. This is only an approximation when
+  // there are concurrent producers and consumers.
+  size_t size() const {
+    size_t head = head_.load(MEMORY_ORDER_ACQUIRE);
+    size_t tail = tail_.load(MEMORY_ORDER_ACQUIRE);
+    return tail > head ? std::min(tail - head, size_) : 0;
+  }
+
+  size_t capacity() const { return size_; }
+
   static void memory_fence() {
 #if defined(CASS_USE_BOOST_ATOMIC) || defined(CASS_USE_STD_ATOMIC)
     atomic_thread_fence(MEMORY_ORDER_SEQ_CST);
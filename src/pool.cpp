@@ -29,10 +29,6 @@
 
 namespace cass {
 
-static bool least_busy_comp(Connection* a, Connection* b) {
-  return a->pending_request_count() < b->pending_request_count();
-}
-
 Pool::Pool(IOWorker* io_worker,
            const Host::ConstPtr& host,
            bool is_initial_connection)
@@ -43,11 +39,23 @@ Pool::Pool(IOWorker* io_worker,
     , metrics_(io_worker->metrics())
     , state_(POOL_STATE_NEW)
     , error_code_(Connection::CONNECTION_OK)
+    , connections_request_count_(0)
     , available_connection_count_(0)
     , is_available_(false)
     , is_initial_connection_(is_initial_connection)
     , is_pending_flush_(false)
-    , cancel_reconnect_(false) { }
+    , cancel_reconnect_(false)
+    , is_low_utilization_(false)
+    , low_utilization_start_ms_(0)
+    , reported_concurrency_limit_(0) {
+  if (config_.connection_power_of_two_choices()) {
+    random_.reset(new MT19937_64(get_random_seed(MT19937_64::DEFAULT_SEED)));
+  }
+  if (config_.concurrency_limiter_settings().type != CASS_CONCURRENCY_LIMITER_NONE) {
+    limiter_.reset(new ConcurrencyLimiter(config_.concurrency_limiter_settings()));
+    update_concurrency_limit();
+  }
+}
 
 Pool::~Pool() {
   LOG_DEBUG("Pool(%p) dtor with %u pending requests",
@@ -61,6 +69,10 @@ Pool::~Pool() {
     request_handler->next_host();
     request_handler->retry();
   }
+  if (reported_concurrency_limit_ != 0) {
+    host_->add_concurrency_limit(-reported_concurrency_limit_);
+    metrics_->concurrency_limit.add(-reported_concurrency_limit_);
+  }
 }
 
 void Pool::connect() {
@@ -96,10 +108,13 @@ void Pool::close(bool cancel_reconnect) {
               host_->address_string().c_str());
 
     connect_timer.stop();
+    scale_down_timer_.stop();
 
     // We're closing before we've connected (likely because of an error), we need
-    // to notify we're "ready"
-    if (state_ == POOL_STATE_CONNECTING) {
+    // to notify we're "ready". This includes initial pools that are still
+    // waiting for the startup fan-out.
+    if (state_ == POOL_STATE_CONNECTING ||
+        (state_ == POOL_STATE_NEW && is_initial_connection_)) {
       state_ = POOL_STATE_CLOSING;
       io_worker_->notify_pool_ready(this);
     } else {
@@ -109,8 +124,8 @@ void Pool::close(bool cancel_reconnect) {
     set_is_available(false);
     cancel_reconnect_ = cancel_reconnect;
 
-    for (ConnectionVec::iterator it = connections_.begin(),
-                                 end = connections_.end();
+    for (ConnectionHeap::const_iterator it = connections_.begin(),
+                                        end = connections_.end();
          it != end; ++it) {
       (*it)->close();
     }
@@ -119,20 +134,29 @@ void Pool::close(bool cancel_reconnect) {
          it != end; ++it) {
       (*it)->close();
     }
+    for (ConnectionSet::iterator it = connections_draining_.begin(),
+                                 end = connections_draining_.end();
+         it != end; ++it) {
+      (*it)->close();
+    }
   }
 
   maybe_close();
 }
 
 Connection* Pool::borrow_connection() {
+  // Requests beyond the concurrency limit wait for in-flight requests to finish
+  if (is_limited()) {
+    return NULL;
+  }
+
   if (connections_.empty()) {
-    for (unsigned i = 0; i < config_.core_connections_per_host(); ++i) {
-      maybe_spawn_connection();
-    }
+    maybe_spawn_connection();
     return NULL;
   }
 
-  Connection* connection = find_least_busy();
+  Connection* connection = random_ ? find_least_busy_of_two()
+                                   : find_least_busy();
 
   if (connection == NULL ||
       connection->pending_request_count() >=
@@ -144,7 +168,14 @@ Connection* Pool::borrow_connection() {
 }
 
 void Pool::return_connection(Connection* connection) {
-  if (!connection->is_ready() || pending_requests_.is_empty()) return;
+  if (pending_requests_.is_empty() || is_limited()) return;
+  if (!connections_.contains(connection)) {
+    // Draining connections don't take new requests
+    if (connections_.empty()) return;
+    connection = find_least_busy();
+    if (connection == NULL) return;
+  }
+  if (!connection->is_ready()) return;
   RequestHandler* request_handler
       = static_cast<RequestHandler*>(pending_requests_.front());
   remove_pending_request(request_handler);
@@ -155,6 +186,30 @@ void Pool::return_connection(Connection* connection) {
   }
 }
 
+void Pool::release_permit(ConcurrencyLimiter::Outcome outcome, uint64_t rtt_ns) {
+  limiter_->release(outcome, rtt_ns, uv_hrtime());
+  update_concurrency_limit();
+
+  // Start the requests that were waiting on the limit
+  while (!pending_requests_.is_empty() && !is_limited() && !connections_.empty()) {
+    Connection* connection = find_least_busy();
+    if (connection == NULL) break;
+    size_t pending_count = pending_requests_.size();
+    return_connection(connection);
+    if (pending_requests_.size() == pending_count) break;
+  }
+}
+
+void Pool::update_concurrency_limit() {
+  int limit = limiter_->limit();
+  if (limit != reported_concurrency_limit_) {
+    int delta = limit - reported_concurrency_limit_;
+    host_->add_concurrency_limit(delta);
+    metrics_->concurrency_limit.add(delta);
+    reported_concurrency_limit_ = limit;
+  }
+}
+
 void Pool::add_pending_request(RequestHandler* request_handler) {
   pending_requests_.add_to_back(request_handler);
 
@@ -167,10 +222,11 @@ void Pool::add_pending_request(RequestHandler* request_handler) {
   }
 
   if (pending_requests_.size() > config_.pending_requests_high_water_mark()) {
-    LOG_WARN("Exceeded pending requests water mark (current: %u water mark: %u) for host %s",
-             static_cast<unsigned int>(pending_requests_.size()),
-             config_.pending_requests_high_water_mark(),
-             host_->address_string().c_str());
+    LOG_WARN_RATELIMITED(1000, 10,
+                         "Exceeded pending requests water mark (current: %u water mark: %u) for host %s",
+                         static_cast<unsigned int>(pending_requests_.size()),
+                         config_.pending_requests_high_water_mark(),
+                         host_->address_string().c_str());
     set_is_available(false);
     metrics_->exceeded_pending_requests_water_mark.inc();
   }
@@ -213,6 +269,10 @@ bool Pool::write(Connection* connection, RequestHandler* request_handler) {
       return false;
     }
   }
+  if (limiter_) {
+    limiter_->acquire();
+    request_handler->set_has_permit(true);
+  }
   if (!is_pending_flush_) {
     io_worker_->add_pending_flush(this);
   }
@@ -222,10 +282,14 @@ bool Pool::write(Connection* connection, RequestHandler* request_handler) {
 
 void Pool::flush() {
   is_pending_flush_ = false;
-  for (ConnectionVec::iterator it = connections_.begin(),
+  for (ConnectionHeap::const_iterator it = connections_.begin(),
        end = connections_.end(); it != end; ++it) {
     (*it)->flush();
   }
+  for (ConnectionSet::iterator it = connections_draining_.begin(),
+       end = connections_draining_.end(); it != end; ++it) {
+    (*it)->flush();
+  }
 }
 
 void Pool::maybe_notify_ready() {
@@ -242,7 +306,7 @@ void Pool::maybe_notify_ready() {
 
 void Pool::maybe_close() {
   if (state_ == POOL_STATE_CLOSING && connections_.empty() &&
-      connections_pending_.empty()) {
+      connections_pending_.empty() && connections_draining_.empty()) {
 
     LOG_DEBUG("Pool(%p) closed connections to host %s",
               static_cast<void*>(this),
@@ -271,12 +335,14 @@ void Pool::spawn_connection() {
 }
 
 void Pool::maybe_spawn_connection() {
-  if (connections_pending_.size() >= config_.max_concurrent_creation()) {
+  size_t max_creation = config_.max_concurrent_creation();
+  if (connections_pending_.size() >= max_creation) {
     return;
   }
 
-  if (connections_.size() + connections_pending_.size() >=
-      config_.max_connections_per_host()) {
+  size_t current = connections_.size() + connections_pending_.size();
+  size_t max_connections = config_.max_connections_per_host();
+  if (current >= max_connections) {
     return;
   }
 
@@ -284,24 +350,125 @@ void Pool::maybe_spawn_connection() {
     return;
   }
 
-  spawn_connection();
+  // Grow the pool to the number of connections required to keep the in-flight
+  // and queued requests below the threshold on each connection. Connections
+  // are created in parallel, bounded by the max concurrent creation setting.
+  size_t wanted = request_demand() / config_.max_concurrent_requests_threshold() + 1;
+  wanted = std::max(wanted, static_cast<size_t>(config_.core_connections_per_host()));
+  wanted = std::min(wanted, max_connections);
+
+  size_t count = wanted > current ? wanted - current : 1;
+  count = std::min(count, max_creation - connections_pending_.size());
+
+  for (size_t i = 0; i < count; ++i) {
+    spawn_connection();
+    if (current + i >= config_.core_connections_per_host()) {
+      metrics_->connections_scaled_up.inc();
+    }
+  }
+}
+
+void Pool::maybe_start_scale_down_timer() {
+  unsigned window_ms = config_.connection_scale_down_window_ms();
+  if (window_ms == 0 ||
+      state_ != POOL_STATE_READY ||
+      scale_down_timer_.is_running() ||
+      connections_.size() <= config_.core_connections_per_host()) {
+    return;
+  }
+
+  // Sample the pool's utilization several times per window
+  scale_down_timer_.start(loop_,
+                          std::max(window_ms / 10, 1u),
+                          this, on_scale_down);
+}
+
+void Pool::maybe_scale_down() {
+  if (state_ != POOL_STATE_READY ||
+      connections_.size() <= config_.core_connections_per_host()) {
+    is_low_utilization_ = false;
+    return;
+  }
+
+  // The pool is considered lightly loaded when its requests would fit on one
+  // less connection with each connection at less than half the threshold.
+  // This leaves headroom so that the pool doesn't immediately grow again.
+  size_t capacity = (connections_.size() - 1) *
+                    config_.max_concurrent_requests_threshold();
+  uint64_t now = uv_now(loop_);
+  if (request_demand() * 2 < capacity) {
+    if (!is_low_utilization_) {
+      is_low_utilization_ = true;
+      low_utilization_start_ms_ = now;
+    } else if (now - low_utilization_start_ms_ >=
+               config_.connection_scale_down_window_ms()) {
+      drain_connection(connections_.top());
+      low_utilization_start_ms_ = now;
+    }
+  } else {
+    is_low_utilization_ = false;
+  }
+
+  maybe_start_scale_down_timer();
+}
+
+void Pool::drain_connection(Connection* connection) {
+  LOG_DEBUG("Draining connection(%p) to host %s for pool(%p) because of low utilization",
+            static_cast<void*>(connection),
+            host_->address_string().c_str(),
+            static_cast<void*>(this));
+
+  connections_.remove(connection);
+  connections_request_count_ -= connection->pending_request_count();
+  connections_draining_.insert(connection);
+  metrics_->draining_connections.inc();
+  metrics_->connections_scaled_down.inc();
+
+  if (connection->pending_request_count() == 0) {
+    connection->close();
+  }
 }
 
 Connection* Pool::find_least_busy() {
-  ConnectionVec::iterator it = std::min_element(
-      connections_.begin(), connections_.end(), least_busy_comp);
-  if ((*it)->is_ready() && (*it)->available_streams() > 0) {
-    return *it;
+  Connection* connection = connections_.top();
+  if (connection->is_ready() && connection->available_streams() > 0) {
+    return connection;
   }
   return NULL;
 }
 
+Connection* Pool::find_least_busy_of_two() {
+  size_t size = connections_.size();
+  if (size < 3) {
+    return find_least_busy();
+  }
+
+  // Power of two choices: pick the less busy of two random connections. This
+  // spreads requests over connections with similar in-flight counts instead
+  // of always favoring the connection at the top of the heap.
+  size_t first = static_cast<size_t>((*random_)() % size);
+  size_t second = static_cast<size_t>((*random_)() % (size - 1));
+  if (second >= first) ++second;
+
+  Connection* connection = connections_[first];
+  if (connections_[second]->pending_request_count() <
+      connection->pending_request_count()) {
+    connection = connections_[second];
+  }
+  if (connection->is_ready() && connection->available_streams() > 0) {
+    return connection;
+  }
+  return find_least_busy();
+}
+
 void Pool::on_ready(Connection* connection) {
   connections_pending_.erase(connection);
-  connections_.push_back(connection);
+  connections_.push(connection);
+  connections_request_count_ += connection->pending_request_count();
   return_connection(connection);
 
   maybe_notify_ready();
+  maybe_start_scale_down_timer();
 
   metrics_->total_connections.inc();
 }
@@ -309,11 +476,12 @@ void Pool::on_ready(Connection* connection) {
 void Pool::on_close(Connection* connection) {
   connections_pending_.erase(connection);
 
-  ConnectionVec::iterator it =
-      std::find(connections_.begin(), connections_.end(), connection);
-  if (it != connections_.end()) {
-    connections_.erase(it);
+  if (connections_.remove(connection)) {
+    connections_request_count_ -= connection->pending_request_count();
     metrics_->total_connections.dec();
+  } else if (connections_draining_.erase(connection) > 0) {
+    metrics_->total_connections.dec();
+    metrics_->draining_connections.dec();
   }
 
   // For timeouts, if there are any valid connections left then don't close the
@@ -376,6 +544,16 @@ void Pool::on_availability_change(Connection* connection) {
   }
 }
 
+void Pool::on_pending_request_count_change(Connection* connection, int delta) {
+  if (connections_.contains(connection)) {
+    connections_request_count_ += delta;
+    connections_.update(connection);
+  } else if (connection->pending_request_count() == 0 &&
+             connections_draining_.count(connection) > 0) {
+    connection->close();
+  }
+}
+
 void Pool::on_pending_request_timeout(Timer* timer) {
   RequestHandler* request_handler = static_cast<RequestHandler*>(timer->data());
   Pool* pool = request_handler->pool();
@@ -419,4 +597,9 @@ void Pool::on_wait_to_connect(Timer* timer) {
   pool->connect();
 }
 
+void Pool::on_scale_down(Timer* timer) {
+  Pool* pool = static_cast<Pool*>(timer->data());
+  pool->maybe_scale_down();
+}
+
 } // namespace cass
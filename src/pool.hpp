@@ -18,9 +18,12 @@
 #define __CASS_POOL_HPP_INCLUDED__
 
 #include "cassandra.h"
+#include "concurrency_limiter.hpp"
 #include "connection.hpp"
+#include "heap.hpp"
 #include "host.hpp"
 #include "metrics.hpp"
+#include "random.hpp"
 #include "ref_counted.hpp"
 #include "request.hpp"
 #include "request_handler.hpp"
@@ -68,6 +71,7 @@ public:
   const Host::ConstPtr& host() const { return host_; }
 
   bool is_initial_connection() const { return is_initial_connection_; }
+  bool is_new() const { return state_ == POOL_STATE_NEW; }
   bool is_ready() const { return state_ == POOL_STATE_READY; }
   bool is_keyspace_error() const {
     return error_code_ == Connection::CONNECTION_ERROR_KEYSPACE;
@@ -83,6 +87,8 @@ public:
 
   void return_connection(Connection* connection);
 
+  void release_permit(ConcurrencyLimiter::Outcome outcome, uint64_t rtt_ns);
+
 private:
   void add_pending_request(RequestHandler* request_handler);
   void remove_pending_request(RequestHandler* request_handler);
@@ -92,22 +98,39 @@ private:
   void maybe_close();
   void spawn_connection();
   void maybe_spawn_connection();
+  void maybe_start_scale_down_timer();
+  void maybe_scale_down();
+  void drain_connection(Connection* connection);
+  size_t request_demand() const {
+    return pending_requests_.size() + connections_request_count_;
+  }
+  bool is_limited() const { return limiter_ && limiter_->is_limited(); }
+  void update_concurrency_limit();
 
   // Connection listener methods
   virtual void on_ready(Connection* connection);
   virtual void on_close(Connection* connection);
   virtual void on_availability_change(Connection* connection);
+  virtual void on_pending_request_count_change(Connection* connection, int delta);
   virtual void on_event(EventResponse* response) {}
 
   static void on_pending_request_timeout(Timer* timer);
   static void on_partial_reconnect(Timer* timer);
   static void on_wait_to_connect(Timer* timer);
+  static void on_scale_down(Timer* timer);
 
   Connection* find_least_busy();
+  Connection* find_least_busy_of_two();
 
 private:
+  struct LeastBusyCompare {
+    bool operator()(const Connection* a, const Connection* b) const {
+      return a->pending_request_count() < b->pending_request_count();
+    }
+  };
+
   typedef std::set<Connection*> ConnectionSet;
-  typedef std::vector<Connection*> ConnectionVec;
+  typedef Heap<Connection, LeastBusyCompare> ConnectionHeap;
 
   IOWorker* io_worker_;
   Host::ConstPtr host_;
@@ -117,8 +140,14 @@ private:
 
   PoolState state_;
   Connection::ConnectionError error_code_;
-  ConnectionVec connections_;
+  // Ready connections ordered by their number of in-flight requests
+  ConnectionHeap connections_;
+  // The sum of the in-flight requests on the ready connections
+  size_t connections_request_count_;
   ConnectionSet connections_pending_;
+  // Surplus connections that no longer take new requests and are closed
+  // once their in-flight requests finish
+  ConnectionSet connections_draining_;
   List<Handler> pending_requests_;
   int available_connection_count_;
   bool is_available_;
@@ -127,6 +156,12 @@ private:
   bool cancel_reconnect_;
 
   Timer connect_timer;
+  Timer scale_down_timer_;
+  bool is_low_utilization_;
+  uint64_t low_utilization_start_ms_;
+  ScopedPtr<MT19937_64> random_;
+  ScopedPtr<ConcurrencyLimiter> limiter_;
+  int reported_concurrency_limit_;
 };
 
 } // namespace cass
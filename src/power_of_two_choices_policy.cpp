@@ -0,0 +1,107 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "power_of_two_choices_policy.hpp"
+
+#include <uv.h>
+
+#include <algorithm>
+
+namespace cass {
+
+static const CopyOnWriteHostVec NO_REPLICAS(new HostVec());
+
+static inline bool contains(const CopyOnWriteHostVec& replicas, const Host* host) {
+  for (HostVec::const_iterator i = replicas->begin(),
+       end = replicas->end(); i != end; ++i) {
+    if (i->get() == host) {
+      return true;
+    }
+  }
+  return false;
+}
+
+QueryPlan* PowerOfTwoChoicesPolicy::new_query_plan(const std::string& connected_keyspace,
+                                                   const Request* request,
+                                                   const TokenMap& token_map,
+                                                   Request::EncodingCache* cache) {
+  // The replicas are computed once by a token-aware child plan
+  QueryPlan* child_plan = child_policy_->new_query_plan(connected_keyspace, request, token_map, cache);
+  const CopyOnWriteHostVec* child_replicas = child_plan->replicas();
+  const CopyOnWriteHostVec& replicas = child_replicas != NULL ? *child_replicas
+                                                              : NO_REPLICAS;
+
+  // Collect the leading hosts that can be swapped for the first host and the
+  // first host that can't
+  HostVec hosts;
+  size_t count = 0;
+  SharedRefPtr<Host> host(child_plan->compute_next());
+  if (host) {
+    hosts.push_back(host);
+    count = 1;
+    if (child_policy_->distance(host) == CASS_HOST_DISTANCE_LOCAL) {
+      bool is_replica = contains(replicas, host.get());
+      while ((host = child_plan->compute_next())) {
+        hosts.push_back(host);
+        if (child_policy_->distance(host) != CASS_HOST_DISTANCE_LOCAL ||
+            contains(replicas, host.get()) != is_replica) {
+          break;
+        }
+        ++count;
+      }
+    }
+  }
+
+  if (count > 1) {
+    size_t first = static_cast<size_t>(random_() % count);
+    size_t second = static_cast<size_t>(random_() % (count - 1));
+    if (second >= first) ++second;
+
+    uint64_t now_ns = uv_hrtime();
+    size_t chosen = is_less_busy(hosts[second], hosts[first], now_ns) ? second : first;
+
+    // Move the chosen host to the front and keep the order of the others
+    std::rotate(hosts.begin(), hosts.begin() + chosen, hosts.begin() + chosen + 1);
+  }
+
+  return new PowerOfTwoChoicesQueryPlan(child_plan, hosts);
+}
+
+SharedRefPtr<Host> PowerOfTwoChoicesPolicy::PowerOfTwoChoicesQueryPlan::compute_next() {
+  if (index_ < hosts_.size()) {
+    return hosts_[index_++];
+  }
+  return child_plan_->compute_next();
+}
+
+bool PowerOfTwoChoicesPolicy::is_less_busy(const SharedRefPtr<Host>& a,
+                                           const SharedRefPtr<Host>& b,
+                                           uint64_t now_ns) const {
+  bool is_a_backing_off = is_backing_off(a, now_ns);
+  if (is_a_backing_off != is_backing_off(b, now_ns)) {
+    return !is_a_backing_off;
+  }
+  return a->inflight_request_count() < b->inflight_request_count();
+}
+
+bool PowerOfTwoChoicesPolicy::is_backing_off(const SharedRefPtr<Host>& host,
+                                             uint64_t now_ns) const {
+  uint64_t last_error_time_ns = host->last_error_time_ns();
+  return last_error_time_ns != 0 &&
+      now_ns - last_error_time_ns < error_backoff_ns_;
+}
+
+} // namespace cass
@@ -0,0 +1,86 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_POWER_OF_TWO_CHOICES_POLICY_HPP_INCLUDED__
+#define __CASS_POWER_OF_TWO_CHOICES_POLICY_HPP_INCLUDED__
+
+#include "load_balancing.hpp"
+#include "host.hpp"
+#include "macros.hpp"
+#include "random.hpp"
+#include "scoped_ptr.hpp"
+
+namespace cass {
+
+// Picks two random hosts from the leading hosts of the child policy's query
+// plan that can be swapped for its first host and tries the one with fewer
+// in-flight requests first. The rest of the plan keeps the child policy's
+// order. Only local hosts are swapped and, when the child policy is token
+// aware, a replica is never swapped for a non-replica. Hosts that returned a
+// load-related error within the backoff period lose to hosts that didn't.
+// Query plans are only created on the session's thread.
+class PowerOfTwoChoicesPolicy : public ChainedLoadBalancingPolicy {
+public:
+  PowerOfTwoChoicesPolicy(LoadBalancingPolicy* child_policy,
+                          uint64_t error_backoff_ns)
+    : ChainedLoadBalancingPolicy(child_policy)
+    , error_backoff_ns_(error_backoff_ns)
+    , random_(get_random_seed(MT19937_64::DEFAULT_SEED)) {}
+
+  virtual ~PowerOfTwoChoicesPolicy() {}
+
+  virtual QueryPlan* new_query_plan(const std::string& connected_keyspace,
+                                    const Request* request,
+                                    const TokenMap& token_map,
+                                    Request::EncodingCache* cache);
+
+  LoadBalancingPolicy* new_instance() {
+    return new PowerOfTwoChoicesPolicy(child_policy_->new_instance(),
+                                       error_backoff_ns_);
+  }
+
+private:
+  class PowerOfTwoChoicesQueryPlan : public QueryPlan {
+  public:
+    // The hosts are returned before the rest of the child plan
+    PowerOfTwoChoicesQueryPlan(QueryPlan* child_plan, const HostVec& hosts)
+      : child_plan_(child_plan)
+      , hosts_(hosts)
+      , index_(0) {}
+
+    SharedRefPtr<Host> compute_next();
+
+  private:
+    ScopedPtr<QueryPlan> child_plan_;
+    HostVec hosts_;
+    size_t index_;
+  };
+
+  bool is_less_busy(const SharedRefPtr<Host>& a,
+                    const SharedRefPtr<Host>& b,
+                    uint64_t now_ns) const;
+  bool is_backing_off(const SharedRefPtr<Host>& host, uint64_t now_ns) const;
+
+  uint64_t error_backoff_ns_;
+  MT19937_64 random_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(PowerOfTwoChoicesPolicy);
+};
+
+} // namespace cass
+
+#endif
@@ -60,6 +60,8 @@ public:
     , query_(query, query_length)
     , value_names_(value_count) { }
 
+  const std::string& query() const { return query_; }
+
   virtual int32_t encode_batch(int version, BufferVec* bufs, Handler* handler) const;
 
 private:
@@ -19,6 +19,7 @@
 
 #include "atomic.hpp"
 #include "macros.hpp"
+#include "memory_budget.hpp"
 
 #include <assert.h>
 #include <new>
@@ -56,34 +57,57 @@ private:
   DISALLOW_COPY_AND_ASSIGN(RefCounted);
 };
 
+// The size of the buffer is accounted in MemoryBudget under its category
 class RefBuffer : public RefCounted<RefBuffer> {
 public:
-  static RefBuffer* create(size_t size) {
+  static RefBuffer* create(size_t size, MemoryBudget::Category category) {
 #if defined(_WIN32)
 #pragma warning(push)
 #pragma warning(disable: 4291) //Invalid warning thrown RefBuffer has a delete function
 #endif
-    return new (size) RefBuffer();
+    return new (size) RefBuffer(size, category);
 #if defined(_WIN32)
 #pragma warning(pop)
 #endif
   }
 
+  ~RefBuffer() {
+    MemoryBudget::remove(category_, size_);
+  }
+
   char* data() {
     return reinterpret_cast<char*>(this) + sizeof(RefBuffer);
   }
 
+  // Moves the accounting of the buffer to another category (e.g. a response
+  // that's kept by the schema metadata). This must not be called
+  // concurrently with the buffer being released.
+  void set_category(MemoryBudget::Category category) {
+    if (category == category_) return;
+    MemoryBudget::remove(category_, size_);
+    MemoryBudget::add(category, size_);
+    category_ = category;
+  }
+
   void operator delete(void* ptr) {
     ::operator delete(ptr);
   }
 
 private:
-  RefBuffer() {}
+  RefBuffer(size_t size, MemoryBudget::Category category)
+    : size_(size)
+    , category_(category) {
+    MemoryBudget::add(category_, size_);
+  }
 
   void* operator new(size_t size, size_t extra) {
     return ::operator new(size + extra);
   }
 
+  size_t size_;
+  MemoryBudget::Category category_;
+
+private:
   DISALLOW_COPY_AND_ASSIGN(RefBuffer);
 };
 
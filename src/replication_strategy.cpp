@@ -24,35 +24,35 @@
 
 #include <map>
 #include <set>
+#include <sstream>
 
 namespace cass {
 
-static void build_dc_replicas(const KeyspaceMetadata& ks_meta,
+static void build_dc_replicas(const ReplicationStrategy::OptionsMap& options,
                               NetworkTopologyStrategy::DCReplicaCountMap* output) {
-  const Value* strategy_options = ks_meta.strategy_options();
-  if (strategy_options->is_map()) {
-    MapIterator iterator(strategy_options);
-    while (iterator.next()) {
-      if (iterator.key()->to_string_ref() != "class") {
-        size_t replication_factor = strtoul(iterator.value()->to_string().c_str(), NULL, 10);
-        if (replication_factor > 0) {
-          (*output)[iterator.key()->to_string()] = replication_factor;
-        }
+  for (ReplicationStrategy::OptionsMap::const_iterator i = options.begin(),
+       end = options.end(); i != end; ++i) {
+    if (i->first != "class") {
+      size_t replication_factor = strtoul(i->second.c_str(), NULL, 10);
+      if (replication_factor > 0) {
+        (*output)[i->first] = replication_factor;
       }
     }
   }
 }
 
-static size_t get_replication_factor(const KeyspaceMetadata& ks_meta) {
+static void build_dc_replicas(const KeyspaceMetadata& ks_meta,
+                              NetworkTopologyStrategy::DCReplicaCountMap* output) {
+  ReplicationStrategy::OptionsMap options;
+  ReplicationStrategy::options_from_keyspace_meta(ks_meta, &options);
+  build_dc_replicas(options, output);
+}
+
+static size_t get_replication_factor(const ReplicationStrategy::OptionsMap& options) {
   size_t replication_factor = 0;
-  const Value* strategy_options = ks_meta.strategy_options();
-  if (strategy_options->is_map()) {
-    MapIterator iterator(strategy_options);
-    while (iterator.next()) {
-      if (iterator.key()->to_string_ref() == "replication_factor") {
-        replication_factor = strtoul(iterator.value()->to_string().c_str(), NULL, 10);
-      }
-    }
+  ReplicationStrategy::OptionsMap::const_iterator i = options.find("replication_factor");
+  if (i != options.end()) {
+    replication_factor = strtoul(i->second.c_str(), NULL, 10);
   }
   if (replication_factor == 0) {
     LOG_WARN("Replication factor of 0");
@@ -60,40 +60,50 @@ static size_t get_replication_factor(const KeyspaceMetadata& ks_meta) {
   return replication_factor;
 }
 
+static size_t get_replication_factor(const KeyspaceMetadata& ks_meta) {
+  ReplicationStrategy::OptionsMap options;
+  ReplicationStrategy::options_from_keyspace_meta(ks_meta, &options);
+  return get_replication_factor(options);
+}
+
+void ReplicationStrategy::options_from_keyspace_meta(const KeyspaceMetadata& ks_meta,
+                                                     OptionsMap* output) {
+  const Value* strategy_options = ks_meta.strategy_options();
+  if (strategy_options->is_map()) {
+    MapIterator iterator(strategy_options);
+    while (iterator.next()) {
+      (*output)[iterator.key()->to_string()] = iterator.value()->to_string();
+    }
+  }
+}
 
 SharedRefPtr<ReplicationStrategy> ReplicationStrategy::from_keyspace_meta(const KeyspaceMetadata& ks_meta) {
-  StringRef strategy_class = ks_meta.strategy_class();
+  OptionsMap options;
+  options_from_keyspace_meta(ks_meta, &options);
+  return from_options(ks_meta.strategy_class().to_string(), options);
+}
 
-  SharedRefPtr<ReplicationStrategy> strategy;
+SharedRefPtr<ReplicationStrategy> ReplicationStrategy::from_options(const std::string& strategy_class,
+                                                                    const OptionsMap& options) {
   if (ends_with(strategy_class, NetworkTopologyStrategy::STRATEGY_CLASS)) {
     NetworkTopologyStrategy::DCReplicaCountMap replication_factors;
-    build_dc_replicas(ks_meta, &replication_factors);
-    return SharedRefPtr<ReplicationStrategy>(new NetworkTopologyStrategy(strategy_class.to_string(),
+    build_dc_replicas(options, &replication_factors);
+    return SharedRefPtr<ReplicationStrategy>(new NetworkTopologyStrategy(strategy_class,
                                                                          replication_factors));
   } else if (ends_with(strategy_class, SimpleStrategy::STRATEGY_CLASS)) {
-    size_t replication_factor = get_replication_factor(ks_meta);
-    return SharedRefPtr<ReplicationStrategy>(new SimpleStrategy(strategy_class.to_string(), replication_factor));
+    size_t replication_factor = get_replication_factor(options);
+    return SharedRefPtr<ReplicationStrategy>(new SimpleStrategy(strategy_class, replication_factor));
   } else {
-    return SharedRefPtr<ReplicationStrategy>(new NonReplicatedStrategy(strategy_class.to_string()));
+    return SharedRefPtr<ReplicationStrategy>(new NonReplicatedStrategy(strategy_class));
   }
 }
 
-const std::string NetworkTopologyStrategy::STRATEGY_CLASS("NetworkTopologyStrategy");
-
-bool NetworkTopologyStrategy::equal(const KeyspaceMetadata& ks_meta) {
-  if (ks_meta.strategy_class() != strategy_class_) return false;
-  DCReplicaCountMap temp_rfs;
-  build_dc_replicas(ks_meta, &temp_rfs);
-  return replication_factors_ == temp_rfs;
-}
-
-typedef std::map<std::string, std::set<std::string> > DCRackMap;
-static DCRackMap racks_in_dcs(const TokenHostMap& token_hosts) {
+DCRackMap racks_in_dcs(const TokenHostMap& token_hosts) {
   DCRackMap racks;
   for (TokenHostMap::const_iterator i = token_hosts.begin();
        i != token_hosts.end(); ++i) {
-    const std::string& dc = i->second->dc();
-    const std::string& rack = i->second->rack();
+    const std::string& dc = i->second.dc;
+    const std::string& rack = i->second.rack;
     if (!dc.empty() &&  !rack.empty()) {
       racks[dc].insert(rack);
     }
@@ -101,102 +111,222 @@ static DCRackMap racks_in_dcs(const TokenHostMap& token_hosts) {
   return racks;
 }
 
-void NetworkTopologyStrategy::tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const {
+void ReplicationStrategy::tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const {
   DCRackMap racks = racks_in_dcs(primary);
 
   output->clear();
 
   for (TokenHostMap::const_iterator i = primary.begin(); i != primary.end(); ++i) {
-    DCReplicaCountMap replica_counts;
-    std::map<std::string, std::set<std::string> > racks_observed;
-    std::map<std::string, std::list<SharedRefPtr<Host> > > skipped_endpoints;
-
     CopyOnWriteHostVec replicas(new HostVec());
-    TokenHostMap::const_iterator j = i;
-    for (size_t count = 0; count < primary.size() && replica_counts != replication_factors_; ++count) {
-      const SharedRefPtr<Host>& host = j->second;
-      const std::string& dc = host->dc();
-
-      ++j;
-      if (j == primary.end()) {
-        j = primary.begin();
-      }
+    token_to_replicas(primary, racks, i, &(*replicas));
+    output->insert(std::make_pair(i->first, replicas));
+  }
+}
 
-      DCReplicaCountMap::const_iterator rf_it =  replication_factors_.find(dc);
-      if (dc.empty() || rf_it == replication_factors_.end()) {
-        continue;
-      }
+void ReplicationStrategy::update_tokens_to_replicas(const TokenHostMap& primary,
+                                                    const TokenVec& changed_tokens,
+                                                    TokenReplicaMap* output) const {
+  if (primary.empty()) {
+    output->clear();
+    return;
+  }
+
+  DCRackMap racks = racks_in_dcs(primary);
+
+  // The walk lengths of the tokens that have already been recomputed
+  std::map<Token, size_t> walk_lengths;
+
+  for (TokenVec::const_iterator it = changed_tokens.begin(),
+       end = changed_tokens.end(); it != end; ++it) {
+    TokenHostMap::const_iterator i = primary.lower_bound(*it);
+    size_t distance = 0;
+
+    if (i == primary.end() || i->first != *it) {
+      // The token was removed so the walks of the tokens before it no longer
+      // visit it and continue on to the next token
+      output->erase(*it);
+      if (i == primary.begin()) i = primary.end();
+      --i;
+      distance = 1;
+    }
 
-      const size_t rf = rf_it->second;
-      size_t& replica_count_this_dc = replica_counts[dc];
-      if (replica_count_this_dc >= rf) {
-        continue;
+    // The walk from a token can only reach the change if the walk from the
+    // token after it does. Walk backwards until a token's walk stops short
+    // of the change.
+    for (size_t count = 0; count < primary.size(); ++count, ++distance) {
+      size_t walk_length;
+      std::map<Token, size_t>::const_iterator walk_it = walk_lengths.find(i->first);
+      if (walk_it != walk_lengths.end()) {
+        walk_length = walk_it->second;
+      } else {
+        CopyOnWriteHostVec replicas(new HostVec());
+        walk_length = token_to_replicas(primary, racks, i, &(*replicas));
+        walk_lengths[i->first] = walk_length;
+
+        TokenReplicaMap::iterator replicas_it = output->find(i->first);
+        if (replicas_it != output->end()) {
+          replicas_it->second = replicas;
+        } else {
+          output->insert(std::make_pair(i->first, replicas));
+        }
       }
 
-      const size_t rack_count_this_dc = racks[dc].size();
-      std::set<std::string>& racks_observed_this_dc = racks_observed[dc];
-      const std::string& rack = host->rack();
+      if (walk_length <= distance) break;
+
+      if (i == primary.begin()) i = primary.end();
+      --i;
+    }
+  }
+}
+
+const std::string NetworkTopologyStrategy::STRATEGY_CLASS("NetworkTopologyStrategy");
+
+NetworkTopologyStrategy::NetworkTopologyStrategy(const std::string& strategy_class,
+                                                 const DCReplicaCountMap& replication_factors)
+  : ReplicationStrategy(strategy_class)
+  , replication_factors_(replication_factors) {
+  std::ostringstream ss;
+  ss << STRATEGY_CLASS << "{";
+  for (DCReplicaCountMap::const_iterator i = replication_factors_.begin(),
+       end = replication_factors_.end(); i != end; ++i) {
+    if (i != replication_factors_.begin()) ss << ",";
+    ss << i->first << ":" << i->second;
+  }
+  ss << "}";
+  key_ = ss.str();
+}
+
+bool NetworkTopologyStrategy::equal(const KeyspaceMetadata& ks_meta) {
+  if (ks_meta.strategy_class() != strategy_class_) return false;
+  DCReplicaCountMap temp_rfs;
+  build_dc_replicas(ks_meta, &temp_rfs);
+  return replication_factors_ == temp_rfs;
+}
+
+size_t NetworkTopologyStrategy::token_to_replicas(const TokenHostMap& primary,
+                                                  const DCRackMap& racks,
+                                                  TokenHostMap::const_iterator i,
+                                                  HostVec* replicas) const {
+  DCReplicaCountMap replica_counts;
+  std::map<std::string, std::set<std::string> > racks_observed;
+  std::map<std::string, std::list<SharedRefPtr<Host> > > skipped_endpoints;
+
+  TokenHostMap::const_iterator j = i;
+  size_t count = 0;
+  for (; count < primary.size() && replica_counts != replication_factors_; ++count) {
+    const SharedRefPtr<Host>& host = j->second.host;
+    const std::string& dc = j->second.dc;
+    const std::string& rack = j->second.rack;
+
+    ++j;
+    if (j == primary.end()) {
+      j = primary.begin();
+    }
+
+    DCReplicaCountMap::const_iterator rf_it =  replication_factors_.find(dc);
+    if (dc.empty() || rf_it == replication_factors_.end()) {
+      continue;
+    }
+
+    const size_t rf = rf_it->second;
+    size_t& replica_count_this_dc = replica_counts[dc];
+    if (replica_count_this_dc >= rf) {
+      continue;
+    }
+
+    DCRackMap::const_iterator racks_it = racks.find(dc);
+    const size_t rack_count_this_dc = racks_it != racks.end() ? racks_it->second.size() : 0;
+    std::set<std::string>& racks_observed_this_dc = racks_observed[dc];
 
-      if (rack.empty() || racks_observed_this_dc.size() == rack_count_this_dc) {
+    if (rack.empty() || racks_observed_this_dc.size() == rack_count_this_dc) {
+      ++replica_count_this_dc;
+      replicas->push_back(host);
+    } else {
+      if (racks_observed_this_dc.count(rack) > 0) {
+        skipped_endpoints[dc].push_back(host);
+      } else {
         ++replica_count_this_dc;
         replicas->push_back(host);
-      } else {
-        if (racks_observed_this_dc.count(rack) > 0) {
-          skipped_endpoints[dc].push_back(host);
-        } else {
-          ++replica_count_this_dc;
-          replicas->push_back(host);
-          racks_observed_this_dc.insert(rack);
-
-          if (racks_observed_this_dc.size() == rack_count_this_dc) {
-            std::list<SharedRefPtr<Host> >& skipped_endpoints_this_dc = skipped_endpoints[dc];
-            while (!skipped_endpoints_this_dc.empty() && replica_count_this_dc < rf) {
-              ++replica_count_this_dc;
-              replicas->push_back(skipped_endpoints_this_dc.front());
-              skipped_endpoints_this_dc.pop_front();
-            }
+        racks_observed_this_dc.insert(rack);
+
+        if (racks_observed_this_dc.size() == rack_count_this_dc) {
+          std::list<SharedRefPtr<Host> >& skipped_endpoints_this_dc = skipped_endpoints[dc];
+          while (!skipped_endpoints_this_dc.empty() && replica_count_this_dc < rf) {
+            ++replica_count_this_dc;
+            replicas->push_back(skipped_endpoints_this_dc.front());
+            skipped_endpoints_this_dc.pop_front();
           }
         }
       }
     }
-
-    output->insert(std::make_pair(i->first, replicas));
   }
+
+  return count;
 }
 
 const std::string SimpleStrategy::STRATEGY_CLASS("SimpleStrategy");
 
+SimpleStrategy::SimpleStrategy(const std::string& strategy_class,
+                               size_t replication_factor)
+  : ReplicationStrategy(strategy_class)
+  , replication_factor_(replication_factor) {
+  std::ostringstream ss;
+  ss << STRATEGY_CLASS << "{" << replication_factor_ << "}";
+  key_ = ss.str();
+}
+
 bool SimpleStrategy::equal(const KeyspaceMetadata& ks_meta) {
   if (ks_meta.strategy_class() != strategy_class_) return false;
   return replication_factor_ == get_replication_factor(ks_meta);
 }
 
-void SimpleStrategy::tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const {
+size_t SimpleStrategy::token_to_replicas(const TokenHostMap& primary,
+                                         const DCRackMap& racks,
+                                         TokenHostMap::const_iterator i,
+                                         HostVec* replicas) const {
   size_t target_replicas = std::min<size_t>(replication_factor_, primary.size());
-  output->clear();
-  for (TokenHostMap::const_iterator i = primary.begin(); i != primary.end(); ++i) {
-    CopyOnWriteHostVec token_replicas(new HostVec());
-    TokenHostMap::const_iterator j = i;
-    do {
-      token_replicas->push_back(j->second);
-      ++j;
-      if (j == primary.end()) {
-        j = primary.begin();
-      }
-    } while (token_replicas->size() < target_replicas);
-    output->insert(std::make_pair(i->first, token_replicas));
-  }
+  TokenHostMap::const_iterator j = i;
+  do {
+    replicas->push_back(j->second.host);
+    ++j;
+    if (j == primary.end()) {
+      j = primary.begin();
+    }
+  } while (replicas->size() < target_replicas);
+  return replicas->size();
 }
 
 bool NonReplicatedStrategy::equal(const KeyspaceMetadata& ks_meta) {
   return ks_meta.strategy_class() == strategy_class_;
 }
 
-void NonReplicatedStrategy::tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const {
-  output->clear();
-  for (TokenHostMap::const_iterator i = primary.begin(); i != primary.end(); ++i) {
-    CopyOnWriteHostVec token_replicas(new HostVec(1, i->second));
-    output->insert(std::make_pair(i->first, token_replicas));
+size_t NonReplicatedStrategy::token_to_replicas(const TokenHostMap& primary,
+                                                const DCRackMap& racks,
+                                                TokenHostMap::const_iterator i,
+                                                HostVec* replicas) const {
+  replicas->push_back(i->second.host);
+  return 1;
+}
+
+CopyOnWriteHostVec ReplicaSetInterner::intern(const CopyOnWriteHostVec& replicas) {
+  HostPtrVec key;
+  key.reserve(replicas->size());
+  for (HostVec::const_iterator i = replicas->begin(),
+       end = replicas->end(); i != end; ++i) {
+    key.push_back(i->get());
+  }
+  ReplicaSetMap::iterator it = replica_sets_.find(key);
+  if (it != replica_sets_.end()) {
+    return it->second;
+  }
+  replica_sets_.insert(std::make_pair(key, replicas));
+  return replicas;
+}
+
+void ReplicaSetInterner::intern_all(TokenReplicaMap* replicas) {
+  for (TokenReplicaMap::iterator i = replicas->begin(),
+       end = replicas->end(); i != end; ++i) {
+    i->second = intern(i->second);
   }
 }
 
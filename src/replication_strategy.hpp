@@ -22,6 +22,8 @@
 #include "ref_counted.hpp"
 
 #include <map>
+#include <set>
+#include <vector>
 
 namespace cass {
 
@@ -29,22 +31,68 @@ class KeyspaceMetadata;
 class Value;
 
 typedef std::vector<uint8_t> Token;
-typedef std::map<Token, SharedRefPtr<Host> > TokenHostMap;
+
+// The host that owns a token along with the host's data center and rack as
+// of when its tokens were mapped. Replicas are computed from these copies
+// because they're computed off the session thread while the host can change.
+struct TokenHost {
+  TokenHost() { }
+  TokenHost(const SharedRefPtr<Host>& host,
+            const std::string& dc,
+            const std::string& rack)
+    : host(host)
+    , dc(dc)
+    , rack(rack) { }
+
+  SharedRefPtr<Host> host;
+  std::string dc;
+  std::string rack;
+};
+
+typedef std::map<Token, TokenHost> TokenHostMap;
 typedef std::map<Token, CopyOnWriteHostVec> TokenReplicaMap;
+typedef std::vector<Token> TokenVec;
+typedef std::map<std::string, std::set<std::string> > DCRackMap;
+
+DCRackMap racks_in_dcs(const TokenHostMap& token_hosts);
 
 class ReplicationStrategy : public RefCounted<ReplicationStrategy> {
 public:
+  typedef std::map<std::string, std::string> OptionsMap;
+
   static SharedRefPtr<ReplicationStrategy> from_keyspace_meta(const KeyspaceMetadata& ks_meta);
+  static SharedRefPtr<ReplicationStrategy> from_options(const std::string& strategy_class,
+                                                        const OptionsMap& options);
+  static void options_from_keyspace_meta(const KeyspaceMetadata& ks_meta,
+                                         OptionsMap* output);
 
   ReplicationStrategy(const std::string& strategy_class)
     : strategy_class_(strategy_class) { }
 
   virtual ~ReplicationStrategy() { }
   virtual bool equal(const KeyspaceMetadata& ks_meta) = 0;
-  virtual void tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const = 0;
+
+  void tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const;
+
+  // Only recomputes the tokens whose replica walk reaches one of the added,
+  // moved or removed tokens. The racks in each DC must not have changed.
+  void update_tokens_to_replicas(const TokenHostMap& primary,
+                                 const TokenVec& changed_tokens,
+                                 TokenReplicaMap* output) const;
+
+  // Strategies with the same key place replicas identically
+  const std::string& key() const { return key_; }
+
+protected:
+  // Returns the number of tokens visited to find the replicas of the token "i"
+  virtual size_t token_to_replicas(const TokenHostMap& primary,
+                                   const DCRackMap& racks,
+                                   TokenHostMap::const_iterator i,
+                                   HostVec* replicas) const = 0;
 
 protected:
   std::string strategy_class_;
+  std::string key_;
 };
 
 
@@ -55,14 +103,17 @@ public:
   static const std::string STRATEGY_CLASS;
 
   NetworkTopologyStrategy(const std::string& strategy_class,
-                          const DCReplicaCountMap& replication_factors)
-    : ReplicationStrategy(strategy_class)
-    , replication_factors_(replication_factors) { }
+                          const DCReplicaCountMap& replication_factors);
 
   virtual ~NetworkTopologyStrategy() { }
 
   virtual bool equal(const KeyspaceMetadata& ks_meta);
-  virtual void tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const;
+
+protected:
+  virtual size_t token_to_replicas(const TokenHostMap& primary,
+                                   const DCRackMap& racks,
+                                   TokenHostMap::const_iterator i,
+                                   HostVec* replicas) const;
 
 private:
   DCReplicaCountMap replication_factors_;
@@ -74,14 +125,17 @@ public:
   static const std::string STRATEGY_CLASS;
 
   SimpleStrategy(const std::string& strategy_class,
-                 size_t replication_factor)
-    : ReplicationStrategy(strategy_class)
-    , replication_factor_(replication_factor) { }
+                 size_t replication_factor);
 
   virtual ~SimpleStrategy() { }
 
   virtual bool equal(const KeyspaceMetadata& ks_meta);
-  virtual void tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const;
+
+protected:
+  virtual size_t token_to_replicas(const TokenHostMap& primary,
+                                   const DCRackMap& racks,
+                                   TokenHostMap::const_iterator i,
+                                   HostVec* replicas) const;
 
 private:
   size_t replication_factor_;
@@ -91,11 +145,34 @@ private:
 class NonReplicatedStrategy : public ReplicationStrategy {
 public:
   NonReplicatedStrategy(const std::string& strategy_class)
-    : ReplicationStrategy(strategy_class) { }
+    : ReplicationStrategy(strategy_class) {
+    key_ = "NonReplicatedStrategy";
+  }
   virtual ~NonReplicatedStrategy() { }
 
   virtual bool equal(const KeyspaceMetadata& ks_meta);
-  virtual void tokens_to_replicas(const TokenHostMap& primary, TokenReplicaMap* output) const;
+
+protected:
+  virtual size_t token_to_replicas(const TokenHostMap& primary,
+                                   const DCRackMap& racks,
+                                   TokenHostMap::const_iterator i,
+                                   HostVec* replicas) const;
+};
+
+// Stores each distinct replica set once so that tokens (and keyspaces)
+// with the same replicas share a single host vector
+class ReplicaSetInterner {
+public:
+  CopyOnWriteHostVec intern(const CopyOnWriteHostVec& replicas);
+
+  void intern_all(TokenReplicaMap* replicas);
+
+  size_t size() const { return replica_sets_.size(); }
+
+private:
+  typedef std::vector<const Host*> HostPtrVec;
+  typedef std::map<HostPtrVec, CopyOnWriteHostVec> ReplicaSetMap;
+  ReplicaSetMap replica_sets_;
 };
 
 } // namespace cass
@@ -45,6 +45,13 @@ public:
     items_.erase(std::string(name, name_length));
   }
 
+  bool empty() const { return items_.empty(); }
+
+  // Adds the other payload's items that aren't already in this payload
+  void merge(const CustomPayload& other) {
+    items_.insert(other.items_.begin(), other.items_.end());
+  }
+
   int32_t encode(BufferVec* bufs) const;
 
 private:
@@ -69,7 +76,8 @@ public:
       , consistency_(DEFAULT_CONSISTENCY)
       , serial_consistency_(CASS_CONSISTENCY_ANY)
       , timestamp_(CASS_INT64_MIN)
-      , request_timeout_ms_(CASS_UINT64_MAX) { } // Disabled (use the cluster-level timeout)
+      , request_timeout_ms_(CASS_UINT64_MAX) // Disabled (use the cluster-level timeout)
+      , tracing_(false) { }
 
   virtual ~Request() { }
 
@@ -95,6 +103,10 @@ public:
     request_timeout_ms_ = request_timeout_ms;
   }
 
+  bool tracing() const { return tracing_; }
+
+  void set_tracing(bool tracing) { tracing_ = tracing; }
+
   RetryPolicy* retry_policy() const {
     return retry_policy_.get();
   }
@@ -119,6 +131,7 @@ private:
   CassConsistency serial_consistency_;
   int64_t timestamp_;
   uint64_t request_timeout_ms_;
+  bool tracing_;
   SharedRefPtr<RetryPolicy> retry_policy_;
   SharedRefPtr<const CustomPayload> custom_payload_;
 
@@ -16,9 +16,11 @@
 
 #include "request_handler.hpp"
 
+#include "batch_request.hpp"
 #include "connection.hpp"
 #include "constants.hpp"
 #include "execute_request.hpp"
+#include "external_types.hpp"
 #include "io_worker.hpp"
 #include "pool.hpp"
 #include "prepare_handler.hpp"
@@ -27,13 +29,31 @@
 #include "schema_change_handler.hpp"
 #include "session.hpp"
 
+#include <string.h>
 #include <uv.h>
 
 namespace cass {
 
+static Atomic<uint64_t> next_interceptor_id;
+
 void RequestHandler::on_set(ResponseMessage* response) {
   assert(connection_ != NULL);
   assert(!is_query_plan_exhausted_ && "Tried to set on a non-existent host");
+  record_stage(LatencyBreakdown::STAGE_RESPONSE_RECEIVED);
+  intercept(CASS_REQUEST_EVENT_RESPONSE);
+  bool is_overloaded = false;
+  if (response->opcode() == CQL_OPCODE_ERROR) {
+    int code = static_cast<ErrorResponse*>(response->response_body().get())->code();
+    is_overloaded = code == CQL_ERROR_OVERLOADED ||
+                    code == CQL_ERROR_READ_TIMEOUT ||
+                    code == CQL_ERROR_WRITE_TIMEOUT;
+  }
+  if (is_overloaded) {
+    current_host_->set_last_error_time_ns(uv_hrtime());
+    release_permit(ConcurrencyLimiter::DROPPED);
+  } else {
+    release_permit(ConcurrencyLimiter::SUCCESS);
+  }
   switch (response->opcode()) {
     case CQL_OPCODE_RESULT:
       on_result_response(response);
@@ -49,8 +69,13 @@ void RequestHandler::on_set(ResponseMessage* response) {
 }
 
 void RequestHandler::on_error(CassError code, const std::string& message) {
+  release_permit(ConcurrencyLimiter::IGNORED);
   if (code == CASS_ERROR_LIB_WRITE_ERROR ||
       code == CASS_ERROR_LIB_UNABLE_TO_SET_KEYSPACE) {
+    if (code == CASS_ERROR_LIB_WRITE_ERROR && !is_query_plan_exhausted_) {
+      current_host_->set_last_error_time_ns(uv_hrtime());
+    }
+    intercept(CASS_REQUEST_EVENT_RETRY);
     next_host();
     retry();
     return_connection();
@@ -61,6 +86,8 @@ void RequestHandler::on_error(CassError code, const std::string& message) {
 
 void RequestHandler::on_timeout() {
   assert(!is_query_plan_exhausted_ && "Tried to timeout on a non-existent host");
+  current_host_->set_last_error_time_ns(uv_hrtime());
+  release_permit(ConcurrencyLimiter::DROPPED);
   set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT, "Request timed out");
 }
 
@@ -70,6 +97,10 @@ void RequestHandler::set_io_worker(IOWorker* io_worker) {
 }
 
 void RequestHandler::retry() {
+  release_permit(ConcurrencyLimiter::IGNORED);
+  // Drop the previous attempt's stages, the dequeue stage is only recorded
+  // when the I/O worker first dispatches the request
+  clear_stages_after(LatencyBreakdown::STAGE_IO_WORKER_DEQUEUED);
   // Reset the request so it can be executed again
   set_state(REQUEST_STATE_NEW);
   pool_ = NULL;
@@ -87,6 +118,9 @@ bool RequestHandler::get_current_host_address(Address* address) {
 void RequestHandler::next_host() {
   current_host_ = query_plan_->compute_next();
   is_query_plan_exhausted_ = !current_host_;
+  if (interceptor_ != NULL && current_host_) {
+    notify_interceptor(CASS_REQUEST_EVENT_HOST_CHOSEN, CASS_OK, NULL);
+  }
 }
 
 bool RequestHandler::is_host_up(const Address& address) const {
@@ -97,14 +131,22 @@ void RequestHandler::set_response(const SharedRefPtr<Response>& response) {
   uint64_t elapsed = uv_hrtime() - start_time_ns();
   current_host_->update_latency(elapsed);
   connection_->metrics()->record_request(elapsed);
+  connection_->metrics()->record_host_request(current_host_.get(), elapsed);
+  finish_latency_breakdown();
+  record_slow_query(CASS_OK);
+  intercept(CASS_REQUEST_EVENT_COMPLETE);
   future_->set_response(current_host_->address(), response);
   return_connection_and_finish();
 }
 
 void RequestHandler::set_error(CassError code, const std::string& message) {
+  finish_latency_breakdown();
+  record_slow_query(code);
+  intercept(CASS_REQUEST_EVENT_COMPLETE, code);
   if (is_query_plan_exhausted_) {
     future_->set_error(code, message);
   } else {
+    record_host_error();
     future_->set_error_with_host_address(current_host_->address(), code, message);
   }
   return_connection_and_finish();
@@ -112,16 +154,119 @@ void RequestHandler::set_error(CassError code, const std::string& message) {
 
 void RequestHandler::set_error_with_error_response(const SharedRefPtr<Response>& error,
                                                    CassError code, const std::string& message) {
+  record_host_error();
+  finish_latency_breakdown();
+  record_slow_query(code);
+  intercept(CASS_REQUEST_EVENT_COMPLETE, code);
   future_->set_error_with_response(current_host_->address(), error, code, message);
   return_connection_and_finish();
 }
 
+void RequestHandler::record_host_error() {
+  if (io_worker_ != NULL) {
+    io_worker_->metrics()->record_host_error(current_host_.get());
+  }
+}
+
+void RequestHandler::finish_latency_breakdown() {
+  if (!is_latency_breakdown_enabled()) return;
+  record_stage(LatencyBreakdown::STAGE_FINISHED);
+  future_->set_latency_breakdown(latency_breakdown());
+  if (io_worker_ != NULL) {
+    io_worker_->metrics()->record_latency_breakdown(latency_breakdown());
+  }
+}
+
+void RequestHandler::record_slow_query(CassError code) {
+  if (slow_query_log_ == NULL) return;
+
+  uint64_t latency_ns = uv_hrtime() - create_time_ns_;
+  if (!slow_query_log_->is_slow(latency_ns) || !slow_query_log_->sample()) {
+    return;
+  }
+
+  SlowQueryLog::Entry* entry = new SlowQueryLog::Entry(request(), latency_ns);
+  if (current_host_) {
+    entry->coordinator = current_host_->address();
+    entry->has_coordinator = true;
+  }
+  entry->consistency = consistency();
+  entry->retries = num_retries_;
+  entry->error = code;
+  if (is_latency_breakdown_enabled()) {
+    entry->latency_breakdown = latency_breakdown();
+  }
+  slow_query_log_->add(entry);
+}
+
+void RequestHandler::enable_interceptor(CassRequestInterceptorCallback callback,
+                                        void* data) {
+  interceptor_ = callback;
+  interceptor_data_ = data;
+  interceptor_id_ = next_interceptor_id.fetch_add(1, MEMORY_ORDER_RELAXED) + 1;
+  submit_time_ns_ = uv_hrtime();
+  enable_write_notification();
+
+  // The request can be shared so the interceptor's entries are merged into a
+  // copy of its custom payload that's only used by this handler
+  SharedRefPtr<CustomPayload> payload(new CustomPayload());
+  notify_interceptor(CASS_REQUEST_EVENT_SUBMIT, CASS_OK,
+                     CassCustomPayload::to(payload.get()));
+  if (!payload->empty()) {
+    if (request_->custom_payload()) {
+      payload->merge(*request_->custom_payload());
+    }
+    set_custom_payload(payload.get());
+  }
+}
+
+void RequestHandler::on_write_finished() {
+  intercept(CASS_REQUEST_EVENT_WRITE_COMPLETE);
+}
+
+void RequestHandler::notify_interceptor(CassRequestEvent event, CassError code,
+                                        CassCustomPayload* payload) {
+  CassRequestInfo info;
+  info.event = event;
+  info.id = interceptor_id_;
+  info.statement = NULL;
+  info.batch = NULL;
+  switch (request_->opcode()) {
+    case CQL_OPCODE_QUERY:
+    case CQL_OPCODE_EXECUTE:
+      info.statement = CassStatement::to(static_cast<const Statement*>(request_.get()));
+      break;
+    case CQL_OPCODE_BATCH:
+      info.batch = CassBatch::to(static_cast<const BatchRequest*>(request_.get()));
+      break;
+    default:
+      break;
+  }
+  memset(&info.host, 0, sizeof(info.host));
+  if (current_host_) {
+    info.host.address_length = current_host_->address().to_inet(info.host.address);
+  }
+  info.consistency = consistency();
+  info.retries = num_retries_;
+  info.elapsed = (uv_hrtime() - submit_time_ns_) / 1000;
+  info.error = code;
+  interceptor_(&info, payload, interceptor_data_);
+}
+
 void RequestHandler::return_connection() {
   if (pool_ != NULL && connection_ != NULL) {
       pool_->return_connection(connection_);
   }
 }
 
+void RequestHandler::release_permit(ConcurrencyLimiter::Outcome outcome) {
+  if (!has_permit_) return;
+  has_permit_ = false;
+  // The permit is always released before the request moves to another pool
+  assert(pool_ != NULL);
+  pool_->release_permit(outcome, uv_hrtime() - start_time_ns());
+}
+
 void RequestHandler::return_connection_and_finish() {
   return_connection();
   if (io_worker_ != NULL) {
@@ -242,6 +387,7 @@ void RequestHandler::handle_retry_decision(ResponseMessage* response,
       break;
 
     case RetryPolicy::RetryDecision::RETRY:
+      intercept(CASS_REQUEST_EVENT_RETRY);
       set_consistency(decision.retry_consistency());
       if (!decision.retry_current_host()) {
         next_host();
@@ -17,6 +17,7 @@
 #ifndef __CASS_REQUEST_HANDLER_HPP_INCLUDED__
 #define __CASS_REQUEST_HANDLER_HPP_INCLUDED__
 
+#include "concurrency_limiter.hpp"
 #include "constants.hpp"
 #include "error_response.hpp"
 #include "future.hpp"
@@ -28,6 +29,7 @@
 #include "response.hpp"
 #include "retry_policy.hpp"
 #include "scoped_ptr.hpp"
+#include "slow_query_log.hpp"
 
 #include <string>
 #include <uv.h>
@@ -43,7 +45,8 @@ class ResponseFuture : public Future {
 public:
   ResponseFuture(const Metadata& metadata)
       : Future(CASS_FUTURE_TYPE_RESPONSE)
-      , schema_metadata(metadata.schema_snapshot()) { }
+      , schema_metadata(metadata.schema_snapshot())
+      , has_latency_breakdown_(false) { }
 
   void set_response(Address address, const SharedRefPtr<Response>& response) {
     ScopedMutex lock(&mutex_);
@@ -78,12 +81,29 @@ public:
     return address_;
   }
 
+  // Must be called before the future is set
+  void set_latency_breakdown(const LatencyBreakdown& latency_breakdown) {
+    ScopedMutex lock(&mutex_);
+    has_latency_breakdown_ = true;
+    latency_breakdown_ = latency_breakdown;
+  }
+
+  bool latency_breakdown(LatencyBreakdown* output) {
+    ScopedMutex lock(&mutex_);
+    internal_wait(lock);
+    if (!has_latency_breakdown_) return false;
+    *output = latency_breakdown_;
+    return true;
+  }
+
   std::string statement;
   Metadata::SchemaSnapshot schema_metadata;
 
 private:
   Address address_;
   SharedRefPtr<Response> response_;
+  bool has_latency_breakdown_;
+  LatencyBreakdown latency_breakdown_;
 };
 
 
@@ -98,7 +118,15 @@ public:
       , num_retries_(0)
       , is_query_plan_exhausted_(true)
       , io_worker_(NULL)
-      , pool_(NULL) {
+      , pool_(NULL)
+      , has_permit_(false)
+      , enqueue_time_ns_(0)
+      , slow_query_log_(NULL)
+      , create_time_ns_(0)
+      , interceptor_(NULL)
+      , interceptor_data_(NULL)
+      , interceptor_id_(0)
+      , submit_time_ns_(0) {
     set_timestamp(request->timestamp());
   }
 
@@ -120,6 +148,28 @@ public:
     pool_ = pool;
   }
 
+  // Set when the request holds a permit from its pool's concurrency limiter
+  void set_has_permit(bool has_permit) {
+    has_permit_ = has_permit;
+  }
+
+  // Set when the request is added to a request queue if the event loop
+  // metrics are enabled
+  uint64_t enqueue_time_ns() const { return enqueue_time_ns_; }
+  void set_enqueue_time_ns(uint64_t enqueue_time_ns) {
+    enqueue_time_ns_ = enqueue_time_ns;
+  }
+
+  // Slow requests are added to the log when they finish
+  void enable_slow_query_log(SlowQueryLog* slow_query_log) {
+    slow_query_log_ = slow_query_log;
+    create_time_ns_ = uv_hrtime();
+  }
+
+  // Notifies the interceptor that the request was submitted and of the
+  // request's remaining events
+  void enable_interceptor(CassRequestInterceptorCallback callback, void* data);
+
   bool get_current_host_address(Address* address);
   void next_host();
 
@@ -133,6 +183,20 @@ private:
                                      CassError code, const std::string& message);
   void return_connection();
   void return_connection_and_finish();
+  void release_permit(ConcurrencyLimiter::Outcome outcome);
+  void record_host_error();
+  void finish_latency_breakdown();
+  void record_slow_query(CassError code);
+
+  virtual void on_write_finished();
+
+  void intercept(CassRequestEvent event, CassError code = CASS_OK) {
+    if (interceptor_ != NULL) {
+      notify_interceptor(event, code, NULL);
+    }
+  }
+  void notify_interceptor(CassRequestEvent event, CassError code,
+                          CassCustomPayload* payload);
 
   void on_result_response(ResponseMessage* response);
   void on_error_response(ResponseMessage* response);
@@ -149,6 +213,14 @@ private:
   ScopedPtr<QueryPlan> query_plan_;
   IOWorker* io_worker_;
   Pool* pool_;
+  bool has_permit_;
+  uint64_t enqueue_time_ns_;
+  SlowQueryLog* slow_query_log_;
+  uint64_t create_time_ns_;
+  CassRequestInterceptorCallback interceptor_;
+  void* interceptor_data_;
+  uint64_t interceptor_id_;
+  uint64_t submit_time_ns_;
 };
 
 } // namespace cass
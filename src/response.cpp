@@ -41,6 +41,11 @@ char* Response::decode_custom_payload(char* buffer, size_t size) {
   return pos;
 }
 
+char* Response::decode_tracing_id(char* buffer) {
+  has_tracing_id_ = true;
+  return decode_uuid(buffer, &tracing_id_);
+}
+
 char* Response::decode_warnings(char* buffer, size_t size) {
   uint16_t warning_count;
   char* pos = decode_uint16(buffer, warning_count);
@@ -164,6 +169,10 @@ ssize_t ResponseMessage::decode(char* input, size_t size) {
 
     char* pos = response_body()->data();
 
+    if (flags_ & CASS_FLAG_TRACING) {
+      pos = response_body()->decode_tracing_id(pos);
+    }
+
     if (flags_ & CASS_FLAG_WARNING) {
       pos = response_body()->decode_warnings(pos, length_);
     }
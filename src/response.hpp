@@ -41,7 +41,8 @@ public:
   typedef FixedVector<StringRef, 8> WarningVec;
 
   Response(uint8_t opcode)
-      : opcode_(opcode) { }
+      : opcode_(opcode)
+      , has_tracing_id_(false) { }
 
   virtual ~Response() { }
 
@@ -52,11 +53,17 @@ public:
   const SharedRefPtr<RefBuffer>& buffer() const { return buffer_; }
 
   void set_buffer(size_t size) {
-    buffer_ = SharedRefPtr<RefBuffer>(RefBuffer::create(size));
+    buffer_ = SharedRefPtr<RefBuffer>(RefBuffer::create(size, MemoryBudget::RESPONSE_BODY));
   }
 
   const CustomPayloadVec& custom_payload() const { return custom_payload_; }
 
+  bool has_tracing_id() const { return has_tracing_id_; }
+
+  const CassUuid& tracing_id() const { return tracing_id_; }
+
+  char* decode_tracing_id(char* buffer);
+
   char* decode_custom_payload(char* buffer, size_t size);
 
   char* decode_warnings(char* buffer, size_t size);
@@ -67,6 +74,8 @@ private:
   uint8_t opcode_;
   SharedRefPtr<RefBuffer> buffer_;
   CustomPayloadVec custom_payload_;
+  bool has_tracing_id_;
+  CassUuid tracing_id_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(Response);
@@ -18,11 +18,15 @@
 
 #include "config.hpp"
 #include "constants.hpp"
+#include "get_time.hpp"
 #include "logger.hpp"
+#include "memory_budget.hpp"
 #include "prepare_request.hpp"
 #include "request_handler.hpp"
 #include "scoped_lock.hpp"
+#include "slow_query_iterator.hpp"
 #include "timer.hpp"
+#include "trace_handler.hpp"
 #include "external_types.hpp"
 
 extern "C" {
@@ -91,6 +95,16 @@ CassFuture* cass_session_execute_batch(CassSession* session, const CassBatch* ba
   return CassFuture::to(session->execute(batch->from()));
 }
 
+size_t cass_session_get_request_capacity(const CassSession* session) {
+  return session->request_capacity();
+}
+
+void cass_session_set_capacity_callback(CassSession* session,
+                                        CassCapacityCallback callback,
+                                        void* data) {
+  session->set_capacity_callback(callback, data);
+}
+
 const CassSchemaMeta* cass_session_get_schema_meta(const CassSession* session) {
   return CassSchemaMeta::to(new cass::Metadata::SchemaSnapshot(session->metadata().schema_snapshot()));
 }
@@ -129,6 +143,124 @@ void  cass_session_get_metrics(const CassSession* session,
   metrics->errors.request_timeouts = internal_metrics->request_timeouts.sum();
 }
 
+void cass_session_get_pool_metrics(const CassSession* session,
+                                   CassPoolMetrics* metrics) {
+  const cass::Metrics* internal_metrics = session->metrics();
+
+  metrics->total_connections = internal_metrics->total_connections.sum();
+  metrics->draining_connections = internal_metrics->draining_connections.sum();
+  metrics->connections_scaled_up = internal_metrics->connections_scaled_up.sum();
+  metrics->connections_scaled_down = internal_metrics->connections_scaled_down.sum();
+  metrics->concurrency_limit = internal_metrics->concurrency_limit.sum();
+}
+
+static void to_latency_snapshot(const cass::Metrics::Histogram::Snapshot& snapshot,
+                                CassLatencySnapshot* output) {
+  output->min = snapshot.min;
+  output->max = snapshot.max;
+  output->mean = snapshot.mean;
+  output->stddev = snapshot.stddev;
+  output->median = snapshot.median;
+  output->percentile_75th = snapshot.percentile_75th;
+  output->percentile_95th = snapshot.percentile_95th;
+  output->percentile_98th = snapshot.percentile_98th;
+  output->percentile_99th = snapshot.percentile_99th;
+  output->percentile_999th = snapshot.percentile_999th;
+}
+
+static void copy_snapshot(const cass::Metrics::Histogram* histogram,
+                          CassLatencySnapshot* output) {
+  cass::Metrics::Histogram::Snapshot snapshot;
+  histogram->get_snapshot(&snapshot);
+  to_latency_snapshot(snapshot, output);
+}
+
+void cass_session_get_request_latency_interval(const CassSession* session,
+                                               CassLatencySnapshot* output) {
+  cass::Metrics::Histogram::Snapshot snapshot;
+  session->metrics()->request_latencies.get_interval_snapshot(
+        cass::Metrics::Histogram::INTERVAL_READER_API, &snapshot);
+  to_latency_snapshot(snapshot, output);
+}
+
+CassError cass_session_get_latency_breakdown_metrics(const CassSession* session,
+                                                     CassLatencyBreakdownMetrics* metrics) {
+  const cass::Metrics* internal_metrics = session->metrics();
+  if (internal_metrics == NULL || !internal_metrics->is_latency_breakdown_enabled()) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+
+  copy_snapshot(internal_metrics->phase_latencies(cass::LatencyBreakdown::PHASE_SESSION_QUEUE),
+                &metrics->session_queue);
+  copy_snapshot(internal_metrics->phase_latencies(cass::LatencyBreakdown::PHASE_IO_WORKER_QUEUE),
+                &metrics->io_worker_queue);
+  copy_snapshot(internal_metrics->phase_latencies(cass::LatencyBreakdown::PHASE_POOL_PENDING),
+                &metrics->pool_pending);
+  copy_snapshot(internal_metrics->phase_latencies(cass::LatencyBreakdown::PHASE_WRITE),
+                &metrics->write);
+  copy_snapshot(internal_metrics->phase_latencies(cass::LatencyBreakdown::PHASE_SERVER),
+                &metrics->server);
+  copy_snapshot(internal_metrics->phase_latencies(cass::LatencyBreakdown::PHASE_DECODE),
+                &metrics->decode);
+  return CASS_OK;
+}
+
+size_t cass_session_get_event_loop_count(const CassSession* session) {
+  return session->event_loop_count();
+}
+
+CassError cass_session_get_event_loop_metrics(const CassSession* session,
+                                              size_t index,
+                                              CassEventLoopMetrics* metrics) {
+  cass::LoopMonitor::Snapshot snapshot;
+  size_t event_queue_size, request_queue_size;
+  if (!session->get_event_loop_metrics(index, &snapshot,
+                                       &event_queue_size, &request_queue_size)) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+
+  to_latency_snapshot(snapshot.lag, &metrics->lag);
+  to_latency_snapshot(snapshot.iteration_time, &metrics->iteration_time);
+  to_latency_snapshot(snapshot.request_queue_time, &metrics->request_queue_time);
+  metrics->utilization = snapshot.utilization;
+  metrics->event_queue_size = event_queue_size;
+  metrics->request_queue_size = request_queue_size;
+  return CASS_OK;
+}
+
+CassError cass_session_get_startup_report(const CassSession* session,
+                                          CassStartupReport* output) {
+  cass::StartupReport report;
+  if (!session->get_startup_report(&report)) {
+    return CASS_ERROR_LIB_NO_HOSTS_AVAILABLE;
+  }
+
+  output->resolve_us = report.duration_ns(cass::StartupReport::PHASE_RESOLVE) / 1000;
+  output->control_connection_us = report.duration_ns(cass::StartupReport::PHASE_CONTROL_CONNECTION) / 1000;
+  output->schema_us = report.duration_ns(cass::StartupReport::PHASE_SCHEMA) / 1000;
+  output->first_pool_ready_us = report.duration_ns(cass::StartupReport::PHASE_FIRST_POOL_READY) / 1000;
+  output->all_pools_ready_us = report.duration_ns(cass::StartupReport::PHASE_ALL_POOLS_READY) / 1000;
+  output->total_us = report.total_ns() / 1000;
+  return CASS_OK;
+}
+
+CassIterator* cass_session_get_slow_queries(CassSession* session) {
+  return CassIterator::to(new cass::SlowQueryIterator(session->slow_query_log()));
+}
+
+CassFuture* cass_session_get_trace(CassSession* session,
+                                   CassUuid tracing_id) {
+  return CassFuture::to(session->get_trace(tracing_id));
+}
+
+CassIterator* cass_session_get_host_metrics(const CassSession* session) {
+  return CassIterator::to(session->new_host_metrics_iterator(false));
+}
+
+CassIterator* cass_session_get_dc_metrics(const CassSession* session) {
+  return CassIterator::to(session->new_host_metrics_iterator(true));
+}
+
 } // extern "C"
 
 namespace cass {
@@ -140,6 +272,9 @@ Session::Session()
     , pending_pool_count_(0)
     , pending_workers_count_(0)
     , current_io_worker_(0)
+    , capacity_callback_(NULL)
+    , capacity_data_(NULL)
+    , is_capacity_exhausted_(false)
     , keyspace_(new std::string){
   uv_mutex_init(&state_mutex_);
   uv_mutex_init(&hosts_mutex_);
@@ -153,7 +288,23 @@ Session::~Session() {
 
 void Session::clear(const Config& config) {
   config_ = config;
-  metrics_.reset(new Metrics(config_.thread_count_io() + 1));
+  metrics_.reset(new Metrics(config_.thread_count_io() + 1,
+                             config_.host_metrics() ? config_.host_metrics_significant_figures() : 0));
+  if (config_.latency_breakdown()) {
+    metrics_->enable_latency_breakdown();
+  }
+  slow_query_log_.reset();
+  if (config_.slow_query_threshold_ms() > 0) {
+    slow_query_log_.reset(new SlowQueryLog(config_.slow_query_threshold_ms(),
+                                           config_.slow_query_sample_rate(),
+                                           config_.slow_query_queue_size()));
+  }
+  histogram_log_writer_.reset();
+  if (!config_.histogram_log_path().empty()) {
+    histogram_log_writer_.reset(
+          new HistogramLogWriter(config_.histogram_log_path(),
+                                 metrics_->request_latencies.significant_figures()));
+  }
   load_balancing_policy_.reset(config.load_balancing_policy());
   connect_future_.reset();
   close_future_.reset();
@@ -169,6 +320,8 @@ void Session::clear(const Config& config) {
   pending_pool_count_ = 0;
   pending_workers_count_ = 0;
   current_io_worker_ = 0;
+  is_capacity_exhausted_.store(false);
+  startup_report_.start(uv_hrtime());
 }
 
 int Session::init() {
@@ -179,6 +332,20 @@ int Session::init() {
   rc = request_queue_->init(loop(), this, &Session::on_execute);
   if (rc != 0) return rc;
 
+  metadata_.set_loop(loop());
+
+  if (config_.event_loop_metrics_interval_ms() > 0) {
+    rc = loop_monitor_.init(loop(), config_.event_loop_metrics_interval_ms());
+    if (rc != 0) return rc;
+  }
+
+  if (slow_query_log_ && config_.slow_query_callback() != NULL) {
+    rc = slow_query_log_->init_callback(loop(),
+                                        config_.slow_query_callback(),
+                                        config_.slow_query_callback_data());
+    if (rc != 0) return rc;
+  }
+
   for (unsigned int i = 0; i < config_.thread_count_io(); ++i) {
     SharedRefPtr<IOWorker> io_worker(new IOWorker(this));
     int rc = io_worker->init();
@@ -273,6 +440,19 @@ bool Session::notify_up_async(const Address& address) {
   return send_event_async(event);
 }
 
+bool Session::notify_capacity_available_async() {
+  SessionEvent event;
+  event.type = SessionEvent::NOTIFY_CAPACITY_AVAILABLE;
+  return send_event_async(event);
+}
+
+void Session::set_capacity_callback(CassCapacityCallback callback, void* data) {
+  // The callback is read on the session's thread
+  ScopedMutex l(&state_mutex_);
+  capacity_callback_ = callback;
+  capacity_data_ = data;
+}
+
 bool Session::notify_down_async(const Address& address) {
   SessionEvent event;
   event.type = SessionEvent::NOTIFY_DOWN;
@@ -342,6 +522,7 @@ void Session::close_async(Future* future, bool force) {
 }
 
 void Session::internal_connect() {
+  startup_report_.finish(StartupReport::PHASE_RESOLVE, uv_hrtime());
   if (hosts_.empty()) { // No hosts lock necessary (only called on session thread)
     notify_connect_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
                          "No hosts provided or no hosts resolved");
@@ -359,9 +540,13 @@ void Session::internal_close() {
 }
 
 void Session::notify_connected() {
+  startup_report_.finish(StartupReport::PHASE_ALL_POOLS_READY, uv_hrtime());
+  LOG_INFO("Session connected (%s)", startup_report_.to_string().c_str());
+
   ScopedMutex l(&state_mutex_);
   if (state_.load(MEMORY_ORDER_RELAXED) == SESSION_STATE_CONNECTING) {
     state_.store(SESSION_STATE_CONNECTED, MEMORY_ORDER_RELAXED);
+    start_histogram_log();
   } else { // We recieved a 'force' close event
     internal_close();
   }
@@ -391,8 +576,18 @@ void Session::notify_closed() {
 }
 
 void Session::close_handles() {
+  if (histogram_log_writer_) {
+    // Log the final, partial interval
+    histogram_log_writer_->write_interval(metrics_->request_latencies,
+                                          get_time_since_epoch_ms());
+    histogram_log_timer_.stop();
+  }
   EventThread<SessionEvent>::close_handles();
   request_queue_->close_handles();
+  loop_monitor_.close_handles();
+  if (slow_query_log_) {
+    slow_query_log_->close_handles();
+  }
   load_balancing_policy_->close_handles();
 }
 
@@ -452,6 +647,7 @@ void Session::on_event(const SessionEvent& event) {
 
     case SessionEvent::NOTIFY_READY:
       if (pending_pool_count_ > 0) {
+        startup_report_.finish(StartupReport::PHASE_FIRST_POOL_READY, uv_hrtime());
         if (--pending_pool_count_ == 0) {
           LOG_DEBUG("Session is connected");
           notify_connected();
@@ -485,6 +681,16 @@ void Session::on_event(const SessionEvent& event) {
       control_connection_.on_down(event.address);
       break;
 
+    case SessionEvent::NOTIFY_CAPACITY_AVAILABLE:
+      maybe_notify_capacity_available();
+      break;
+
+    case SessionEvent::FETCH_TRACE:
+      TraceHandler::fetch(&control_connection_, event.trace_future,
+                          config_.tracing_max_wait_time_ms());
+      event.trace_future->dec_ref(); // Session reference
+      break;
+
     default:
       assert(false);
       break;
@@ -516,12 +722,138 @@ void Session::execute(RequestHandler* request_handler) {
   if (state_.load(MEMORY_ORDER_ACQUIRE) != SESSION_STATE_CONNECTED) {
     request_handler->on_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
                               "Session is not connected");
-  } else if (!request_queue_->enqueue(request_handler)) {
+    return;
+  }
+
+  if (!MemoryBudget::admit(request_handler->request_timeout_ms(config_))) {
+    request_handler->on_error(CASS_ERROR_LIB_MEMORY_LIMIT,
+                              "The memory limit has been reached");
+    return;
+  }
+
+  if (loop_monitor_.is_enabled()) {
+    request_handler->set_enqueue_time_ns(uv_hrtime());
+  }
+
+  if (!request_queue_->enqueue(request_handler)) {
+    set_capacity_exhausted();
     request_handler->on_error(CASS_ERROR_LIB_REQUEST_QUEUE_FULL,
                               "The request queue has reached capacity");
   }
 }
 
+size_t Session::request_capacity() const {
+  if (state_.load(MEMORY_ORDER_ACQUIRE) != SESSION_STATE_CONNECTED) {
+    return 0;
+  }
+  size_t size = request_queue_->size();
+  size_t capacity = request_queue_->capacity();
+  return size < capacity ? capacity - size : 0;
+}
+
+bool Session::get_event_loop_metrics(size_t index,
+                                     LoopMonitor::Snapshot* snapshot,
+                                     size_t* event_queue_size,
+                                     size_t* request_queue_size) const {
+  // The IO workers don't change while the session is connected
+  if (state_.load(MEMORY_ORDER_ACQUIRE) != SESSION_STATE_CONNECTED ||
+      index >= event_loop_count() ||
+      !loop_monitor_.is_enabled()) {
+    return false;
+  }
+
+  if (index == 0) {
+    loop_monitor_.get_snapshot(snapshot);
+    *event_queue_size = this->event_queue_size();
+    *request_queue_size = request_queue_->size();
+  } else {
+    const SharedRefPtr<IOWorker>& io_worker = io_workers_[index - 1];
+    io_worker->loop_monitor().get_snapshot(snapshot);
+    *event_queue_size = io_worker->event_queue_size();
+    *request_queue_size = io_worker->request_queue_size();
+  }
+  return true;
+}
+
+bool Session::get_startup_report(StartupReport* report) const {
+  // The report isn't modified after the session is connected
+  if (state_.load(MEMORY_ORDER_ACQUIRE) != SESSION_STATE_CONNECTED) {
+    return false;
+  }
+  *report = startup_report_;
+  return true;
+}
+
+HostMetricsIterator* Session::new_host_metrics_iterator(bool aggregate_by_dc) const {
+  HostVec hosts;
+  { // Lock hosts
+    ScopedMutex l(&hosts_mutex_);
+    hosts.reserve(hosts_.size());
+    for (HostMap::const_iterator it = hosts_.begin(),
+         end = hosts_.end(); it != end; ++it) {
+      hosts.push_back(it->second);
+    }
+  }
+  return new HostMetricsIterator(hosts, aggregate_by_dc);
+}
+
+void Session::start_histogram_log() {
+  if (!histogram_log_writer_) return;
+  if (!histogram_log_writer_->open(get_time_since_epoch_ms())) {
+    histogram_log_writer_.reset();
+    return;
+  }
+  LOG_INFO("Logging request latencies to '%s' every %u ms",
+           histogram_log_writer_->path().c_str(),
+           config_.histogram_log_interval_ms());
+  histogram_log_timer_.start(loop(), config_.histogram_log_interval_ms(),
+                             this, on_histogram_log);
+}
+
+void Session::on_histogram_log(Timer* timer) {
+  Session* session = static_cast<Session*>(timer->data());
+  session->histogram_log_writer_->write_interval(session->metrics_->request_latencies,
+                                                 get_time_since_epoch_ms());
+  session->histogram_log_timer_.start(session->loop(),
+                                      session->config_.histogram_log_interval_ms(),
+                                      session, on_histogram_log);
+}
+
+void Session::set_capacity_exhausted() {
+  is_capacity_exhausted_.store(true);
+
+  // The queues can drain after a request is rejected but before the flag is
+  // set, in which case no drain notifies the callback. Check again now that
+  // the flag is visible.
+  if (request_queue_->size() <= request_queue_->capacity() / 2) {
+    notify_capacity_available_async();
+  }
+}
+
+void Session::maybe_notify_capacity_available() {
+  if (!is_capacity_exhausted_.load()) return;
+
+  // Only notify once the request queue has drained below its low water mark
+  // (half its capacity) so that producers don't immediately fill it again.
+  if (request_queue_->size() > request_queue_->capacity() / 2) return;
+
+  bool expected = true;
+  if (!is_capacity_exhausted_.compare_exchange_strong(expected, false)) return;
+
+  CassCapacityCallback callback;
+  void* data;
+  { // Lock state
+    ScopedMutex l(&state_mutex_);
+    callback = capacity_callback_;
+    data = capacity_data_;
+  }
+
+  // The lock isn't held so that the callback can use the session
+  if (callback != NULL) {
+    callback(CassSession::to(this), data);
+  }
+}
+
 #if UV_VERSION_MAJOR >= 1
 void Session::on_resolve_name(MultiResolver<Session*>::NameResolver* resolver) {
   Session* session = resolver->data()->data();
@@ -546,7 +878,12 @@ void Session::on_add_resolve_name(NameResolver* resolver) {
 }
 #endif
 
+void Session::on_control_connection_connected() {
+  startup_report_.finish(StartupReport::PHASE_CONTROL_CONNECTION, uv_hrtime());
+}
+
 void Session::on_control_connection_ready() {
+  startup_report_.finish(StartupReport::PHASE_SCHEMA, uv_hrtime());
   // No hosts lock necessary (only called on session thread and read-only)
   load_balancing_policy_->init(control_connection_.connected_host(), hosts_);
   load_balancing_policy_->register_handles(loop());
@@ -554,9 +891,19 @@ void Session::on_control_connection_ready() {
        end = io_workers_.end(); it != end; ++it) {
     (*it)->set_protocol_version(control_connection_.protocol_version());
   }
+  // Pools to local hosts are added first so that they're the first to connect
+  // when the number of connecting pools is bounded.
   for (HostMap::iterator it = hosts_.begin(), hosts_end = hosts_.end();
        it != hosts_end; ++it) {
-    on_add(it->second, true);
+    if (load_balancing_policy_->distance(it->second) == CASS_HOST_DISTANCE_LOCAL) {
+      on_add(it->second, true);
+    }
+  }
+  for (HostMap::iterator it = hosts_.begin(), hosts_end = hosts_.end();
+       it != hosts_end; ++it) {
+    if (load_balancing_policy_->distance(it->second) != CASS_HOST_DISTANCE_LOCAL) {
+      on_add(it->second, true);
+    }
   }
   if (config().core_connections_per_host() == 0) {
     // Special case for internal testing. Not allowed by API
@@ -579,11 +926,28 @@ Future* Session::prepare(const char* statement, size_t length) {
   RequestHandler* request_handler = new RequestHandler(prepare, future, NULL);
   request_handler->inc_ref(); // IOWorker reference
 
+  enable_request_monitoring(request_handler);
+
   execute(request_handler);
 
   return future;
 }
 
+void Session::enable_request_monitoring(RequestHandler* request_handler) {
+  if (config_.latency_breakdown()) {
+    request_handler->enable_latency_breakdown();
+  }
+
+  if (slow_query_log_) {
+    request_handler->enable_slow_query_log(slow_query_log_.get());
+  }
+
+  if (config_.request_interceptor() != NULL) {
+    request_handler->enable_interceptor(config_.request_interceptor(),
+                                        config_.request_interceptor_data());
+  }
+}
+
 void Session::on_add(SharedRefPtr<Host> host, bool is_initial_connection) {
 #if UV_VERSION_MAJOR >= 1
   if (config_.use_hostname_resolution() && host->hostname().empty()) {
@@ -674,11 +1038,37 @@ Future* Session::execute(const RoutableRequest* request) {
                                                        retry_policy);
   request_handler->inc_ref(); // IOWorker reference
 
+  enable_request_monitoring(request_handler);
+
   execute(request_handler);
 
   return future;
 }
 
+Future* Session::get_trace(const CassUuid& tracing_id) {
+  TraceFuture* future = new TraceFuture(tracing_id);
+  future->inc_ref(); // External reference
+  future->set_loop(loop());
+
+  if (state_.load(MEMORY_ORDER_ACQUIRE) != SESSION_STATE_CONNECTED) {
+    future->set_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
+                      "Session is not connected");
+    return future;
+  }
+
+  SessionEvent event;
+  event.type = SessionEvent::FETCH_TRACE;
+  event.trace_future = future;
+  future->inc_ref(); // Session reference
+  if (!send_event_async(event)) {
+    future->dec_ref();
+    future->set_error(CASS_ERROR_LIB_REQUEST_QUEUE_FULL,
+                      "The session's event queue has reached capacity");
+  }
+
+  return future;
+}
+
 #if UV_VERSION_MAJOR == 0
 void Session::on_execute(uv_async_t* data, int status) {
 #else
@@ -691,6 +1081,8 @@ void Session::on_execute(uv_async_t* data) {
   RequestHandler* request_handler = NULL;
   while (session->request_queue_->dequeue(request_handler)) {
     if (request_handler != NULL) {
+      request_handler->record_stage(LatencyBreakdown::STAGE_SESSION_DEQUEUED);
+      session->loop_monitor_.record_request_queue_time(request_handler->enqueue_time_ns());
       request_handler->set_query_plan(session->new_query_plan(request_handler->request(),
                                                               request_handler->encoding_cache()));
 
@@ -704,6 +1096,8 @@ void Session::on_execute(uv_async_t* data) {
 
         Address address;
         if (!request_handler->get_current_host_address(&address)) {
+          // maybe_notify_capacity_available() runs at the end of this drain
+          session->is_capacity_exhausted_.store(true);
           request_handler->on_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
                                     "All connections on all I/O threads are busy");
           break;
@@ -726,6 +1120,8 @@ void Session::on_execute(uv_async_t* data) {
     }
   }
 
+  session->maybe_notify_capacity_available();
+
   if (is_closing) {
     session->pending_workers_count_ = session->io_workers_.size();
     for (IOWorkerVec::iterator it = session->io_workers_.begin(),
@@ -738,8 +1134,9 @@ void Session::on_execute(uv_async_t* data) {
 
 QueryPlan* Session::new_query_plan(const Request* request, Request::EncodingCache* cache) {
   const CopyOnWritePtr<std::string> keyspace(keyspace_);
+  TokenMap::ConstPtr token_map(metadata_.token_map());
   return load_balancing_policy_->new_query_plan(*keyspace, request,
-                                                metadata_.token_map(), cache);
+                                                *token_map, cache);
 }
 
 } // namespace cass
@@ -21,9 +21,12 @@
 #include "control_connection.hpp"
 #include "event_thread.hpp"
 #include "future.hpp"
+#include "histogram_log_writer.hpp"
 #include "host.hpp"
+#include "host_metrics_iterator.hpp"
 #include "io_worker.hpp"
 #include "load_balancing.hpp"
+#include "loop_monitor.hpp"
 #include "metadata.hpp"
 #include "metrics.hpp"
 #include "mpmc_queue.hpp"
@@ -32,6 +35,9 @@
 #include "row.hpp"
 #include "scoped_lock.hpp"
 #include "scoped_ptr.hpp"
+#include "slow_query_log.hpp"
+#include "startup_report.hpp"
+#include "timer.hpp"
 
 #include <list>
 #include <memory>
@@ -46,6 +52,7 @@ class RequestHandler;
 class Future;
 class IOWorker;
 class Request;
+class TraceFuture;
 
 struct SessionEvent {
   enum Type {
@@ -55,14 +62,18 @@ struct SessionEvent {
     NOTIFY_KEYSPACE_ERROR,
     NOTIFY_WORKER_CLOSED,
     NOTIFY_UP,
-    NOTIFY_DOWN
+    NOTIFY_DOWN,
+    NOTIFY_CAPACITY_AVAILABLE,
+    FETCH_TRACE
   };
 
   SessionEvent()
-    : type(INVALID) { }
+    : type(INVALID)
+    , trace_future(NULL) { }
 
   Type type;
   Address address;
+  TraceFuture* trace_future;
 };
 
 class Session : public EventThread<SessionEvent> {
@@ -94,15 +105,48 @@ public:
   bool notify_worker_closed_async();
   bool notify_up_async(const Address& address);
   bool notify_down_async(const Address& address);
+  bool notify_capacity_available_async();
 
   void connect_async(const Config& config, const std::string& keyspace, Future* future);
   void close_async(Future* future, bool force = false);
 
   Future* prepare(const char* statement, size_t length);
   Future* execute(const RoutableRequest* statement);
+  Future* get_trace(const CassUuid& tracing_id);
 
   const Metadata& metadata() const { return metadata_; }
 
+  size_t request_capacity() const;
+
+  HostMetricsIterator* new_host_metrics_iterator(bool aggregate_by_dc) const;
+
+  // Index 0 is the session's event loop and the remaining indexes are the
+  // IO worker event loops
+  size_t event_loop_count() const { return io_workers_.size() + 1; }
+
+  // NULL if the slow query log is disabled or its entries are delivered
+  // to a callback
+  SharedRefPtr<SlowQueryLog> slow_query_log() {
+    return config_.slow_query_callback() == NULL ? slow_query_log_
+                                                 : SharedRefPtr<SlowQueryLog>();
+  }
+  bool get_event_loop_metrics(size_t index,
+                              LoopMonitor::Snapshot* snapshot,
+                              size_t* event_queue_size,
+                              size_t* request_queue_size) const;
+
+  // Returns false if the session isn't connected
+  bool get_startup_report(StartupReport* report) const;
+
+  void set_capacity_callback(CassCapacityCallback callback, void* data);
+
+  bool is_capacity_exhausted() const {
+    return is_capacity_exhausted_.load();
+  }
+
+  // Called when a request is rejected for a lack of capacity
+  void set_capacity_exhausted();
+
   int protocol_version() const {
     return control_connection_.protocol_version();
   }
@@ -120,8 +164,16 @@ private:
   void notify_connect_error(CassError code, const std::string& message);
   void notify_closed();
 
+  // Applies the configured latency breakdown, slow query log and
+  // interceptor to a new request
+  void enable_request_monitoring(RequestHandler* request_handler);
   void execute(RequestHandler* request_handler);
 
+  void maybe_notify_capacity_available();
+
+  void start_histogram_log();
+  static void on_histogram_log(Timer* timer);
+
   virtual void on_run();
   virtual void on_after_run();
   virtual void on_event(const SessionEvent& event);
@@ -166,6 +218,7 @@ private:
 
   Metadata& metadata() { return metadata_; }
 
+  void on_control_connection_connected();
   void on_control_connection_ready();
   void on_control_connection_error(CassError code, const std::string& message);
 
@@ -191,7 +244,7 @@ private:
   ScopedRefPtr<Future> close_future_;
 
   HostMap hosts_;
-  uv_mutex_t hosts_mutex_;
+  mutable uv_mutex_t hosts_mutex_;
 
   IOWorkerVec io_workers_;
   ScopedPtr<AsyncQueue<MPMCQueue<RequestHandler*> > > request_queue_;
@@ -202,6 +255,19 @@ private:
   int pending_workers_count_;
   int current_io_worker_;
 
+  CassCapacityCallback capacity_callback_;
+  void* capacity_data_;
+  Atomic<bool> is_capacity_exhausted_;
+
+  LoopMonitor loop_monitor_;
+
+  SharedRefPtr<SlowQueryLog> slow_query_log_;
+
+  ScopedPtr<HistogramLogWriter> histogram_log_writer_;
+  Timer histogram_log_timer_;
+
+  StartupReport startup_report_;
+
   CopyOnWritePtr<std::string> keyspace_;
 };
 
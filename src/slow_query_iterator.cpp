@@ -0,0 +1,54 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "slow_query_iterator.hpp"
+
+#include "external_types.hpp"
+
+extern "C" {
+
+CassError cass_iterator_get_slow_query(const CassIterator* iterator,
+                                       CassSlowQuery* query) {
+  if (iterator->type() != CASS_ITERATOR_TYPE_SLOW_QUERY) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+
+  const cass::SlowQueryLog::Entry* entry
+      = static_cast<const cass::SlowQueryIterator*>(
+          iterator->from())->entry();
+  if (entry == NULL) {
+    return CASS_ERROR_LIB_BAD_PARAMS;
+  }
+
+  entry->to_cass(query);
+  return CASS_OK;
+}
+
+} // extern "C"
+
+namespace cass {
+
+bool SlowQueryIterator::next() {
+  SlowQueryLog::Entry* entry = NULL;
+  if (!log_ || !log_->remove(&entry)) {
+    entry_.reset();
+    return false;
+  }
+  entry_.reset(entry);
+  return true;
+}
+
+} // namespace cass
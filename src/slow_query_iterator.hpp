@@ -0,0 +1,46 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_SLOW_QUERY_ITERATOR_HPP_INCLUDED__
+#define __CASS_SLOW_QUERY_ITERATOR_HPP_INCLUDED__
+
+#include "iterator.hpp"
+#include "ref_counted.hpp"
+#include "scoped_ptr.hpp"
+#include "slow_query_log.hpp"
+
+namespace cass {
+
+// Iterates over the entries removed from a slow query log. The entries are
+// removed as the iterator advances so each entry is only seen once.
+class SlowQueryIterator : public Iterator {
+public:
+  SlowQueryIterator(const SharedRefPtr<SlowQueryLog>& log)
+    : Iterator(CASS_ITERATOR_TYPE_SLOW_QUERY)
+    , log_(log) { }
+
+  virtual bool next();
+
+  const SlowQueryLog::Entry* entry() const { return entry_.get(); }
+
+private:
+  SharedRefPtr<SlowQueryLog> log_;
+  ScopedPtr<SlowQueryLog::Entry> entry_;
+};
+
+} // namespace cass
+
+#endif
@@ -0,0 +1,164 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "slow_query_log.hpp"
+
+#include "batch_request.hpp"
+#include "constants.hpp"
+#include "execute_request.hpp"
+#include "logger.hpp"
+#include "prepare_request.hpp"
+#include "query_request.hpp"
+#include "utils.hpp"
+
+#include <string.h>
+
+namespace cass {
+
+static void add_statement(const Statement* statement,
+                          SlowQueryLog::Entry* entry) {
+  if (!entry->statement.empty()) {
+    entry->statement.append("; ");
+  }
+
+  if (statement->kind() == CASS_BATCH_KIND_QUERY) {
+    entry->statement.append(static_cast<const QueryRequest*>(statement)->query());
+  } else {
+    entry->statement.append(
+          static_cast<const ExecuteRequest*>(statement)->prepared()->statement());
+  }
+
+  const AbstractData::ElementVec& elements = statement->elements();
+  for (AbstractData::ElementVec::const_iterator it = elements.begin(),
+       end = elements.end(); it != end; ++it) {
+    if (it->is_unset() || it->is_null()) {
+      entry->bound_value_sizes.push_back(-1);
+    } else {
+      // Values are encoded with an [int] length
+      size_t size = it->get_size(CASS_HIGHEST_SUPPORTED_PROTOCOL_VERSION);
+      entry->bound_value_sizes.push_back(static_cast<int32_t>(size - sizeof(int32_t)));
+    }
+  }
+}
+
+SlowQueryLog::Entry::Entry(const Request* request, uint64_t latency_ns)
+  : has_coordinator(false)
+  , consistency(CASS_CONSISTENCY_UNKNOWN)
+  , retries(0)
+  , error(CASS_OK)
+  , latency_ns(latency_ns) {
+  switch (request->opcode()) {
+    case CQL_OPCODE_QUERY:
+    case CQL_OPCODE_EXECUTE:
+      add_statement(static_cast<const Statement*>(request), this);
+      break;
+
+    case CQL_OPCODE_BATCH: {
+      const BatchRequest::StatementList& statements
+          = static_cast<const BatchRequest*>(request)->statements();
+      for (BatchRequest::StatementList::const_iterator it = statements.begin(),
+           end = statements.end(); it != end; ++it) {
+        add_statement(it->get(), this);
+      }
+      break;
+    }
+
+    case CQL_OPCODE_PREPARE:
+      statement = static_cast<const PrepareRequest*>(request)->query();
+      break;
+
+    default:
+      break;
+  }
+}
+
+void SlowQueryLog::Entry::to_cass(CassSlowQuery* output) const {
+  output->statement = statement.data();
+  output->statement_length = statement.size();
+  output->bound_value_sizes = bound_value_sizes.empty() ? NULL : &bound_value_sizes[0];
+  output->bound_value_count = bound_value_sizes.size();
+  memset(&output->coordinator, 0, sizeof(output->coordinator));
+  if (has_coordinator) {
+    output->coordinator.address_length = coordinator.to_inet(output->coordinator.address);
+  }
+  output->consistency = consistency;
+  output->retries = retries;
+  output->error = error;
+  output->latency = latency_ns / 1000;
+  latency_breakdown.to_cass(&output->phases);
+}
+
+SlowQueryLog::SlowQueryLog(uint64_t threshold_ms, double sample_rate, size_t queue_size)
+  : threshold_ns_(threshold_ms * 1000 * 1000)
+  , sample_rate_(sample_rate)
+  , sample_count_(0)
+  , dropped_count_(0)
+  , queue_(queue_size)
+  , callback_(NULL)
+  , callback_data_(NULL) { }
+
+SlowQueryLog::~SlowQueryLog() {
+  Entry* entry;
+  while (remove(&entry)) {
+    delete entry;
+  }
+}
+
+int SlowQueryLog::init_callback(uv_loop_t* loop, CassSlowQueryCallback callback, void* data) {
+  async_.data = this;
+  int rc = uv_async_init(loop, &async_, on_callback);
+  if (rc != 0) return rc;
+  callback_ = callback;
+  callback_data_ = data;
+  return 0;
+}
+
+void SlowQueryLog::close_handles() {
+  if (callback_ == NULL) return;
+  uv_close(copy_cast<uv_async_t*, uv_handle_t*>(&async_), NULL);
+}
+
+void SlowQueryLog::add(Entry* entry) {
+  if (!queue_.enqueue(entry)) {
+    delete entry;
+    uint64_t dropped = dropped_count_.fetch_add(1, MEMORY_ORDER_RELAXED) + 1;
+    LOG_WARN_RATELIMITED(1000, 1,
+                         "Slow query log is full, %llu slow queries dropped",
+                         static_cast<unsigned long long>(dropped));
+    return;
+  }
+  if (callback_ != NULL) {
+    MPMCQueue<Entry*>::memory_fence();
+    uv_async_send(&async_);
+  }
+}
+
+#if UV_VERSION_MAJOR == 0
+void SlowQueryLog::on_callback(uv_async_t* async, int status) {
+#else
+void SlowQueryLog::on_callback(uv_async_t* async) {
+#endif
+  SlowQueryLog* log = static_cast<SlowQueryLog*>(async->data);
+  Entry* entry;
+  while (log->remove(&entry)) {
+    CassSlowQuery query;
+    entry->to_cass(&query);
+    log->callback_(&query, log->callback_data_);
+    delete entry;
+  }
+}
+
+} // namespace cass
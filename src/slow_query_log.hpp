@@ -0,0 +1,111 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_SLOW_QUERY_LOG_HPP_INCLUDED__
+#define __CASS_SLOW_QUERY_LOG_HPP_INCLUDED__
+
+#include "address.hpp"
+#include "atomic.hpp"
+#include "cassandra.h"
+#include "latency_breakdown.hpp"
+#include "macros.hpp"
+#include "mpmc_queue.hpp"
+#include "ref_counted.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <uv.h>
+#include <vector>
+
+namespace cass {
+
+class Request;
+
+// Captures a sample of the requests that took longer than a threshold.
+// Entries are added by the IO worker threads to a bounded lock-free queue
+// and are either drained by the application or, if a callback is set,
+// delivered to the callback on the session's thread. Entries are dropped
+// when the queue is full. The log is shared with the iterators returned to
+// the application so that it outlives a session that is reconnected or freed.
+class SlowQueryLog : public RefCounted<SlowQueryLog> {
+public:
+  struct Entry {
+    Entry(const Request* request, uint64_t latency_ns);
+
+    void to_cass(CassSlowQuery* output) const;
+
+    std::string statement;
+    std::vector<int32_t> bound_value_sizes; // -1 for null and unset values
+    Address coordinator;
+    bool has_coordinator;
+    CassConsistency consistency;
+    int retries;
+    CassError error;
+    uint64_t latency_ns;
+    LatencyBreakdown latency_breakdown;
+  };
+
+  SlowQueryLog(uint64_t threshold_ms, double sample_rate, size_t queue_size);
+  ~SlowQueryLog();
+
+  // Must be called on the thread that runs "loop" before it's run
+  int init_callback(uv_loop_t* loop, CassSlowQueryCallback callback, void* data);
+  void close_handles();
+
+  bool is_slow(uint64_t latency_ns) const {
+    return latency_ns >= threshold_ns_;
+  }
+
+  // Selects a fraction (the sample rate) of the slow requests. This is
+  // deterministic so that rare slow requests are still captured.
+  bool sample() {
+    uint64_t n = sample_count_.fetch_add(1, MEMORY_ORDER_RELAXED);
+    return static_cast<uint64_t>((n + 1) * sample_rate_) >
+        static_cast<uint64_t>(n * sample_rate_);
+  }
+
+  // Takes ownership of the entry
+  void add(Entry* entry);
+
+  // Removes the oldest entry, the caller takes ownership
+  bool remove(Entry** entry) { return queue_.dequeue(*entry); }
+
+  uint64_t dropped_count() const { return dropped_count_.load(MEMORY_ORDER_RELAXED); }
+
+private:
+#if UV_VERSION_MAJOR == 0
+  static void on_callback(uv_async_t* async, int status);
+#else
+  static void on_callback(uv_async_t* async);
+#endif
+
+private:
+  uint64_t threshold_ns_;
+  double sample_rate_;
+  Atomic<uint64_t> sample_count_;
+  Atomic<uint64_t> dropped_count_;
+  MPMCQueue<Entry*> queue_;
+  uv_async_t async_;
+  CassSlowQueryCallback callback_;
+  void* callback_data_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(SlowQueryLog);
+};
+
+} // namespace cass
+
+#endif
@@ -75,6 +75,16 @@ public:
         tail_.load(MEMORY_ORDER_ACQUIRE);
   }
 
+  // The number of entries in the queue. This is only an approximation when
+  // called from a thread other than the producer or consumer.
+  size_t size() const {
+    return (tail_.load(MEMORY_ORDER_ACQUIRE) -
+            head_.load(MEMORY_ORDER_ACQUIRE)) & mask_;
+  }
+
+  // One slot is always left empty to distinguish a full queue from an empty one
+  size_t capacity() const { return size_ - 1; }
+
   static void memory_fence() {
    // Internally, libuv has a "pending" flag check whose load can be reordered
    // before storing the data into the queue causing the data in the queue
@@ -0,0 +1,85 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "startup_report.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace cass {
+
+static const char* phase_name(StartupReport::Phase phase) {
+  switch (phase) {
+    case StartupReport::PHASE_RESOLVE: return "resolve";
+    case StartupReport::PHASE_CONTROL_CONNECTION: return "control connection";
+    case StartupReport::PHASE_SCHEMA: return "schema";
+    case StartupReport::PHASE_FIRST_POOL_READY: return "first pool ready";
+    case StartupReport::PHASE_ALL_POOLS_READY: return "all pools ready";
+    default: return "unknown";
+  }
+}
+
+void StartupReport::start(uint64_t now_ns) {
+  start_ns_ = now_ns;
+  for (int i = 0; i < PHASE_COUNT; ++i) {
+    finished_ns_[i] = 0;
+  }
+}
+
+void StartupReport::finish(Phase phase, uint64_t now_ns) {
+  if (is_finished(phase)) return;
+  for (int i = 0; i <= phase; ++i) {
+    if (finished_ns_[i] == 0) {
+      finished_ns_[i] = now_ns;
+    }
+  }
+}
+
+uint64_t StartupReport::duration_ns(Phase phase) const {
+  if (!is_finished(phase)) return 0;
+  uint64_t started_ns;
+  switch (phase) {
+    case PHASE_RESOLVE:
+      started_ns = start_ns_;
+      break;
+    case PHASE_FIRST_POOL_READY:
+    case PHASE_ALL_POOLS_READY:
+      started_ns = finished_ns_[PHASE_SCHEMA];
+      break;
+    default:
+      started_ns = finished_ns_[phase - 1];
+      break;
+  }
+  return finished_ns_[phase] > started_ns ? finished_ns_[phase] - started_ns : 0;
+}
+
+uint64_t StartupReport::total_ns() const {
+  if (!is_finished(PHASE_ALL_POOLS_READY)) return 0;
+  return finished_ns_[PHASE_ALL_POOLS_READY] - start_ns_;
+}
+
+std::string StartupReport::to_string() const {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(3);
+  for (int i = 0; i < PHASE_COUNT; ++i) {
+    Phase phase = static_cast<Phase>(i);
+    ss << phase_name(phase) << ": " << duration_ns(phase) / 1e6 << " ms, ";
+  }
+  ss << "total: " << total_ns() / 1e6 << " ms";
+  return ss.str();
+}
+
+} // namespace cass
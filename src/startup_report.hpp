@@ -0,0 +1,61 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_STARTUP_REPORT_HPP_INCLUDED__
+#define __CASS_STARTUP_REPORT_HPP_INCLUDED__
+
+#include <stdint.h>
+#include <string>
+
+namespace cass {
+
+// Timings of the phases of connecting a session. The resolve, control
+// connection and schema phases run one after the other. Both pool phases
+// start when the schema phase finishes because pools connect in parallel.
+class StartupReport {
+public:
+  enum Phase {
+    PHASE_RESOLVE,
+    PHASE_CONTROL_CONNECTION,
+    PHASE_SCHEMA,
+    PHASE_FIRST_POOL_READY,
+    PHASE_ALL_POOLS_READY,
+    PHASE_COUNT
+  };
+
+  StartupReport() { start(0); }
+
+  void start(uint64_t now_ns);
+
+  // Only the first call for a phase is recorded. Earlier phases that were
+  // skipped e.g. there was nothing to resolve, are finished at the same time.
+  void finish(Phase phase, uint64_t now_ns);
+
+  bool is_finished(Phase phase) const { return finished_ns_[phase] != 0; }
+
+  uint64_t duration_ns(Phase phase) const;
+  uint64_t total_ns() const;
+
+  std::string to_string() const;
+
+private:
+  uint64_t start_ns_;
+  uint64_t finished_ns_[PHASE_COUNT];
+};
+
+} // namespace cass
+
+#endif
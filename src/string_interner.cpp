@@ -0,0 +1,73 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "string_interner.hpp"
+
+#include "scoped_lock.hpp"
+
+#include <map>
+#include <uv.h>
+
+namespace cass {
+
+// The keys reference the interned strings' own storage
+typedef std::map<StringRef, InternedString::Ptr> InternedStringMap;
+
+static uv_once_t init_guard = UV_ONCE_INIT;
+static uv_mutex_t mutex;
+static InternedStringMap* strings;
+
+static void init() {
+  uv_mutex_init(&mutex);
+  // Never freed so that it's valid during static destruction
+  strings = new InternedStringMap();
+}
+
+InternedString::Ptr StringInterner::intern(const StringRef& str) {
+  uv_once(&init_guard, init);
+  ScopedMutex l(&mutex);
+  InternedStringMap::iterator i = strings->find(str);
+  if (i != strings->end()) {
+    return i->second;
+  }
+  InternedString::Ptr interned(new InternedString(str));
+  strings->insert(std::make_pair(StringRef(interned->str()), interned));
+  return interned;
+}
+
+size_t StringInterner::purge() {
+  uv_once(&init_guard, init);
+  ScopedMutex l(&mutex);
+  size_t count = 0;
+  InternedStringMap::iterator i = strings->begin();
+  while (i != strings->end()) {
+    if (i->second->ref_count() == 1) {
+      strings->erase(i++);
+      ++count;
+    } else {
+      ++i;
+    }
+  }
+  return count;
+}
+
+size_t StringInterner::size() {
+  uv_once(&init_guard, init);
+  ScopedMutex l(&mutex);
+  return strings->size();
+}
+
+} // namespace cass
@@ -0,0 +1,62 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_STRING_INTERNER_HPP_INCLUDED__
+#define __CASS_STRING_INTERNER_HPP_INCLUDED__
+
+#include "ref_counted.hpp"
+#include "string_ref.hpp"
+
+#include <string>
+
+namespace cass {
+
+class InternedString : public RefCounted<InternedString> {
+public:
+  typedef SharedRefPtr<const InternedString> Ptr;
+
+  InternedString(const StringRef& str)
+    : str_(str.data(), str.size()) { }
+
+  const std::string& str() const { return str_; }
+
+private:
+  const std::string str_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(InternedString);
+};
+
+// A process wide table of immutable strings. Schema metadata repeats the same
+// names (field names, common column names) across thousands of objects and
+// interning stores a single copy of each.
+//
+// Strings are only removed by purge() so that a string can't be released by
+// one thread while it's being interned by another. A string is purged when
+// the table holds its only reference.
+class StringInterner {
+public:
+  static InternedString::Ptr intern(const StringRef& str);
+
+  // Returns the number of strings removed
+  static size_t purge();
+
+  static size_t size();
+};
+
+} // namespace cass
+
+#endif
@@ -51,6 +51,8 @@ private:
 
     SharedRefPtr<Host> compute_next();
 
+    const CopyOnWriteHostVec* replicas() const { return &replicas_; }
+
   private:
     LoadBalancingPolicy* child_policy_;
     ScopedPtr<QueryPlan> child_plan_;
@@ -20,7 +20,6 @@
 #include "logger.hpp"
 #include "md5.hpp"
 #include "murmur3.hpp"
-#include "scoped_ptr.hpp"
 #include "utils.hpp"
 
 #include <uv.h>
@@ -98,7 +97,16 @@ void TokenMap::clear() {
   mapped_addresses_.clear();
   token_map_.clear();
   keyspace_replica_map_.clear();
+  strategy_replica_map_.clear();
   keyspace_strategy_map_.clear();
+  racks_.clear();
+}
+
+TokenMap::ConstPtr TokenMap::snapshot() const {
+  SharedRefPtr<TokenMap> token_map(new TokenMap());
+  token_map->partitioner_ = partitioner_;
+  token_map->keyspace_replica_map_ = keyspace_replica_map_;
+  return token_map;
 }
 
 void TokenMap::build() {
@@ -115,17 +123,24 @@ void TokenMap::set_partitioner(const std::string& partitioner_class) {
   if (partitioner_) return;
 
   if (ends_with(partitioner_class, Murmur3Partitioner::PARTITIONER_CLASS)) {
-    partitioner_.reset(new Murmur3Partitioner());
+    partitioner_ = SharedRefPtr<const Partitioner>(new Murmur3Partitioner());
   } else if (ends_with(partitioner_class, RandomPartitioner::PARTITIONER_CLASS)) {
-    partitioner_.reset(new RandomPartitioner());
+    partitioner_ = SharedRefPtr<const Partitioner>(new RandomPartitioner());
   } else if (ends_with(partitioner_class, ByteOrderedPartitioner::PARTITIONER_CLASS)) {
-    partitioner_.reset(new ByteOrderedPartitioner());
+    partitioner_ = SharedRefPtr<const Partitioner>(new ByteOrderedPartitioner());
   } else {
     LOG_WARN("Unsupported partitioner class '%s'", partitioner_class.c_str());
   }
 }
 
 void TokenMap::update_host(SharedRefPtr<Host>& host, const TokenStringList& token_strings) {
+  update_host(host, token_strings, host->dc(), host->rack());
+}
+
+void TokenMap::update_host(const SharedRefPtr<Host>& host,
+                           const TokenStringList& token_strings,
+                           const std::string& dc,
+                           const std::string& rack) {
   if (!partitioner_) return;
 
   // There's a chance to avoid purging if tokens are the same as existing; deemed
@@ -133,21 +148,25 @@ void TokenMap::update_host(SharedRefPtr<Host>& host, const TokenStringList& toke
   // 1.) Updates should only happen on "new" host, or "moved"
   // 2.) Moving should only occur on non-vnode clusters, in which case the
   //     token map is relatively small and easy to purge/repopulate
-  purge_address(host->address());
+  TokenVec changed_tokens;
+  purge_address(host->address(), &changed_tokens);
 
   for (TokenStringList::const_iterator i = token_strings.begin();
        i != token_strings.end(); ++i) {
-    token_map_[partitioner_->token_from_string_ref(*i)] = host;
+    Token token(partitioner_->token_from_string_ref(*i));
+    token_map_[token] = TokenHost(host, dc, rack);
+    changed_tokens.push_back(token);
   }
   mapped_addresses_.insert(host->address());
-  map_replicas();
+  update_replicas(changed_tokens);
 }
 
 void TokenMap::remove_host(SharedRefPtr<Host>& host) {
   if (!partitioner_) return;
 
-  if (purge_address(host->address())) {
-    map_replicas();
+  TokenVec changed_tokens;
+  if (purge_address(host->address(), &changed_tokens)) {
+    update_replicas(changed_tokens);
   }
 }
 
@@ -157,20 +176,38 @@ void TokenMap::update_keyspace(const std::string& ks_name, const KeyspaceMetadat
   KeyspaceStrategyMap::iterator i = keyspace_strategy_map_.find(ks_name);
   if (i == keyspace_strategy_map_.end() || !i->second->equal(ks_meta)) {
     SharedRefPtr<ReplicationStrategy> strategy(ReplicationStrategy::from_keyspace_meta(ks_meta));
-    map_keyspace_replicas(ks_name, strategy);
+    ReplicaSetInterner interner;
+    map_keyspace_replicas(ks_name, strategy, &interner);
     if (i == keyspace_strategy_map_.end()) {
       keyspace_strategy_map_[ks_name] = strategy;
     } else {
+      std::string previous_key(i->second->key());
       i->second = strategy;
+      purge_strategy_replicas(previous_key);
     }
   }
 }
 
+void TokenMap::update_keyspace(const std::string& ks_name,
+                               const SharedRefPtr<ReplicationStrategy>& strategy) {
+  if (!partitioner_) return;
+
+  KeyspaceStrategyMap::iterator i = keyspace_strategy_map_.find(ks_name);
+  if (i == keyspace_strategy_map_.end() || i->second->key() != strategy->key()) {
+    set_replication_strategy(ks_name, strategy);
+  }
+}
+
 void TokenMap::drop_keyspace(const std::string& ks_name) {
   if (!partitioner_) return;
 
   keyspace_replica_map_.erase(ks_name);
-  keyspace_strategy_map_.erase(ks_name);
+  KeyspaceStrategyMap::iterator i = keyspace_strategy_map_.find(ks_name);
+  if (i != keyspace_strategy_map_.end()) {
+    std::string key(i->second->key());
+    keyspace_strategy_map_.erase(i);
+    purge_strategy_replicas(key);
+  }
 }
 
 const CopyOnWriteHostVec& TokenMap::get_replicas(const std::string& ks_name,
@@ -179,7 +216,7 @@ const CopyOnWriteHostVec& TokenMap::get_replicas(const std::string& ks_name,
 
   KeyspaceReplicaMap::const_iterator tokens_it = keyspace_replica_map_.find(ks_name);
   if (tokens_it != keyspace_replica_map_.end()) {
-    const TokenReplicaMap& tokens_to_replicas = tokens_it->second;
+    const TokenReplicaMap& tokens_to_replicas = *tokens_it->second;
 
     const Token t = partitioner_->hash(reinterpret_cast<const uint8_t*>(routing_key.data()), routing_key.size());
     TokenReplicaMap::const_iterator replicas_it = tokens_to_replicas.upper_bound(t);
@@ -197,30 +234,100 @@ const CopyOnWriteHostVec& TokenMap::get_replicas(const std::string& ks_name,
 
 void TokenMap::set_replication_strategy(const std::string& ks_name,
                                         const SharedRefPtr<ReplicationStrategy>& strategy) {
+  KeyspaceStrategyMap::iterator i = keyspace_strategy_map_.find(ks_name);
+  std::string previous_key(i != keyspace_strategy_map_.end() ? i->second->key() : "");
   keyspace_strategy_map_[ks_name] = strategy;
-  map_keyspace_replicas(ks_name, strategy);
+  ReplicaSetInterner interner;
+  map_keyspace_replicas(ks_name, strategy, &interner);
+  if (!previous_key.empty()) {
+    purge_strategy_replicas(previous_key);
+  }
 }
 
 void TokenMap::map_replicas(bool force) {
   if (keyspace_replica_map_.empty() && !force) {// do nothing ahead of first build
     return;
   }
+  // The hosts or tokens changed so all the shared replicas are recomputed
+  strategy_replica_map_.clear();
+  racks_ = racks_in_dcs(token_map_);
+  ReplicaSetInterner interner;
   for (KeyspaceStrategyMap::const_iterator i = keyspace_strategy_map_.begin();
        i != keyspace_strategy_map_.end(); ++i) {
-    map_keyspace_replicas(i->first, i->second, force);
+    map_keyspace_replicas(i->first, i->second, &interner, force);
+  }
+}
+
+void TokenMap::update_replicas(const TokenVec& changed_tokens) {
+  if (keyspace_replica_map_.empty()) {// do nothing ahead of first build
+    return;
+  }
+
+  // Rack aware placement depends on the number of racks in each DC so a
+  // host that adds or removes a rack changes the replicas of every token
+  if (racks_in_dcs(token_map_) != racks_) {
+    map_replicas();
+    return;
+  }
+
+  for (StrategyReplicaMap::iterator i = strategy_replica_map_.begin();
+       i != strategy_replica_map_.end(); ++i) {
+    i->second.first->update_tokens_to_replicas(token_map_, changed_tokens,
+                                                &(*i->second.second));
+  }
+
+  // Updating a shared map makes a copy so the keyspaces are pointed at the
+  // updated maps
+  for (KeyspaceReplicaMap::iterator i = keyspace_replica_map_.begin();
+       i != keyspace_replica_map_.end(); ++i) {
+    KeyspaceStrategyMap::const_iterator strategy = keyspace_strategy_map_.find(i->first);
+    if (strategy == keyspace_strategy_map_.end()) continue;
+    StrategyReplicaMap::const_iterator replicas = strategy_replica_map_.find(strategy->second->key());
+    if (replicas != strategy_replica_map_.end()) {
+      i->second = replicas->second.second;
+    }
   }
 }
 
 void TokenMap::map_keyspace_replicas(const std::string& ks_name,
                                      const SharedRefPtr<ReplicationStrategy>& strategy,
+                                     ReplicaSetInterner* interner,
                                      bool force) {
   if (keyspace_replica_map_.empty() && !force) {// do nothing ahead of first build
     return;
   }
-  strategy->tokens_to_replicas(token_map_, &keyspace_replica_map_[ks_name]);
+  CopyOnWriteTokenReplicaMap replicas(strategy_replicas(strategy, interner));
+  KeyspaceReplicaMap::iterator i = keyspace_replica_map_.find(ks_name);
+  if (i == keyspace_replica_map_.end()) {
+    keyspace_replica_map_.insert(std::make_pair(ks_name, replicas));
+  } else {
+    i->second = replicas;
+  }
 }
 
-bool TokenMap::purge_address(const Address& addr) {
+TokenMap::CopyOnWriteTokenReplicaMap TokenMap::strategy_replicas(const SharedRefPtr<ReplicationStrategy>& strategy,
+                                                                 ReplicaSetInterner* interner) {
+  StrategyReplicaMap::iterator i = strategy_replica_map_.find(strategy->key());
+  if (i != strategy_replica_map_.end()) {
+    return i->second.second;
+  }
+  CopyOnWriteTokenReplicaMap replicas(new TokenReplicaMap());
+  strategy->tokens_to_replicas(token_map_, &(*replicas));
+  interner->intern_all(&(*replicas));
+  strategy_replica_map_.insert(std::make_pair(strategy->key(),
+                                              StrategyReplicas(strategy, replicas)));
+  return replicas;
+}
+
+void TokenMap::purge_strategy_replicas(const std::string& strategy_key) {
+  for (KeyspaceStrategyMap::const_iterator i = keyspace_strategy_map_.begin();
+       i != keyspace_strategy_map_.end(); ++i) {
+    if (i->second->key() == strategy_key) return; // Still in use
+  }
+  strategy_replica_map_.erase(strategy_key);
+}
+
+bool TokenMap::purge_address(const Address& addr, TokenVec* removed_tokens) {
   AddressSet::iterator addr_itr = mapped_addresses_.find(addr);
   if (addr_itr == mapped_addresses_.end()) {
     return false;
@@ -228,7 +335,10 @@ bool TokenMap::purge_address(const Address& addr) {
 
   TokenHostMap::iterator i = token_map_.begin();
   while (i != token_map_.end()) {
-    if (addr.compare(i->second->address()) == 0) {
+    if (addr.compare(i->second.host->address()) == 0) {
+      if (removed_tokens != NULL) {
+        removed_tokens->push_back(i->first);
+      }
       TokenHostMap::iterator to_erase = i++;
       token_map_.erase(to_erase);
     } else {
@@ -20,8 +20,8 @@
 #include "buffer.hpp"
 #include "copy_on_write_ptr.hpp"
 #include "host.hpp"
+#include "ref_counted.hpp"
 #include "replication_strategy.hpp"
-#include "scoped_ptr.hpp"
 #include "string_ref.hpp"
 
 #include <map>
@@ -31,24 +31,38 @@ namespace cass {
 
 typedef std::vector<StringRef> TokenStringList;
 
-class Partitioner {
+class Partitioner : public RefCounted<Partitioner> {
 public:
   virtual ~Partitioner() {}
   virtual Token token_from_string_ref(const StringRef& token_string_ref) const = 0;
   virtual Token hash(const uint8_t* data, size_t size) const = 0;
 };
 
-class TokenMap {
+class TokenMap : public RefCounted<TokenMap> {
 public:
+  typedef SharedRefPtr<const TokenMap> ConstPtr;
+
   virtual ~TokenMap() {}
 
   void clear();
   void build();
 
+  // Returns an immutable copy that can only be used to get replicas. The
+  // replica maps are shared with this token map so this is inexpensive.
+  ConstPtr snapshot() const;
+
   void set_partitioner(const std::string& partitioner_class);
+  // Uses the host's current data center and rack so this must be called on
+  // the thread that updates the host
   void update_host(SharedRefPtr<Host>& host, const TokenStringList& token_strings);
+  void update_host(const SharedRefPtr<Host>& host,
+                   const TokenStringList& token_strings,
+                   const std::string& dc,
+                   const std::string& rack);
   void remove_host(SharedRefPtr<Host>& host);
   void update_keyspace(const std::string& ks_name, const KeyspaceMetadata& ks_meta);
+  void update_keyspace(const std::string& ks_name,
+                       const SharedRefPtr<ReplicationStrategy>& strategy);
   void drop_keyspace(const std::string& ks_name);
   const CopyOnWriteHostVec& get_replicas(const std::string& ks_name,
                                          const std::string& routing_key) const;
@@ -56,27 +70,44 @@ public:
   // Testing only
   void set_replication_strategy(const std::string& ks_name,
                                 const SharedRefPtr<ReplicationStrategy>& strategy);
+  size_t replica_map_count() const { return strategy_replica_map_.size(); }
 
 private:
+  typedef CopyOnWritePtr<TokenReplicaMap> CopyOnWriteTokenReplicaMap;
+
   void map_replicas(bool force = false);
+  void update_replicas(const TokenVec& changed_tokens);
   void map_keyspace_replicas(const std::string& ks_name,
                              const SharedRefPtr<ReplicationStrategy>& strategy,
+                             ReplicaSetInterner* interner,
                              bool force = false);
-  bool purge_address(const Address& addr);
+  CopyOnWriteTokenReplicaMap strategy_replicas(const SharedRefPtr<ReplicationStrategy>& strategy,
+                                               ReplicaSetInterner* interner);
+  void purge_strategy_replicas(const std::string& strategy_key);
+  bool purge_address(const Address& addr, TokenVec* removed_tokens = NULL);
 
 protected:
   TokenHostMap token_map_;
 
-  typedef std::map<std::string, TokenReplicaMap> KeyspaceReplicaMap;
+  // Keyspaces that have the same replication strategy share the same
+  // replicas. The shared maps are keyed by ReplicationStrategy::key().
+  typedef std::map<std::string, CopyOnWriteTokenReplicaMap> KeyspaceReplicaMap;
   KeyspaceReplicaMap keyspace_replica_map_;
 
+  typedef std::pair<SharedRefPtr<ReplicationStrategy>, CopyOnWriteTokenReplicaMap> StrategyReplicas;
+  typedef std::map<std::string, StrategyReplicas> StrategyReplicaMap;
+  StrategyReplicaMap strategy_replica_map_;
+
   typedef std::map<std::string, SharedRefPtr<ReplicationStrategy> > KeyspaceStrategyMap;
   KeyspaceStrategyMap keyspace_strategy_map_;
 
   typedef std::set<Address> AddressSet;
   AddressSet mapped_addresses_;
 
-  ScopedPtr<Partitioner> partitioner_;
+  // The racks in each DC as of the last full rebuild
+  DCRackMap racks_;
+
+  SharedRefPtr<const Partitioner> partitioner_;
 };
 
 
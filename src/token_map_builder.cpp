@@ -0,0 +1,207 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "token_map_builder.hpp"
+
+#include "metadata.hpp"
+#include "scoped_lock.hpp"
+
+#include <assert.h>
+
+namespace cass {
+
+TokenMapBuilder::TokenMapBuilder()
+  : loop_(NULL)
+  , is_working_(false)
+  , is_built_(false)
+  , snapshot_(new TokenMap()) {
+  work_request_.data = this;
+  uv_mutex_init(&mutex_);
+}
+
+TokenMapBuilder::~TokenMapBuilder() {
+  uv_mutex_destroy(&mutex_);
+}
+
+void TokenMapBuilder::set_partitioner(const std::string& partitioner_class) {
+  Update update(Update::SET_PARTITIONER);
+  update.name = partitioner_class;
+  add(update);
+}
+
+void TokenMapBuilder::update_host(const SharedRefPtr<Host>& host, const TokenStringList& tokens) {
+  Update update(Update::UPDATE_HOST);
+  update.host = host;
+  update.dc = host->dc();
+  update.rack = host->rack();
+  // The tokens reference the response so they're copied
+  update.tokens.reserve(tokens.size());
+  for (TokenStringList::const_iterator i = tokens.begin(),
+       end = tokens.end(); i != end; ++i) {
+    update.tokens.push_back(i->to_string());
+  }
+  add(update);
+}
+
+void TokenMapBuilder::remove_host(const SharedRefPtr<Host>& host) {
+  Update update(Update::REMOVE_HOST);
+  update.host = host;
+  add(update);
+}
+
+void TokenMapBuilder::update_keyspace(const std::string& ks_name, const KeyspaceMetadata& ks_meta) {
+  // The keyspace metadata is only valid on this thread so the strategy is
+  // created here
+  update_keyspace(ks_name, ReplicationStrategy::from_keyspace_meta(ks_meta));
+}
+
+void TokenMapBuilder::update_keyspace(const std::string& ks_name,
+                                      const SharedRefPtr<ReplicationStrategy>& strategy) {
+  Update update(Update::UPDATE_KEYSPACE);
+  update.name = ks_name;
+  update.strategy = strategy;
+  add(update);
+}
+
+void TokenMapBuilder::drop_keyspace(const std::string& ks_name) {
+  Update update(Update::DROP_KEYSPACE);
+  update.name = ks_name;
+  add(update);
+}
+
+void TokenMapBuilder::build() {
+  add(Update(Update::BUILD));
+}
+
+void TokenMapBuilder::clear() {
+  add(Update(Update::CLEAR));
+}
+
+void TokenMapBuilder::reset() {
+  assert(!is_working_ && "Unable to reset while changes are being applied");
+  pending_.clear();
+  token_map_.clear();
+  is_built_ = false;
+  publish(TokenMap::ConstPtr(new TokenMap()));
+}
+
+TokenMap::ConstPtr TokenMapBuilder::snapshot() const {
+  ScopedMutex l(&mutex_);
+  return snapshot_;
+}
+
+void TokenMapBuilder::add(const Update& update) {
+  pending_.push_back(update);
+
+  if (loop_ == NULL) {
+    UpdateVec updates;
+    updates.swap(pending_);
+    apply(updates);
+    if (applied_snapshot_) {
+      publish(applied_snapshot_);
+      applied_snapshot_.reset();
+    }
+    return;
+  }
+
+  if (!is_working_) {
+    applying_.swap(pending_);
+    is_working_ = true;
+    inc_ref(); // Keep alive until the work is done
+    uv_queue_work(loop_, &work_request_, on_work, on_after_work);
+  }
+}
+
+void TokenMapBuilder::apply(const UpdateVec& updates) {
+  for (UpdateVec::const_iterator i = updates.begin(),
+       end = updates.end(); i != end; ++i) {
+    SharedRefPtr<Host> host(i->host);
+    switch (i->type) {
+      case Update::SET_PARTITIONER:
+        token_map_.set_partitioner(i->name);
+        break;
+
+      case Update::UPDATE_HOST: {
+        TokenStringList tokens(i->tokens.begin(), i->tokens.end());
+        token_map_.update_host(host, tokens, i->dc, i->rack);
+        break;
+      }
+
+      case Update::REMOVE_HOST:
+        token_map_.remove_host(host);
+        break;
+
+      case Update::UPDATE_KEYSPACE:
+        token_map_.update_keyspace(i->name, i->strategy);
+        break;
+
+      case Update::DROP_KEYSPACE:
+        token_map_.drop_keyspace(i->name);
+        break;
+
+      case Update::BUILD:
+        token_map_.build();
+        is_built_ = true;
+        break;
+
+      case Update::CLEAR:
+        token_map_.clear();
+        is_built_ = false;
+        break;
+    }
+  }
+
+  if (is_built_) {
+    applied_snapshot_ = token_map_.snapshot();
+  }
+}
+
+void TokenMapBuilder::publish(const TokenMap::ConstPtr& snapshot) {
+  // The previous snapshot is released outside of the lock
+  TokenMap::ConstPtr previous;
+  {
+    ScopedMutex l(&mutex_);
+    previous = snapshot_;
+    snapshot_ = snapshot;
+  }
+}
+
+void TokenMapBuilder::on_work(uv_work_t* request) {
+  TokenMapBuilder* builder = static_cast<TokenMapBuilder*>(request->data);
+  builder->apply(builder->applying_);
+  builder->applying_.clear();
+}
+
+void TokenMapBuilder::on_after_work(uv_work_t* request, int status) {
+  TokenMapBuilder* builder = static_cast<TokenMapBuilder*>(request->data);
+
+  if (builder->applied_snapshot_) {
+    builder->publish(builder->applied_snapshot_);
+    builder->applied_snapshot_.reset();
+  }
+
+  builder->is_working_ = false;
+  if (!builder->pending_.empty()) {
+    builder->applying_.swap(builder->pending_);
+    builder->is_working_ = true;
+    builder->inc_ref();
+    uv_queue_work(builder->loop_, &builder->work_request_, on_work, on_after_work);
+  }
+
+  builder->dec_ref();
+}
+
+} // namespace cass
@@ -0,0 +1,122 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_TOKEN_MAP_BUILDER_HPP_INCLUDED__
+#define __CASS_TOKEN_MAP_BUILDER_HPP_INCLUDED__
+
+#include "host.hpp"
+#include "macros.hpp"
+#include "ref_counted.hpp"
+#include "replication_strategy.hpp"
+#include "token_map.hpp"
+
+#include <string>
+#include <uv.h>
+#include <vector>
+
+namespace cass {
+
+class KeyspaceMetadata;
+
+// Owns a private token map that topology and keyspace changes are applied
+// to. When a loop is set the changes are applied on the libuv thread pool so
+// that rebuilding replicas never blocks the loop's thread. After each batch
+// of changes an immutable snapshot is published that can be read from any
+// thread. Snapshots aren't published between a clear() and the next build()
+// so the previous snapshot is used while the token map is being refreshed.
+class TokenMapBuilder : public RefCounted<TokenMapBuilder> {
+public:
+  TokenMapBuilder();
+  ~TokenMapBuilder();
+
+  // The following methods must be called on the loop's thread
+  void set_loop(uv_loop_t* loop) { loop_ = loop; }
+
+  void set_partitioner(const std::string& partitioner_class);
+  void update_host(const SharedRefPtr<Host>& host, const TokenStringList& tokens);
+  void remove_host(const SharedRefPtr<Host>& host);
+  void update_keyspace(const std::string& ks_name, const KeyspaceMetadata& ks_meta);
+  void update_keyspace(const std::string& ks_name,
+                       const SharedRefPtr<ReplicationStrategy>& strategy);
+  void drop_keyspace(const std::string& ks_name);
+  void build();
+  void clear();
+
+  // Discards the token map and publishes an empty snapshot. This must only
+  // be called when no changes are being applied e.g. when the loop isn't
+  // running.
+  void reset();
+
+  // This can be called from any thread
+  TokenMap::ConstPtr snapshot() const;
+
+private:
+  struct Update {
+    enum Type {
+      SET_PARTITIONER,
+      UPDATE_HOST,
+      REMOVE_HOST,
+      UPDATE_KEYSPACE,
+      DROP_KEYSPACE,
+      BUILD,
+      CLEAR
+    };
+
+    Update(Type type)
+      : type(type) { }
+
+    Type type;
+    std::string name; // The partitioner class or keyspace name
+    SharedRefPtr<Host> host;
+    std::string dc;   // The host's data center and rack are copied because
+    std::string rack; // the host can change while the update is applied
+    std::vector<std::string> tokens;
+    SharedRefPtr<ReplicationStrategy> strategy;
+  };
+
+  typedef std::vector<Update> UpdateVec;
+
+  void add(const Update& update);
+  void apply(const UpdateVec& updates);
+  void publish(const TokenMap::ConstPtr& snapshot);
+
+  static void on_work(uv_work_t* request);
+  static void on_after_work(uv_work_t* request, int status);
+
+private:
+  uv_loop_t* loop_;
+  uv_work_t work_request_;
+  bool is_working_;
+
+  // Only used on the loop's thread
+  UpdateVec pending_;
+
+  // Only used by the thread applying the changes
+  UpdateVec applying_;
+  TokenMap token_map_;
+  bool is_built_;
+  TokenMap::ConstPtr applied_snapshot_;
+
+  mutable uv_mutex_t mutex_;
+  TokenMap::ConstPtr snapshot_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(TokenMapBuilder);
+};
+
+} // namespace cass
+
+#endif
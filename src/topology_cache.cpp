@@ -0,0 +1,324 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "topology_cache.hpp"
+
+#include "logger.hpp"
+#include "serialization.hpp"
+
+#include <stdio.h>
+
+#define TOPOLOGY_CACHE_MAGIC "CASSTOPO"
+#define TOPOLOGY_CACHE_MAGIC_SIZE 8
+
+namespace cass {
+
+class TopologyCacheEncoder {
+public:
+  TopologyCacheEncoder(std::string* output)
+    : output_(output) { }
+
+  void encode_int(int32_t value) {
+    char buf[sizeof(int32_t)];
+    encode_int32(buf, value);
+    output_->append(buf, sizeof(int32_t));
+  }
+
+  void encode_string(const std::string& value) {
+    encode_int(static_cast<int32_t>(value.size()));
+    output_->append(value);
+  }
+
+private:
+  std::string* output_;
+};
+
+// Every read is bounds checked because the file could be truncated or
+// corrupt
+class TopologyCacheDecoder {
+public:
+  TopologyCacheDecoder(const char* data, size_t size)
+    : pos_(data)
+    , end_(data + size) { }
+
+  bool decode_bytes(size_t size, StringRef* output) {
+    if (static_cast<size_t>(end_ - pos_) < size) return false;
+    *output = StringRef(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool decode_int(int32_t* output) {
+    if (static_cast<size_t>(end_ - pos_) < sizeof(int32_t)) return false;
+    decode_int32(const_cast<char*>(pos_), *output);
+    pos_ += sizeof(int32_t);
+    return true;
+  }
+
+  bool decode_count(size_t* output) {
+    int32_t count;
+    if (!decode_int(&count) || count < 0) return false;
+    *output = static_cast<size_t>(count);
+    return true;
+  }
+
+  bool decode_string(std::string* output) {
+    size_t size;
+    StringRef bytes;
+    if (!decode_count(&size) || !decode_bytes(size, &bytes)) return false;
+    output->assign(bytes.data(), bytes.size());
+    return true;
+  }
+
+  bool is_done() const { return pos_ == end_; }
+
+private:
+  const char* pos_;
+  const char* end_;
+};
+
+void TopologyCache::encode(std::string* output) const {
+  TopologyCacheEncoder encoder(output);
+
+  output->append(TOPOLOGY_CACHE_MAGIC, TOPOLOGY_CACHE_MAGIC_SIZE);
+  encoder.encode_int(FORMAT_VERSION);
+  encoder.encode_string(schema_version);
+  encoder.encode_string(partitioner);
+
+  encoder.encode_int(static_cast<int32_t>(hosts.size()));
+  for (HostEntryMap::const_iterator i = hosts.begin(),
+       end = hosts.end(); i != end; ++i) {
+    const HostEntry& host = i->second;
+    encoder.encode_string(host.address.to_string());
+    encoder.encode_int(host.address.port());
+    encoder.encode_string(host.dc);
+    encoder.encode_string(host.rack);
+    encoder.encode_string(host.release_version);
+    encoder.encode_string(host.listen_address);
+    encoder.encode_int(static_cast<int32_t>(host.tokens.size()));
+    for (StringVec::const_iterator t = host.tokens.begin(),
+         tokens_end = host.tokens.end(); t != tokens_end; ++t) {
+      encoder.encode_string(*t);
+    }
+  }
+
+  encoder.encode_int(static_cast<int32_t>(keyspaces.size()));
+  for (KeyspaceEntryMap::const_iterator i = keyspaces.begin(),
+       end = keyspaces.end(); i != end; ++i) {
+    encoder.encode_string(i->first);
+    encoder.encode_string(i->second.strategy_class);
+    encoder.encode_int(static_cast<int32_t>(i->second.options.size()));
+    for (ReplicationStrategy::OptionsMap::const_iterator o = i->second.options.begin(),
+         options_end = i->second.options.end(); o != options_end; ++o) {
+      encoder.encode_string(o->first);
+      encoder.encode_string(o->second);
+    }
+  }
+}
+
+bool TopologyCache::decode(const char* data, size_t size) {
+  clear();
+
+  TopologyCacheDecoder decoder(data, size);
+
+  StringRef magic;
+  int32_t format_version;
+  if (!decoder.decode_bytes(TOPOLOGY_CACHE_MAGIC_SIZE, &magic) ||
+      magic != StringRef(TOPOLOGY_CACHE_MAGIC) ||
+      !decoder.decode_int(&format_version) ||
+      format_version != FORMAT_VERSION ||
+      !decoder.decode_string(&schema_version) ||
+      !decoder.decode_string(&partitioner)) {
+    clear();
+    return false;
+  }
+
+  size_t host_count;
+  if (!decoder.decode_count(&host_count)) {
+    clear();
+    return false;
+  }
+  for (size_t i = 0; i < host_count; ++i) {
+    HostEntry host;
+    std::string address;
+    int32_t port;
+    size_t token_count;
+    if (!decoder.decode_string(&address) ||
+        !decoder.decode_int(&port) ||
+        !Address::from_string(address, port, &host.address) ||
+        !decoder.decode_string(&host.dc) ||
+        !decoder.decode_string(&host.rack) ||
+        !decoder.decode_string(&host.release_version) ||
+        !decoder.decode_string(&host.listen_address) ||
+        !decoder.decode_count(&token_count)) {
+      clear();
+      return false;
+    }
+    host.tokens.resize(token_count);
+    for (size_t t = 0; t < token_count; ++t) {
+      if (!decoder.decode_string(&host.tokens[t])) {
+        clear();
+        return false;
+      }
+    }
+    hosts[host.address] = host;
+  }
+
+  size_t keyspace_count;
+  if (!decoder.decode_count(&keyspace_count)) {
+    clear();
+    return false;
+  }
+  for (size_t i = 0; i < keyspace_count; ++i) {
+    std::string name;
+    KeyspaceEntry keyspace;
+    size_t option_count;
+    if (!decoder.decode_string(&name) ||
+        !decoder.decode_string(&keyspace.strategy_class) ||
+        !decoder.decode_count(&option_count)) {
+      clear();
+      return false;
+    }
+    for (size_t o = 0; o < option_count; ++o) {
+      std::string key;
+      std::string value;
+      if (!decoder.decode_string(&key) || !decoder.decode_string(&value)) {
+        clear();
+        return false;
+      }
+      keyspace.options[key] = value;
+    }
+    keyspaces[name] = keyspace;
+  }
+
+  if (!decoder.is_done()) {
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool TopologyCache::load(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    LOG_DEBUG("No topology cache found at \"%s\"", path.c_str());
+    return false;
+  }
+
+  std::string data;
+  char buf[4096];
+  size_t size;
+  while ((size = fread(buf, 1, sizeof(buf), file)) > 0) {
+    data.append(buf, size);
+  }
+  bool is_error = ferror(file) != 0;
+  fclose(file);
+
+  if (is_error || !decode(data.data(), data.size())) {
+    LOG_WARN("Ignoring invalid topology cache \"%s\"", path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool TopologyCache::save(const std::string& path) const {
+  std::string data;
+  encode(&data);
+  return write(path, data);
+}
+
+bool TopologyCache::write(const std::string& path, const std::string& data) {
+  std::string temp_path(path + ".tmp");
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (file == NULL) {
+    LOG_WARN("Unable to open topology cache \"%s\" for writing", temp_path.c_str());
+    return false;
+  }
+
+  bool is_error = fwrite(data.data(), 1, data.size(), file) != data.size();
+  is_error = (fclose(file) != 0) || is_error;
+
+#ifdef _WIN32
+  // Windows doesn't replace an existing file when renaming
+  if (!is_error) remove(path.c_str());
+#endif
+
+  if (is_error || rename(temp_path.c_str(), path.c_str()) != 0) {
+    LOG_WARN("Unable to write topology cache \"%s\"", path.c_str());
+    remove(temp_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+void TopologyCache::clear() {
+  schema_version.clear();
+  partitioner.clear();
+  hosts.clear();
+  keyspaces.clear();
+}
+
+void TopologyCacheWriter::save(const std::string& path, const TopologyCache& cache) {
+  if (loop_ == NULL) {
+    if (cache.save(path)) {
+      LOG_DEBUG("Saved topology cache \"%s\"", path.c_str());
+    }
+    return;
+  }
+
+  pending_path_ = path;
+  pending_data_.clear();
+  cache.encode(&pending_data_);
+  has_pending_ = true;
+  if (!is_working_) {
+    start();
+  }
+}
+
+void TopologyCacheWriter::start() {
+  path_.swap(pending_path_);
+  data_.swap(pending_data_);
+  has_pending_ = false;
+  result_ = false;
+  is_working_ = true;
+  int rc = uv_queue_work(loop_, &req_, on_work, on_after_work);
+  if (rc != 0) {
+    is_working_ = false;
+    LOG_WARN("Unable to queue the topology cache write");
+  }
+}
+
+void TopologyCacheWriter::on_work(uv_work_t* req) {
+  TopologyCacheWriter* writer = static_cast<TopologyCacheWriter*>(req->data);
+  writer->result_ = TopologyCache::write(writer->path_, writer->data_);
+}
+
+void TopologyCacheWriter::on_after_work(uv_work_t* req, int status) {
+  TopologyCacheWriter* writer = static_cast<TopologyCacheWriter*>(req->data);
+  writer->is_working_ = false;
+  if (writer->result_) {
+    LOG_DEBUG("Saved topology cache \"%s\"", writer->path_.c_str());
+  }
+  writer->data_.clear();
+  if (writer->has_pending_) {
+    writer->start();
+  }
+}
+
+} // namespace cass
@@ -0,0 +1,134 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_TOPOLOGY_CACHE_HPP_INCLUDED__
+#define __CASS_TOPOLOGY_CACHE_HPP_INCLUDED__
+
+#include "address.hpp"
+#include "replication_strategy.hpp"
+#include "string_ref.hpp"
+
+#include <map>
+#include <string>
+#include <uv.h>
+
+namespace cass {
+
+// A snapshot of the cluster's hosts, tokens, partitioner and keyspace
+// replication that is persisted between process starts so that a session can
+// open pools and route token-aware requests before the control connection
+// has refreshed the cluster's metadata.
+//
+// The file is a flat sequence of big-endian length prefixed fields so it can
+// be decoded in a single pass directly from a read or mapped buffer:
+//
+//   [magic "CASSTOPO"][int format version]
+//   [string schema version][string partitioner]
+//   [int host count]
+//     [string address][int port][string dc][string rack]
+//     [string release version][string listen address]
+//     [int token count][string token]...
+//   [int keyspace count]
+//     [string name][string strategy class]
+//     [int option count][string key][string value]...
+class TopologyCache {
+public:
+  static const int32_t FORMAT_VERSION = 1;
+
+  struct HostEntry {
+    Address address;
+    std::string dc;
+    std::string rack;
+    std::string release_version;
+    std::string listen_address;
+    StringVec tokens;
+  };
+
+  typedef std::map<Address, HostEntry> HostEntryMap;
+
+  struct KeyspaceEntry {
+    std::string strategy_class;
+    ReplicationStrategy::OptionsMap options;
+  };
+
+  typedef std::map<std::string, KeyspaceEntry> KeyspaceEntryMap;
+
+  void encode(std::string* output) const;
+
+  // Returns false if the data is truncated, corrupt or from a different format
+  // version.
+  bool decode(const char* data, size_t size);
+
+  bool load(const std::string& path);
+
+  // The cache is written to a temporary file that replaces the previous file
+  // so that a partially written cache is never loaded.
+  bool save(const std::string& path) const;
+
+  // Writes encoded cache data using a temporary file
+  static bool write(const std::string& path, const std::string& data);
+
+  void clear();
+
+public:
+  std::string schema_version;
+  std::string partitioner;
+  HostEntryMap hosts;
+  KeyspaceEntryMap keyspaces;
+};
+
+// Saves topology caches on an event loop's thread pool so the loop never
+// blocks on file I/O. Only one write is in progress at a time and a save
+// requested during a write replaces any save that's still waiting, so the
+// file always ends up with the most recent cache. Caches are written
+// immediately when no loop is set.
+class TopologyCacheWriter {
+public:
+  TopologyCacheWriter()
+    : loop_(NULL)
+    , is_working_(false)
+    , has_pending_(false) {
+    req_.data = this;
+  }
+
+  void set_loop(uv_loop_t* loop) { loop_ = loop; }
+
+  // The cache is encoded on the calling thread
+  void save(const std::string& path, const TopologyCache& cache);
+
+  bool is_working() const { return is_working_; }
+
+private:
+  void start();
+
+  static void on_work(uv_work_t* req);
+  static void on_after_work(uv_work_t* req, int status);
+
+private:
+  uv_loop_t* loop_;
+  uv_work_t req_;
+  bool is_working_;
+  bool has_pending_;
+  std::string path_;
+  std::string data_;
+  bool result_;
+  std::string pending_path_;
+  std::string pending_data_;
+};
+
+} // namespace cass
+
+#endif
@@ -0,0 +1,213 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "trace_handler.hpp"
+
+#include "connection.hpp"
+#include "control_connection.hpp"
+#include "logger.hpp"
+#include "result_iterator.hpp"
+#include "result_response.hpp"
+#include "serialization.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+
+#define INITIAL_TRACE_RETRY_WAIT_MS 3
+#define MAX_TRACE_RETRY_WAIT_MS 250
+
+namespace cass {
+
+static void get_string(const Value* value, const char** output, size_t* output_length) {
+  if (value == NULL || value->is_null()) {
+    *output = NULL;
+    *output_length = 0;
+  } else {
+    *output = value->data();
+    *output_length = value->size();
+  }
+}
+
+static void get_inet(const Value* value, CassInet* output) {
+  memset(output, 0, sizeof(CassInet));
+  if (value != NULL && !value->is_null() &&
+      value->size() <= static_cast<int32_t>(sizeof(output->address))) {
+    output->address_length = value->size();
+    memcpy(output->address, value->data(), value->size());
+  }
+}
+
+void TraceHandler::fetch(ControlConnection* control_connection,
+                         TraceFuture* future,
+                         uint64_t max_wait_ms,
+                         uint64_t deadline_ms,
+                         uint64_t retry_wait_ms) {
+  if (deadline_ms == 0) {
+    deadline_ms = now_ms() + max_wait_ms;
+  }
+
+  Connection* connection = control_connection->connection();
+  if (connection == NULL) {
+    future->set_error(CASS_ERROR_LIB_NO_HOSTS_AVAILABLE,
+                      "The control connection is not available to retrieve the trace");
+    return;
+  }
+
+  SharedRefPtr<TraceHandler> handler(
+        new TraceHandler(connection, control_connection, future,
+                         max_wait_ms, deadline_ms, retry_wait_ms));
+  handler->execute();
+}
+
+uint64_t TraceHandler::next_retry_wait_ms(uint64_t retry_wait_ms,
+                                          uint64_t now_ms,
+                                          uint64_t deadline_ms) {
+  if (now_ms >= deadline_ms) {
+    return 0;
+  }
+  uint64_t wait_ms = retry_wait_ms == 0
+                     ? INITIAL_TRACE_RETRY_WAIT_MS
+                     : std::min(retry_wait_ms * 2,
+                                static_cast<uint64_t>(MAX_TRACE_RETRY_WAIT_MS));
+  return std::min(wait_ms, deadline_ms - now_ms);
+}
+
+uint64_t TraceHandler::now_ms() {
+  return uv_hrtime() / (1000 * 1000);
+}
+
+TraceHandler::TraceHandler(Connection* connection,
+                           ControlConnection* control_connection,
+                           TraceFuture* future,
+                           uint64_t max_wait_ms,
+                           uint64_t deadline_ms,
+                           uint64_t retry_wait_ms)
+  : MultipleRequestHandler(connection)
+  , control_connection_(control_connection)
+  , future_(future)
+  , max_wait_ms_(max_wait_ms)
+  , deadline_ms_(deadline_ms)
+  , retry_wait_ms_(retry_wait_ms) { }
+
+void TraceHandler::execute() {
+  char tracing_id[CASS_UUID_STRING_LENGTH];
+  cass_uuid_string(future_->tracing_id(), tracing_id);
+
+  std::string where(" WHERE session_id = ");
+  where.append(tracing_id);
+
+  execute_query("sessions",
+                "SELECT coordinator, duration, request, started_at "
+                "FROM system_traces.sessions" + where);
+  execute_query("events",
+                "SELECT event_id, activity, source, source_elapsed, thread "
+                "FROM system_traces.events" + where);
+}
+
+void TraceHandler::on_set(const ResponseMap& responses) {
+  for (ResponseMap::const_iterator it = responses.begin(),
+       end = responses.end(); it != end; ++it) {
+    if (it->second->opcode() != CQL_OPCODE_RESULT) {
+      future_->set_error(CASS_ERROR_LIB_UNEXPECTED_RESPONSE,
+                         "Unexpected response when retrieving the trace");
+      return;
+    }
+  }
+
+  ResultResponse* sessions_result;
+  bool is_complete = false;
+  if (get_result_response(responses, "sessions", &sessions_result) &&
+      sessions_result->row_count() > 0) {
+    sessions_result->decode_first_row();
+    // The duration is written when the request finishes on the coordinator
+    const Value* duration = sessions_result->first_row().get_by_name("duration");
+    is_complete = duration != NULL && !duration->is_null();
+  }
+
+  if (!is_complete) {
+    retry_wait_ms_ = next_retry_wait_ms(retry_wait_ms_, now_ms(), deadline_ms_);
+    if (retry_wait_ms_ == 0) {
+      std::ostringstream ss;
+      ss << "Trace is not complete after " << max_wait_ms_ << " ms";
+      future_->set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT, ss.str());
+      return;
+    }
+
+    LOG_DEBUG("Trace is not complete, trying again in %llu ms",
+              static_cast<unsigned long long>(retry_wait_ms_));
+
+    inc_ref(); // Timer reference
+    retry_timer_.start(connection()->loop(), retry_wait_ms_, this, on_retry);
+    return;
+  }
+
+  const Row& session = sessions_result->first_row();
+
+  CassTrace trace;
+  trace.tracing_id = future_->tracing_id();
+  get_inet(session.get_by_name("coordinator"), &trace.coordinator);
+  trace.duration = session.get_by_name("duration")->as_int32();
+  get_string(session.get_by_name("request"), &trace.request, &trace.request_length);
+  trace.started_at = 0;
+  const Value* started_at = session.get_by_name("started_at");
+  if (started_at != NULL && !started_at->is_null()) {
+    decode_int64(started_at->data(), trace.started_at);
+  }
+
+  TraceFuture::EventVec events;
+  ResultResponse* events_result;
+  if (get_result_response(responses, "events", &events_result)) {
+    events_result->decode_first_row();
+    ResultIterator rows(events_result);
+    while (rows.next()) {
+      const Row* row = rows.row();
+      CassTraceEvent event;
+      const Value* event_id = row->get_by_name("event_id");
+      if (event_id == NULL || event_id->is_null()) continue;
+      event.event_id = event_id->as_uuid();
+      get_string(row->get_by_name("activity"), &event.activity, &event.activity_length);
+      get_inet(row->get_by_name("source"), &event.source);
+      const Value* source_elapsed = row->get_by_name("source_elapsed");
+      event.source_elapsed = source_elapsed != NULL && !source_elapsed->is_null()
+                             ? source_elapsed->as_int32() : 0;
+      get_string(row->get_by_name("thread"), &event.thread, &event.thread_length);
+      events.push_back(event);
+    }
+  }
+
+  future_->set_trace(trace, events, responses);
+}
+
+void TraceHandler::on_error(CassError code, const std::string& message) {
+  // Writing both queries can fail
+  if (future_->ready()) return;
+  future_->set_error(code, "Unable to retrieve the trace: " + message);
+}
+
+void TraceHandler::on_timeout() {
+  future_->set_error(CASS_ERROR_LIB_REQUEST_TIMED_OUT,
+                     "A timeout occurred retrieving the trace");
+}
+
+void TraceHandler::on_retry(Timer* timer) {
+  TraceHandler* handler = static_cast<TraceHandler*>(timer->data());
+  fetch(handler->control_connection_, handler->future_.get(),
+        handler->max_wait_ms_, handler->deadline_ms_, handler->retry_wait_ms_);
+  handler->dec_ref();
+}
+
+} // namespace cass
@@ -0,0 +1,120 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __CASS_TRACE_HANDLER_HPP_INCLUDED__
+#define __CASS_TRACE_HANDLER_HPP_INCLUDED__
+
+#include "cassandra.h"
+#include "future.hpp"
+#include "multiple_request_handler.hpp"
+#include "ref_counted.hpp"
+#include "timer.hpp"
+
+#include <uv.h>
+#include <vector>
+
+namespace cass {
+
+class Connection;
+class ControlConnection;
+
+class TraceFuture : public Future {
+public:
+  typedef std::vector<CassTraceEvent> EventVec;
+
+  TraceFuture(const CassUuid& tracing_id)
+    : Future(CASS_FUTURE_TYPE_TRACE)
+    , tracing_id_(tracing_id) { }
+
+  const CassUuid& tracing_id() const { return tracing_id_; }
+
+  // The trace's strings point into the responses' buffers
+  void set_trace(const CassTrace& trace, const EventVec& events,
+                 const MultipleRequestHandler::ResponseMap& responses) {
+    ScopedMutex lock(&mutex_);
+    trace_ = trace;
+    events_ = events;
+    responses_ = responses;
+    trace_.events = events_.empty() ? NULL : &events_[0];
+    trace_.event_count = events_.size();
+    internal_set(lock);
+  }
+
+  void trace(CassTrace* output) {
+    ScopedMutex lock(&mutex_);
+    internal_wait(lock);
+    *output = trace_;
+  }
+
+private:
+  CassUuid tracing_id_;
+  CassTrace trace_;
+  EventVec events_;
+  MultipleRequestHandler::ResponseMap responses_;
+};
+
+// Queries a trace from the "system_traces" keyspace on the control
+// connection. Cassandra writes the trace asynchronously so the queries are
+// retried with an exponential backoff until the trace's session has a
+// duration (the request finished on the coordinator) or the maximum wait
+// time has elapsed.
+class TraceHandler : public MultipleRequestHandler {
+public:
+  // The deadline is set when the first handler is created and is passed to
+  // the handlers created for each retry
+  static void fetch(ControlConnection* control_connection,
+                    TraceFuture* future,
+                    uint64_t max_wait_ms,
+                    uint64_t deadline_ms = 0,
+                    uint64_t retry_wait_ms = 0);
+
+  // Returns the time to wait before the next attempt, doubling the previous
+  // wait and never waiting past the deadline. Returns 0 if the deadline has
+  // passed.
+  static uint64_t next_retry_wait_ms(uint64_t retry_wait_ms,
+                                     uint64_t now_ms,
+                                     uint64_t deadline_ms);
+
+  // The current time used for the deadline (monotonic)
+  static uint64_t now_ms();
+
+  TraceHandler(Connection* connection,
+               ControlConnection* control_connection,
+               TraceFuture* future,
+               uint64_t max_wait_ms,
+               uint64_t deadline_ms,
+               uint64_t retry_wait_ms);
+
+  void execute();
+
+  virtual void on_set(const ResponseMap& responses);
+  virtual void on_error(CassError code, const std::string& message);
+  virtual void on_timeout();
+
+private:
+  static void on_retry(Timer* timer);
+
+  ControlConnection* control_connection_;
+  ScopedRefPtr<TraceFuture> future_;
+  uint64_t max_wait_ms_;
+  uint64_t deadline_ms_;
+  uint64_t retry_wait_ms_;
+  Timer retry_timer_;
+};
+
+} // namespace cass
+
+#endif
@@ -32,6 +32,7 @@ class Value;
 
 typedef std::vector<std::string> ContactPointList;
 typedef std::vector<std::string> DcList;
+typedef std::vector<std::string> KeyspaceList;
 
 template<class From, class To>
 #if _MSC_VER && !__INTEL_COMPILER
@@ -0,0 +1,696 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef __MOCK_CQL_SERVER_HPP_INCLUDED__
+#define __MOCK_CQL_SERVER_HPP_INCLUDED__
+
+#include "address.hpp"
+#include "cassandra.h"
+#include "constants.hpp"
+#include "loop_thread.hpp"
+#include "scoped_lock.hpp"
+#include "serialization.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <uv.h>
+
+#include <algorithm>
+#include <deque>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// A minimal CQL server (protocol v3 and v4) for tests that need a session
+// connected to a cluster. Each node listens on its own loopback address using
+// the same port and answers the startup handshake, the control connection's
+// "system" table queries, "USE" queries and any other query with a void
+// result. Responses to other queries, and the startup responses of chosen
+// nodes, can be held and released to keep requests or connections in flight.
+// Topology and status change events can be pushed to the connections that
+// registered for them.
+class MockCqlServer : public cass::LoopThread {
+public:
+  MockCqlServer(int port = 29042)
+    : port_(port)
+    , is_holding_responses_(false)
+    , released_count_(0)
+    , is_started_(false)
+    , is_closing_(false)
+    , accepted_count_(0) {
+    uv_mutex_init(&mutex_);
+    async_.data = this;
+  }
+
+  ~MockCqlServer() {
+    stop();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      delete nodes_[i];
+    }
+    uv_mutex_destroy(&mutex_);
+  }
+
+  // Nodes that aren't listening are still returned in "system.peers" so that
+  // connections to them fail
+  void add_node(const std::string& ip, const std::string& dc = "dc1",
+                bool is_listening = true) {
+    Node* node = new Node();
+    node->server = this;
+    node->ip = ip;
+    node->dc = dc;
+    node->is_listening = is_listening;
+    node->is_holding_startup = false;
+    node->tcp.data = node;
+    nodes_.push_back(node);
+  }
+
+  int start() {
+    int rc = init();
+    if (rc != 0) return rc;
+    rc = uv_async_init(loop(), &async_, on_async);
+    if (rc != 0) return rc;
+    is_started_ = true;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      Node* node = nodes_[i];
+      if (!node->is_listening) continue;
+      cass::Address address(node->ip, port_);
+      uv_tcp_init(loop(), &node->tcp);
+#if UV_VERSION_MAJOR == 0
+      rc = uv_tcp_bind(&node->tcp, *address.addr_in());
+#else
+      rc = uv_tcp_bind(&node->tcp, address.addr(), 0);
+#endif
+      if (rc != 0) return rc;
+      rc = uv_listen(reinterpret_cast<uv_stream_t*>(&node->tcp), 128, on_connection);
+      if (rc != 0) return rc;
+    }
+    return run();
+  }
+
+  void stop() {
+    {
+      cass::ScopedMutex lock(&mutex_);
+      if (!is_started_ || is_closing_) return;
+      is_closing_ = true;
+    }
+    uv_async_send(&async_);
+    join();
+  }
+
+  // Holds the responses to the node's STARTUP requests so that its
+  // connections stay in the middle of their handshake. This must be called
+  // before the server is started.
+  void hold_startup(const std::string& ip) {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      if (nodes_[i]->ip == ip) nodes_[i]->is_holding_startup = true;
+    }
+  }
+
+  // Sends an event, e.g. ("TOPOLOGY_CHANGE", "REMOVED_NODE"), about the node
+  // with the address "ip" to the registered connections
+  void send_event(const std::string& type, const std::string& change,
+                  const std::string& ip) {
+    std::string body;
+    append_string(&body, type);
+    append_string(&body, change);
+    std::string address(inet_bytes(ip));
+    body.push_back(static_cast<char>(address.size()));
+    body.append(address);
+    append_int32(&body, port_);
+    {
+      cass::ScopedMutex lock(&mutex_);
+      pending_events_.push_back(body);
+    }
+    uv_async_send(&async_);
+  }
+
+  void set_is_holding_responses(bool is_holding_responses) {
+    cass::ScopedMutex lock(&mutex_);
+    is_holding_responses_ = is_holding_responses;
+  }
+
+  // Sends the oldest held responses
+  void release_responses(size_t count) {
+    {
+      cass::ScopedMutex lock(&mutex_);
+      released_count_ += count;
+    }
+    uv_async_send(&async_);
+  }
+
+  size_t held_response_count() {
+    cass::ScopedMutex lock(&mutex_);
+    return held_responses_.size();
+  }
+
+  size_t accepted_count() {
+    cass::ScopedMutex lock(&mutex_);
+    return accepted_count_;
+  }
+
+  // The nodes' addresses in the order their first connection was accepted
+  std::vector<std::string> accept_order() {
+    cass::ScopedMutex lock(&mutex_);
+    return accept_order_;
+  }
+
+private:
+  struct Node;
+
+  struct Client {
+    uv_tcp_t tcp;
+    Node* node;
+    std::string buffer;
+    int8_t registered_version; // Zero until the client registers for events
+  };
+
+  struct Node {
+    uv_tcp_t tcp;
+    MockCqlServer* server;
+    std::string ip;
+    std::string dc;
+    bool is_listening;
+    bool is_holding_startup;
+    std::vector<Client*> clients;
+  };
+
+  struct HeldResponse {
+    Client* client;
+    std::string frame;
+  };
+
+  struct WriteRequest {
+    uv_write_t req;
+    std::string frame;
+  };
+
+  static void append_int16(std::string* output, int16_t value) {
+    char buf[sizeof(int16_t)];
+    cass::encode_int16(buf, value);
+    output->append(buf, sizeof(buf));
+  }
+
+  static void append_int32(std::string* output, int32_t value) {
+    char buf[sizeof(int32_t)];
+    cass::encode_int32(buf, value);
+    output->append(buf, sizeof(buf));
+  }
+
+  static void append_string(std::string* output, const std::string& value) {
+    append_int16(output, static_cast<int16_t>(value.size()));
+    output->append(value);
+  }
+
+  static void append_bytes(std::string* output, const std::string& value) {
+    append_int32(output, static_cast<int32_t>(value.size()));
+    output->append(value);
+  }
+
+  static std::string inet_bytes(const std::string& ip) {
+    cass::Address address(ip, 0);
+    return std::string(reinterpret_cast<const char*>(&address.addr_in()->sin_addr),
+                       sizeof(address.addr_in()->sin_addr));
+  }
+
+  static std::string frame(int8_t version, int16_t stream, int8_t opcode,
+                           const std::string& body) {
+    std::string output;
+    output.push_back(static_cast<char>(version | 0x80));
+    output.push_back(0);
+    append_int16(&output, stream);
+    output.push_back(static_cast<char>(opcode));
+    append_int32(&output, static_cast<int32_t>(body.size()));
+    output.append(body);
+    return output;
+  }
+
+  // A rows result of varchar and inet columns with optional set<varchar>
+  // "tokens" column
+  std::string local_rows(const Node* node) const {
+    std::string body;
+    append_int32(&body, CASS_RESULT_KIND_ROWS);
+    append_int32(&body, 1); // Global table spec
+    append_int32(&body, 5);
+    append_string(&body, "system");
+    append_string(&body, "local");
+    append_varchar_column(&body, "data_center");
+    append_varchar_column(&body, "rack");
+    append_varchar_column(&body, "release_version");
+    append_varchar_column(&body, "partitioner");
+    append_tokens_column(&body);
+    append_int32(&body, 1);
+    append_bytes(&body, node->dc);
+    append_bytes(&body, "rack1");
+    append_bytes(&body, "3.0.0");
+    append_bytes(&body, "org.apache.cassandra.dht.Murmur3Partitioner");
+    append_bytes(&body, tokens(node));
+    return body;
+  }
+
+  // Only the peer with the address "peer_ip" is returned if it's not empty
+  std::string peers_rows(const Node* node, const std::string& peer_ip) const {
+    std::vector<const Node*> peers;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      const Node* peer = nodes_[i];
+      if (peer != node && (peer_ip.empty() || peer->ip == peer_ip)) {
+        peers.push_back(peer);
+      }
+    }
+
+    std::string body;
+    append_int32(&body, CASS_RESULT_KIND_ROWS);
+    append_int32(&body, 1); // Global table spec
+    append_int32(&body, 6);
+    append_string(&body, "system");
+    append_string(&body, "peers");
+    append_string(&body, "peer");
+    append_int16(&body, CASS_VALUE_TYPE_INET);
+    append_varchar_column(&body, "data_center");
+    append_varchar_column(&body, "rack");
+    append_varchar_column(&body, "release_version");
+    append_string(&body, "rpc_address");
+    append_int16(&body, CASS_VALUE_TYPE_INET);
+    append_tokens_column(&body);
+    append_int32(&body, static_cast<int32_t>(peers.size()));
+    for (size_t i = 0; i < peers.size(); ++i) {
+      const Node* peer = peers[i];
+      append_bytes(&body, inet_bytes(peer->ip));
+      append_bytes(&body, peer->dc);
+      append_bytes(&body, "rack1");
+      append_bytes(&body, "3.0.0");
+      append_bytes(&body, inet_bytes(peer->ip));
+      append_bytes(&body, tokens(peer));
+    }
+    return body;
+  }
+
+  static void append_varchar_column(std::string* body, const std::string& name) {
+    append_string(body, name);
+    append_int16(body, CASS_VALUE_TYPE_VARCHAR);
+  }
+
+  static void append_tokens_column(std::string* body) {
+    append_string(body, "tokens");
+    append_int16(body, CASS_VALUE_TYPE_SET);
+    append_int16(body, CASS_VALUE_TYPE_VARCHAR);
+  }
+
+  // A single token per node spread evenly over the Murmur3 token range
+  std::string tokens(const Node* node) const {
+    size_t index = std::find(nodes_.begin(), nodes_.end(), node) - nodes_.begin();
+    int64_t step = static_cast<int64_t>(CASS_INT64_MAX / nodes_.size()) * 2;
+    char token[32];
+    sprintf(token, "%lld", static_cast<long long>(CASS_INT64_MIN + step * index));
+    std::string set;
+    append_int32(&set, 1);
+    append_bytes(&set, token);
+    return set;
+  }
+
+  std::string query_response(const Node* node, const std::string& query) const {
+    std::string body;
+    if (query.find("system.local") != std::string::npos) {
+      return local_rows(node);
+    } else if (query.find("system.peers") != std::string::npos) {
+      std::string peer_ip;
+      size_t pos = query.find("WHERE peer = '");
+      if (pos != std::string::npos) {
+        pos += strlen("WHERE peer = '");
+        peer_ip = query.substr(pos, query.find('\'', pos) - pos);
+      }
+      return peers_rows(node, peer_ip);
+    } else if (query.find("system") != std::string::npos) {
+      // Empty schema tables
+      append_int32(&body, CASS_RESULT_KIND_ROWS);
+      append_int32(&body, 0);
+      append_int32(&body, 0);
+      append_int32(&body, 0);
+      return body;
+    }
+    if (query.compare(0, 4, "USE ") == 0) {
+      std::string keyspace(query.substr(4));
+      keyspace.erase(std::remove(keyspace.begin(), keyspace.end(), '"'), keyspace.end());
+      append_int32(&body, CASS_RESULT_KIND_SET_KEYSPACE);
+      append_string(&body, keyspace);
+      return body;
+    }
+    append_int32(&body, CASS_RESULT_KIND_VOID);
+    return body;
+  }
+
+  void on_frame(Client* client, int8_t version, int16_t stream,
+                int8_t opcode, const std::string& body) {
+    switch (opcode) {
+      case CQL_OPCODE_STARTUP: {
+        std::string response(frame(version, stream, CQL_OPCODE_READY, std::string()));
+        if (client->node->is_holding_startup) {
+          cass::ScopedMutex lock(&mutex_);
+          HeldResponse held;
+          held.client = client;
+          held.frame = response;
+          held_responses_.push_back(held);
+        } else {
+          write(client, response);
+        }
+        break;
+      }
+
+      case CQL_OPCODE_REGISTER:
+        client->registered_version = version;
+        write(client, frame(version, stream, CQL_OPCODE_READY, std::string()));
+        break;
+
+      case CQL_OPCODE_OPTIONS: {
+        std::string supported;
+        append_int16(&supported, 0);
+        write(client, frame(version, stream, CQL_OPCODE_SUPPORTED, supported));
+        break;
+      }
+
+      case CQL_OPCODE_QUERY: {
+        int32_t length;
+        cass::decode_int32(const_cast<char*>(body.data()), length);
+        std::string query(body.data() + sizeof(int32_t), length);
+        std::string response(frame(version, stream, CQL_OPCODE_RESULT,
+                                   query_response(client->node, query)));
+        bool is_system = query.find("system") != std::string::npos;
+        cass::ScopedMutex lock(&mutex_);
+        if (is_holding_responses_ && !is_system) {
+          HeldResponse held;
+          held.client = client;
+          held.frame = response;
+          held_responses_.push_back(held);
+        } else {
+          lock.unlock();
+          write(client, response);
+        }
+        break;
+      }
+
+      default: {
+        std::string error;
+        append_int32(&error, CQL_ERROR_PROTOCOL_ERROR);
+        append_string(&error, "Unsupported opcode");
+        write(client, frame(version, stream, CQL_OPCODE_ERROR, error));
+        break;
+      }
+    }
+  }
+
+  void write(Client* client, const std::string& response) {
+    WriteRequest* request = new WriteRequest();
+    request->frame = response;
+    uv_buf_t buf = uv_buf_init(&request->frame[0],
+                               static_cast<unsigned int>(request->frame.size()));
+    uv_write(&request->req, reinterpret_cast<uv_stream_t*>(&client->tcp),
+             &buf, 1, on_write);
+  }
+
+  void release_held_responses() {
+    std::vector<HeldResponse> responses;
+    {
+      cass::ScopedMutex lock(&mutex_);
+      while (released_count_ > 0 && !held_responses_.empty()) {
+        responses.push_back(held_responses_.front());
+        held_responses_.pop_front();
+        released_count_--;
+      }
+      if (held_responses_.empty()) released_count_ = 0;
+    }
+    for (size_t i = 0; i < responses.size(); ++i) {
+      write(responses[i].client, responses[i].frame);
+    }
+  }
+
+  void send_pending_events() {
+    std::vector<std::string> events;
+    {
+      cass::ScopedMutex lock(&mutex_);
+      events.swap(pending_events_);
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+      for (size_t j = 0; j < nodes_.size(); ++j) {
+        const std::vector<Client*>& clients = nodes_[j]->clients;
+        for (size_t k = 0; k < clients.size(); ++k) {
+          if (clients[k]->registered_version != 0) {
+            write(clients[k], frame(clients[k]->registered_version, -1,
+                                    CQL_OPCODE_EVENT, events[i]));
+          }
+        }
+      }
+    }
+  }
+
+  void close_client(Client* client) {
+    {
+      cass::ScopedMutex lock(&mutex_);
+      for (std::deque<HeldResponse>::iterator it = held_responses_.begin();
+           it != held_responses_.end();) {
+        if (it->client == client) {
+          it = held_responses_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    std::vector<Client*>& clients = client->node->clients;
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+    uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(&client->tcp);
+    if (!uv_is_closing(handle)) {
+      uv_close(handle, on_client_close);
+    }
+  }
+
+  static void on_write(uv_write_t* req, int status) {
+    delete reinterpret_cast<WriteRequest*>(req);
+  }
+
+  static void on_client_close(uv_handle_t* handle) {
+    delete static_cast<Client*>(handle->data);
+  }
+
+  static void on_connection(uv_stream_t* server, int status) {
+    Node* node = static_cast<Node*>(server->data);
+    if (status != 0) return;
+    Client* client = new Client();
+    client->node = node;
+    client->registered_version = 0;
+    client->tcp.data = client;
+    uv_tcp_init(server->loop, &client->tcp);
+    if (uv_accept(server, reinterpret_cast<uv_stream_t*>(&client->tcp)) != 0) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&client->tcp), on_client_close);
+      return;
+    }
+    node->clients.push_back(client);
+    {
+      MockCqlServer* server = node->server;
+      cass::ScopedMutex lock(&server->mutex_);
+      server->accepted_count_++;
+      if (std::find(server->accept_order_.begin(), server->accept_order_.end(),
+                    node->ip) == server->accept_order_.end()) {
+        server->accept_order_.push_back(node->ip);
+      }
+    }
+    uv_read_start(reinterpret_cast<uv_stream_t*>(&client->tcp), on_alloc, on_read);
+  }
+
+#if UV_VERSION_MAJOR == 0
+  static uv_buf_t on_alloc(uv_handle_t* handle, size_t suggested_size) {
+    return uv_buf_init(new char[suggested_size], static_cast<unsigned int>(suggested_size));
+  }
+
+  static void on_read(uv_stream_t* stream, ssize_t nread, uv_buf_t buf) {
+    on_read_internal(stream, nread, &buf);
+  }
+#else
+  static void on_alloc(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+    *buf = uv_buf_init(new char[suggested_size], static_cast<unsigned int>(suggested_size));
+  }
+
+  static void on_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+    on_read_internal(stream, nread, buf);
+  }
+#endif
+
+  static void on_read_internal(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+    Client* client = static_cast<Client*>(stream->data);
+    MockCqlServer* server = client->node->server;
+    if (nread < 0) {
+      delete[] buf->base;
+      server->close_client(client);
+      return;
+    }
+    client->buffer.append(buf->base, nread);
+    delete[] buf->base;
+
+    // Protocol v3 and v4 headers are 9 bytes
+    while (client->buffer.size() >= 9) {
+      int32_t length;
+      cass::decode_int32(&client->buffer[5], length);
+      if (client->buffer.size() < 9 + static_cast<size_t>(length)) break;
+      int8_t version = client->buffer[0] & 0x7F;
+      int16_t stream_id;
+      cass::decode_int16(&client->buffer[2], stream_id);
+      int8_t opcode = client->buffer[4];
+      std::string body(client->buffer.substr(9, length));
+      client->buffer.erase(0, 9 + length);
+      server->on_frame(client, version, stream_id, opcode, body);
+    }
+  }
+
+#if UV_VERSION_MAJOR == 0
+  static void on_async(uv_async_t* async, int status) {
+#else
+  static void on_async(uv_async_t* async) {
+#endif
+    MockCqlServer* server = static_cast<MockCqlServer*>(async->data);
+    bool is_closing;
+    {
+      cass::ScopedMutex lock(&server->mutex_);
+      is_closing = server->is_closing_;
+    }
+    if (!is_closing) {
+      server->send_pending_events();
+      server->release_held_responses();
+      return;
+    }
+    for (size_t i = 0; i < server->nodes_.size(); ++i) {
+      Node* node = server->nodes_[i];
+      while (!node->clients.empty()) {
+        server->close_client(node->clients.back());
+      }
+      if (node->is_listening) {
+        uv_close(reinterpret_cast<uv_handle_t*>(&node->tcp), NULL);
+      }
+    }
+    uv_close(reinterpret_cast<uv_handle_t*>(&server->async_), NULL);
+    server->close_handles();
+  }
+
+  int port_;
+  std::vector<Node*> nodes_;
+  uv_async_t async_;
+  uv_mutex_t mutex_;
+  bool is_holding_responses_;
+  std::deque<HeldResponse> held_responses_;
+  size_t released_count_;
+  std::vector<std::string> pending_events_;
+  bool is_started_;
+  bool is_closing_;
+  size_t accepted_count_;
+  std::vector<std::string> accept_order_;
+};
+
+// Polls the predicate every millisecond for up to five seconds
+template <class Predicate>
+bool wait_for(Predicate predicate) {
+  for (int i = 0; i < 5000; ++i) {
+    if (predicate()) return true;
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+// A session for a MockCqlServer cluster with a single IO thread, one core
+// connection per host and without schema metadata or token aware routing.
+// Tests add the server's nodes and adjust the cluster before connecting.
+struct MockSession {
+  struct HeldResponseCount {
+    HeldResponseCount(MockCqlServer* server, size_t count)
+      : server(server)
+      , count(count) { }
+
+    bool operator()() const { return server->held_response_count() == count; }
+
+    MockCqlServer* server;
+    size_t count;
+  };
+
+  MockSession()
+    : cluster(cass_cluster_new())
+    , session(cass_session_new())
+    , connect_future(NULL) {
+    cass_cluster_set_contact_points(cluster, "127.0.0.1");
+    cass_cluster_set_port(cluster, 29042);
+    cass_cluster_set_use_schema(cluster, cass_false);
+    cass_cluster_set_token_aware_routing(cluster, cass_false);
+    cass_cluster_set_num_threads_io(cluster, 1);
+    cass_cluster_set_core_connections_per_host(cluster, 1);
+  }
+
+  ~MockSession() {
+    server.set_is_holding_responses(false);
+    server.release_responses(server.held_response_count());
+    if (connect_future != NULL) {
+      cass_future_wait(connect_future);
+      cass_future_free(connect_future);
+    }
+    wait_for_futures();
+    CassFuture* future = cass_session_close(session);
+    cass_future_wait(future);
+    cass_future_free(future);
+    cass_session_free(session);
+    cass_cluster_free(cluster);
+  }
+
+  // Starts the server and the session's connection without waiting for it
+  void start_connect() {
+    BOOST_REQUIRE_EQUAL(server.start(), 0);
+    connect_future = cass_session_connect(session, cluster);
+  }
+
+  void connect() {
+    start_connect();
+    BOOST_REQUIRE_EQUAL(cass_future_error_code(connect_future), CASS_OK);
+  }
+
+  CassFuture* execute() {
+    CassStatement* statement = cass_statement_new("SELECT * FROM test", 0);
+    CassFuture* future = cass_session_execute(session, statement);
+    cass_statement_free(statement);
+    return future;
+  }
+
+  // Executes the requests and keeps their futures for wait_for_futures()
+  void execute(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      futures.push_back(execute());
+    }
+  }
+
+  void wait_for_futures() {
+    for (size_t i = 0; i < futures.size(); ++i) {
+      BOOST_CHECK_EQUAL(cass_future_error_code(futures[i]), CASS_OK);
+      cass_future_free(futures[i]);
+    }
+    futures.clear();
+  }
+
+  bool wait_for_held_responses(size_t count) {
+    return wait_for(HeldResponseCount(&server, count));
+  }
+
+  MockCqlServer server;
+  CassCluster* cluster;
+  CassSession* session;
+  CassFuture* connect_future;
+  std::vector<CassFuture*> futures;
+};
+
+#endif
@@ -128,6 +128,35 @@ BOOST_AUTO_TEST_CASE(bounds)
   }
 }
 
+template <class Queue>
+void queue_size() {
+  Queue queue(4);
+  size_t capacity = queue.capacity();
+  BOOST_CHECK_EQUAL(queue.size(), 0u);
+
+  // Wrap around the ring buffer a few times
+  for (int n = 0; n < 3; ++n) {
+    for (size_t i = 0; i < capacity; ++i) {
+      BOOST_CHECK(queue.enqueue(static_cast<int>(i)));
+      BOOST_CHECK_EQUAL(queue.size(), i + 1);
+    }
+    BOOST_CHECK(queue.enqueue(-1) == false);
+    BOOST_CHECK_EQUAL(queue.size(), capacity);
+
+    int r;
+    for (size_t i = capacity; i > 0; --i) {
+      BOOST_CHECK(queue.dequeue(r));
+      BOOST_CHECK_EQUAL(queue.size(), i - 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(size)
+{
+  queue_size<cass::SPSCQueue<int> >();
+  queue_size<cass::MPMCQueue<int> >();
+}
+
 BOOST_AUTO_TEST_CASE(spsc_async)
 {
   TestAsyncQueue<cass::SPSCQueue<int> > test_queue(NUM_ITERATIONS);
@@ -0,0 +1,146 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "atomic.hpp"
+#include "cassandra.h"
+#include "external_types.hpp"
+#include "mock_cql_server.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+struct CallbackState {
+  CallbackState()
+    : count(0)
+    , is_blocking(false) { }
+
+  cass::Atomic<int> count;
+  cass::Atomic<bool> is_blocking;
+};
+
+// Holds up the session's thread while the test asks it to
+static void on_capacity_available(CassSession* session, void* data) {
+  CallbackState* state = static_cast<CallbackState*>(data);
+  state->count.fetch_add(1);
+  while (state->is_blocking.load()) {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+  }
+}
+
+// A session with a small request queue. The queue can be filled by holding
+// up the session's thread in the capacity callback.
+struct CapacitySession : public MockSession {
+  struct CallbackCount {
+    CallbackCount(const CallbackState* state, int count)
+      : state(state)
+      , count(count) { }
+
+    bool operator()() const { return state->count.load() == count; }
+
+    const CallbackState* state;
+    int count;
+  };
+
+  CapacitySession() {
+    server.add_node("127.0.0.1");
+    // The IO workers' queues are the same size so the requests are spread
+    // over two of them to fit once the request queue is drained
+    BOOST_REQUIRE_EQUAL(cass_cluster_set_queue_size_io(cluster, 16), CASS_OK);
+    cass_cluster_set_num_threads_io(cluster, 2);
+    cass_session_set_capacity_callback(session, on_capacity_available, &state);
+    connect();
+  }
+
+  // The state is destroyed before the session is closed
+  ~CapacitySession() {
+    state.is_blocking.store(false);
+    wait_for_futures();
+    cass_session_set_capacity_callback(session, NULL, NULL);
+  }
+
+  bool wait_for_callback_count(int count) {
+    return wait_for(CallbackCount(&state, count));
+  }
+
+  // Marks the capacity as exhausted while the request queue is empty, the
+  // session notifies the callback which then blocks the session's thread
+  void block_session_thread() {
+    int count = state.count.load();
+    state.is_blocking.store(true);
+    session->from()->set_capacity_exhausted();
+    BOOST_REQUIRE(wait_for_callback_count(count + 1));
+  }
+
+  void release_session_thread() {
+    state.is_blocking.store(false);
+  }
+
+  // Executes requests until one is rejected by the full request queue. The
+  // requests that were queued wait for the session's thread.
+  void fill_request_queue() {
+    for (int i = 0; i < 1024; ++i) {
+      CassFuture* future = execute();
+      if (cass_future_ready(future)) {
+        BOOST_CHECK_EQUAL(cass_future_error_code(future), CASS_ERROR_LIB_REQUEST_QUEUE_FULL);
+        cass_future_free(future);
+        return;
+      }
+      futures.push_back(future);
+    }
+    BOOST_FAIL("The request queue never filled");
+  }
+
+  CallbackState state;
+};
+
+BOOST_AUTO_TEST_SUITE(capacity_callback)
+
+BOOST_AUTO_TEST_CASE(notified_after_drain)
+{
+  CapacitySession capacity;
+
+  capacity.block_session_thread();
+  capacity.fill_request_queue();
+  BOOST_CHECK_EQUAL(capacity.state.count.load(), 1);
+  capacity.release_session_thread();
+  BOOST_CHECK(capacity.wait_for_callback_count(2));
+  capacity.wait_for_futures();
+
+  // The callback is notified again the next time capacity is exhausted
+  capacity.block_session_thread();
+  capacity.fill_request_queue();
+  capacity.release_session_thread();
+  BOOST_CHECK(capacity.wait_for_callback_count(4));
+}
+
+BOOST_AUTO_TEST_CASE(drained_before_exhausted)
+{
+  CapacitySession capacity;
+
+  // A request was rejected by a full request queue and the queue was
+  // drained before the session marked its capacity as exhausted. No
+  // drain saw the mark so it has to notify the callback itself.
+  capacity.session->from()->set_capacity_exhausted();
+  BOOST_CHECK(capacity.wait_for_callback_count(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
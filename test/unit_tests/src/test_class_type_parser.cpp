@@ -22,6 +22,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <sstream>
+
 BOOST_AUTO_TEST_SUITE(class_type_parser)
 
 BOOST_AUTO_TEST_CASE(simple)
@@ -335,5 +337,30 @@ BOOST_AUTO_TEST_CASE(frozen)
   BOOST_CHECK(collection->types()[0]->is_frozen());
 }
 
+BOOST_AUTO_TEST_CASE(cache)
+{
+  cass::NativeDataTypes native_types;
+  native_types.init_class_names();
+
+  cass::DataTypeCache::clear();
+
+  cass::DataType::ConstPtr data_type1 =
+      cass::DataTypeClassNameParser::parse_one("org.apache.cassandra.db.marshal.MapType(org.apache.cassandra.db.marshal.UTF8Type,org.apache.cassandra.db.marshal.Int32Type)", native_types);
+  cass::DataType::ConstPtr data_type2 =
+      cass::DataTypeClassNameParser::parse_one("org.apache.cassandra.db.marshal.MapType(org.apache.cassandra.db.marshal.UTF8Type,org.apache.cassandra.db.marshal.Int32Type)", native_types);
+  BOOST_REQUIRE(data_type1);
+  BOOST_CHECK(data_type1.get() == data_type2.get());
+
+  // The cache is bounded
+  for (size_t i = 0; i < 2 * cass::DataTypeCache::MAX_SIZE; ++i) {
+    std::ostringstream ss;
+    ss << "org.apache.cassandra.db.marshal.CustomType" << i;
+    BOOST_REQUIRE(cass::DataTypeClassNameParser::parse_one(ss.str(), native_types));
+    BOOST_REQUIRE(cass::DataTypeCache::size() <= static_cast<size_t>(cass::DataTypeCache::MAX_SIZE));
+  }
+
+  cass::DataTypeCache::clear();
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
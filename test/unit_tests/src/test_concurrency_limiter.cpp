@@ -0,0 +1,170 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "concurrency_limiter.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+const uint64_t ONE_MS = 1000LL * 1000LL;
+
+// Simulates a host that can process "capacity" requests concurrently with a
+// base RTT. Requests beyond the capacity queue and add to the RTT.
+static uint64_t simulated_rtt(int in_flight, int capacity, uint64_t base_rtt) {
+  if (in_flight <= capacity) return base_rtt;
+  return base_rtt * in_flight / capacity;
+}
+
+static void run(cass::ConcurrencyLimiter& limiter,
+                int capacity, uint64_t base_rtt, int iterations,
+                uint64_t* now) {
+  for (int i = 0; i < iterations; ++i) {
+    // Keep the limiter saturated
+    while (!limiter.is_limited()) {
+      limiter.acquire();
+    }
+    uint64_t rtt = simulated_rtt(limiter.in_flight(), capacity, base_rtt);
+    *now += rtt / limiter.in_flight();
+    limiter.release(cass::ConcurrencyLimiter::SUCCESS, rtt, *now);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(concurrency_limiter)
+
+BOOST_AUTO_TEST_CASE(limits)
+{
+  cass::ConcurrencyLimiter::Settings settings;
+  settings.type = CASS_CONCURRENCY_LIMITER_AIMD;
+  settings.initial_limit = 2;
+  settings.min_limit = 1;
+  settings.max_limit = 4;
+
+  cass::ConcurrencyLimiter limiter(settings);
+  BOOST_CHECK_EQUAL(limiter.limit(), 2);
+  BOOST_CHECK(!limiter.is_limited());
+
+  limiter.acquire();
+  limiter.acquire();
+  BOOST_CHECK(limiter.is_limited());
+  BOOST_CHECK_EQUAL(limiter.in_flight(), 2);
+
+  limiter.release(cass::ConcurrencyLimiter::IGNORED, 0, 0);
+  BOOST_CHECK(!limiter.is_limited());
+  BOOST_CHECK_EQUAL(limiter.limit(), 2);
+
+  // The limit never drops below the minimum
+  for (int i = 0; i < 100; ++i) {
+    limiter.acquire();
+    limiter.release(cass::ConcurrencyLimiter::DROPPED, 0, 0);
+  }
+  BOOST_CHECK_EQUAL(limiter.limit(), 1);
+
+  // ...or grows above the maximum
+  for (int i = 0; i < 1000; ++i) {
+    limiter.acquire();
+    limiter.release(cass::ConcurrencyLimiter::SUCCESS, ONE_MS, 0);
+  }
+  BOOST_CHECK_EQUAL(limiter.limit(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(aimd)
+{
+  cass::ConcurrencyLimiter::Settings settings;
+  settings.type = CASS_CONCURRENCY_LIMITER_AIMD;
+  settings.initial_limit = 10;
+
+  cass::ConcurrencyLimiter limiter(settings);
+  uint64_t now = 0;
+
+  run(limiter, 100, ONE_MS, 1000, &now);
+  int limit = limiter.limit();
+  BOOST_CHECK_GT(limit, 10);
+
+  // Timeouts and overloaded errors reduce the limit
+  limiter.acquire();
+  limiter.release(cass::ConcurrencyLimiter::DROPPED, 0, now);
+  BOOST_CHECK_LT(limiter.limit(), limit);
+}
+
+BOOST_AUTO_TEST_CASE(aimd_not_saturated)
+{
+  cass::ConcurrencyLimiter::Settings settings;
+  settings.type = CASS_CONCURRENCY_LIMITER_AIMD;
+  settings.initial_limit = 10;
+
+  cass::ConcurrencyLimiter limiter(settings);
+
+  // A single request at a time doesn't use enough of the limit to grow it
+  for (int i = 0; i < 1000; ++i) {
+    limiter.acquire();
+    limiter.release(cass::ConcurrencyLimiter::SUCCESS, ONE_MS, 0);
+  }
+  BOOST_CHECK_EQUAL(limiter.limit(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(gradient)
+{
+  cass::ConcurrencyLimiter::Settings settings;
+  settings.type = CASS_CONCURRENCY_LIMITER_GRADIENT;
+  settings.initial_limit = 10;
+
+  uint64_t now = 0;
+
+  {
+    // The limit grows while the RTT stays at the base RTT...
+    cass::ConcurrencyLimiter limiter(settings);
+    run(limiter, 200, ONE_MS, 1000, &now);
+    BOOST_CHECK_GT(limiter.limit(), 10);
+  }
+
+  {
+    // ...and converges near the capacity of the host once requests queue
+    const int capacity = 50;
+    cass::ConcurrencyLimiter limiter(settings);
+    run(limiter, capacity, ONE_MS, 10000, &now);
+    BOOST_CHECK_GT(limiter.limit(), capacity / 2);
+    BOOST_CHECK_LT(limiter.limit(), capacity * 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(gradient_latency_increase)
+{
+  cass::ConcurrencyLimiter::Settings settings;
+  settings.type = CASS_CONCURRENCY_LIMITER_GRADIENT;
+  settings.initial_limit = 100;
+  settings.min_rtt_window_ns = 1000LL * ONE_MS;
+
+  cass::ConcurrencyLimiter limiter(settings);
+  uint64_t now = 0;
+
+  for (int i = 0; i < 10; ++i) {
+    limiter.acquire();
+    limiter.release(cass::ConcurrencyLimiter::SUCCESS, ONE_MS, now);
+  }
+
+  // A host that suddenly becomes much slower gets a lower limit
+  int limit = limiter.limit();
+  for (int i = 0; i < 10; ++i) {
+    limiter.acquire();
+    limiter.release(cass::ConcurrencyLimiter::SUCCESS, 10 * ONE_MS, now);
+  }
+  BOOST_CHECK_LT(limiter.limit(), limit);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -224,4 +224,49 @@ BOOST_AUTO_TEST_CASE(invalid)
   BOOST_CHECK(!cass::DataTypeCqlNameParser::parse("", native_types, &keyspace));
 }
 
+BOOST_AUTO_TEST_CASE(cache)
+{
+  cass::NativeDataTypes native_types;
+  native_types.init_cql_names();
+
+  cass::KeyspaceMetadata keyspace1("keyspace1");
+  cass::KeyspaceMetadata keyspace2("keyspace2");
+
+  cass::DataTypeCache::clear();
+
+  // The same type is shared by all columns with the same type string
+  cass::DataType::ConstPtr data_type1 =
+      cass::DataTypeCqlNameParser::parse("map<text, frozen<list<int>>>", native_types, &keyspace1);
+  cass::DataType::ConstPtr data_type2 =
+      cass::DataTypeCqlNameParser::parse("map<text, frozen<list<int>>>", native_types, &keyspace2);
+  BOOST_REQUIRE(data_type1);
+  BOOST_CHECK(data_type1.get() == data_type2.get());
+
+  // Nested types are cached too
+  cass::DataType::ConstPtr data_type3 =
+      cass::DataTypeCqlNameParser::parse("list<frozen<list<int>>>", native_types, &keyspace1);
+  cass::CollectionType::ConstPtr map = static_cast<cass::CollectionType::ConstPtr>(data_type1);
+  cass::CollectionType::ConstPtr list = static_cast<cass::CollectionType::ConstPtr>(data_type3);
+  BOOST_CHECK(map->types()[1].get() == list->types()[0].get());
+
+  // User types are resolved using the keyspace and aren't cached
+  cass::DataType::ConstPtr udt1 =
+      cass::DataTypeCqlNameParser::parse("list<frozen<type1>>", native_types, &keyspace1);
+  cass::DataType::ConstPtr udt2 =
+      cass::DataTypeCqlNameParser::parse("list<frozen<type1>>", native_types, &keyspace2);
+  BOOST_REQUIRE(udt1 && udt2);
+  BOOST_CHECK(udt1.get() != udt2.get());
+  cass::CollectionType::ConstPtr udt_list = static_cast<cass::CollectionType::ConstPtr>(udt2);
+  cass::UserType::ConstPtr udt = static_cast<cass::UserType::ConstPtr>(udt_list->types()[0]);
+  BOOST_CHECK_EQUAL(udt->keyspace(), "keyspace2");
+
+  // Invalid types aren't cached
+  size_t size = cass::DataTypeCache::size();
+  BOOST_CHECK(!cass::DataTypeCqlNameParser::parse("list<>", native_types, &keyspace1));
+  BOOST_CHECK_EQUAL(cass::DataTypeCache::size(), size);
+
+  cass::DataTypeCache::clear();
+  BOOST_CHECK_EQUAL(cass::DataTypeCache::size(), 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "event_debouncer.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(event_debouncer)
+
+BOOST_AUTO_TEST_CASE(coalesce_schema)
+{
+  cass::EventDebouncer debouncer;
+  debouncer.init(100, 1000);
+  BOOST_CHECK(debouncer.is_enabled());
+  BOOST_CHECK(debouncer.is_empty());
+
+  // A migration creating many tables in the same keyspace
+  for (int i = 0; i < 200; ++i) {
+    std::string table("table" + boost::lexical_cast<std::string>(i));
+    debouncer.add_table_or_view(cass::StringRef("ks1"), cass::StringRef(table));
+    debouncer.add_table_or_view(cass::StringRef("ks1"), cass::StringRef(table));
+  }
+  debouncer.add_table_or_view(cass::StringRef("ks2"), cass::StringRef("table1"));
+  debouncer.add_keyspace(cass::StringRef("ks1"));
+  debouncer.add_keyspace(cass::StringRef("ks1"));
+  debouncer.add_type(cass::StringRef("ks1"), cass::StringRef("type1"));
+  debouncer.add_type(cass::StringRef("ks1"), cass::StringRef("type2"));
+
+  cass::StringRefVec arg_types;
+  arg_types.push_back(cass::StringRef("int"));
+  debouncer.add_function(cass::StringRef("ks1"), cass::StringRef("func"), arg_types, false);
+  debouncer.add_function(cass::StringRef("ks1"), cass::StringRef("func"), arg_types, false);
+  debouncer.add_function(cass::StringRef("ks1"), cass::StringRef("func"), arg_types, true);
+
+  const cass::EventDebouncer::Pending& pending = debouncer.pending();
+  BOOST_CHECK_EQUAL(pending.keyspaces.size(), 1u);
+  BOOST_REQUIRE_EQUAL(pending.tables_and_views.size(), 2u);
+  BOOST_CHECK_EQUAL(pending.tables_and_views.find("ks1")->second.size(), 200u);
+  BOOST_CHECK_EQUAL(pending.tables_and_views.find("ks2")->second.size(), 1u);
+  BOOST_REQUIRE_EQUAL(pending.types.size(), 1u);
+  BOOST_CHECK_EQUAL(pending.types.find("ks1")->second.size(), 2u);
+  BOOST_CHECK_EQUAL(pending.functions.size(), 2u);
+
+  // Dropped objects no longer need to be refreshed
+  debouncer.drop_table_or_view("ks2", "table1");
+  BOOST_CHECK_EQUAL(pending.tables_and_views.size(), 1u);
+  debouncer.drop_function("ks1", "func", cass::to_strings(arg_types), true);
+  BOOST_CHECK_EQUAL(pending.functions.size(), 1u);
+  debouncer.drop_keyspace("ks1");
+  BOOST_CHECK(debouncer.is_empty());
+}
+
+BOOST_AUTO_TEST_CASE(coalesce_nodes)
+{
+  cass::EventDebouncer debouncer;
+  debouncer.init(100, 1000);
+
+  cass::SharedRefPtr<cass::Host> host1(new cass::Host(cass::Address("127.0.0.1", 9042), false));
+  cass::SharedRefPtr<cass::Host> host2(new cass::Host(cass::Address("127.0.0.2", 9042), false));
+
+  debouncer.add_node(host1, true, false);
+  debouncer.add_node(host1, false, true);
+  debouncer.add_node(host2, false, true);
+  debouncer.add_keyspace(cass::StringRef("ks1"));
+
+  const cass::EventDebouncer::Pending& pending = debouncer.pending();
+  BOOST_REQUIRE_EQUAL(pending.nodes.size(), 2u);
+  const cass::EventDebouncer::Node& node = pending.nodes.find(host1->address())->second;
+  BOOST_CHECK(node.is_new_node);
+  BOOST_CHECK(node.query_tokens);
+
+  debouncer.remove_node(host2->address());
+  BOOST_CHECK_EQUAL(pending.nodes.size(), 1u);
+
+  // Node refreshes are kept when the schema is refreshed
+  debouncer.clear_schema();
+  BOOST_CHECK(pending.keyspaces.empty());
+  BOOST_CHECK_EQUAL(pending.nodes.size(), 1u);
+
+  cass::EventDebouncer::Pending taken;
+  debouncer.take(&taken);
+  BOOST_CHECK_EQUAL(taken.nodes.size(), 1u);
+  BOOST_CHECK(debouncer.is_empty());
+}
+
+BOOST_AUTO_TEST_CASE(delay)
+{
+  cass::EventDebouncer debouncer;
+  BOOST_CHECK(!debouncer.is_enabled());
+
+  debouncer.init(100, 250);
+  BOOST_CHECK_EQUAL(debouncer.next_delay(1000), 100u);
+  BOOST_CHECK_EQUAL(debouncer.next_delay(1090), 100u);
+  BOOST_CHECK_EQUAL(debouncer.next_delay(1180), 70u); // Bounded by the max delay
+  BOOST_CHECK_EQUAL(debouncer.next_delay(1260), 0u);
+
+  // A new burst starts after the pending refreshes are taken
+  cass::EventDebouncer::Pending pending;
+  debouncer.take(&pending);
+  BOOST_CHECK_EQUAL(debouncer.next_delay(2000), 100u);
+
+  // The max delay is never less than the window
+  debouncer.init(100, 10);
+  BOOST_CHECK_EQUAL(debouncer.next_delay(3000), 100u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "heap.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+struct Item : public cass::HeapNode {
+  Item(int key = 0)
+    : key(key) {}
+  int key;
+};
+
+struct ItemCompare {
+  bool operator()(const Item* a, const Item* b) const {
+    return a->key < b->key;
+  }
+};
+
+typedef cass::Heap<Item, ItemCompare> ItemHeap;
+
+static int min_key(const ItemHeap& heap) {
+  int min = heap[0]->key;
+  for (ItemHeap::const_iterator it = heap.begin(),
+       end = heap.end(); it != end; ++it) {
+    min = std::min(min, (*it)->key);
+  }
+  return min;
+}
+
+BOOST_AUTO_TEST_SUITE(heap)
+
+BOOST_AUTO_TEST_CASE(push_and_remove)
+{
+  ItemHeap heap;
+  BOOST_CHECK(heap.empty());
+  BOOST_CHECK(heap.top() == NULL);
+
+  Item items[] = { Item(5), Item(3), Item(8), Item(1), Item(4) };
+  for (size_t i = 0; i < 5; ++i) {
+    heap.push(&items[i]);
+    BOOST_CHECK(items[i].is_in_heap());
+  }
+  BOOST_CHECK_EQUAL(heap.size(), 5u);
+  BOOST_CHECK_EQUAL(heap.top()->key, 1);
+
+  BOOST_CHECK(heap.remove(&items[3]));
+  BOOST_CHECK(!items[3].is_in_heap());
+  BOOST_CHECK(!heap.remove(&items[3]));
+  BOOST_CHECK_EQUAL(heap.top()->key, 3);
+
+  BOOST_CHECK(heap.remove(&items[0]));
+  BOOST_CHECK(heap.remove(&items[1]));
+  BOOST_CHECK_EQUAL(heap.top()->key, 4);
+  BOOST_CHECK_EQUAL(heap.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(update)
+{
+  ItemHeap heap;
+
+  Item items[] = { Item(2), Item(4), Item(6), Item(8) };
+  for (size_t i = 0; i < 4; ++i) {
+    heap.push(&items[i]);
+  }
+
+  items[3].key = 0;
+  heap.update(&items[3]);
+  BOOST_CHECK(heap.top() == &items[3]);
+
+  items[3].key = 10;
+  heap.update(&items[3]);
+  BOOST_CHECK(heap.top() == &items[0]);
+
+  items[0].key = 5;
+  heap.update(&items[0]);
+  BOOST_CHECK(heap.top() == &items[1]);
+}
+
+BOOST_AUTO_TEST_CASE(random_operations)
+{
+  const size_t num_items = 64;
+  std::vector<Item> items(num_items);
+  ItemHeap heap;
+
+  srand(12345);
+  for (size_t i = 0; i < num_items; ++i) {
+    items[i].key = rand() % 100;
+    heap.push(&items[i]);
+  }
+
+  for (int i = 0; i < 10000; ++i) {
+    Item* item = &items[rand() % num_items];
+    switch (rand() % 3) {
+      case 0:
+        if (!item->is_in_heap()) heap.push(item);
+        break;
+      case 1:
+        heap.remove(item);
+        break;
+      default:
+        item->key = rand() % 100;
+        heap.update(item);
+        break;
+    }
+    if (!heap.empty()) {
+      BOOST_REQUIRE_EQUAL(heap.top()->key, min_key(heap));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
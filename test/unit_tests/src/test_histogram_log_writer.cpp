@@ -0,0 +1,180 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "histogram_log_writer.hpp"
+#include "serialization.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef CASS_USE_ZLIB
+#include <zlib.h>
+
+static std::vector<char> decode_base64(const std::string& input) {
+  static const std::string alphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::vector<char> output;
+  uint32_t bits = 0;
+  int num_bits = 0;
+  for (size_t i = 0; i < input.size() && input[i] != '='; ++i) {
+    bits = (bits << 6) | static_cast<uint32_t>(alphabet.find(input[i]));
+    num_bits += 6;
+    if (num_bits >= 8) {
+      num_bits -= 8;
+      output.push_back(static_cast<char>((bits >> num_bits) & 0xFF));
+    }
+  }
+  return output;
+}
+
+static const char* decode_zig_zag(const char* input, int64_t* output) {
+  uint64_t v = 0;
+  int shift = 0;
+  for (int i = 0; i < 8; ++i) {
+    uint8_t b = static_cast<uint8_t>(*input++);
+    v |= static_cast<uint64_t>(b & 0x7F) << shift;
+    shift += 7;
+    if ((b & 0x80) == 0) {
+      *output = static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+      return input;
+    }
+  }
+  v |= static_cast<uint64_t>(static_cast<uint8_t>(*input++)) << shift;
+  *output = static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+  return input;
+}
+
+// Decodes a histogram written by HistogramLogWriter::encode() into the
+// counts of a histogram with the same precision
+static bool decode(const std::string& encoded, hdr_histogram* h) {
+  std::vector<char> compressed(decode_base64(encoded));
+
+  int32_t cookie, compressed_size;
+  cass::decode_int32(&compressed[0], cookie);
+  cass::decode_int32(&compressed[4], compressed_size);
+  if (cookie != 0x1c849314) return false;
+
+  std::vector<char> payload(1024 * 1024);
+  uLongf payload_size = static_cast<uLongf>(payload.size());
+  if (uncompress(reinterpret_cast<Bytef*>(&payload[0]), &payload_size,
+                 reinterpret_cast<const Bytef*>(&compressed[8]),
+                 compressed_size) != Z_OK) {
+    return false;
+  }
+
+  int32_t counts_size, significant_figures;
+  cass::decode_int32(&payload[0], cookie);
+  cass::decode_int32(&payload[4], counts_size);
+  cass::decode_int32(&payload[12], significant_figures);
+  if (cookie != 0x1c849313 || significant_figures != h->significant_figures) {
+    return false;
+  }
+
+  const char* pos = &payload[40];
+  const char* end = pos + counts_size;
+  int32_t index = 0;
+  while (pos < end) {
+    int64_t count;
+    pos = decode_zig_zag(pos, &count);
+    if (count < 0) {
+      index += static_cast<int32_t>(-count);
+    } else {
+      hdr_record_values(h, hdr_value_at_index(h, index++), count);
+    }
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_SUITE(histogram_log_writer)
+
+BOOST_AUTO_TEST_CASE(encode)
+{
+  hdr_histogram* h;
+  hdr_init(1LL, cass::Metrics::Histogram::HIGHEST_TRACKABLE_VALUE, 3, &h);
+  for (int64_t i = 1; i <= 1000; ++i) {
+    hdr_record_value(h, i * i);
+  }
+  hdr_record_values(h, 1000000, 1000000);
+
+  std::string encoded;
+  BOOST_REQUIRE(cass::HistogramLogWriter::encode(h, &encoded));
+  BOOST_CHECK_EQUAL(encoded.substr(0, 5), "HISTF");
+
+  hdr_histogram* decoded;
+  hdr_init(1LL, cass::Metrics::Histogram::HIGHEST_TRACKABLE_VALUE, 3, &decoded);
+  BOOST_REQUIRE(decode(encoded, decoded));
+
+  BOOST_CHECK_EQUAL(decoded->total_count, h->total_count);
+  for (int32_t i = 0; i < h->counts_len; ++i) {
+    BOOST_REQUIRE_EQUAL(decoded->counts[i], h->counts[i]);
+  }
+
+  free(h);
+  free(decoded);
+}
+
+BOOST_AUTO_TEST_CASE(write_intervals)
+{
+  const char* path = "test_histogram_log_writer.hlog";
+
+  cass::Metrics::ThreadState thread_state(1);
+  cass::Metrics::Histogram histogram(&thread_state);
+
+  {
+    cass::HistogramLogWriter writer(path, histogram.significant_figures());
+    BOOST_REQUIRE(writer.open(1000000));
+
+    for (int64_t i = 1; i <= 100; ++i) {
+      histogram.record_value(i * 1000);
+    }
+    writer.write_interval(histogram, 1005000);
+    writer.write_interval(histogram, 1010000);
+  }
+
+  std::ifstream file(path);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(file, line)) {
+    lines.push_back(line);
+  }
+  remove(path);
+
+  BOOST_REQUIRE_EQUAL(lines.size(), 5u);
+  BOOST_CHECK_EQUAL(lines[0], "#[Histogram log format version 1.3]");
+  BOOST_CHECK_EQUAL(lines[1].substr(0, 24), "#[StartTime: 1000.000 (s");
+  BOOST_CHECK_EQUAL(lines[2], "\"StartTimestamp\",\"Interval_Length\",\"Interval_Max\",\"Interval_Compressed_Histogram\"");
+  BOOST_CHECK_EQUAL(lines[3].substr(0, 26), "0.000,5.000,100.031,HISTFA");
+  BOOST_CHECK_EQUAL(lines[4].substr(0, 23), "5.000,5.000,0.000,HISTF");
+
+  hdr_histogram* decoded;
+  hdr_init(1LL, cass::Metrics::Histogram::HIGHEST_TRACKABLE_VALUE,
+           histogram.significant_figures(), &decoded);
+  BOOST_REQUIRE(decode(lines[3].substr(lines[3].rfind(',') + 1), decoded));
+  BOOST_CHECK_EQUAL(decoded->total_count, 100);
+  BOOST_CHECK_EQUAL(hdr_min(decoded), 1000);
+  free(decoded);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
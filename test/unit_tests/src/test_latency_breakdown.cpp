@@ -0,0 +1,102 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "latency_breakdown.hpp"
+#include "metrics.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(latency_breakdown)
+
+BOOST_AUTO_TEST_CASE(phases)
+{
+  cass::LatencyBreakdown breakdown;
+  breakdown.record(cass::LatencyBreakdown::STAGE_CREATED, 1000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_SESSION_DEQUEUED, 3000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_IO_WORKER_DEQUEUED, 6000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_STARTED, 10000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_FINISHED, 15000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_RESPONSE_RECEIVED, 21000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_FINISHED, 28000);
+
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_SESSION_QUEUE), 2000u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_IO_WORKER_QUEUE), 3000u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_POOL_PENDING), 4000u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_WRITE), 5000u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_SERVER), 6000u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_DECODE), 7000u);
+  BOOST_CHECK_EQUAL(breakdown.total_ns(), 27000u);
+}
+
+BOOST_AUTO_TEST_CASE(retry_and_missing_stages)
+{
+  cass::LatencyBreakdown breakdown;
+  breakdown.record(cass::LatencyBreakdown::STAGE_CREATED, 1000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_SESSION_DEQUEUED, 2000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_IO_WORKER_DEQUEUED, 3000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_STARTED, 4000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_FINISHED, 5000);
+
+  // A retry clears the stages of the previous attempt but keeps the dequeue
+  breakdown.clear_after(cass::LatencyBreakdown::STAGE_IO_WORKER_DEQUEUED);
+  BOOST_CHECK_EQUAL(breakdown.time_ns(cass::LatencyBreakdown::STAGE_IO_WORKER_DEQUEUED), 3000u);
+  BOOST_CHECK_EQUAL(breakdown.time_ns(cass::LatencyBreakdown::STAGE_WRITE_STARTED), 0u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_WRITE), 0u);
+  BOOST_CHECK(!breakdown.is_phase_reached(cass::LatencyBreakdown::PHASE_WRITE));
+
+  // The response arrived before the write callback
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_STARTED, 12000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_RESPONSE_RECEIVED, 20000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_FINISHED, 21000);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_POOL_PENDING), 9000u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_WRITE), 0u);
+  BOOST_CHECK_EQUAL(breakdown.phase_ns(cass::LatencyBreakdown::PHASE_SERVER), 8000u);
+  BOOST_CHECK(breakdown.is_phase_reached(cass::LatencyBreakdown::PHASE_SERVER));
+  BOOST_CHECK_EQUAL(breakdown.total_ns(), 20000u);
+}
+
+BOOST_AUTO_TEST_CASE(metrics)
+{
+  cass::Metrics metrics(1);
+  BOOST_CHECK(!metrics.is_latency_breakdown_enabled());
+
+  metrics.enable_latency_breakdown();
+  BOOST_REQUIRE(metrics.is_latency_breakdown_enabled());
+
+  cass::LatencyBreakdown breakdown;
+  breakdown.record(cass::LatencyBreakdown::STAGE_CREATED, 1000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_SESSION_DEQUEUED, 6000);
+  metrics.record_latency_breakdown(breakdown);
+
+  cass::Metrics::Histogram::Snapshot snapshot;
+  metrics.phase_latencies(cass::LatencyBreakdown::PHASE_SESSION_QUEUE)->get_snapshot(&snapshot);
+  BOOST_CHECK_EQUAL(snapshot.max, 5);
+
+  // Phases that weren't reached aren't recorded as 0
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_STARTED, 10000);
+  breakdown.record(cass::LatencyBreakdown::STAGE_WRITE_FINISHED, 14000);
+  metrics.record_latency_breakdown(breakdown);
+  breakdown.clear_after(cass::LatencyBreakdown::STAGE_SESSION_DEQUEUED);
+  metrics.record_latency_breakdown(breakdown);
+  metrics.phase_latencies(cass::LatencyBreakdown::PHASE_WRITE)->get_snapshot(&snapshot);
+  BOOST_CHECK_EQUAL(snapshot.min, 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -24,6 +24,7 @@
 #include "latency_aware_policy.hpp"
 #include "loop_thread.hpp"
 #include "murmur3.hpp"
+#include "power_of_two_choices_policy.hpp"
 #include "query_request.hpp"
 #include "token_aware_policy.hpp"
 #include "token_map.hpp"
@@ -40,6 +41,7 @@
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <set>
 #include <string>
 #include <uv.h>
 
@@ -914,3 +916,133 @@ BOOST_AUTO_TEST_CASE(dc)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(power_of_two_choices_lb)
+
+// Returns the sequence numbers of the hosts in the plan
+static std::vector<size_t> plan_sequence(cass::QueryPlan* qp) {
+  std::vector<size_t> sequence;
+  cass::Address address;
+  while (qp->compute_next(&address)) {
+    size_t i = 1;
+    while (!(addr_for_sequence(i) == address)) ++i;
+    sequence.push_back(i);
+  }
+  return sequence;
+}
+
+BOOST_AUTO_TEST_CASE(simple)
+{
+  cass::HostMap hosts;
+  populate_hosts(4, "rack1", LOCAL_DC, &hosts);
+  cass::PowerOfTwoChoicesPolicy policy(new cass::RoundRobinPolicy(),
+                                       1000LL * 1000LL * 1000LL);
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts);
+
+  // Follows the child policy's plans
+  cass::RoundRobinPolicy child_policy;
+  child_policy.init(cass::SharedRefPtr<cass::Host>(), hosts);
+
+  cass::TokenMap token_map;
+
+  // The two hosts are random, not the first two of the child plan
+  size_t other_firsts = 0;
+  for (int i = 0; i < 60; ++i) {
+    boost::scoped_ptr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, token_map, NULL));
+    boost::scoped_ptr<cass::QueryPlan> child_qp(child_policy.new_query_plan("ks", NULL, token_map, NULL));
+    std::vector<size_t> sequence(plan_sequence(qp.get()));
+    std::vector<size_t> child_sequence(plan_sequence(child_qp.get()));
+    BOOST_REQUIRE_EQUAL(sequence.size(), 4u);
+    BOOST_CHECK_EQUAL(std::set<size_t>(sequence.begin(), sequence.end()).size(), 4u);
+    if (sequence[0] != child_sequence[0] && sequence[0] != child_sequence[1]) {
+      ++other_firsts;
+    }
+  }
+  BOOST_CHECK_GT(other_firsts, 0u);
+
+  // The less busy host is tried first so the two busy hosts are only tried
+  // first when they're compared with each other (1 in 6 pairs)
+  cass::SharedRefPtr<cass::Host> host1(hosts[addr_for_sequence(1)]);
+  cass::SharedRefPtr<cass::Host> host2(hosts[addr_for_sequence(2)]);
+  for (int i = 0; i < 5; ++i) {
+    host1->inc_inflight_request_count();
+    host2->inc_inflight_request_count();
+  }
+  size_t busy_firsts = 0;
+  for (int i = 0; i < 120; ++i) {
+    boost::scoped_ptr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, token_map, NULL));
+    std::vector<size_t> sequence(plan_sequence(qp.get()));
+    BOOST_REQUIRE_EQUAL(sequence.size(), 4u);
+    if (sequence[0] == 1 || sequence[0] == 2) ++busy_firsts;
+  }
+  BOOST_CHECK_LT(busy_firsts, 60u);
+
+  // A host that recently returned an error loses even if it's less busy
+  host1->dec_inflight_request_count(5);
+  host2->dec_inflight_request_count(5);
+  host1->set_last_error_time_ns(uv_hrtime());
+  for (int i = 0; i < 60; ++i) {
+    boost::scoped_ptr<cass::QueryPlan> qp(policy.new_query_plan("ks", NULL, token_map, NULL));
+    std::vector<size_t> sequence(plan_sequence(qp.get()));
+    BOOST_REQUIRE_EQUAL(sequence.size(), 4u);
+    BOOST_CHECK_NE(sequence[0], 1u);
+  }
+
+  BOOST_CHECK_EQUAL(host1->inflight_request_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(token_aware)
+{
+  const int64_t num_hosts = 4;
+  cass::HostMap hosts;
+  populate_hosts(num_hosts, "rack1", LOCAL_DC, &hosts);
+  cass::PowerOfTwoChoicesPolicy policy(new cass::TokenAwarePolicy(new cass::RoundRobinPolicy()),
+                                       1000LL * 1000LL * 1000LL);
+  cass::TokenMap token_map;
+
+  token_map.set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+  cass::SharedRefPtr<cass::ReplicationStrategy> strategy(new cass::SimpleStrategy("", 3));
+  token_map.set_replication_strategy("test", strategy);
+
+  uint64_t partition_size = CASS_UINT64_MAX / num_hosts;
+  int64_t t = CASS_INT64_MIN + partition_size;
+  for (cass::HostMap::iterator i = hosts.begin(); i != hosts.end(); ++i) {
+    std::string ts = boost::lexical_cast<std::string>(t);
+    cass::TokenStringList tokens;
+    tokens.push_back(cass::StringRef(ts));
+    token_map.update_host(i->second, tokens);
+    t += partition_size;
+  }
+
+  token_map.build();
+  policy.init(cass::SharedRefPtr<cass::Host>(), hosts);
+
+  cass::SharedRefPtr<cass::QueryRequest> request(new cass::QueryRequest(1));
+  const char* value = "kjdfjkldsdjkl"; // hash: 9024137376112061887
+  request->set(0, cass::CassString(value, strlen(value)));
+  request->add_key_index(0);
+
+  // Replicas are 4.0.0.0, 1.0.0.0 and 2.0.0.0
+  hosts[addr_for_sequence(4)]->inc_inflight_request_count();
+
+  // The busy replica is never tried first and the non-replica is last
+  for (int i = 0; i < 60; ++i) {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("test", request.get(), token_map, NULL));
+    std::vector<size_t> sequence(plan_sequence(qp.get()));
+    BOOST_REQUIRE_EQUAL(sequence.size(), 4u);
+    BOOST_CHECK_NE(sequence[0], 4u);
+    BOOST_CHECK_EQUAL(sequence[3], 3u);
+  }
+
+  // A busy replica is still preferred over a non-replica
+  hosts[addr_for_sequence(1)]->set_down();
+  hosts[addr_for_sequence(2)]->set_down();
+
+  {
+    cass::ScopedPtr<cass::QueryPlan> qp(policy.new_query_plan("test", request.get(), token_map, NULL));
+    const size_t seq[] = { 4, 3 };
+    verify_sequence(qp.get(), VECTOR_FROM(size_t, seq));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
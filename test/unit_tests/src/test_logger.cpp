@@ -0,0 +1,181 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "logger.hpp"
+#include "scoped_lock.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <string.h>
+#include <uv.h>
+
+#define NUM_MESSAGES 100
+
+struct LogData {
+  LogData()
+    : count(0)
+    , dropped_warnings(0)
+    , suppressed_reports(0)
+    , is_blocked(false) {
+    uv_mutex_init(&mutex);
+    uv_cond_init(&cond);
+  }
+
+  ~LogData() {
+    uv_mutex_destroy(&mutex);
+    uv_cond_destroy(&cond);
+  }
+
+  void unblock() {
+    cass::ScopedMutex l(&mutex);
+    is_blocked = false;
+    uv_cond_signal(&cond);
+  }
+
+  uv_mutex_t mutex;
+  uv_cond_t cond;
+  int count;
+  int dropped_warnings;
+  int suppressed_reports;
+  bool is_blocked;
+};
+
+static void on_log(const CassLogMessage* message, void* data) {
+  LogData* log_data = static_cast<LogData*>(data);
+  cass::ScopedMutex l(&log_data->mutex);
+  while (log_data->is_blocked) {
+    uv_cond_wait(&log_data->cond, l.get());
+  }
+  if (strncmp(message->message, "Dropped", 7) == 0) {
+    log_data->dropped_warnings++;
+  } else if (strncmp(message->message, "Suppressed", 10) == 0) {
+    log_data->suppressed_reports++;
+  } else {
+    log_data->count++;
+  }
+}
+
+static void log_message(int i) {
+  cass::Logger::log(CASS_LOG_INFO, __FILE__, __LINE__, "", "Message %d", i);
+}
+
+namespace cass {
+
+static void log_message_ratelimited(int i) {
+  LOG_INFO_RATELIMITED(60 * 1000, 10, "Message %d", i);
+}
+
+} // namespace cass
+
+struct LoggerFixture {
+  LoggerFixture() {
+    cass::Logger::set_log_level(CASS_LOG_INFO);
+    cass::Logger::set_callback(on_log, &log_data);
+  }
+
+  ~LoggerFixture() {
+    cass::Logger::cleanup();
+    cass::Logger::set_log_level(CASS_LOG_WARN);
+    cass::Logger::set_callback(NULL, NULL);
+  }
+
+  LogData log_data;
+};
+
+BOOST_FIXTURE_TEST_SUITE(logger, LoggerFixture)
+
+BOOST_AUTO_TEST_CASE(sync)
+{
+  for (int i = 0; i < NUM_MESSAGES; ++i) {
+    log_message(i);
+  }
+  BOOST_CHECK_EQUAL(log_data.count, NUM_MESSAGES);
+}
+
+BOOST_AUTO_TEST_CASE(async)
+{
+  cass::Logger::set_queue_size(2 * NUM_MESSAGES);
+
+  for (int i = 0; i < NUM_MESSAGES; ++i) {
+    log_message(i);
+  }
+
+  // Cleaning up flushes the queue
+  cass::Logger::cleanup();
+
+  BOOST_CHECK_EQUAL(log_data.count, NUM_MESSAGES);
+}
+
+BOOST_AUTO_TEST_CASE(async_dropped)
+{
+  uint64_t dropped_count = cass::Logger::dropped_count();
+
+  cass::Logger::set_queue_size(16);
+
+  // Block the logging thread so that the queue fills up. Logging would
+  // deadlock here if the callback was called synchronously.
+  log_data.is_blocked = true;
+
+  for (int i = 0; i < NUM_MESSAGES; ++i) {
+    log_message(i);
+  }
+
+  log_data.unblock();
+  cass::Logger::cleanup();
+
+  uint64_t dropped = cass::Logger::dropped_count() - dropped_count;
+  BOOST_CHECK_GT(dropped, 0u);
+  BOOST_CHECK_EQUAL(log_data.count + dropped, static_cast<uint64_t>(NUM_MESSAGES));
+  BOOST_CHECK_EQUAL(log_data.dropped_warnings, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ratelimited)
+{
+  for (int i = 0; i < NUM_MESSAGES; ++i) {
+    cass::log_message_ratelimited(i);
+  }
+  BOOST_CHECK_EQUAL(log_data.count, 10);
+  BOOST_CHECK_EQUAL(log_data.suppressed_reports, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ratelimiter)
+{
+  // Rate limiters rely on static storage to be zero-initialized
+  static cass::LogRateLimiter limiter;
+
+  uint64_t suppressed;
+  for (int i = 0; i < 5; ++i) {
+    BOOST_CHECK(limiter.allow(50, 5, &suppressed));
+    BOOST_CHECK_EQUAL(suppressed, 0u);
+  }
+  for (int i = 0; i < 90; ++i) {
+    BOOST_CHECK(!limiter.allow(50, 5, &suppressed));
+  }
+
+  // The suppressed messages are reported by the first message allowed in
+  // the next interval
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+  BOOST_CHECK(limiter.allow(50, 5, &suppressed));
+  BOOST_CHECK_EQUAL(suppressed, 90u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "loop_monitor.hpp"
+#include "timer.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#define SAMPLE_INTERVAL_MS 10
+#define BUSY_TIME_MS 30
+
+struct LoopMonitorTest {
+  uv_loop_t* loop;
+  cass::LoopMonitor monitor;
+  cass::Timer busy_timer;
+  cass::Timer done_timer;
+};
+
+static void busy_wait(uint64_t ms) {
+  uint64_t end = uv_hrtime() + ms * 1000 * 1000;
+  while (uv_hrtime() < end) { }
+}
+
+void on_busy(cass::Timer* timer) {
+  LoopMonitorTest* test = static_cast<LoopMonitorTest*>(timer->data());
+  // Simulate a request that was queued 1 ms ago
+  test->monitor.record_request_queue_time(uv_hrtime() - 1000 * 1000);
+  busy_wait(BUSY_TIME_MS);
+}
+
+void on_done(cass::Timer* timer) {
+  LoopMonitorTest* test = static_cast<LoopMonitorTest*>(timer->data());
+  test->monitor.close_handles();
+}
+
+BOOST_AUTO_TEST_SUITE(loop_monitor)
+
+BOOST_AUTO_TEST_CASE(disabled)
+{
+  cass::LoopMonitor monitor;
+  BOOST_CHECK(!monitor.is_enabled());
+  monitor.close_handles();
+}
+
+BOOST_AUTO_TEST_CASE(busy_loop)
+{
+  LoopMonitorTest test;
+
+#if UV_VERSION_MAJOR == 0
+  test.loop = uv_loop_new();
+#else
+  uv_loop_t loop_storage__;
+  test.loop = &loop_storage__;
+  uv_loop_init(test.loop);
+#endif
+
+  BOOST_REQUIRE_EQUAL(test.monitor.init(test.loop, SAMPLE_INTERVAL_MS), 0);
+  BOOST_CHECK(test.monitor.is_enabled());
+
+  test.busy_timer.start(test.loop, 5, &test, on_busy);
+  test.done_timer.start(test.loop, 100, &test, on_done);
+
+  uv_run(test.loop, UV_RUN_DEFAULT);
+
+  cass::LoopMonitor::Snapshot snapshot;
+  test.monitor.get_snapshot(&snapshot);
+
+  // The sample timer can't run while the loop is busy
+  BOOST_CHECK_GE(snapshot.lag.max, (BUSY_TIME_MS - SAMPLE_INTERVAL_MS) * 1000);
+  BOOST_CHECK_GE(snapshot.iteration_time.max, (BUSY_TIME_MS - 1) * 1000);
+  BOOST_CHECK_GE(snapshot.request_queue_time.min, 1000);
+  BOOST_CHECK(snapshot.utilization >= 0.0 && snapshot.utilization <= 1.0);
+
+#if UV_VERSION_MAJOR == 0
+  uv_loop_delete(test.loop);
+#else
+  uv_loop_close(test.loop);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
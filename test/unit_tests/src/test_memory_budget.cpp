@@ -0,0 +1,140 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "buffer.hpp"
+#include "cassandra.h"
+#include "memory_budget.hpp"
+#include "mock_cql_server.hpp"
+#include "ref_counted.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <uv.h>
+
+struct MemoryBudgetTest {
+  ~MemoryBudgetTest() {
+    cass::MemoryBudget::set_limit(0, CASS_MEMORY_LIMIT_MODE_REJECT);
+  }
+};
+
+struct ReadBufferBytes {
+  ReadBufferBytes(int64_t bytes)
+    : bytes(bytes) { }
+
+  bool operator()() const {
+    return cass::MemoryBudget::bytes(cass::MemoryBudget::READ_BUFFER) == bytes;
+  }
+
+  int64_t bytes;
+};
+
+static void release_buffer(void* arg) {
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+  static_cast<cass::RefBuffer*>(arg)->dec_ref();
+}
+
+BOOST_FIXTURE_TEST_SUITE(memory_budget, MemoryBudgetTest)
+
+BOOST_AUTO_TEST_CASE(accounting)
+{
+  int64_t encodings = cass::MemoryBudget::bytes(cass::MemoryBudget::REQUEST_ENCODING);
+  int64_t responses = cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY);
+  int64_t metadata = cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA);
+
+  {
+    // Small buffers are stored inline
+    cass::Buffer small(8);
+    BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::REQUEST_ENCODING), encodings);
+
+    cass::Buffer large(1024);
+    cass::Buffer copy(large);
+    BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::REQUEST_ENCODING), encodings + 1024);
+  }
+  BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::REQUEST_ENCODING), encodings);
+
+  {
+    cass::SharedRefPtr<cass::RefBuffer> buffer(
+          cass::RefBuffer::create(4096, cass::MemoryBudget::RESPONSE_BODY));
+    BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY), responses + 4096);
+
+    buffer->set_category(cass::MemoryBudget::METADATA);
+    BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY), responses);
+    BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA), metadata + 4096);
+  }
+  BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA), metadata);
+}
+
+BOOST_AUTO_TEST_CASE(reject)
+{
+  BOOST_CHECK(cass::MemoryBudget::admit(0));
+
+  int64_t total = cass::MemoryBudget::total();
+  cass::MemoryBudget::set_limit(total + 1024, CASS_MEMORY_LIMIT_MODE_REJECT);
+  BOOST_CHECK(cass::MemoryBudget::admit(0));
+
+  uint64_t rejected = cass::MemoryBudget::rejected_count();
+  {
+    cass::Buffer buffer(1024);
+    BOOST_CHECK(!cass::MemoryBudget::admit(0));
+    BOOST_CHECK_EQUAL(cass::MemoryBudget::rejected_count(), rejected + 1);
+  }
+  BOOST_CHECK(cass::MemoryBudget::admit(0));
+}
+
+BOOST_AUTO_TEST_CASE(block)
+{
+  int64_t total = cass::MemoryBudget::total();
+  cass::MemoryBudget::set_limit(total + 1024, CASS_MEMORY_LIMIT_MODE_BLOCK);
+
+  cass::RefBuffer* buffer = cass::RefBuffer::create(1024, cass::MemoryBudget::REQUEST_ENCODING);
+  buffer->inc_ref();
+
+  // Times out while the buffer is held
+  uint64_t start = uv_hrtime();
+  BOOST_CHECK(!cass::MemoryBudget::admit(10));
+  BOOST_CHECK_GE(uv_hrtime() - start, 10ULL * 1000 * 1000);
+
+  // Admitted once another thread releases the buffer
+  uv_thread_t thread;
+  uv_thread_create(&thread, release_buffer, buffer);
+  BOOST_CHECK(cass::MemoryBudget::admit(10000));
+  uv_thread_join(&thread);
+}
+
+BOOST_AUTO_TEST_CASE(parked_read_buffers)
+{
+  int64_t read_buffers = cass::MemoryBudget::bytes(cass::MemoryBudget::READ_BUFFER);
+
+  MockSession mock;
+  mock.server.add_node("127.0.0.1");
+  mock.connect();
+
+  CassFuture* future = mock.execute();
+  BOOST_CHECK_EQUAL(cass_future_error_code(future), CASS_OK);
+  cass_future_free(future);
+
+  // The connections keep their read buffers for reuse once the responses
+  // are read but they're no longer counted
+  BOOST_CHECK(wait_for(ReadBufferBytes(read_buffers)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
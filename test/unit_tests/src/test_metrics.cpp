@@ -18,6 +18,7 @@
 #   define BOOST_TEST_MODULE cassandra
 #endif
 
+#include "host_metrics_iterator.hpp"
 #include "metrics.hpp"
 
 #include <boost/chrono.hpp>
@@ -164,6 +165,67 @@ BOOST_AUTO_TEST_CASE(histogram_threads)
   BOOST_CHECK(snapshot.mean == snapshot.median);
 }
 
+BOOST_AUTO_TEST_CASE(histogram_interval)
+{
+  cass::Metrics::ThreadState thread_state(1);
+  cass::Metrics::Histogram histogram(&thread_state);
+
+  for (uint64_t i = 1; i <= 100; ++i) {
+    histogram.record_value(i);
+  }
+
+  cass::Metrics::Histogram::Snapshot snapshot;
+
+  // The first interval includes everything recorded so far
+  histogram.get_interval_snapshot(cass::Metrics::Histogram::INTERVAL_READER_API, &snapshot);
+  BOOST_CHECK(snapshot.min == 1);
+  BOOST_CHECK(snapshot.max == 100);
+
+  for (uint64_t i = 1000; i <= 2000; ++i) {
+    histogram.record_value(i);
+  }
+
+  // The next interval only includes values recorded since the previous
+  // interval...
+  histogram.get_interval_snapshot(cass::Metrics::Histogram::INTERVAL_READER_API, &snapshot);
+  BOOST_CHECK(snapshot.min == 1000);
+  BOOST_CHECK(snapshot.max == 2000);
+
+  histogram.get_interval_snapshot(cass::Metrics::Histogram::INTERVAL_READER_API, &snapshot);
+  BOOST_CHECK(snapshot.max == 0);
+
+  // ...and doesn't affect the intervals of other readers or the cumulative
+  // snapshot
+  histogram.get_interval_snapshot(cass::Metrics::Histogram::INTERVAL_READER_LOG, &snapshot);
+  BOOST_CHECK(snapshot.min == 1);
+  BOOST_CHECK(snapshot.max == 2000);
+
+  histogram.get_snapshot(&snapshot);
+  BOOST_CHECK(snapshot.min == 1);
+  BOOST_CHECK(snapshot.max == 2000);
+}
+
+BOOST_AUTO_TEST_CASE(histogram_repeated_snapshots)
+{
+  cass::Metrics::ThreadState thread_state(1);
+  cass::Metrics::Histogram histogram(&thread_state);
+
+  hdr_histogram* h;
+  hdr_init(1LL, cass::Metrics::Histogram::HIGHEST_TRACKABLE_VALUE, 3, &h);
+
+  // Values must only be counted once no matter how many times the
+  // per-thread histograms are merged
+  for (int i = 0; i < 4; ++i) {
+    histogram.record_value(100);
+    cass::Metrics::Histogram::Snapshot snapshot;
+    histogram.get_snapshot(&snapshot);
+  }
+
+  histogram.add_to(h);
+  BOOST_CHECK_EQUAL(h->total_count, 4);
+  free(h);
+}
+
 BOOST_AUTO_TEST_CASE(meter)
 {
   cass::Metrics::ThreadState thread_state(1);
@@ -225,4 +287,68 @@ BOOST_AUTO_TEST_CASE(meter_threads)
   BOOST_CHECK_CLOSE(meter.fifteen_minute_rate(), 10 * NUM_THREADS, tolerance);
 }
 
+BOOST_AUTO_TEST_CASE(host_metrics)
+{
+  cass::Metrics metrics(1, 2);
+
+  cass::Host::Ptr host1(new cass::Host(cass::Address("127.0.0.1", 9042), false));
+  cass::Host::Ptr host2(new cass::Host(cass::Address("127.0.0.2", 9042), false));
+  cass::Host::Ptr host3(new cass::Host(cass::Address("127.0.0.3", 9042), false));
+  host1->set_rack_and_dc("rack1", "dc1");
+  host2->set_rack_and_dc("rack1", "dc1");
+  host3->set_rack_and_dc("rack1", "dc2");
+
+  for (uint64_t i = 1; i <= 100; ++i) {
+    metrics.record_host_request(host1.get(), i * 1000);
+    metrics.record_host_request(host2.get(), (i + 100) * 1000);
+  }
+  metrics.record_host_error(host1.get());
+  host1->inc_inflight_request_count();
+
+  cass::HostVec hosts;
+  hosts.push_back(host1);
+  hosts.push_back(host2);
+  hosts.push_back(host3);
+
+  // Metrics are only created for hosts that have been used
+  BOOST_CHECK(host1->metrics() != NULL);
+  BOOST_CHECK(host3->metrics() == NULL);
+
+  {
+    cass::HostMetricsIterator it(hosts, false);
+    BOOST_REQUIRE(it.next());
+    BOOST_CHECK_EQUAL(it.entry().address, host1->address());
+    BOOST_CHECK_EQUAL(it.entry().latencies.min, 1);
+    BOOST_CHECK_EQUAL(it.entry().latencies.max, 100);
+    BOOST_CHECK_EQUAL(it.entry().requests.count, 100u);
+    BOOST_CHECK_EQUAL(it.entry().errors.count, 1u);
+    BOOST_CHECK_EQUAL(it.entry().inflight_requests, 1);
+    BOOST_REQUIRE(it.next());
+    BOOST_CHECK_EQUAL(it.entry().address, host2->address());
+    BOOST_CHECK(!it.next());
+  }
+
+  {
+    cass::HostMetricsIterator it(hosts, true);
+    BOOST_REQUIRE(it.next());
+    BOOST_CHECK_EQUAL(it.entry().dc, "dc1");
+    BOOST_CHECK(!it.entry().has_address);
+    BOOST_CHECK_EQUAL(it.entry().latencies.min, 1);
+    BOOST_CHECK_EQUAL(it.entry().latencies.max, 200);
+    BOOST_CHECK_EQUAL(it.entry().requests.count, 200u);
+    BOOST_CHECK_EQUAL(it.entry().inflight_requests, 1);
+    BOOST_CHECK(!it.next());
+  }
+
+  host1->dec_inflight_request_count();
+}
+
+BOOST_AUTO_TEST_CASE(host_metrics_disabled)
+{
+  cass::Metrics metrics(1);
+  cass::Host::Ptr host(new cass::Host(cass::Address("127.0.0.1", 9042), false));
+  metrics.record_host_request(host.get(), 1000);
+  BOOST_CHECK(host->metrics() == NULL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
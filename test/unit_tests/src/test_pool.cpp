@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cql_server.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#define SCALE_THRESHOLD 8
+
+// A session with a single connection per host that grows by one connection
+// for every SCALE_THRESHOLD in-flight requests
+struct PoolSession : public MockSession {
+  struct ConnectionCount {
+    ConnectionCount(CassSession* session,
+                    cass_uint64_t total, cass_uint64_t draining)
+      : session(session)
+      , total(total)
+      , draining(draining) { }
+
+    bool operator()() const {
+      CassPoolMetrics metrics;
+      cass_session_get_pool_metrics(session, &metrics);
+      return metrics.total_connections == total &&
+          metrics.draining_connections == draining;
+    }
+
+    CassSession* session;
+    cass_uint64_t total;
+    cass_uint64_t draining;
+  };
+
+  PoolSession() {
+    server.add_node("127.0.0.1");
+    cass_cluster_set_max_connections_per_host(cluster, 4);
+    cass_cluster_set_max_concurrent_creation(cluster, 4);
+    cass_cluster_set_max_concurrent_requests_threshold(cluster, SCALE_THRESHOLD);
+    cass_cluster_set_connection_scale_down_window(cluster, 50);
+    connect();
+  }
+
+  bool wait_for_connections(cass_uint64_t total, cass_uint64_t draining) {
+    return wait_for(ConnectionCount(session, total, draining));
+  }
+
+  CassPoolMetrics pool_metrics() {
+    CassPoolMetrics metrics;
+    cass_session_get_pool_metrics(session, &metrics);
+    return metrics;
+  }
+};
+
+BOOST_AUTO_TEST_SUITE(pool)
+
+BOOST_AUTO_TEST_CASE(scale_up_and_down)
+{
+  PoolSession pool;
+  BOOST_REQUIRE(pool.wait_for_connections(1, 0));
+
+  // The connection reaches the threshold so one more is created
+  pool.server.set_is_holding_responses(true);
+  pool.execute(SCALE_THRESHOLD + 1);
+  BOOST_REQUIRE(pool.wait_for_held_responses(SCALE_THRESHOLD + 1));
+  BOOST_REQUIRE(pool.wait_for_connections(2, 0));
+  BOOST_CHECK_EQUAL(pool.pool_metrics().connections_scaled_up, 1u);
+
+  // Without requests the surplus connection is closed after the window
+  pool.server.release_responses(SCALE_THRESHOLD + 1);
+  pool.wait_for_futures();
+  BOOST_REQUIRE(pool.wait_for_connections(1, 0));
+  BOOST_CHECK_EQUAL(pool.pool_metrics().connections_scaled_down, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(drain_then_close)
+{
+  PoolSession pool;
+  BOOST_REQUIRE(pool.wait_for_connections(1, 0));
+
+  pool.server.set_is_holding_responses(true);
+  pool.execute(SCALE_THRESHOLD + 1);
+  BOOST_REQUIRE(pool.wait_for_connections(2, 0));
+
+  // The new connection is the least busy so it takes the next request
+  pool.execute(1);
+  BOOST_REQUIRE(pool.wait_for_held_responses(SCALE_THRESHOLD + 2));
+
+  // Leave one request in flight on each connection. The pool is lightly
+  // loaded so a connection is drained but it stays open until its request
+  // finishes.
+  pool.server.release_responses(SCALE_THRESHOLD);
+  BOOST_REQUIRE(pool.wait_for_connections(2, 1));
+  BOOST_CHECK_EQUAL(pool.pool_metrics().connections_scaled_down, 1u);
+
+  pool.server.release_responses(2);
+  pool.wait_for_futures();
+  BOOST_REQUIRE(pool.wait_for_connections(1, 0));
+  BOOST_CHECK_EQUAL(pool.pool_metrics().connections_scaled_down, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cql_server.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#define INITIAL_LIMIT 20
+
+// A session whose host's pool limits its in-flight requests. Latency is
+// injected by holding the server's responses.
+struct LimiterSession : public MockSession {
+  struct LimitBelow {
+    LimitBelow(CassSession* session, cass_uint64_t limit)
+      : session(session)
+      , limit(limit) { }
+
+    bool operator()() const {
+      CassPoolMetrics metrics;
+      cass_session_get_pool_metrics(session, &metrics);
+      return metrics.concurrency_limit < limit;
+    }
+
+    CassSession* session;
+    cass_uint64_t limit;
+  };
+
+  LimiterSession(CassConcurrencyLimiter type) {
+    server.add_node("127.0.0.1");
+    BOOST_REQUIRE_EQUAL(cass_cluster_set_concurrency_limiter(cluster, type), CASS_OK);
+    BOOST_REQUIRE_EQUAL(cass_cluster_set_concurrency_limiter_settings(cluster,
+                                                                      INITIAL_LIMIT,
+                                                                      1, 1000, 1000),
+                        CASS_OK);
+  }
+
+  cass_uint64_t concurrency_limit() {
+    CassPoolMetrics metrics;
+    cass_session_get_pool_metrics(session, &metrics);
+    return metrics.concurrency_limit;
+  }
+
+  bool wait_for_limit_below(cass_uint64_t limit) {
+    return wait_for(LimitBelow(session, limit));
+  }
+
+  // The responses to the requests are sent after the delay
+  void execute_with_latency(size_t count, unsigned delay_ms) {
+    server.set_is_holding_responses(true);
+    execute(count);
+    BOOST_REQUIRE(wait_for_held_responses(count));
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(delay_ms));
+    server.set_is_holding_responses(false);
+    server.release_responses(count);
+    wait_for_futures();
+  }
+};
+
+BOOST_AUTO_TEST_SUITE(pool_limiter)
+
+BOOST_AUTO_TEST_CASE(invalid_type)
+{
+  CassCluster* cluster = cass_cluster_new();
+  BOOST_CHECK_EQUAL(cass_cluster_set_concurrency_limiter(cluster,
+                                                         static_cast<CassConcurrencyLimiter>(3)),
+                    CASS_ERROR_LIB_BAD_PARAMS);
+  cass_cluster_free(cluster);
+}
+
+BOOST_AUTO_TEST_CASE(gradient_latency_increase)
+{
+  LimiterSession limiter(CASS_CONCURRENCY_LIMITER_GRADIENT);
+  limiter.connect();
+  BOOST_CHECK_EQUAL(limiter.concurrency_limit(), INITIAL_LIMIT);
+
+  // Establish the host's minimum round-trip time
+  for (int i = 0; i < 10; ++i) {
+    limiter.execute(4);
+    limiter.wait_for_futures();
+  }
+  cass_uint64_t limit = limiter.concurrency_limit();
+
+  // The limit is lowered once the host becomes much slower
+  for (int i = 0; i < 5; ++i) {
+    limiter.execute_with_latency(4, 20);
+  }
+  BOOST_CHECK(limiter.wait_for_limit_below(limit));
+}
+
+BOOST_AUTO_TEST_CASE(aimd_timeouts)
+{
+  LimiterSession limiter(CASS_CONCURRENCY_LIMITER_AIMD);
+  cass_cluster_set_request_timeout(limiter.cluster, 50);
+  limiter.connect();
+
+  // Requests that time out back off the limit
+  limiter.server.set_is_holding_responses(true);
+  for (int i = 0; i < 5; ++i) {
+    CassFuture* future = limiter.execute();
+    BOOST_CHECK_EQUAL(cass_future_error_code(future), CASS_ERROR_LIB_REQUEST_TIMED_OUT);
+    cass_future_free(future);
+  }
+  BOOST_CHECK(limiter.wait_for_limit_below(INITIAL_LIMIT));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,13 +28,13 @@
 #include <set>
 #include <string>
 
-static cass::SharedRefPtr<cass::Host> create_host(const std::string& ip,
-                                                  const std::string& rack = "",
-                                                  const std::string& dc = "") {
+static cass::TokenHost create_host(const std::string& ip,
+                                   const std::string& rack = "",
+                                   const std::string& dc = "") {
   cass::SharedRefPtr<cass::Host> host =
       cass::SharedRefPtr<cass::Host>(new cass::Host(cass::Address(ip, 4092), false));
   host->set_rack_and_dc(rack, dc);
-  return host;
+  return cass::TokenHost(host, dc, rack);
 }
 
 void check_host(const cass::SharedRefPtr<cass::Host>& host,
@@ -0,0 +1,292 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "connection.hpp"
+#include "constants.hpp"
+#include "external_types.hpp"
+#include "metadata.hpp"
+#include "metrics.hpp"
+#include "query_request.hpp"
+#include "request_handler.hpp"
+#include "response.hpp"
+#include "retry_policy.hpp"
+#include "serialization.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+struct InterceptorData {
+  std::vector<CassRequestEvent> events;
+  std::vector<cass_uint64_t> ids;
+  const CassStatement* statement;
+};
+
+void on_request(const CassRequestInfo* info, CassCustomPayload* payload, void* data) {
+  InterceptorData* interceptor_data = static_cast<InterceptorData*>(data);
+  interceptor_data->events.push_back(info->event);
+  interceptor_data->ids.push_back(info->id);
+  interceptor_data->statement = info->statement;
+  if (payload != NULL) {
+    cass_custom_payload_set(payload, "span",
+                            reinterpret_cast<const cass_byte_t*>("1234"), 4);
+  }
+}
+
+// Returns the name and value of each custom payload item of an encoded
+// (protocol v4) request
+std::vector<std::pair<std::string, std::string> > encoded_custom_payload(const cass::BufferVec& bufs) {
+  std::vector<std::pair<std::string, std::string> > items;
+  uint16_t count;
+  cass::decode_uint16(const_cast<char*>(bufs[1].data()), count);
+  for (uint16_t i = 0; i < count; ++i) {
+    char* pos = const_cast<char*>(bufs[2 + i].data());
+    cass::StringRef name;
+    pos = cass::decode_string(pos, &name);
+    int32_t value_size;
+    pos = cass::decode_int32(pos, value_size);
+    items.push_back(std::make_pair(name.to_string(), std::string(pos, value_size)));
+  }
+  return items;
+}
+
+class SingleHostQueryPlan : public cass::QueryPlan {
+public:
+  SingleHostQueryPlan(const cass::SharedRefPtr<cass::Host>& host)
+    : host_(host) { }
+
+  virtual cass::SharedRefPtr<cass::Host> compute_next() {
+    cass::SharedRefPtr<cass::Host> host(host_);
+    host_.reset();
+    return host;
+  }
+
+private:
+  cass::SharedRefPtr<cass::Host> host_;
+};
+
+class NopListener : public cass::Connection::Listener {
+public:
+  virtual void on_ready(cass::Connection* connection) { }
+  virtual void on_close(cass::Connection* connection) { }
+  virtual void on_availability_change(cass::Connection* connection) { }
+  virtual void on_event(cass::EventResponse* response) { }
+};
+
+void append_int32(std::string* frame, int32_t value) {
+  char buf[sizeof(int32_t)];
+  cass::encode_int32(buf, value);
+  frame->append(buf, sizeof(buf));
+}
+
+void append_uint16(std::string* frame, uint16_t value) {
+  char buf[sizeof(uint16_t)];
+  cass::encode_uint16(buf, value);
+  frame->append(buf, sizeof(buf));
+}
+
+// Decodes a protocol v3 response frame with the given opcode and body
+void decode_response(cass::ResponseMessage* response, int8_t opcode,
+                     const std::string& body) {
+  std::string frame;
+  frame.push_back(static_cast<char>(0x83));
+  frame.push_back(0);
+  append_uint16(&frame, 0);
+  frame.push_back(static_cast<char>(opcode));
+  append_int32(&frame, static_cast<int32_t>(body.size()));
+  frame.append(body);
+  BOOST_REQUIRE_EQUAL(response->decode(&frame[0], frame.size()),
+                      static_cast<ssize_t>(frame.size()));
+  BOOST_REQUIRE(response->is_body_ready());
+}
+
+// Runs a request on a connection that's closed before it connects and sets
+// the given response
+struct RequestHandlerHarness {
+  RequestHandlerHarness(InterceptorData* data)
+    : metrics(1)
+    , host(new cass::Host(cass::Address("127.0.0.1", 9042), false)) {
+#if UV_VERSION_MAJOR == 0
+    loop = uv_loop_new();
+#else
+    loop = &loop_storage__;
+    uv_loop_init(loop);
+#endif
+    connection = new cass::Connection(loop, config, &metrics, host, "", 3, &listener);
+    connection->connect();
+
+    request.reset(new cass::QueryRequest("SELECT 1"));
+    request_handler.reset(
+          new cass::RequestHandler(request.get(),
+                                   new cass::ResponseFuture(metadata),
+                                   &retry_policy));
+    request_handler->enable_interceptor(on_request, data);
+    request_handler->set_query_plan(new SingleHostQueryPlan(host));
+    request_handler->next_host();
+    request_handler->set_connection(connection);
+    request_handler->set_state(cass::Handler::REQUEST_STATE_WRITING);
+  }
+
+  ~RequestHandlerHarness() {
+    connection->close();
+    uv_run(loop, UV_RUN_DEFAULT);
+#if UV_VERSION_MAJOR == 0
+    uv_loop_delete(loop);
+#else
+    uv_loop_close(loop);
+#endif
+  }
+
+  void set_response(cass::Handler::State next_state,
+                    int8_t opcode, const std::string& body) {
+    cass::ResponseMessage response;
+    decode_response(&response, opcode, body);
+    // Held by the IO worker while the request is running
+    request_handler->inc_ref();
+    request_handler->set_state(next_state);
+    request_handler->on_set(&response);
+  }
+
+  uv_loop_t* loop;
+#if UV_VERSION_MAJOR > 0
+  uv_loop_t loop_storage__;
+#endif
+  cass::Config config;
+  cass::Metrics metrics;
+  cass::Metadata metadata;
+  cass::DefaultRetryPolicy retry_policy;
+  NopListener listener;
+  cass::SharedRefPtr<cass::Host> host;
+  cass::Connection* connection;
+  cass::SharedRefPtr<cass::QueryRequest> request;
+  cass::SharedRefPtr<cass::RequestHandler> request_handler;
+};
+
+size_t count_events(const InterceptorData& data, CassRequestEvent event) {
+  size_t count = 0;
+  for (size_t i = 0; i < data.events.size(); ++i) {
+    if (data.events[i] == event) count++;
+  }
+  return count;
+}
+
+BOOST_AUTO_TEST_SUITE(request_interceptor)
+
+BOOST_AUTO_TEST_CASE(events)
+{
+  cass::Metadata metadata;
+  InterceptorData data;
+
+  cass::SharedRefPtr<cass::QueryRequest> request(new cass::QueryRequest("SELECT 1"));
+  cass::SharedRefPtr<cass::RequestHandler> request_handler(
+        new cass::RequestHandler(request.get(), new cass::ResponseFuture(metadata), NULL));
+
+  request_handler->enable_interceptor(on_request, &data);
+  BOOST_REQUIRE_EQUAL(data.events.size(), 1u);
+  BOOST_CHECK_EQUAL(data.events[0], CASS_REQUEST_EVENT_SUBMIT);
+  BOOST_CHECK(data.statement == CassStatement::to(request.get()));
+
+  request_handler->set_state(cass::Handler::REQUEST_STATE_WRITING);
+  request_handler->set_state(cass::Handler::REQUEST_STATE_READING);
+  BOOST_REQUIRE_EQUAL(data.events.size(), 2u);
+  BOOST_CHECK_EQUAL(data.events[1], CASS_REQUEST_EVENT_WRITE_COMPLETE);
+  BOOST_CHECK_EQUAL(data.ids[0], data.ids[1]);
+  request_handler->set_state(cass::Handler::REQUEST_STATE_DONE);
+}
+
+BOOST_AUTO_TEST_CASE(custom_payload)
+{
+  cass::Metadata metadata;
+  InterceptorData data;
+
+  cass::SharedRefPtr<cass::CustomPayload> payload(new cass::CustomPayload());
+  payload->set("span", 4, reinterpret_cast<const uint8_t*>("0000"), 4);
+  payload->set("tenant", 6, reinterpret_cast<const uint8_t*>("abc"), 3);
+
+  cass::SharedRefPtr<cass::QueryRequest> request(new cass::QueryRequest("SELECT 1"));
+  request->set_custom_payload(payload.get());
+
+  cass::SharedRefPtr<cass::RequestHandler> request_handler(
+        new cass::RequestHandler(request.get(), new cass::ResponseFuture(metadata), NULL));
+  request_handler->enable_interceptor(on_request, &data);
+
+  cass::BufferVec bufs;
+  BOOST_REQUIRE_GT(request_handler->encode(4, 0, &bufs), 0);
+  BOOST_CHECK(bufs[0].data()[1] & CASS_FLAG_CUSTOM_PAYLOAD);
+
+  // The interceptor's entries replace the request's entries
+  std::vector<std::pair<std::string, std::string> > items(encoded_custom_payload(bufs));
+  BOOST_REQUIRE_EQUAL(items.size(), 2u);
+  BOOST_CHECK_EQUAL(items[0].first, "span");
+  BOOST_CHECK_EQUAL(items[0].second, "1234");
+  BOOST_CHECK_EQUAL(items[1].first, "tenant");
+  BOOST_CHECK_EQUAL(items[1].second, "abc");
+
+  // The request's payload is unchanged
+  cass::BufferVec request_bufs;
+  payload->encode(&request_bufs);
+  BOOST_CHECK_EQUAL(std::string(request_bufs[1].data() + 10, 4), "0000");
+}
+
+BOOST_AUTO_TEST_CASE(no_retry_on_success)
+{
+  InterceptorData data;
+  RequestHandlerHarness harness(&data);
+
+  std::string body;
+  append_int32(&body, CASS_RESULT_KIND_VOID);
+  harness.request_handler->set_state(cass::Handler::REQUEST_STATE_READING);
+  harness.set_response(cass::Handler::REQUEST_STATE_DONE, CQL_OPCODE_RESULT, body);
+
+  BOOST_CHECK_EQUAL(count_events(data, CASS_REQUEST_EVENT_RETRY), 0u);
+  BOOST_CHECK_EQUAL(count_events(data, CASS_REQUEST_EVENT_RESPONSE), 1u);
+  BOOST_REQUIRE(!data.events.empty());
+  BOOST_CHECK_EQUAL(data.events.back(), CASS_REQUEST_EVENT_COMPLETE);
+}
+
+BOOST_AUTO_TEST_CASE(retry_decision)
+{
+  InterceptorData data;
+  RequestHandlerHarness harness(&data);
+
+  // A read timeout where enough replicas responded but no data was returned
+  // is retried once on the same host by the default retry policy
+  std::string body;
+  append_int32(&body, CQL_ERROR_READ_TIMEOUT);
+  append_uint16(&body, 0);
+  append_uint16(&body, CASS_CONSISTENCY_ONE);
+  append_int32(&body, 1);
+  append_int32(&body, 1);
+  body.push_back(0);
+  // The response arrives before the write callback so the retry waits for
+  // the write to finish
+  harness.set_response(cass::Handler::REQUEST_STATE_READ_BEFORE_WRITE,
+                       CQL_OPCODE_ERROR, body);
+
+  BOOST_CHECK_EQUAL(count_events(data, CASS_REQUEST_EVENT_RETRY), 1u);
+  BOOST_CHECK_EQUAL(count_events(data, CASS_REQUEST_EVENT_COMPLETE), 0u);
+  BOOST_CHECK_EQUAL(harness.request_handler->state(),
+                    cass::Handler::REQUEST_STATE_RETRY_WRITE_OUTSTANDING);
+  harness.request_handler->set_state(cass::Handler::REQUEST_STATE_NEW);
+  harness.request_handler->dec_ref();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
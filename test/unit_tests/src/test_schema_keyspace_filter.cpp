@@ -0,0 +1,63 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cluster.hpp"
+#include "control_connection.hpp"
+#include "external_types.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(schema_keyspace_filter)
+
+BOOST_AUTO_TEST_CASE(config)
+{
+  CassCluster* cluster = cass_cluster_new();
+
+  cass_cluster_set_schema_keyspace_filter(cluster, "ks1, ks2");
+  cass_cluster_set_schema_keyspace_filter(cluster, "ks3");
+
+  const cass::KeyspaceList& keyspaces
+      = cluster->config().schema_keyspace_filter();
+  BOOST_REQUIRE_EQUAL(keyspaces.size(), 3u);
+  BOOST_CHECK_EQUAL(keyspaces[0], "ks1");
+  BOOST_CHECK_EQUAL(keyspaces[1], "ks2");
+  BOOST_CHECK_EQUAL(keyspaces[2], "ks3");
+
+  cass_cluster_set_schema_keyspace_filter(cluster, "");
+  BOOST_CHECK(keyspaces.empty());
+
+  cass_cluster_free(cluster);
+}
+
+BOOST_AUTO_TEST_CASE(where_clause)
+{
+  cass::KeyspaceList keyspaces;
+  BOOST_CHECK_EQUAL(cass::ControlConnection::keyspace_filter_clause(keyspaces), "");
+
+  keyspaces.push_back("ks1");
+  BOOST_CHECK_EQUAL(cass::ControlConnection::keyspace_filter_clause(keyspaces),
+                    " WHERE keyspace_name IN ('ks1')");
+
+  keyspaces.push_back("O'Brien");
+  BOOST_CHECK_EQUAL(cass::ControlConnection::keyspace_filter_clause(keyspaces),
+                    " WHERE keyspace_name IN ('ks1', 'O''Brien')");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,375 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "memory_budget.hpp"
+#include "metadata.hpp"
+#include "result_response.hpp"
+#include "serialization.hpp"
+#include "string_interner.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define NUM_KEYSPACES 10
+#define NUM_TABLES 10000
+
+// Protocol v4 type option ids
+#define TYPE_BLOB 0x0003
+#define TYPE_BOOLEAN 0x0004
+#define TYPE_INT 0x0009
+#define TYPE_VARCHAR 0x000D
+#define TYPE_MAP 0x0021
+
+// Builds the body of a protocol v4 "ROWS" result
+class SchemaRowsBuilder {
+public:
+  SchemaRowsBuilder(const std::string& table)
+    : table_(table)
+    , column_count_(0)
+    , row_count_(0) { }
+
+  void add_column(const std::string& name, uint16_t type) {
+    append_string(name, &columns_);
+    append_short(type, &columns_);
+    column_count_++;
+  }
+
+  void add_map_column(const std::string& name, uint16_t key_type, uint16_t value_type) {
+    append_string(name, &columns_);
+    append_short(TYPE_MAP, &columns_);
+    append_short(key_type, &columns_);
+    append_short(value_type, &columns_);
+    column_count_++;
+  }
+
+  SchemaRowsBuilder& value(const std::string& value) {
+    append_int(static_cast<int32_t>(value.size()), &rows_);
+    rows_.append(value);
+    return *this;
+  }
+
+  SchemaRowsBuilder& value(int32_t value) {
+    append_int(sizeof(int32_t), &rows_);
+    append_int(value, &rows_);
+    return *this;
+  }
+
+  SchemaRowsBuilder& value(bool value) {
+    append_int(1, &rows_);
+    rows_.push_back(value ? 1 : 0);
+    return *this;
+  }
+
+  SchemaRowsBuilder& map_value(const std::string& key, const std::string& value) {
+    std::string map;
+    append_int(1, &map);
+    append_int(static_cast<int32_t>(key.size()), &map);
+    map.append(key);
+    append_int(static_cast<int32_t>(value.size()), &map);
+    map.append(value);
+    return this->value(map);
+  }
+
+  SchemaRowsBuilder& null_value() {
+    append_int(-1, &rows_);
+    return *this;
+  }
+
+  void end_row() { row_count_++; }
+
+  cass::SharedRefPtr<cass::ResultResponse> build() const {
+    std::string body;
+    append_int(CASS_RESULT_KIND_ROWS, &body);
+    append_int(CASS_RESULT_FLAG_GLOBAL_TABLESPEC, &body);
+    append_int(column_count_, &body);
+    append_string("system_schema", &body);
+    append_string(table_, &body);
+    body.append(columns_);
+    append_int(row_count_, &body);
+    body.append(rows_);
+
+    cass::SharedRefPtr<cass::ResultResponse> result(new cass::ResultResponse());
+    result->set_buffer(body.size());
+    memcpy(result->data(), body.data(), body.size());
+    BOOST_REQUIRE(result->decode(4, result->data(), body.size()));
+    return result;
+  }
+
+private:
+  static void append_int(int32_t value, std::string* output) {
+    char buf[sizeof(int32_t)];
+    cass::encode_int32(buf, value);
+    output->append(buf, sizeof(int32_t));
+  }
+
+  static void append_short(uint16_t value, std::string* output) {
+    char buf[sizeof(uint16_t)];
+    cass::encode_uint16(buf, value);
+    output->append(buf, sizeof(uint16_t));
+  }
+
+  static void append_string(const std::string& value, std::string* output) {
+    append_short(static_cast<uint16_t>(value.size()), output);
+    output->append(value);
+  }
+
+private:
+  std::string table_;
+  std::string columns_;
+  std::string rows_;
+  int32_t column_count_;
+  int32_t row_count_;
+};
+
+static std::string keyspace_name(int i) {
+  return "keyspace" + boost::lexical_cast<std::string>(i);
+}
+
+static std::string table_name(int i) {
+  return "table" + boost::lexical_cast<std::string>(i);
+}
+
+static cass::SharedRefPtr<cass::ResultResponse> keyspaces_result() {
+  SchemaRowsBuilder builder("keyspaces");
+  builder.add_column("keyspace_name", TYPE_VARCHAR);
+  builder.add_column("durable_writes", TYPE_BOOLEAN);
+  builder.add_map_column("replication", TYPE_VARCHAR, TYPE_VARCHAR);
+  for (int k = 0; k < NUM_KEYSPACES; ++k) {
+    builder.value(keyspace_name(k))
+        .value(true)
+        .map_value("class", "org.apache.cassandra.locator.LocalStrategy")
+        .end_row();
+  }
+  return builder.build();
+}
+
+static cass::SharedRefPtr<cass::ResultResponse> tables_result() {
+  SchemaRowsBuilder builder("tables");
+  builder.add_column("keyspace_name", TYPE_VARCHAR);
+  builder.add_column("table_name", TYPE_VARCHAR);
+  builder.add_column("comment", TYPE_VARCHAR);
+  builder.add_column("default_time_to_live", TYPE_INT);
+  builder.add_column("gc_grace_seconds", TYPE_INT);
+  builder.add_map_column("caching", TYPE_VARCHAR, TYPE_VARCHAR);
+  builder.add_map_column("compaction", TYPE_VARCHAR, TYPE_VARCHAR);
+  for (int t = 0; t < NUM_TABLES; ++t) {
+    builder.value(keyspace_name(t % NUM_KEYSPACES))
+        .value(table_name(t))
+        .value(std::string(""))
+        .value(0)
+        .value(864000)
+        .map_value("keys", "ALL")
+        .map_value("class", "org.apache.cassandra.db.compaction.SizeTieredCompactionStrategy")
+        .end_row();
+  }
+  return builder.build();
+}
+
+// Rows must be grouped by keyspace and table. The "value" column of the first
+// table has the type "value_type".
+static cass::SharedRefPtr<cass::ResultResponse> columns_result(const std::string& value_type) {
+  SchemaRowsBuilder builder("columns");
+  builder.add_column("keyspace_name", TYPE_VARCHAR);
+  builder.add_column("table_name", TYPE_VARCHAR);
+  builder.add_column("column_name", TYPE_VARCHAR);
+  builder.add_column("clustering_order", TYPE_VARCHAR);
+  builder.add_column("column_name_bytes", TYPE_BLOB);
+  builder.add_column("kind", TYPE_VARCHAR);
+  builder.add_column("position", TYPE_INT);
+  builder.add_column("type", TYPE_VARCHAR);
+  for (int k = 0; k < NUM_KEYSPACES; ++k) {
+    for (int t = k; t < NUM_TABLES; t += NUM_KEYSPACES) {
+      builder.value(keyspace_name(k)).value(table_name(t))
+          .value(std::string("id")).value(std::string("none")).value(std::string("id"))
+          .value(std::string("partition_key")).value(0).value(std::string("uuid"))
+          .end_row();
+      builder.value(keyspace_name(k)).value(table_name(t))
+          .value(std::string("ts")).value(std::string("desc")).value(std::string("ts"))
+          .value(std::string("clustering")).value(0).value(std::string("timestamp"))
+          .end_row();
+      builder.value(keyspace_name(k)).value(table_name(t))
+          .value(std::string("tags")).value(std::string("none")).value(std::string("tags"))
+          .value(std::string("regular")).value(-1).value(std::string("set<text>"))
+          .end_row();
+      builder.value(keyspace_name(k)).value(table_name(t))
+          .value(std::string("value")).value(std::string("none")).value(std::string("value"))
+          .value(std::string("regular")).value(-1).value(t == 0 ? value_type : std::string("text"))
+          .end_row();
+    }
+  }
+  return builder.build();
+}
+
+static void refresh(cass::Metadata* metadata, const std::string& value_type) {
+  metadata->clear_and_update_back();
+  metadata->update_keyspaces(keyspaces_result().get());
+  metadata->update_tables(tables_result().get());
+  metadata->update_columns(columns_result(value_type).get());
+  metadata->swap_to_back_and_update_front();
+}
+
+static const cass::ColumnMetadata* get_column(const cass::Metadata::SchemaSnapshot& snapshot,
+                                              int table, const std::string& column) {
+  const cass::KeyspaceMetadata* keyspace = snapshot.get_keyspace(keyspace_name(table % NUM_KEYSPACES));
+  BOOST_REQUIRE(keyspace != NULL);
+  const cass::TableMetadata* table_metadata = keyspace->get_table(table_name(table));
+  BOOST_REQUIRE(table_metadata != NULL);
+  return table_metadata->get_column(column);
+}
+
+static size_t heap_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE(schema_metadata)
+
+BOOST_AUTO_TEST_CASE(memory)
+{
+  int64_t initial_page_bytes = cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY);
+  int64_t initial_metadata_bytes = cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA);
+
+  int64_t page_bytes = 0;
+  {
+    cass::SharedRefPtr<cass::ResultResponse> keyspaces(keyspaces_result());
+    cass::SharedRefPtr<cass::ResultResponse> tables(tables_result());
+    cass::SharedRefPtr<cass::ResultResponse> columns(columns_result("text"));
+    page_bytes = cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY) - initial_page_bytes;
+  }
+
+  size_t initial_heap_bytes = heap_bytes();
+
+  cass::Metadata metadata;
+  metadata.set_protocol_version(4);
+  metadata.set_cassandra_version(cass::VersionNumber(3, 0, 0));
+  refresh(&metadata, "text");
+
+  // The schema's pages are released after they're processed
+  BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::RESPONSE_BODY),
+                    initial_page_bytes);
+
+  int64_t metadata_bytes = cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA) - initial_metadata_bytes;
+  BOOST_CHECK(metadata_bytes > 0);
+  BOOST_CHECK(metadata_bytes < page_bytes);
+
+  BOOST_TEST_MESSAGE("Schema with " << NUM_TABLES << " tables: "
+                     << page_bytes << " page bytes, "
+                     << metadata_bytes << " metadata buffer bytes, "
+                     << (heap_bytes() - initial_heap_bytes) << " heap bytes");
+
+  const cass::ColumnMetadata* id;
+  const cass::ColumnMetadata* tags;
+  const cass::ColumnMetadata* value;
+  {
+    cass::Metadata::SchemaSnapshot snapshot(metadata.schema_snapshot());
+    id = get_column(snapshot, 0, "id");
+    tags = get_column(snapshot, 0, "tags");
+    value = get_column(snapshot, 0, "value");
+    BOOST_REQUIRE(id != NULL && tags != NULL && value != NULL);
+    BOOST_CHECK_EQUAL(id->type(), CASS_COLUMN_TYPE_PARTITION_KEY);
+    BOOST_CHECK_EQUAL(value->data_type()->value_type(), CASS_VALUE_TYPE_TEXT);
+    BOOST_CHECK_EQUAL(get_column(snapshot, NUM_TABLES - 1, "ts")->type(),
+                      CASS_COLUMN_TYPE_CLUSTERING_KEY);
+    BOOST_CHECK(get_column(snapshot, NUM_TABLES - 1, "ts")->is_reversed());
+  }
+
+  // A full refresh shares the columns that didn't change
+  refresh(&metadata, "int");
+  {
+    cass::Metadata::SchemaSnapshot snapshot(metadata.schema_snapshot());
+    BOOST_CHECK(get_column(snapshot, 0, "id") == id);
+    BOOST_CHECK(get_column(snapshot, 0, "tags") == tags);
+    const cass::ColumnMetadata* changed = get_column(snapshot, 0, "value");
+    BOOST_REQUIRE(changed != NULL);
+    BOOST_CHECK(changed != value);
+    BOOST_CHECK_EQUAL(changed->data_type()->value_type(), CASS_VALUE_TYPE_INT);
+  }
+
+  // The memory used doesn't grow with refreshes
+  BOOST_CHECK(cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA) - initial_metadata_bytes <= metadata_bytes + 16);
+
+  metadata.clear();
+  BOOST_CHECK_EQUAL(cass::MemoryBudget::bytes(cass::MemoryBudget::METADATA), initial_metadata_bytes);
+}
+
+struct SchemaAppliedData {
+  SchemaAppliedData(cass::Metadata* metadata)
+    : metadata(metadata)
+    , count(0) { }
+
+  cass::Metadata* metadata;
+  int count;
+  std::vector<CassValueType> value_types;
+};
+
+static void on_schema_applied(void* data) {
+  SchemaAppliedData* applied = static_cast<SchemaAppliedData*>(data);
+  applied->count++;
+  cass::Metadata::SchemaSnapshot snapshot(applied->metadata->schema_snapshot());
+  const cass::ColumnMetadata* value = get_column(snapshot, 0, "value");
+  applied->value_types.push_back(value != NULL ? value->data_type()->value_type()
+                                               : CASS_VALUE_TYPE_UNKNOWN);
+}
+
+BOOST_AUTO_TEST_CASE(background)
+{
+  uv_loop_t loop;
+  BOOST_REQUIRE(uv_loop_init(&loop) == 0);
+
+  cass::Metadata metadata;
+  metadata.set_loop(&loop);
+  metadata.set_protocol_version(4);
+  metadata.set_cassandra_version(cass::VersionNumber(3, 0, 0));
+  BOOST_CHECK(metadata.cassandra_version() >= cass::VersionNumber(3, 0, 0));
+
+  SchemaAppliedData applied(&metadata);
+  refresh(&metadata, "text");
+  metadata.notify_when_applied(on_schema_applied, &applied);
+  refresh(&metadata, "int");
+  metadata.notify_when_applied(on_schema_applied, &applied);
+
+  // Callbacks are only run on the loop's thread
+  BOOST_CHECK_EQUAL(applied.count, 0);
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+
+  BOOST_REQUIRE_EQUAL(applied.count, 2);
+  BOOST_CHECK_EQUAL(applied.value_types[1], CASS_VALUE_TYPE_INT);
+  BOOST_CHECK_EQUAL(metadata.schema_snapshot().keyspaces()->size(),
+                    static_cast<size_t>(NUM_KEYSPACES));
+
+  metadata.clear();
+  uv_loop_close(&loop);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "batch_request.hpp"
+#include "query_request.hpp"
+#include "slow_query_iterator.hpp"
+#include "slow_query_log.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <uv.h>
+
+struct CallbackData {
+  int count;
+  std::string statement;
+};
+
+void on_slow_query(const CassSlowQuery* query, void* data) {
+  CallbackData* callback_data = static_cast<CallbackData*>(data);
+  callback_data->count++;
+  callback_data->statement.assign(query->statement, query->statement_length);
+}
+
+BOOST_AUTO_TEST_SUITE(slow_query_log)
+
+BOOST_AUTO_TEST_CASE(entry)
+{
+  cass::SharedRefPtr<cass::QueryRequest> request(
+        new cass::QueryRequest(std::string("SELECT * FROM t WHERE k = ? AND c = ?"), 3));
+  request->set(0, cass::CassString("abc", 3));
+  request->set(1, static_cast<cass_int64_t>(1));
+
+  cass::SlowQueryLog::Entry entry(request.get(), 2000000);
+  entry.coordinator = cass::Address("127.0.0.1", 9042);
+  entry.has_coordinator = true;
+  entry.consistency = CASS_CONSISTENCY_QUORUM;
+  entry.retries = 1;
+
+  CassSlowQuery query;
+  entry.to_cass(&query);
+  BOOST_CHECK_EQUAL(std::string(query.statement, query.statement_length),
+                    "SELECT * FROM t WHERE k = ? AND c = ?");
+  BOOST_REQUIRE_EQUAL(query.bound_value_count, 3u);
+  BOOST_CHECK_EQUAL(query.bound_value_sizes[0], 3);
+  BOOST_CHECK_EQUAL(query.bound_value_sizes[1], 8);
+  BOOST_CHECK_EQUAL(query.bound_value_sizes[2], -1); // Unset
+  BOOST_CHECK_EQUAL(query.coordinator.address_length, 4);
+  BOOST_CHECK_EQUAL(query.consistency, CASS_CONSISTENCY_QUORUM);
+  BOOST_CHECK_EQUAL(query.retries, 1u);
+  BOOST_CHECK_EQUAL(query.error, CASS_OK);
+  BOOST_CHECK_EQUAL(query.latency, 2000u);
+  BOOST_CHECK_EQUAL(query.phases.total, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(batch_entry)
+{
+  cass::SharedRefPtr<cass::BatchRequest> batch(
+        new cass::BatchRequest(CASS_BATCH_TYPE_LOGGED));
+  batch->add_statement(new cass::QueryRequest("INSERT INTO t (k) VALUES (1)"));
+  batch->add_statement(new cass::QueryRequest("INSERT INTO t (k) VALUES (2)"));
+
+  cass::SlowQueryLog::Entry entry(batch.get(), 0);
+  BOOST_CHECK_EQUAL(entry.statement,
+                    "INSERT INTO t (k) VALUES (1); INSERT INTO t (k) VALUES (2)");
+  BOOST_CHECK(entry.bound_value_sizes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(threshold_and_sampling)
+{
+  cass::SlowQueryLog log(10, 0.25, 16);
+  BOOST_CHECK(!log.is_slow(9 * 1000 * 1000));
+  BOOST_CHECK(log.is_slow(10 * 1000 * 1000));
+
+  int sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    if (log.sample()) sampled++;
+  }
+  BOOST_CHECK_EQUAL(sampled, 25);
+
+  cass::SlowQueryLog none(10, 0.0, 16);
+  BOOST_CHECK(!none.sample());
+}
+
+BOOST_AUTO_TEST_CASE(drain)
+{
+  cass::SharedRefPtr<cass::QueryRequest> request(new cass::QueryRequest("SELECT 1"));
+
+  cass::SharedRefPtr<cass::SlowQueryLog> log(new cass::SlowQueryLog(10, 1.0, 2));
+  for (int i = 0; i < 3; ++i) {
+    log->add(new cass::SlowQueryLog::Entry(request.get(), 0));
+  }
+  BOOST_CHECK_EQUAL(log->dropped_count(), 1u);
+
+  // The iterator keeps the log alive after the session releases it
+  cass::SlowQueryIterator iterator(log);
+  log.reset();
+
+  int count = 0;
+  while (iterator.next()) {
+    BOOST_CHECK_EQUAL(iterator.entry()->statement, "SELECT 1");
+    count++;
+  }
+  BOOST_CHECK_EQUAL(count, 2);
+  BOOST_CHECK(!iterator.next());
+}
+
+BOOST_AUTO_TEST_CASE(callback)
+{
+  uv_loop_t* loop;
+
+#if UV_VERSION_MAJOR == 0
+  loop = uv_loop_new();
+#else
+  uv_loop_t loop_storage__;
+  loop = &loop_storage__;
+  uv_loop_init(loop);
+#endif
+
+  CallbackData data;
+  data.count = 0;
+
+  cass::SharedRefPtr<cass::QueryRequest> request(new cass::QueryRequest("SELECT 1"));
+
+  cass::SlowQueryLog log(10, 1.0, 16);
+  BOOST_REQUIRE_EQUAL(log.init_callback(loop, on_slow_query, &data), 0);
+
+  log.add(new cass::SlowQueryLog::Entry(request.get(), 0));
+  log.add(new cass::SlowQueryLog::Entry(request.get(), 0));
+
+  uv_run(loop, UV_RUN_NOWAIT);
+
+  BOOST_CHECK_EQUAL(data.count, 2);
+  BOOST_CHECK_EQUAL(data.statement, "SELECT 1");
+
+  log.close_handles();
+  uv_run(loop, UV_RUN_DEFAULT);
+
+#if UV_VERSION_MAJOR == 0
+  uv_loop_delete(loop);
+#else
+  uv_loop_close(loop);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
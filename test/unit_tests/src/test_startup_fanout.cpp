@@ -0,0 +1,168 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "cassandra.h"
+#include "mock_cql_server.hpp"
+
+#include <boost/chrono.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <string>
+#include <vector>
+
+// A session that connects the pools of its IO worker one at a time. The
+// control connection is always to 127.0.0.1.
+struct FanoutSession : public MockSession {
+  struct IsAccepted {
+    IsAccepted(MockCqlServer* server, const std::string& ip)
+      : server(server)
+      , ip(ip) { }
+
+    bool operator()() const {
+      std::vector<std::string> order(server->accept_order());
+      return std::find(order.begin(), order.end(), ip) != order.end();
+    }
+
+    MockCqlServer* server;
+    std::string ip;
+  };
+
+  FanoutSession() {
+    cass_cluster_set_startup_pool_fanout(cluster, 1);
+  }
+
+  CassError wait_for_connect() {
+    return cass_future_error_code(connect_future);
+  }
+
+  bool wait_for_accepted(const std::string& ip) {
+    return wait_for(IsAccepted(&server, ip));
+  }
+
+  bool is_accepted(const std::string& ip) {
+    return IsAccepted(&server, ip)();
+  }
+};
+
+static std::vector<std::string> make_order(const char* first,
+                                           const char* second,
+                                           const char* third) {
+  std::vector<std::string> order;
+  order.push_back(first);
+  order.push_back(second);
+  order.push_back(third);
+  return order;
+}
+
+BOOST_AUTO_TEST_SUITE(startup_fanout)
+
+BOOST_AUTO_TEST_CASE(local_hosts_first)
+{
+  FanoutSession fanout;
+  fanout.server.add_node("127.0.0.1", "dc1");
+  fanout.server.add_node("127.0.0.2", "dc2");
+  fanout.server.add_node("127.0.0.3", "dc1");
+  cass_cluster_set_load_balance_dc_aware(fanout.cluster, "dc1", 1, cass_false);
+
+  fanout.start_connect();
+  BOOST_REQUIRE_EQUAL(fanout.wait_for_connect(), CASS_OK);
+
+  std::vector<std::string> order(fanout.server.accept_order());
+  BOOST_CHECK(order == make_order("127.0.0.1", "127.0.0.3", "127.0.0.2"));
+}
+
+BOOST_AUTO_TEST_CASE(failed_pool)
+{
+  FanoutSession fanout;
+  fanout.server.add_node("127.0.0.1");
+  fanout.server.add_node("127.0.0.2", "dc1", false);
+  fanout.server.add_node("127.0.0.3");
+
+  // The failed pool frees its slot for the next pool
+  fanout.start_connect();
+  BOOST_REQUIRE_EQUAL(fanout.wait_for_connect(), CASS_OK);
+  BOOST_CHECK(fanout.is_accepted("127.0.0.3"));
+}
+
+BOOST_AUTO_TEST_CASE(connecting_pool_removed)
+{
+  FanoutSession fanout;
+  fanout.server.add_node("127.0.0.1");
+  fanout.server.add_node("127.0.0.2");
+  fanout.server.add_node("127.0.0.3");
+  fanout.server.hold_startup("127.0.0.2");
+
+  fanout.start_connect();
+  BOOST_REQUIRE(fanout.wait_for_held_responses(1));
+  BOOST_CHECK(!fanout.is_accepted("127.0.0.3"));
+
+  // Closing the connecting pool frees its slot
+  fanout.server.send_event("TOPOLOGY_CHANGE", "REMOVED_NODE", "127.0.0.2");
+  BOOST_CHECK(fanout.wait_for_accepted("127.0.0.3"));
+  BOOST_CHECK_EQUAL(fanout.wait_for_connect(), CASS_OK);
+}
+
+BOOST_AUTO_TEST_CASE(waiting_pool_removed)
+{
+  FanoutSession fanout;
+  fanout.server.add_node("127.0.0.1");
+  fanout.server.add_node("127.0.0.2");
+  fanout.server.add_node("127.0.0.3");
+  fanout.server.hold_startup("127.0.0.2");
+
+  fanout.start_connect();
+  BOOST_REQUIRE(fanout.wait_for_held_responses(1));
+
+  // There's no way to observe the removal of a pool that isn't connecting
+  // so the event is given time to reach the IO worker
+  fanout.server.send_event("TOPOLOGY_CHANGE", "REMOVED_NODE", "127.0.0.3");
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+  // The removed pool is skipped when the connecting pool is ready
+  fanout.server.release_responses(1);
+  BOOST_CHECK_EQUAL(fanout.wait_for_connect(), CASS_OK);
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+  BOOST_CHECK(!fanout.is_accepted("127.0.0.3"));
+}
+
+BOOST_AUTO_TEST_CASE(waiting_pool_readded)
+{
+  FanoutSession fanout;
+  fanout.server.add_node("127.0.0.1");
+  fanout.server.add_node("127.0.0.2");
+  fanout.server.add_node("127.0.0.3");
+  fanout.server.hold_startup("127.0.0.2");
+
+  fanout.start_connect();
+  BOOST_REQUIRE(fanout.wait_for_held_responses(1));
+
+  // The waiting pool is closed when its host goes down and the host's new
+  // pool isn't part of the startup so it connects right away
+  fanout.server.send_event("STATUS_CHANGE", "DOWN", "127.0.0.3");
+  fanout.server.send_event("STATUS_CHANGE", "UP", "127.0.0.3");
+  BOOST_CHECK(fanout.wait_for_accepted("127.0.0.3"));
+
+  fanout.server.release_responses(1);
+  BOOST_CHECK_EQUAL(fanout.wait_for_connect(), CASS_OK);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
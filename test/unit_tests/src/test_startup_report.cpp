@@ -0,0 +1,70 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "startup_report.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(startup_report)
+
+BOOST_AUTO_TEST_CASE(phases)
+{
+  cass::StartupReport report;
+  report.start(1000);
+  BOOST_CHECK(!report.is_finished(cass::StartupReport::PHASE_RESOLVE));
+  BOOST_CHECK_EQUAL(report.total_ns(), 0u);
+
+  report.finish(cass::StartupReport::PHASE_RESOLVE, 1100);
+  report.finish(cass::StartupReport::PHASE_CONTROL_CONNECTION, 1300);
+  report.finish(cass::StartupReport::PHASE_SCHEMA, 1600);
+  report.finish(cass::StartupReport::PHASE_FIRST_POOL_READY, 1700);
+  report.finish(cass::StartupReport::PHASE_FIRST_POOL_READY, 1800); // Ignored
+  report.finish(cass::StartupReport::PHASE_ALL_POOLS_READY, 2000);
+
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_RESOLVE), 100u);
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_CONTROL_CONNECTION), 200u);
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_SCHEMA), 300u);
+  // Both pool phases start when the schema phase finishes
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_FIRST_POOL_READY), 100u);
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_ALL_POOLS_READY), 400u);
+  BOOST_CHECK_EQUAL(report.total_ns(), 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(skipped_phases)
+{
+  cass::StartupReport report;
+  report.start(1000);
+
+  // No pools were connected
+  report.finish(cass::StartupReport::PHASE_SCHEMA, 1500);
+  report.finish(cass::StartupReport::PHASE_ALL_POOLS_READY, 1500);
+
+  BOOST_CHECK(report.is_finished(cass::StartupReport::PHASE_RESOLVE));
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_RESOLVE), 500u);
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_CONTROL_CONNECTION), 0u);
+  BOOST_CHECK_EQUAL(report.duration_ns(cass::StartupReport::PHASE_FIRST_POOL_READY), 0u);
+  BOOST_CHECK_EQUAL(report.total_ns(), 500u);
+
+  // Restarting clears the previous connect
+  report.start(3000);
+  BOOST_CHECK(!report.is_finished(cass::StartupReport::PHASE_ALL_POOLS_READY));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "string_interner.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(string_interner)
+
+BOOST_AUTO_TEST_CASE(intern)
+{
+  cass::InternedString::Ptr str1(cass::StringInterner::intern(cass::StringRef("interned_abc")));
+  cass::InternedString::Ptr str2(cass::StringInterner::intern(cass::StringRef(std::string("interned_abc"))));
+  cass::InternedString::Ptr str3(cass::StringInterner::intern(cass::StringRef("interned_xyz")));
+
+  BOOST_CHECK_EQUAL(str1->str(), "interned_abc");
+  BOOST_CHECK_EQUAL(str3->str(), "interned_xyz");
+  BOOST_CHECK(str1.get() == str2.get());
+  BOOST_CHECK(str1.get() != str3.get());
+}
+
+BOOST_AUTO_TEST_CASE(purge)
+{
+  cass::StringInterner::purge();
+  size_t size = cass::StringInterner::size();
+
+  cass::InternedString::Ptr str1(cass::StringInterner::intern(cass::StringRef("purged_abc")));
+  cass::InternedString::Ptr str2(cass::StringInterner::intern(cass::StringRef("purged_xyz")));
+  BOOST_CHECK_EQUAL(cass::StringInterner::size(), size + 2);
+
+  // Referenced strings are kept
+  str1.reset();
+  BOOST_CHECK_EQUAL(cass::StringInterner::purge(), 1u);
+  BOOST_CHECK_EQUAL(cass::StringInterner::size(), size + 1);
+
+  cass::InternedString::Ptr str3(cass::StringInterner::intern(cass::StringRef("purged_xyz")));
+  BOOST_CHECK(str2.get() == str3.get());
+
+  str2.reset();
+  str3.reset();
+  BOOST_CHECK_EQUAL(cass::StringInterner::purge(), 1u);
+  BOOST_CHECK_EQUAL(cass::StringInterner::size(), size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
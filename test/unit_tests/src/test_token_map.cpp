@@ -30,6 +30,11 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/random/mersenne_twister.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <stdio.h>
+#include <uv.h>
+
 cass::SharedRefPtr<cass::Host> create_host(const std::string& ip) {
   return cass::SharedRefPtr<cass::Host>(new cass::Host(cass::Address(ip, 4092), false));
 }
@@ -82,6 +87,70 @@ struct TestTokenMap {
   }
 };
 
+struct RingHost {
+  cass::SharedRefPtr<cass::Host> host;
+  std::vector<std::string> tokens;
+};
+
+typedef std::map<std::string, RingHost> RingHostMap;
+
+const char* RING_KEYSPACES[] = { "nts", "simple", "none" };
+
+void add_ring_keyspaces(cass::TokenMap* token_map) {
+  cass::NetworkTopologyStrategy::DCReplicaCountMap replication_factors;
+  replication_factors["dc1"] = 3;
+  replication_factors["dc2"] = 2;
+  token_map->set_replication_strategy("nts",
+                                      cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                        new cass::NetworkTopologyStrategy("", replication_factors)));
+  token_map->set_replication_strategy("simple",
+                                      cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                        new cass::SimpleStrategy("", 3)));
+  token_map->set_replication_strategy("none",
+                                      cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                        new cass::NonReplicatedStrategy("")));
+}
+
+void update_ring_host(cass::TokenMap* token_map, RingHost* ring_host) {
+  cass::TokenStringList tokens(ring_host->tokens.begin(), ring_host->tokens.end());
+  token_map->update_host(ring_host->host, tokens);
+}
+
+RingHost create_ring_host(const std::string& ip, size_t num_tokens, size_t num_racks,
+                          boost::mt19937_64& ng) {
+  RingHost ring_host;
+  ring_host.host = create_host(ip);
+  ring_host.host->set_rack_and_dc("rack" + boost::lexical_cast<std::string>(ng() % num_racks),
+                                  ng() % 2 == 0 ? "dc1" : "dc2");
+  for (size_t i = 0; i < num_tokens; ++i) {
+    ring_host.tokens.push_back(boost::lexical_cast<std::string>(static_cast<int64_t>(ng())));
+  }
+  return ring_host;
+}
+
+// Compares the replicas of an incrementally updated map with a map that's
+// built from scratch using the same ring
+void verify_against_rebuild(const cass::TokenMap& token_map, RingHostMap& ring,
+                            boost::mt19937_64& ng) {
+  cass::TokenMap rebuilt;
+  rebuilt.set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+  add_ring_keyspaces(&rebuilt);
+  for (RingHostMap::iterator i = ring.begin(); i != ring.end(); ++i) {
+    update_ring_host(&rebuilt, &i->second);
+  }
+  rebuilt.build();
+
+  for (int i = 0; i < 1000; ++i) {
+    std::string key(boost::lexical_cast<std::string>(ng()));
+    for (size_t j = 0; j < sizeof(RING_KEYSPACES) / sizeof(RING_KEYSPACES[0]); ++j) {
+      const cass::CopyOnWriteHostVec& expected = rebuilt.get_replicas(RING_KEYSPACES[j], key);
+      const cass::CopyOnWriteHostVec& actual = token_map.get_replicas(RING_KEYSPACES[j], key);
+      BOOST_REQUIRE_EQUAL(actual->size(), expected->size());
+      BOOST_REQUIRE(std::equal(actual->begin(), actual->end(), expected->begin()));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE(token_map)
 
 int64_t murmur3_hash(const std::string& s) {
@@ -262,6 +331,156 @@ BOOST_AUTO_TEST_CASE(drop_keyspace)
   }
 }
 
+BOOST_AUTO_TEST_CASE(shared_replicas)
+{
+  // Synthetic 100 node, 256 vnode ring with many keyspaces that only use two
+  // distinct replication settings
+  const size_t num_hosts = 100;
+  const size_t tokens_per_host = 256;
+  const size_t num_keyspaces = 120;
+
+  cass::NetworkTopologyStrategy::DCReplicaCountMap replication_factors;
+  replication_factors["dc1"] = 3;
+  replication_factors["dc2"] = 3;
+
+  cass::TokenMap token_map;
+  token_map.set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+
+  for (size_t i = 0; i < num_keyspaces; ++i) {
+    cass::SharedRefPtr<cass::ReplicationStrategy> strategy;
+    if (i % 2 == 0) {
+      strategy = cass::SharedRefPtr<cass::ReplicationStrategy>(
+                   new cass::NetworkTopologyStrategy("", replication_factors));
+    } else {
+      strategy = cass::SharedRefPtr<cass::ReplicationStrategy>(
+                   new cass::SimpleStrategy("", 3));
+    }
+    token_map.set_replication_strategy("ks" + boost::lexical_cast<std::string>(i),
+                                       strategy);
+  }
+
+  boost::mt19937_64 ng;
+
+  for (size_t i = 0; i < num_hosts; ++i) {
+    char ip[32];
+    sprintf(ip, "1.0.%u.%u", static_cast<unsigned>(i / 250), static_cast<unsigned>(i % 250 + 1));
+    cass::SharedRefPtr<cass::Host> host(create_host(ip));
+    host->set_rack_and_dc(i % 4 < 2 ? "rack1" : "rack2", i % 2 == 0 ? "dc1" : "dc2");
 
+    // The token list references the strings
+    std::vector<std::string> token_strings;
+    for (size_t j = 0; j < tokens_per_host; ++j) {
+      token_strings.push_back(boost::lexical_cast<std::string>(static_cast<int64_t>(ng())));
+    }
+    cass::TokenStringList tokens(token_strings.begin(), token_strings.end());
+    token_map.update_host(host, tokens);
+  }
+
+  uint64_t start = uv_hrtime();
+  token_map.build();
+  uint64_t elapsed = uv_hrtime() - start;
+
+  BOOST_TEST_MESSAGE("Token map rebuild for " << num_hosts << " hosts, "
+                     << tokens_per_host << " tokens per host and "
+                     << num_keyspaces << " keyspaces took "
+                     << elapsed / (1000 * 1000) << " ms");
+
+  // Only one replica map is computed per distinct replication setting
+  BOOST_CHECK_EQUAL(token_map.replica_map_count(), 2u);
+
+  for (int i = 0; i < 24; ++i) {
+    std::string value(1, 'a' + i);
+    const cass::CopyOnWriteHostVec& nts = token_map.get_replicas("ks0", value);
+    const cass::CopyOnWriteHostVec& simple = token_map.get_replicas("ks1", value);
+    BOOST_REQUIRE_EQUAL(nts->size(), 6u);
+    BOOST_REQUIRE_EQUAL(simple->size(), 3u);
+    BOOST_CHECK(&(*nts) == &(*token_map.get_replicas("ks2", value)));
+    BOOST_CHECK(&(*simple) == &(*token_map.get_replicas("ks3", value)));
+  }
+
+  // Bootstrapping a single host only recomputes the token ranges around its
+  // tokens
+  {
+    cass::SharedRefPtr<cass::Host> host(create_host("1.0.1.1"));
+    host->set_rack_and_dc("rack1", "dc1");
+    std::vector<std::string> token_strings;
+    for (size_t j = 0; j < tokens_per_host; ++j) {
+      token_strings.push_back(boost::lexical_cast<std::string>(static_cast<int64_t>(ng())));
+    }
+    cass::TokenStringList tokens(token_strings.begin(), token_strings.end());
+
+    start = uv_hrtime();
+    token_map.update_host(host, tokens);
+    elapsed = uv_hrtime() - start;
+
+    BOOST_TEST_MESSAGE("Incremental token map update for a new host took "
+                       << elapsed / (1000 * 1000) << " ms");
+    BOOST_CHECK_EQUAL(token_map.replica_map_count(), 2u);
+  }
+
+  // Dropping one keyspace keeps the shared map, dropping all of them frees it
+  token_map.drop_keyspace("ks1");
+  BOOST_CHECK_EQUAL(token_map.replica_map_count(), 2u);
+  for (size_t i = 1; i < num_keyspaces; i += 2) {
+    token_map.drop_keyspace("ks" + boost::lexical_cast<std::string>(i));
+  }
+  BOOST_CHECK_EQUAL(token_map.replica_map_count(), 1u);
+  BOOST_CHECK_EQUAL(token_map.get_replicas("ks3", "abc")->size(), 0u);
+  BOOST_CHECK_EQUAL(token_map.get_replicas("ks2", "abc")->size(), 6u);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_updates)
+{
+  boost::mt19937_64 ng;
+
+  const size_t tokens_per_host = 8;
+  const size_t num_racks = 3;
+  size_t next_host = 1;
+
+  cass::TokenMap token_map;
+  token_map.set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+  add_ring_keyspaces(&token_map);
+
+  RingHostMap ring;
+  for (; next_host <= 24; ++next_host) {
+    std::string ip("1.0.0." + boost::lexical_cast<std::string>(next_host));
+    ring[ip] = create_ring_host(ip, tokens_per_host, num_racks, ng);
+    update_ring_host(&token_map, &ring[ip]);
+  }
+  token_map.build();
+  verify_against_rebuild(token_map, ring, ng);
+
+  // Randomly add, remove and move hosts. New hosts occasionally land in a
+  // new rack which requires a full rebuild.
+  for (int i = 0; i < 100; ++i) {
+    switch (ng() % 3) {
+      case 0: {
+        std::string ip("1.0.0." + boost::lexical_cast<std::string>(next_host++));
+        ring[ip] = create_ring_host(ip, tokens_per_host, num_racks + 1, ng);
+        update_ring_host(&token_map, &ring[ip]);
+        break;
+      }
+
+      case 1: {
+        if (ring.size() <= 1) continue;
+        RingHostMap::iterator it = ring.begin();
+        std::advance(it, ng() % ring.size());
+        token_map.remove_host(it->second.host);
+        ring.erase(it);
+        break;
+      }
+
+      case 2: {
+        RingHostMap::iterator it = ring.begin();
+        std::advance(it, ng() % ring.size());
+        it->second.tokens[ng() % tokens_per_host]
+            = boost::lexical_cast<std::string>(static_cast<int64_t>(ng()));
+        update_ring_host(&token_map, &it->second);
+        break;
+      }
+    }
+    verify_against_rebuild(token_map, ring, ng);
+  }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,177 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "atomic.hpp"
+#include "constants.hpp"
+#include "token_map_builder.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <uv.h>
+#include <vector>
+
+static cass::SharedRefPtr<cass::Host> create_builder_host(const std::string& ip) {
+  return cass::SharedRefPtr<cass::Host>(new cass::Host(cass::Address(ip, 9042), false));
+}
+
+static void add_builder_hosts(cass::TokenMapBuilder* builder,
+                              cass::HostVec* hosts,
+                              const std::string& dc = "") {
+  // The tokens are copied by the builder
+  for (int i = 0; i < 3; ++i) {
+    std::string token(boost::lexical_cast<std::string>((i - 1) * (CASS_INT64_MAX / 2)));
+    cass::TokenStringList tokens;
+    tokens.push_back(cass::StringRef(token));
+    hosts->push_back(create_builder_host("1.0.0." + boost::lexical_cast<std::string>(i + 1)));
+    hosts->back()->set_rack_and_dc("", dc);
+    builder->update_host(hosts->back(), tokens);
+  }
+}
+
+struct SnapshotReader {
+  cass::TokenMapBuilder* builder;
+  cass::Atomic<bool> is_done;
+  cass::Atomic<int> invalid_count;
+};
+
+static void read_snapshots(void* arg) {
+  SnapshotReader* reader = static_cast<SnapshotReader*>(arg);
+  while (!reader->is_done.load()) {
+    cass::TokenMap::ConstPtr token_map(reader->builder->snapshot());
+    const cass::CopyOnWriteHostVec& replicas = token_map->get_replicas("test", "abc");
+    if (replicas->size() > 2) {
+      reader->invalid_count.fetch_add(1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(token_map_builder)
+
+BOOST_AUTO_TEST_CASE(without_loop)
+{
+  cass::SharedRefPtr<cass::TokenMapBuilder> builder(new cass::TokenMapBuilder());
+  builder->set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+  builder->update_keyspace("test", cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                     new cass::SimpleStrategy("", 2)));
+  cass::HostVec hosts;
+  add_builder_hosts(builder.get(), &hosts);
+
+  // Nothing is published until the token map is built
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 0u);
+
+  builder->build();
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 2u);
+
+  builder->reset();
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(host_location_copied)
+{
+  cass::SharedRefPtr<cass::TokenMapBuilder> builder(new cass::TokenMapBuilder());
+  builder->set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+
+  cass::NetworkTopologyStrategy::DCReplicaCountMap replication_factors;
+  replication_factors["dc1"] = 2;
+  builder->update_keyspace("test", cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                     new cass::NetworkTopologyStrategy("", replication_factors)));
+
+  cass::HostVec hosts;
+  add_builder_hosts(builder.get(), &hosts, "dc1");
+
+  // The replicas are computed from the data center the hosts had when their
+  // tokens were updated
+  for (cass::HostVec::iterator it = hosts.begin(); it != hosts.end(); ++it) {
+    (*it)->set_rack_and_dc("", "dc2");
+  }
+  builder->build();
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(snapshots)
+{
+  uv_loop_t* loop;
+
+#if UV_VERSION_MAJOR == 0
+  loop = uv_loop_new();
+#else
+  uv_loop_t loop_storage__;
+  loop = &loop_storage__;
+  uv_loop_init(loop);
+#endif
+
+  cass::SharedRefPtr<cass::TokenMapBuilder> builder(new cass::TokenMapBuilder());
+  builder->set_loop(loop);
+
+  SnapshotReader reader;
+  reader.builder = builder.get();
+  reader.is_done.store(false);
+  reader.invalid_count.store(0);
+
+  uv_thread_t thread;
+  uv_thread_create(&thread, read_snapshots, &reader);
+
+  builder->set_partitioner(cass::Murmur3Partitioner::PARTITIONER_CLASS);
+  builder->update_keyspace("test", cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                     new cass::SimpleStrategy("", 2)));
+  cass::HostVec hosts;
+  add_builder_hosts(builder.get(), &hosts);
+  builder->build();
+
+  // The changes are applied on the thread pool
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  cass::TokenMap::ConstPtr snapshot(builder->snapshot());
+  BOOST_REQUIRE_EQUAL(snapshot->get_replicas("test", "abc")->size(), 2u);
+
+  // Published snapshots are immutable
+  builder->remove_host(hosts[0]);
+  builder->remove_host(hosts[1]);
+  uv_run(loop, UV_RUN_DEFAULT);
+
+  BOOST_CHECK_EQUAL(snapshot->get_replicas("test", "abc")->size(), 2u);
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 1u);
+
+  // The previous snapshot is used while the token map is being rebuilt
+  builder->clear();
+  add_builder_hosts(builder.get(), &hosts);
+  uv_run(loop, UV_RUN_DEFAULT);
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 1u);
+
+  builder->update_keyspace("test", cass::SharedRefPtr<cass::ReplicationStrategy>(
+                                     new cass::SimpleStrategy("", 2)));
+  builder->build();
+  uv_run(loop, UV_RUN_DEFAULT);
+  BOOST_CHECK_EQUAL(builder->snapshot()->get_replicas("test", "abc")->size(), 2u);
+
+  reader.is_done.store(true);
+  uv_thread_join(&thread);
+  BOOST_CHECK_EQUAL(reader.invalid_count.load(), 0);
+
+#if UV_VERSION_MAJOR == 0
+  uv_loop_delete(loop);
+#else
+  uv_loop_close(loop);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
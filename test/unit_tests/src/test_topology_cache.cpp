@@ -0,0 +1,210 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "topology_cache.hpp"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <stdio.h>
+#include <string>
+#include <uv.h>
+
+static void populate_cache(cass::TopologyCache* cache) {
+  cache->schema_version = "0123456789abcdef";
+  cache->partitioner = "org.apache.cassandra.dht.Murmur3Partitioner";
+
+  for (int i = 1; i <= 3; ++i) {
+    cass::TopologyCache::HostEntry host;
+    cass::Address::from_string("127.0.0." + boost::lexical_cast<std::string>(i), 9042, &host.address);
+    host.dc = "dc1";
+    host.rack = "rack" + boost::lexical_cast<std::string>(i);
+    host.release_version = "3.0.9";
+    host.listen_address = host.address.to_string();
+    for (int j = 0; j < 4; ++j) {
+      host.tokens.push_back(boost::lexical_cast<std::string>(i * 1000 + j));
+    }
+    cache->hosts[host.address] = host;
+  }
+
+  cass::TopologyCache::KeyspaceEntry simple;
+  simple.strategy_class = "org.apache.cassandra.locator.SimpleStrategy";
+  simple.options["replication_factor"] = "3";
+  cache->keyspaces["ks1"] = simple;
+
+  cass::TopologyCache::KeyspaceEntry nts;
+  nts.strategy_class = "org.apache.cassandra.locator.NetworkTopologyStrategy";
+  nts.options["dc1"] = "3";
+  nts.options["dc2"] = "2";
+  cache->keyspaces["ks2"] = nts;
+}
+
+static void check_cache(const cass::TopologyCache& cache) {
+  BOOST_CHECK_EQUAL(cache.schema_version, "0123456789abcdef");
+  BOOST_CHECK_EQUAL(cache.partitioner, "org.apache.cassandra.dht.Murmur3Partitioner");
+  BOOST_REQUIRE_EQUAL(cache.hosts.size(), 3u);
+
+  cass::Address address("127.0.0.2", 9042);
+  cass::TopologyCache::HostEntryMap::const_iterator host = cache.hosts.find(address);
+  BOOST_REQUIRE(host != cache.hosts.end());
+  BOOST_CHECK(host->second.address == address);
+  BOOST_CHECK_EQUAL(host->second.dc, "dc1");
+  BOOST_CHECK_EQUAL(host->second.rack, "rack2");
+  BOOST_CHECK_EQUAL(host->second.release_version, "3.0.9");
+  BOOST_CHECK_EQUAL(host->second.listen_address, "127.0.0.2");
+  BOOST_REQUIRE_EQUAL(host->second.tokens.size(), 4u);
+  BOOST_CHECK_EQUAL(host->second.tokens[3], "2003");
+
+  BOOST_REQUIRE_EQUAL(cache.keyspaces.size(), 2u);
+  const cass::TopologyCache::KeyspaceEntry& nts = cache.keyspaces.find("ks2")->second;
+  BOOST_CHECK_EQUAL(nts.strategy_class, "org.apache.cassandra.locator.NetworkTopologyStrategy");
+  BOOST_REQUIRE_EQUAL(nts.options.size(), 2u);
+  BOOST_CHECK_EQUAL(nts.options.find("dc2")->second, "2");
+}
+
+BOOST_AUTO_TEST_SUITE(topology_cache)
+
+BOOST_AUTO_TEST_CASE(encode_decode)
+{
+  cass::TopologyCache cache;
+  populate_cache(&cache);
+
+  std::string data;
+  cache.encode(&data);
+
+  cass::TopologyCache decoded;
+  BOOST_REQUIRE(decoded.decode(data.data(), data.size()));
+  check_cache(decoded);
+}
+
+BOOST_AUTO_TEST_CASE(invalid)
+{
+  cass::TopologyCache cache;
+  populate_cache(&cache);
+
+  std::string data;
+  cache.encode(&data);
+
+  cass::TopologyCache decoded;
+
+  // Truncated
+  for (size_t size = 0; size < data.size(); size += 7) {
+    BOOST_CHECK(!decoded.decode(data.data(), size));
+    BOOST_CHECK(decoded.hosts.empty());
+  }
+
+  // Trailing data
+  std::string trailing(data + "x");
+  BOOST_CHECK(!decoded.decode(trailing.data(), trailing.size()));
+
+  // Bad magic
+  std::string bad_magic(data);
+  bad_magic[0] = 'X';
+  BOOST_CHECK(!decoded.decode(bad_magic.data(), bad_magic.size()));
+
+  // Different format version
+  std::string bad_version(data);
+  bad_version[11] = static_cast<char>(cass::TopologyCache::FORMAT_VERSION + 1);
+  BOOST_CHECK(!decoded.decode(bad_version.data(), bad_version.size()));
+}
+
+BOOST_AUTO_TEST_CASE(save_load)
+{
+  std::string path("topology_cache_test.bin");
+
+  cass::TopologyCache cache;
+  populate_cache(&cache);
+  BOOST_REQUIRE(cache.save(path));
+
+  cass::TopologyCache loaded;
+  BOOST_REQUIRE(loaded.load(path));
+  check_cache(loaded);
+
+  // Replacing an existing cache
+  cache.hosts.erase(cache.hosts.begin());
+  BOOST_REQUIRE(cache.save(path));
+  BOOST_REQUIRE(loaded.load(path));
+  BOOST_CHECK_EQUAL(loaded.hosts.size(), 2u);
+
+  remove(path.c_str());
+  BOOST_CHECK(!loaded.load(path));
+}
+
+BOOST_AUTO_TEST_CASE(writer)
+{
+  std::string path("topology_cache_writer_test.bin");
+
+  uv_loop_t* loop;
+
+#if UV_VERSION_MAJOR == 0
+  loop = uv_loop_new();
+#else
+  uv_loop_t loop_storage__;
+  loop = &loop_storage__;
+  uv_loop_init(loop);
+#endif
+
+  cass::TopologyCacheWriter writer;
+  writer.set_loop(loop);
+
+  // The first save is written on the thread pool and the saves requested
+  // while it's in progress are coalesced into one write of the latest cache
+  cass::TopologyCache cache;
+  populate_cache(&cache);
+  writer.save(path, cache);
+  BOOST_CHECK(writer.is_working());
+  cache.hosts.erase(cache.hosts.begin());
+  writer.save(path, cache);
+  cache.hosts.erase(cache.hosts.begin());
+  writer.save(path, cache);
+
+  uv_run(loop, UV_RUN_DEFAULT);
+  BOOST_CHECK(!writer.is_working());
+
+  cass::TopologyCache loaded;
+  BOOST_REQUIRE(loaded.load(path));
+  BOOST_CHECK_EQUAL(loaded.hosts.size(), 1u);
+  BOOST_CHECK(fopen((path + ".tmp").c_str(), "rb") == NULL);
+
+  remove(path.c_str());
+
+#if UV_VERSION_MAJOR == 0
+  uv_loop_delete(loop);
+#else
+  uv_loop_close(loop);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(replication_from_options)
+{
+  cass::TopologyCache cache;
+  populate_cache(&cache);
+
+  const cass::TopologyCache::KeyspaceEntry& simple = cache.keyspaces.find("ks1")->second;
+  cass::SharedRefPtr<cass::ReplicationStrategy> strategy(
+        cass::ReplicationStrategy::from_options(simple.strategy_class, simple.options));
+  BOOST_CHECK_EQUAL(strategy->key(), "SimpleStrategy{3}");
+
+  const cass::TopologyCache::KeyspaceEntry& nts = cache.keyspaces.find("ks2")->second;
+  strategy = cass::ReplicationStrategy::from_options(nts.strategy_class, nts.options);
+  BOOST_CHECK_EQUAL(strategy->key(), "NetworkTopologyStrategy{dc1:3,dc2:2}");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+/*
+  Copyright (c) 2014-2016 DataStax
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE cassandra
+#endif
+
+#include "constants.hpp"
+#include "metadata.hpp"
+#include "query_request.hpp"
+#include "request_handler.hpp"
+#include "response.hpp"
+#include "serialization.hpp"
+#include "trace_handler.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(tracing)
+
+BOOST_AUTO_TEST_CASE(request_flag)
+{
+  cass::Metadata metadata;
+
+  cass::SharedRefPtr<cass::QueryRequest> request(new cass::QueryRequest("SELECT 1"));
+  cass::SharedRefPtr<cass::RequestHandler> request_handler(
+        new cass::RequestHandler(request.get(), new cass::ResponseFuture(metadata), NULL));
+
+  cass::BufferVec bufs;
+  BOOST_REQUIRE_GT(request_handler->encode(4, 0, &bufs), 0);
+  BOOST_CHECK(!(bufs[0].data()[1] & CASS_FLAG_TRACING));
+
+  request->set_tracing(true);
+  bufs.clear();
+  BOOST_REQUIRE_GT(request_handler->encode(4, 0, &bufs), 0);
+  BOOST_CHECK(bufs[0].data()[1] & CASS_FLAG_TRACING);
+}
+
+BOOST_AUTO_TEST_CASE(response_tracing_id)
+{
+  CassUuid tracing_id;
+  tracing_id.time_and_version = 0x11E6000012345678ULL;
+  tracing_id.clock_seq_and_node = 0x8000AABBCCDDEEFFULL;
+
+  // A v4 void result with a tracing ID
+  char frame[CASS_HEADER_SIZE_V3 + 16 + 4];
+  char* pos = frame;
+  pos = cass::encode_byte(pos, 0x84);
+  pos = cass::encode_byte(pos, CASS_FLAG_TRACING);
+  cass::encode_int16(pos, 0);
+  pos += 2;
+  pos = cass::encode_byte(pos, CQL_OPCODE_RESULT);
+  cass::encode_int32(pos, 16 + 4);
+  pos += 4;
+  cass::encode_uuid(pos, tracing_id);
+  pos += 16;
+  cass::encode_int32(pos, CASS_RESULT_KIND_VOID);
+
+  cass::ResponseMessage message;
+  BOOST_REQUIRE_EQUAL(message.decode(frame, sizeof(frame)),
+                      static_cast<ssize_t>(sizeof(frame)));
+  BOOST_REQUIRE(message.is_body_ready());
+
+  const cass::SharedRefPtr<cass::Response>& response = message.response_body();
+  BOOST_REQUIRE(response->has_tracing_id());
+  BOOST_CHECK_EQUAL(response->tracing_id().time_and_version, tracing_id.time_and_version);
+  BOOST_CHECK_EQUAL(response->tracing_id().clock_seq_and_node, tracing_id.clock_seq_and_node);
+}
+
+BOOST_AUTO_TEST_CASE(retry_backoff)
+{
+  const uint64_t max_wait_ms = 1000;
+  const uint64_t start_ms = 5000;
+  const uint64_t deadline_ms = start_ms + max_wait_ms;
+
+  // Simulate each attempt's query taking 10 ms followed by the backoff wait
+  std::vector<uint64_t> waits;
+  uint64_t now_ms = start_ms;
+  uint64_t retry_wait_ms = 0;
+  while (true) {
+    now_ms += 10;
+    retry_wait_ms = cass::TraceHandler::next_retry_wait_ms(retry_wait_ms, now_ms, deadline_ms);
+    if (retry_wait_ms == 0) break;
+    waits.push_back(retry_wait_ms);
+    now_ms += retry_wait_ms;
+  }
+
+  BOOST_REQUIRE_GE(waits.size(), 8u);
+  BOOST_CHECK_EQUAL(waits[0], 3u);
+  BOOST_CHECK_EQUAL(waits[1], 6u);
+  BOOST_CHECK_EQUAL(waits[6], 192u);
+  BOOST_CHECK_EQUAL(waits[7], 250u);
+  // The sleeps count against the deadline and the last wait is cut short so
+  // the final attempt happens at the deadline
+  BOOST_CHECK_EQUAL(now_ms, deadline_ms + 10);
+  BOOST_CHECK_LT(waits.back(), 250u);
+}
+
+BOOST_AUTO_TEST_CASE(retry_timeout)
+{
+  CassUuid tracing_id;
+  tracing_id.time_and_version = 0x11E6000012345678ULL;
+  tracing_id.clock_seq_and_node = 0x8000AABBCCDDEEFFULL;
+  cass::SharedRefPtr<cass::TraceFuture> future(new cass::TraceFuture(tracing_id));
+
+  // The trace isn't available and the deadline has passed
+  cass::SharedRefPtr<cass::TraceHandler> handler(
+        new cass::TraceHandler(NULL, NULL, future.get(), 100,
+                               cass::TraceHandler::now_ms() - 1, 50));
+  handler->on_set(cass::MultipleRequestHandler::ResponseMap());
+
+  BOOST_REQUIRE(future->ready());
+  cass::Future::Error* error = future->get_error();
+  BOOST_REQUIRE(error != NULL);
+  BOOST_CHECK_EQUAL(error->code, CASS_ERROR_LIB_REQUEST_TIMED_OUT);
+  BOOST_CHECK_EQUAL(error->message, "Trace is not complete after 100 ms");
+}
+
+BOOST_AUTO_TEST_SUITE_END()